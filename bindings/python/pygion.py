@@ -2133,6 +2133,7 @@ class _IndexLauncher(_TaskLauncher):
         redop = []
         if self.reduction_op is not None:
             assert self.task.return_type is not None
+            # Uses the runtime's default, which is a deterministic reduction
             launch = c.legion_index_launcher_execute_reduction
             redop = [_redop_ids[self.reduction_op][self.task.return_type]]
 
@@ -20,6 +20,7 @@
 #include <unistd.h>
 #include <legion.h>
 #include <realm/cmdline.h>
+#include <realm/timers.h>
 
 #include "simple_blas.h"
 
@@ -37,12 +38,14 @@ void top_level_task(const Task *task,
 {
   size_t num_elements = 32768;
   size_t num_pieces = 1;
+  bool irregular = false;
 
   const InputArgs &command_args = Runtime::get_input_args();
 
   bool ok = Realm::CommandLineParser()
     .add_option_int("-n", num_elements)
     .add_option_int("-p", num_pieces)
+    .add_option_bool("-irregular", irregular)
     .parse_command_line(command_args.argc, (const char **)command_args.argv);
 
   if(!ok) {
@@ -72,6 +75,17 @@ void top_level_task(const Task *task,
   float exp_result = num_elements * 2.0 * (3.0 + 0.5 * 2.0);
 
   printf("got %g, exp %g\n", result, exp_result);
+
+  // time the same load-imbalanced loop under each schedule
+  if(irregular) {
+    const char *names[] = { "static", "dynamic", "guided" };
+    for(int i = 0; i < 3; i++) {
+      long long t_start = Realm::Clock::current_time_in_microseconds();
+      float sum = irregular_sum(runtime, ctx, x, BlasLoopSchedule(i));
+      long long t_end = Realm::Clock::current_time_in_microseconds();
+      printf("irregular %-7s: sum %g, %lld us\n", names[i], sum, t_end - t_start);
+    }
+  }
 }
 
 int main(int argc, char **argv)
@@ -64,3 +64,56 @@ float BlasTaskImplementations<float>::dot_task_cpu(const Task *task,
     acc += fa_x[i] * fa_y[i];
   return acc;
 }
+
+// the cost of element i grows linearly with i
+static inline float irregular_element(float x, int i)
+{
+  float v = x;
+  for(int j = 0; j < (i >> 4); j++)
+    v = v * 0.999f + 0.001f;
+  return v;
+}
+
+template <>
+float BlasTaskImplementations<float>::irregular_task_cpu(const Task *task,
+							 const std::vector<PhysicalRegion> &regions,
+							 Context ctx, Runtime *runtime)
+{
+  IndexSpace is = regions[0].get_logical_region().get_index_space();
+  Rect<1> bounds = runtime->get_index_space_domain(ctx, is);
+
+  int schedule = *(const int *)(task->args);
+
+  const FieldAccessor<READ_ONLY,float,1,coord_t,
+          Realm::AffineAccessor<float,1,coord_t> > fa_x(regions[0], task->regions[0].instance_fields[0]);
+
+  int lo = bounds.lo[0];
+  int hi = bounds.hi[0];
+  float acc = 0;
+  switch(schedule) {
+  case BLAS_SCHEDULE_DYNAMIC:
+    {
+#pragma omp parallel for schedule(dynamic) reduction(+:acc) if(blas_do_parallel)
+      for(int i = lo; i <= hi; i++)
+	acc += irregular_element(fa_x[i], i - lo);
+      break;
+    }
+
+  case BLAS_SCHEDULE_GUIDED:
+    {
+#pragma omp parallel for schedule(guided) reduction(+:acc) if(blas_do_parallel)
+      for(int i = lo; i <= hi; i++)
+	acc += irregular_element(fa_x[i], i - lo);
+      break;
+    }
+
+  default:
+    {
+#pragma omp parallel for schedule(static) reduction(+:acc) if(blas_do_parallel)
+      for(int i = lo; i <= hi; i++)
+	acc += irregular_element(fa_x[i], i - lo);
+      break;
+    }
+  }
+  return acc;
+}
@@ -58,11 +58,25 @@ T dot(Runtime *runtime, Context ctx,
       const BlasArrayRef<T>& x, BlasArrayRef<T> y,
       IndexPartition distpart = IndexPartition::NO_PART);
 
+// loop schedules for the irregular kernel below
+enum BlasLoopSchedule {
+  BLAS_SCHEDULE_STATIC,
+  BLAS_SCHEDULE_DYNAMIC,
+  BLAS_SCHEDULE_GUIDED,
+};
+
+// sums a function of each element of x whose cost grows with the element's
+//  index, so an even split of the iterations is badly load-imbalanced
+template <typename T>
+T irregular_sum(Runtime *runtime, Context ctx,
+		const BlasArrayRef<T>& x, BlasLoopSchedule schedule);
+
 template <typename T>
 class BlasTaskImplementations {
 public:
   TaskID axpy_task_id;
   TaskID dot_task_id;
+  TaskID irregular_task_id;
 
   // performs _static_ registration of tasks at startup
   void preregister_tasks(void);
@@ -76,6 +90,10 @@ public: // these must be public as they are used as template arguments
   static T dot_task_cpu(const Task *task,
 			const std::vector<PhysicalRegion> &regions,
 			Context ctx, Runtime *runtime);
+
+  static T irregular_task_cpu(const Task *task,
+			      const std::vector<PhysicalRegion> &regions,
+			      Context ctx, Runtime *runtime);
 };
 
 // single-precision float
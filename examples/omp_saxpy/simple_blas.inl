@@ -99,6 +99,18 @@ inline T dot(Runtime *runtime, Context ctx,
   return f.get_result<T>();
 }
 
+template <typename T>
+inline T irregular_sum(Runtime *runtime, Context ctx,
+		       const BlasArrayRef<T>& x, BlasLoopSchedule schedule)
+{
+  int sched_arg = schedule;
+  TaskLauncher launcher(blas_impl_s.irregular_task_id,
+			TaskArgument(&sched_arg, sizeof(int)));
+  x.add_requirement(launcher, READ_ONLY);
+  Future f = runtime->execute_task(ctx, launcher);
+  return f.get_result<T>();
+}
+
 template <typename T>
 inline void BlasTaskImplementations<T>::preregister_tasks(void)
 {
@@ -123,6 +135,17 @@ inline void BlasTaskImplementations<T>::preregister_tasks(void)
 #endif
     Runtime::preregister_task_variant<T, BlasTaskImplementations<T>::dot_task_cpu>(tvr, "dot (cpu)");
   }
+
+  {
+    irregular_task_id = Runtime::generate_static_task_id();
+    TaskVariantRegistrar tvr(irregular_task_id);
+#ifdef REALM_USE_OPENMP
+    tvr.add_constraint(ProcessorConstraint(Processor::OMP_PROC));
+#else
+    tvr.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+#endif
+    Runtime::preregister_task_variant<T, BlasTaskImplementations<T>::irregular_task_cpu>(tvr, "irregular (cpu)");
+  }
 }
 
 
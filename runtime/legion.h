@@ -2063,6 +2063,10 @@ namespace Legion {
       std::vector<FieldID>                          file_fields; // normal files
       std::map<FieldID,
         std::vector</*file name*/const char*> >     field_files; // hdf5 files
+      // Start reading all the attached files into memory in parallel
+      // when the attach is issued (e.g. for sharded checkpoints) so
+      // later copies out of them do not wait on the disk
+      bool                                          prefetch /*= false*/;
     public:
       // Data for external instances
       LayoutConstraintSet                           constraints;
@@ -2358,6 +2362,31 @@ namespace Legion {
                                               bool generic_accessor,
                                               bool check_field_size,
                                               ReductionOpID redop = 0) const;
+      // Initialize an affine accessor for the whole region, the layout is
+      // cached the first time so later accessors for the same field in
+      // the same mode do not have to go back to the runtime or Realm
+      template<typename FT, int N, typename T>
+      Realm::RegionInstance get_affine_accessor(
+                                        Realm::AffineAccessor<FT,N,T> &accessor,
+                                        DomainT<N,T> &bounds,
+                                        PrivilegeMode mode, FieldID fid,
+                                        size_t field_size,
+                                        bool check_field_size,
+                                        bool silence_warnings,
+                                        const char *warning_string,
+                                        size_t offset,
+                                        ReductionOpID redop = 0) const;
+      bool find_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              Realm::RegionInstance &instance, Domain &bounds,
+                              uintptr_t &base, size_t *strides) const;
+      void record_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              Realm::RegionInstance instance,
+                              const Domain &bounds, uintptr_t base,
+                              const size_t *strides) const;
       void report_incompatible_accessor(const char *accessor_kind,
                              Realm::RegionInstance instance, FieldID fid) const;
       void report_incompatible_multi_accessor(unsigned index, FieldID fid,
@@ -3564,6 +3593,7 @@ namespace Legion {
         BY_PREIMAGE, // create partition by preimage
         BY_PREIMAGE_RANGE,  // create partition by preimage range
         BY_ASSOCIATION,  // create partition by association
+        BY_SPACE_FILLING_CURVE, // create partition by weighted curve
       };
       virtual PartitionKind get_partition_kind(void) const = 0;
     public:
@@ -4788,6 +4818,75 @@ namespace Legion {
                           PartitionKind part_kind = LEGION_DISJOINT_KIND);
       ///@}
       ///@{
+      /**
+       * Create a partition of 'parent' by ordering its points along a
+       * space-filling curve (Hilbert or Morton) laid over its bounds and
+       * cutting the curve into one contiguous piece for each point in
+       * 'color_space'. The pieces keep spatial locality and are balanced
+       * by number of points. This works for sparse and irregular index
+       * spaces with no coloring field from the user. Colors are given
+       * pieces in the order the color space is iterated. The curve is
+       * laid out as 2^16 cells over the bounds of the parent, and a cell
+       * that a cut falls inside is split point by point, so each piece is
+       * within one point (or one point's weight) of an even share. This
+       * holds as long as each cell spans at most 2^16 points; with larger
+       * cells (bounds of more than about 2^32 points) cuts stay at cell
+       * boundaries and balance is only as fine as a cell.
+       * The second form weights each point by the value in field 'fid'
+       * of 'handle', which must hold int or size_t values (negative
+       * weights count as zero). Legion fields carry no type, so only the
+       * field size is checked: floating-point fields are not supported
+       * and would be read as integers. Point weights are summed in
+       * parallel on the nodes where the mapped instances live, so this
+       * works for distributed regions. By construction the partition is
+       * disjoint and complete.
+       * @param ctx the enclosing task context
+       * @param parent index space of the partition to be made
+       * @param handle logical region containing the weight field
+       * @param parent_region the parent region from which privileges
+       *                      are derived
+       * @param fid the field ID of the per-point weights
+       * @param color_space space of colors for the partition
+       * @param curve which space-filling curve to order the points by
+       * @param color optional new color for the index partition
+       * @param id the ID of the mapper to use for mapping the weight field
+       * @param tag the context tag to pass to the mapper
+       * @return a new index partition of the parent index space
+       */
+      IndexPartition create_partition_by_space_filling_curve(Context ctx,
+                                    IndexSpace parent,
+                                    IndexSpace color_space,
+                                    SpaceFillingCurve curve = 
+                                                      LEGION_HILBERT_CURVE,
+                                    Color color = LEGION_AUTO_GENERATE_ID);
+      template<int DIM, typename COORD_T, 
+               int COLOR_DIM, typename COLOR_COORD_T>
+      IndexPartitionT<DIM,COORD_T> create_partition_by_space_filling_curve(
+                          Context ctx, IndexSpaceT<DIM,COORD_T> parent,
+                          IndexSpaceT<COLOR_DIM,COLOR_COORD_T> color_space,
+                          SpaceFillingCurve curve = LEGION_HILBERT_CURVE,
+                          Color color = LEGION_AUTO_GENERATE_ID);
+      IndexPartition create_partition_by_space_filling_curve(Context ctx,
+                                    LogicalRegion handle,
+                                    LogicalRegion parent_region,
+                                    FieldID fid,
+                                    IndexSpace color_space,
+                                    SpaceFillingCurve curve = 
+                                                      LEGION_HILBERT_CURVE,
+                                    Color color = LEGION_AUTO_GENERATE_ID,
+                                    MapperID id = 0, MappingTagID tag = 0);
+      template<int DIM, typename COORD_T, 
+               int COLOR_DIM, typename COLOR_COORD_T>
+      IndexPartitionT<DIM,COORD_T> create_partition_by_space_filling_curve(
+                          Context ctx, LogicalRegionT<DIM,COORD_T> handle,
+                          LogicalRegionT<DIM,COORD_T> parent_region,
+                          FieldID fid, // type: int or size_t
+                          IndexSpaceT<COLOR_DIM,COLOR_COORD_T> color_space,
+                          SpaceFillingCurve curve = LEGION_HILBERT_CURVE,
+                          Color color = LEGION_AUTO_GENERATE_ID,
+                          MapperID id = 0, MappingTagID tag = 0);
+      ///@}
+      ///@{
       /**
        * Create partition by image creates a new index partition from an
        * existing field that represents an enumerated function from 
@@ -6013,28 +6112,40 @@ namespace Legion {
        * @param launcher the task launcher configuration
        * @param redop ID for the reduction op to use for reducing return values
        * @param deterministic request that the reduced future value be computed 
-       *        in a deterministic way (more expensive than non-deterministic)
+       *        in a deterministic way; by default each slice sent to
+       *        another node folds its points in point order and the slices
+       *        are folded in the order of their first points, so the result
+       *        does not depend on the order the point tasks finish but can
+       *        change if the mapper slices the launch differently (when
+       *        every point runs on the launching node it is the plain
+       *        point-order fold), while false folds the values of the
+       *        slices in the order they finish
        * @return a future result representing the reduction of
        *    all the return values from the index space of tasks
        */
       Future execute_index_space(Context ctx, const IndexTaskLauncher &launcher,
-                               ReductionOpID redop, bool deterministic = false);
+                               ReductionOpID redop, bool deterministic = true);
 
       /**
        * Reduce a future map down to a single future value using 
        * a specified reduction operator. This assumes that all the values
        * in the future map are instance of the reduction operator's RHS
        * type and the resulting future will also be an RHS type.
+       * The values are folded in a tree over the nodes that hold them so
+       * that only one partial result comes back from each subtree.
        * @param ctx enclosing task context
        * @param future_map the future map to reduct the value
        * @param redop ID for the reduction op to use for reducing values
        * @param deterministic request that the reduced future be computed
-       *        in a deterministic way (more expensive than non-deterministic)
+       *        in a deterministic way; by default every value is brought
+       *        to this node and folded in point order, while false lets
+       *        each node fold the values it produced and folds those
+       *        partial results in the order they arrive
        * @return a future result representing the the reduction of all the
        *         values in the future map
        */
       Future reduce_future_map(Context ctx, const FutureMap &future_map, 
-                               ReductionOpID redop, bool deterministic = false);
+                               ReductionOpID redop, bool deterministic = true);
 
       /**
        * Construct a future map from a collection of buffers. The user must
@@ -1804,7 +1804,7 @@ namespace Legion {
     IndexAttachLauncher::IndexAttachLauncher(ExternalResource r,
                                              LogicalRegion p, const bool restr)
       : resource(r), parent(p), restricted(restr), mode(LEGION_FILE_READ_ONLY),
-        static_dependences(NULL)
+        prefetch(false), static_dependences(NULL)
     //--------------------------------------------------------------------------
     {
     }
@@ -2521,6 +2521,34 @@ namespace Legion {
                                      generic_accessor, check_field_size, redop);
     }
 
+    //--------------------------------------------------------------------------
+    bool PhysicalRegion::find_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              Realm::RegionInstance &instance, Domain &bounds,
+                              uintptr_t &base, size_t *strides) const
+    //--------------------------------------------------------------------------
+    {
+      // Uninitialized regions report their error on the slow path
+      if (impl == NULL)
+        return false;
+      return impl->find_affine_layout(mode, fid, field_size, type_tag,
+          check_field_size, redop, instance, bounds, base, strides);
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalRegion::record_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              Realm::RegionInstance instance,
+                              const Domain &bounds, uintptr_t base,
+                              const size_t *strides) const
+    //--------------------------------------------------------------------------
+    {
+      impl->record_affine_layout(mode, fid, field_size, type_tag,
+          check_field_size, redop, instance, bounds, base, strides);
+    }
+
     //--------------------------------------------------------------------------
     void PhysicalRegion::report_incompatible_accessor(const char *accessor_kind,
                               Realm::RegionInstance instance, FieldID fid) const
@@ -4223,6 +4251,28 @@ namespace Legion {
                                             color, id, tag, part_kind);
     }
 
+    //--------------------------------------------------------------------------
+    IndexPartition Runtime::create_partition_by_space_filling_curve(
+                   Context ctx, IndexSpace parent, IndexSpace color_space,
+                   SpaceFillingCurve curve, Color color)
+    //--------------------------------------------------------------------------
+    {
+      return ctx->create_partition_by_space_filling_curve(parent, color_space,
+                                                          curve, color);
+    }
+
+    //--------------------------------------------------------------------------
+    IndexPartition Runtime::create_partition_by_space_filling_curve(
+                   Context ctx, LogicalRegion handle, 
+                   LogicalRegion parent_region, FieldID fid,
+                   IndexSpace color_space, SpaceFillingCurve curve,
+                   Color color, MapperID id, MappingTagID tag)
+    //--------------------------------------------------------------------------
+    {
+      return ctx->create_partition_by_space_filling_curve(handle, 
+               parent_region, fid, color_space, curve, color, id, tag);
+    }
+
     //--------------------------------------------------------------------------
     IndexPartition Runtime::create_partition_by_image(Context ctx,
                   IndexSpace handle, LogicalPartition projection,
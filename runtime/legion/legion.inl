@@ -2370,15 +2370,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_ONLY, fid, actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<N,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_ONLY, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -2540,15 +2534,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_ONLY, fid, actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<N,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_ONLY, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<N,T>(is);
       }
       // With explicit bounds
@@ -2750,15 +2738,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_ONLY, fid, actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<1,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_ONLY, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -2908,15 +2890,9 @@ namespace Legion {
         : field(fid) 
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_ONLY, fid, actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<1,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_ONLY, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<1,T>(is);
       }
       // With explicit bounds
@@ -3105,15 +3081,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_WRITE, fid,actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<N,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_WRITE, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -3285,15 +3255,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_WRITE, fid,actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<N,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_WRITE, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<N,T>(is);
       }
       // With explicit bounds
@@ -3519,15 +3483,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_WRITE, fid,actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<1,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_WRITE, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -3687,15 +3645,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_READ_WRITE, fid,actual_field_size,&is,
-              Internal::NT_TemplateHelper::encode_tag<1,T>(), warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_READ_WRITE, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<1,T>(is);
       }
       // With explicit bounds
@@ -3908,15 +3860,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size, 
-              &is,Internal::NT_TemplateHelper::encode_tag<N,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -4082,15 +4028,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<N,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<N,T>(is);
       }
       // With explicit bounds
@@ -4303,15 +4243,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<1,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -4465,15 +4399,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<1,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<1,T>(is);
       }
       // With explicit bounds
@@ -4673,15 +4601,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<N,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -4842,15 +4764,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<N,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<N,T>(is);
       }
       // With explicit bounds
@@ -5048,15 +4964,9 @@ namespace Legion {
                     size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<1,T>(),warning_string, 
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       FieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -5205,15 +5115,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_WRITE_DISCARD, fid, actual_field_size,
-              &is,Internal::NT_TemplateHelper::encode_tag<1,T>(),warning_string,
-              silence_warnings, false/*generic accessor*/, check_field_size);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_WRITE_DISCARD, fid,
+            actual_field_size, check_field_size,
+            silence_warnings, warning_string, offset);
         bounds = AffineBounds::Tester<1,T>(is);
       }
       // With explicit bounds
@@ -5395,16 +5299,9 @@ namespace Legion {
                         size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-         region.get_instance_info(LEGION_REDUCE,fid,sizeof(typename REDOP::RHS),
-              &is, Internal::NT_TemplateHelper::encode_tag<N,T>(), 
-              warning_string, silence_warnings, false/*generic accessor*/, 
-              false/*check field size*/, redop);
-        if (!Realm::AffineAccessor<typename REDOP::RHS,N,T>::is_compatible(
-              instance, fid, is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = Realm::AffineAccessor<typename REDOP::RHS,N,T>(
-            instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_REDUCE, fid,
+            sizeof(typename REDOP::RHS), false/*check field size*/,
+            silence_warnings, warning_string, offset, redop);
       }
       // With explicit bounds
       ReductionAccessor(const PhysicalRegion &region, FieldID fid,
@@ -5553,16 +5450,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-         region.get_instance_info(LEGION_REDUCE,fid,sizeof(typename REDOP::RHS),
-              &is, Internal::NT_TemplateHelper::encode_tag<N,T>(), 
-              warning_string, silence_warnings, false/*generic accessor*/, 
-              false/*check field size*/, redop);
-        if (!Realm::AffineAccessor<typename REDOP::RHS,N,T>::is_compatible(
-              instance, fid, is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = Realm::AffineAccessor<typename REDOP::RHS,N,T>(
-            instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_REDUCE, fid,
+            sizeof(typename REDOP::RHS), false/*check field size*/,
+            silence_warnings, warning_string, offset, redop);
         bounds = AffineBounds::Tester<N,T>(is);
       }
       // With explicit bounds
@@ -5746,16 +5636,9 @@ namespace Legion {
                         size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-         region.get_instance_info(LEGION_REDUCE,fid,sizeof(typename REDOP::RHS),
-              &is, Internal::NT_TemplateHelper::encode_tag<1,T>(), 
-              warning_string, silence_warnings, false/*generic accessor*/, 
-              false/*check field size*/, redop);
-        if (!Realm::AffineAccessor<typename REDOP::RHS,1,T>::is_compatible(
-              instance, fid, is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = Realm::AffineAccessor<typename REDOP::RHS,1,T>(
-            instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_REDUCE, fid,
+            sizeof(typename REDOP::RHS), false/*check field size*/,
+            silence_warnings, warning_string, offset, redop);
       }
       // With explicit bounds
       ReductionAccessor(const PhysicalRegion &region, FieldID fid,
@@ -5894,16 +5777,9 @@ namespace Legion {
         : field(fid)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-         region.get_instance_info(LEGION_REDUCE,fid,sizeof(typename REDOP::RHS),
-              &is, Internal::NT_TemplateHelper::encode_tag<1,T>(), 
-              warning_string, silence_warnings, false/*generic accessor*/, 
-              false/*check field size*/, redop);
-        if (!Realm::AffineAccessor<typename REDOP::RHS,1,T>::is_compatible(
-              instance, fid, is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = Realm::AffineAccessor<typename REDOP::RHS,1,T>(
-            instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_REDUCE, fid,
+            sizeof(typename REDOP::RHS), false/*check field size*/,
+            silence_warnings, warning_string, offset, redop);
         bounds = AffineBounds::Tester<1,T>(is);
       }
       // With explicit bounds
@@ -14640,16 +14516,9 @@ namespace Legion {
                           size_t offset = 0)
       {
         DomainT<N,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_NO_ACCESS, fid, sizeof(FT), &is,
-              Internal::NT_TemplateHelper::encode_tag<N,T>(), 
-              warning_string, silence_warnings,
-              false/*generic accessor*/, false/*check field size*/);
-        if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,N,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_NO_ACCESS, fid,
+            sizeof(FT), false/*check field size*/,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       UnsafeFieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -14787,16 +14656,9 @@ namespace Legion {
                           size_t offset = 0)
       {
         DomainT<1,T> is;
-        const Realm::RegionInstance instance = 
-          region.get_instance_info(LEGION_NO_ACCESS, fid, sizeof(FT), &is,
-              Internal::NT_TemplateHelper::encode_tag<1,T>(), 
-              warning_string, silence_warnings,
-              false/*generic accessor*/, false/*check field size*/);
-        if (!Realm::AffineAccessor<FT,1,T>::is_compatible(instance, fid, 
-                                                          is.bounds))
-          region.report_incompatible_accessor("AffineAccessor", instance, fid);
-        accessor = 
-          Realm::AffineAccessor<FT,1,T>(instance, fid, is.bounds, offset);
+        region.get_affine_accessor(accessor, is, LEGION_NO_ACCESS, fid,
+            sizeof(FT), false/*check field size*/,
+            silence_warnings, warning_string, offset);
       }
       // With explicit bounds
       UnsafeFieldAccessor(const PhysicalRegion &region, FieldID fid,
@@ -18901,6 +18763,51 @@ namespace Legion {
       return result.bounds;
     }
 
+    //--------------------------------------------------------------------------
+    template<typename FT, int N, typename T>
+    Realm::RegionInstance PhysicalRegion::get_affine_accessor(
+                  Realm::AffineAccessor<FT,N,T> &accessor, DomainT<N,T> &bounds,
+                  PrivilegeMode mode, FieldID fid, size_t field_size,
+                  bool check_field_size, bool silence_warnings,
+                  const char *warning_string, size_t offset,
+                  ReductionOpID redop) const
+    //--------------------------------------------------------------------------
+    {
+      const TypeTag type_tag = Internal::NT_TemplateHelper::encode_tag<N,T>();
+      Realm::RegionInstance instance;
+#if !defined(REALM_ACCESSOR_DEBUG) && !defined(REALM_USE_KOKKOS)
+      // Realm's debug and Kokkos accessors carry extra state so they
+      // always have to be made the slow way
+      Domain domain;
+      uintptr_t base;
+      size_t strides[N];
+      if (find_affine_layout(mode, fid, field_size, type_tag, check_field_size,
+                             redop, instance, domain, base, strides))
+      {
+        bounds = domain;
+        accessor.base = base + offset;
+        for (int i = 0; i < N; i++)
+          accessor.strides[i] = strides[i];
+        return instance;
+      }
+#endif
+      instance = get_instance_info(mode, fid, field_size, &bounds, type_tag,
+          warning_string, silence_warnings, false/*generic accessor*/,
+          check_field_size, redop);
+      if (!Realm::AffineAccessor<FT,N,T>::is_compatible(instance, fid,
+                                                        bounds.bounds))
+        report_incompatible_accessor("AffineAccessor", instance, fid);
+      accessor =
+        Realm::AffineAccessor<FT,N,T>(instance, fid, bounds.bounds, offset);
+#if !defined(REALM_ACCESSOR_DEBUG) && !defined(REALM_USE_KOKKOS)
+      for (int i = 0; i < N; i++)
+        strides[i] = accessor.strides[i];
+      record_affine_layout(mode, fid, field_size, type_tag, check_field_size,
+          redop, instance, Domain(bounds), accessor.base - offset, strides);
+#endif
+      return instance;
+    }
+
     //--------------------------------------------------------------------------
     inline bool PieceIterator::valid(void) const
     //--------------------------------------------------------------------------
@@ -19815,6 +19722,34 @@ namespace Legion {
             IndexSpace(color_space), color, id, tag, part_kind));
     }
 
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T, int COLOR_DIM, typename COLOR_T>
+    IndexPartitionT<DIM,T> Runtime::create_partition_by_space_filling_curve(
+                                    Context ctx, IndexSpaceT<DIM,T> parent,
+                                    IndexSpaceT<COLOR_DIM,COLOR_T> color_space,
+                                    SpaceFillingCurve curve, Color color)
+    //--------------------------------------------------------------------------
+    {
+      return IndexPartitionT<DIM,T>(create_partition_by_space_filling_curve(
+            ctx, IndexSpace(parent), IndexSpace(color_space), curve, color));
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T, int COLOR_DIM, typename COLOR_T>
+    IndexPartitionT<DIM,T> Runtime::create_partition_by_space_filling_curve(
+                                    Context ctx, LogicalRegionT<DIM,T> handle,
+                                    LogicalRegionT<DIM,T> parent_region,
+                                    FieldID fid,
+                                    IndexSpaceT<COLOR_DIM,COLOR_T> color_space,
+                                    SpaceFillingCurve curve, Color color,
+                                    MapperID id, MappingTagID tag)
+    //--------------------------------------------------------------------------
+    {
+      return IndexPartitionT<DIM,T>(create_partition_by_space_filling_curve(
+            ctx, LogicalRegion(handle), LogicalRegion(parent_region), fid,
+            IndexSpace(color_space), curve, color, id, tag));
+    }
+
     //--------------------------------------------------------------------------
     template<int DIM1, typename T1, int DIM2, typename T2,
              int COLOR_DIM, typename COLOR_T>
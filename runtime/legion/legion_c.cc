@@ -1414,6 +1414,53 @@ legion_index_partition_create_by_field(legion_runtime_t runtime_,
   return CObjectWrapper::wrap(ip);
 }
 
+legion_index_partition_t
+legion_index_partition_create_by_space_filling_curve(
+  legion_runtime_t runtime_,
+  legion_context_t ctx_,
+  legion_index_space_t parent_,
+  legion_index_space_t color_space_,
+  legion_space_filling_curve_t curve /* = LEGION_HILBERT_CURVE */,
+  legion_color_t color /* = AUTO_GENERATE_ID */)
+{
+  Runtime *runtime = CObjectWrapper::unwrap(runtime_);
+  Context ctx = CObjectWrapper::unwrap(ctx_)->context();
+  IndexSpace parent = CObjectWrapper::unwrap(parent_);
+  IndexSpace color_space = CObjectWrapper::unwrap(color_space_);
+
+  IndexPartition ip =
+    runtime->create_partition_by_space_filling_curve(ctx, parent, color_space,
+                                                     curve, color);
+
+  return CObjectWrapper::wrap(ip);
+}
+
+legion_index_partition_t
+legion_index_partition_create_by_weighted_space_filling_curve(
+  legion_runtime_t runtime_,
+  legion_context_t ctx_,
+  legion_logical_region_t handle_,
+  legion_logical_region_t parent_,
+  legion_field_id_t fid,
+  legion_index_space_t color_space_,
+  legion_space_filling_curve_t curve /* = LEGION_HILBERT_CURVE */,
+  legion_color_t color /* = AUTO_GENERATE_ID */,
+  legion_mapper_id_t id /* = 0 */,
+  legion_mapping_tag_id_t tag /* = 0 */)
+{
+  Runtime *runtime = CObjectWrapper::unwrap(runtime_);
+  Context ctx = CObjectWrapper::unwrap(ctx_)->context();
+  LogicalRegion handle = CObjectWrapper::unwrap(handle_);
+  LogicalRegion parent = CObjectWrapper::unwrap(parent_);
+  IndexSpace color_space = CObjectWrapper::unwrap(color_space_);
+
+  IndexPartition ip =
+    runtime->create_partition_by_space_filling_curve(ctx, handle, parent, fid,
+                                   color_space, curve, color, id, tag);
+
+  return CObjectWrapper::wrap(ip);
+}
+
 legion_index_partition_t
 legion_index_partition_create_by_image(
   legion_runtime_t runtime_,
@@ -5438,6 +5485,16 @@ legion_index_attach_launcher_set_restricted(
   handle->restricted = restricted;
 }
 
+void
+legion_index_attach_launcher_set_prefetch(
+    legion_index_attach_launcher_t handle_,
+    bool prefetch)
+{
+  IndexAttachLauncher *handle = CObjectWrapper::unwrap(handle_);
+
+  handle->prefetch = prefetch;
+}
+
 void
 legion_index_attach_launcher_attach_file(legion_index_attach_launcher_t handle_,
                                          legion_logical_region_t region_,
@@ -6331,6 +6388,129 @@ legion_accessor_array_##DIM##d_ref_point(legion_accessor_array_##DIM##d_t handle
 LEGION_FOREACH_N(REF_POINT)
 #undef REF_POINT
 
+// Copies a rectangle between an instance and a dense buffer, with the
+// first dimension varying fastest. Rows are moved with a single memcpy
+// whenever the instance is packed along the first dimension.
+template<int DIM>
+static void copy_accessor_rect(
+    UnsafeFieldAccessor<char,DIM,coord_t,
+                        Realm::AffineAccessor<char,DIM,coord_t> > *accessor,
+    const Rect<DIM,coord_t> &rect, char *buffer, size_t bytes, bool read)
+{
+  if (rect.empty())
+    return;
+  const size_t row_points = rect.hi[0] - rect.lo[0] + 1;
+  const size_t stride = accessor->accessor.strides[0];
+  Rect<DIM,coord_t> rows = rect;
+  rows.hi[0] = rect.lo[0];
+  // Instances that are dense over the whole rectangle need only one copy
+  bool dense = (stride == bytes);
+  size_t expected = row_points * bytes;
+  for (int i = 1; dense && (i < DIM); i++)
+  {
+    if (size_t(accessor->accessor.strides[i]) != expected)
+      dense = false;
+    expected *= (rect.hi[i] - rect.lo[i] + 1);
+  }
+  if (dense)
+  {
+    char *ptr = accessor->ptr(rect.lo);
+    if (read)
+      memcpy(buffer, ptr, expected);
+    else
+      memcpy(ptr, buffer, expected);
+    return;
+  }
+  for (PointInRectIterator<DIM,coord_t> itr(rows); itr(); itr++)
+  {
+    char *ptr = accessor->ptr(*itr);
+    if (stride == bytes)
+    {
+      if (read)
+        memcpy(buffer, ptr, row_points * bytes);
+      else
+        memcpy(ptr, buffer, row_points * bytes);
+      buffer += row_points * bytes;
+    }
+    else
+    {
+      for (size_t idx = 0; idx < row_points; idx++, buffer += bytes)
+      {
+        if (read)
+          memcpy(buffer, ptr + idx * stride, bytes);
+        else
+          memcpy(ptr + idx * stride, buffer, bytes);
+      }
+    }
+  }
+}
+
+#define READ_RECT(DIM) \
+void \
+legion_accessor_array_##DIM##d_read_rect(legion_accessor_array_##DIM##d_t handle_, \
+                                         legion_rect_##DIM##d_t rect_, \
+                                         void *dst, size_t bytes) \
+{ \
+  UnsafeFieldAccessor<char,DIM,coord_t,Realm::AffineAccessor<char,DIM,coord_t> > \
+    *handle = CObjectWrapper::unwrap(handle_); \
+  Rect##DIM##D rect = CObjectWrapper::unwrap(rect_); \
+ \
+  copy_accessor_rect<DIM>(handle, rect, static_cast<char*>(dst), \
+                          bytes, true/*read*/); \
+}
+LEGION_FOREACH_N(READ_RECT)
+#undef READ_RECT
+
+#define WRITE_RECT(DIM) \
+void \
+legion_accessor_array_##DIM##d_write_rect(legion_accessor_array_##DIM##d_t handle_, \
+                                          legion_rect_##DIM##d_t rect_, \
+                                          const void *src, size_t bytes) \
+{ \
+  UnsafeFieldAccessor<char,DIM,coord_t,Realm::AffineAccessor<char,DIM,coord_t> > \
+    *handle = CObjectWrapper::unwrap(handle_); \
+  Rect##DIM##D rect = CObjectWrapper::unwrap(rect_); \
+ \
+  copy_accessor_rect<DIM>(handle, rect, \
+      const_cast<char*>(static_cast<const char*>(src)), bytes, false/*read*/); \
+}
+LEGION_FOREACH_N(WRITE_RECT)
+#undef WRITE_RECT
+
+#define READ_POINTS(DIM) \
+void \
+legion_accessor_array_##DIM##d_read_points(legion_accessor_array_##DIM##d_t handle_, \
+                                           const legion_point_##DIM##d_t *points_, \
+                                           size_t num_points, \
+                                           void *dst_, size_t bytes) \
+{ \
+  UnsafeFieldAccessor<char,DIM,coord_t,Realm::AffineAccessor<char,DIM,coord_t> > \
+    *handle = CObjectWrapper::unwrap(handle_); \
+  char *dst = static_cast<char*>(dst_); \
+ \
+  for (size_t idx = 0; idx < num_points; idx++, dst += bytes) \
+    memcpy(dst, handle->ptr(CObjectWrapper::unwrap(points_[idx])), bytes); \
+}
+LEGION_FOREACH_N(READ_POINTS)
+#undef READ_POINTS
+
+#define WRITE_POINTS(DIM) \
+void \
+legion_accessor_array_##DIM##d_write_points(legion_accessor_array_##DIM##d_t handle_, \
+                                            const legion_point_##DIM##d_t *points_, \
+                                            size_t num_points, \
+                                            const void *src_, size_t bytes) \
+{ \
+  UnsafeFieldAccessor<char,DIM,coord_t,Realm::AffineAccessor<char,DIM,coord_t> > \
+    *handle = CObjectWrapper::unwrap(handle_); \
+  const char *src = static_cast<const char*>(src_); \
+ \
+  for (size_t idx = 0; idx < num_points; idx++, src += bytes) \
+    memcpy(handle->ptr(CObjectWrapper::unwrap(points_[idx])), src, bytes); \
+}
+LEGION_FOREACH_N(WRITE_POINTS)
+#undef WRITE_POINTS
+
 // -----------------------------------------------------------------------
 // External Resource Operations
 // -----------------------------------------------------------------------
@@ -1310,6 +1310,38 @@ extern "C" {
                                          legion_mapping_tag_id_t tag /* = 0 */,
                                          legion_partition_kind_t part_kind /* = DISJOINT_KIND */);
 
+  /**
+   * @return Caller takes ownership of return value.
+   *
+   * @see Legion::Runtime::create_partition_by_space_filling_curve()
+   */
+  legion_index_partition_t
+  legion_index_partition_create_by_space_filling_curve(
+    legion_runtime_t runtime,
+    legion_context_t ctx,
+    legion_index_space_t parent,
+    legion_index_space_t color_space,
+    legion_space_filling_curve_t curve /* = LEGION_HILBERT_CURVE */,
+    legion_color_t color /* = AUTO_GENERATE_ID */);
+
+  /**
+   * @return Caller takes ownership of return value.
+   *
+   * @see Legion::Runtime::create_partition_by_space_filling_curve()
+   */
+  legion_index_partition_t
+  legion_index_partition_create_by_weighted_space_filling_curve(
+    legion_runtime_t runtime,
+    legion_context_t ctx,
+    legion_logical_region_t handle,
+    legion_logical_region_t parent,
+    legion_field_id_t fid,
+    legion_index_space_t color_space,
+    legion_space_filling_curve_t curve /* = LEGION_HILBERT_CURVE */,
+    legion_color_t color /* = AUTO_GENERATE_ID */,
+    legion_mapper_id_t id /* = 0 */,
+    legion_mapping_tag_id_t tag /* = 0 */);
+
   /**
    * @return Caller takes ownership of return value.
    *
@@ -3027,6 +3059,9 @@ extern "C" {
                                legion_index_launcher_t launcher);
 
   /**
+   * Uses the default deterministic reduction; see
+   * legion_index_launcher_execute_deterministic_reduction to choose.
+   *
    * @return Caller takes ownership of return value.
    *
    * @see Legion::Runtime::execute_index_space(Context, const IndexTaskLauncher &, ReductionOpID)
@@ -4331,6 +4366,13 @@ extern "C" {
   legion_index_attach_launcher_set_restricted(
       legion_index_attach_launcher_t handle, bool restricted);
 
+  /**
+   * @see Legion::IndexAttachLauncher::prefetch
+   */
+  void
+  legion_index_attach_launcher_set_prefetch(
+      legion_index_attach_launcher_t handle, bool prefetch);
+
   /**
    * @see Legion::IndexAttachLauncher::attach_file
    */
@@ -4741,6 +4783,50 @@ extern "C" {
   LEGION_FOREACH_N(REF_ARRAY)
 #undef REF_ARRAY
 
+  // Bulk read/write
+  //
+  // These copy every point of a rectangle, or of a list of points, between
+  // the instance and a caller buffer in a single call. Each element is
+  // `bytes` bytes long. Rectangles are packed densely in the buffer with
+  // the first dimension varying fastest, which is the same order as a
+  // Legion domain's linearization. For zero-copy access, use
+  // legion_accessor_array_*d_raw_rect_ptr instead. It returns a base
+  // pointer and the byte stride of every dimension.
+
+#define READ_RECT(DIM) \
+  void \
+  legion_accessor_array_##DIM##d_read_rect(legion_accessor_array_##DIM##d_t handle, \
+                                     legion_rect_##DIM##d_t rect, \
+                                     void *dst, size_t bytes);
+  LEGION_FOREACH_N(READ_RECT)
+#undef READ_RECT
+
+#define WRITE_RECT(DIM) \
+  void \
+  legion_accessor_array_##DIM##d_write_rect(legion_accessor_array_##DIM##d_t handle, \
+                                      legion_rect_##DIM##d_t rect, \
+                                      const void *src, size_t bytes);
+  LEGION_FOREACH_N(WRITE_RECT)
+#undef WRITE_RECT
+
+#define READ_POINTS(DIM) \
+  void \
+  legion_accessor_array_##DIM##d_read_points(legion_accessor_array_##DIM##d_t handle, \
+                                       const legion_point_##DIM##d_t *points, \
+                                       size_t num_points, \
+                                       void *dst, size_t bytes);
+  LEGION_FOREACH_N(READ_POINTS)
+#undef READ_POINTS
+
+#define WRITE_POINTS(DIM) \
+  void \
+  legion_accessor_array_##DIM##d_write_points(legion_accessor_array_##DIM##d_t handle, \
+                                        const legion_point_##DIM##d_t *points, \
+                                        size_t num_points, \
+                                        const void *src, size_t bytes);
+  LEGION_FOREACH_N(WRITE_POINTS)
+#undef WRITE_POINTS
+
   /**
    * @param handle Caller must have ownership of parameter `handle`.
    */
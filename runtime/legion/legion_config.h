@@ -1252,6 +1252,8 @@ typedef enum legion_error_t {
   ERROR_INDEX_SPACE_ATTACH = 576,
   ERROR_INDEX_SPACE_DETACH = 577,
   ERROR_POST_EXECUTION_UNORDERED_OPERATION = 578,
+  ERROR_ILLEGAL_PARTITION_SFC = 579,
+  ERROR_INVALID_PARTITION_BY_SFC_WEIGHT = 580,
   
 
   LEGION_WARNING_FUTURE_NONLEAF = 1000,
@@ -1457,6 +1459,11 @@ typedef enum legion_external_resource_t {
   LEGION_DEPRECATED_ENUM(EXTERNAL_INSTANCE)
 } legion_external_resource_t;
 
+typedef enum legion_space_filling_curve_t {
+  LEGION_MORTON_CURVE, // Z-order curve
+  LEGION_HILBERT_CURVE, // Hilbert curve
+} legion_space_filling_curve_t;
+
 typedef enum legion_timing_measurement_t {
   LEGION_MEASURE_SECONDS,
   LEGION_MEASURE_MICRO_SECONDS,
@@ -4340,6 +4340,106 @@ namespace Legion {
       return pid;
     }
 
+    //--------------------------------------------------------------------------
+    IndexPartition InnerContext::create_partition_by_space_filling_curve(
+                                                IndexSpace parent,
+                                                IndexSpace color_space,
+                                                SpaceFillingCurve curve,
+                                                Color color)
+    //--------------------------------------------------------------------------
+    {
+      AutoRuntimeCall call(this);  
+      const IndexPartition pid(runtime->get_unique_index_partition_id(), 
+                               parent.get_tree_id(), parent.get_type_tag());
+      const DistributedID did = runtime->get_available_distributed_id();
+#ifdef DEBUG_LEGION
+      log_index.debug("Creating partition %d by space-filling curve with "
+                      "parent index space %x in task %s (ID %lld)", pid.id,
+                      parent.id, get_task_name(), get_unique_id());
+#endif
+      LegionColor partition_color = INVALID_COLOR;
+      if (color != LEGION_AUTO_GENERATE_ID)
+        partition_color = color;
+      PendingPartitionOp *part_op = 
+        runtime->get_available_pending_partition_op();
+      part_op->initialize_sfc_partition(this, pid, curve);
+      const ApEvent term_event = part_op->get_completion_event();
+      // Tell the region tree forest about this partition
+      RegionTreeForest *forest = runtime->forest;
+      const RtEvent safe = forest->create_pending_partition(this, pid, parent,
+                  color_space, partition_color, LEGION_DISJOINT_COMPLETE_KIND,
+                  did, term_event);
+      // Now we can add the operation to the queue
+      add_to_dependence_queue(part_op);
+      // Wait for any notifications to occur before returning
+      if (safe.exists())
+        safe.wait();
+      return pid;
+    }
+
+    //--------------------------------------------------------------------------
+    IndexPartition InnerContext::create_partition_by_space_filling_curve(
+                                              LogicalRegion handle,
+                                              LogicalRegion parent_priv,
+                                              FieldID fid,
+                                              IndexSpace color_space,
+                                              SpaceFillingCurve curve,
+                                              Color color,
+                                              MapperID id, MappingTagID tag)
+    //--------------------------------------------------------------------------
+    {
+      AutoRuntimeCall call(this);
+      IndexSpace parent = handle.get_index_space(); 
+      IndexPartition pid(runtime->get_unique_index_partition_id(), 
+                         parent.get_tree_id(), parent.get_type_tag());
+      DistributedID did = runtime->get_available_distributed_id();
+#ifdef DEBUG_LEGION
+      log_index.debug("Creating partition by weighted space-filling curve "
+                      "in task %s (ID %lld)", get_task_name(), get_unique_id());
+#endif
+      LegionColor part_color = INVALID_COLOR;
+      if (color != LEGION_AUTO_GENERATE_ID)
+        part_color = color;
+      // Allocate the partition operation
+      DependentPartitionOp *part_op = 
+        runtime->get_available_dependent_partition_op();
+      ApEvent term_event = part_op->get_completion_event();
+      // Tell the region tree forest about this partition 
+      RtEvent safe = runtime->forest->create_pending_partition(this, pid, 
+            parent, color_space, part_color, LEGION_DISJOINT_COMPLETE_KIND,
+            did, term_event);
+      // Do this after creating the pending partition so the node exists
+      // in case we need to look at it during initialization
+      part_op->initialize_by_space_filling_curve(this, pid, handle, 
+                                        parent_priv, fid, curve, id, tag);
+      // Now figure out if we need to unmap and re-map any inline mappings
+      std::vector<PhysicalRegion> unmapped_regions;
+      if (!runtime->unsafe_launch)
+        find_conflicting_regions(part_op, unmapped_regions);
+      if (!unmapped_regions.empty())
+      {
+        if (runtime->runtime_warnings)
+        {
+          REPORT_LEGION_WARNING(LEGION_WARNING_RUNTIME_UNMAPPING_REMAPPING,
+            "Runtime is unmapping and remapping "
+              "physical regions around "
+              "create_partition_by_space_filling_curve call "
+              "in task %s (UID %lld).", get_task_name(), get_unique_id());
+        }
+        for (unsigned idx = 0; idx < unmapped_regions.size(); idx++)
+          unmapped_regions[idx].impl->unmap_region();
+      }
+      // Issue the partition operation
+      add_to_dependence_queue(part_op);
+      // Remap any unmapped regions
+      if (!unmapped_regions.empty())
+        remap_unmapped_regions(current_trace, unmapped_regions);
+      // Wait for any notifications to occur before returning
+      if (safe.exists())
+        safe.wait();
+      return pid;
+    }
+
     //--------------------------------------------------------------------------
     IndexPartition InnerContext::create_partition_by_image(
                                                     IndexSpace handle,
@@ -11303,6 +11403,37 @@ namespace Legion {
       return IndexPartition::NO_PART;
     }
 
+    //--------------------------------------------------------------------------
+    IndexPartition LeafContext::create_partition_by_space_filling_curve(
+                                                IndexSpace parent,
+                                                IndexSpace color_space,
+                                                SpaceFillingCurve curve,
+                                                Color color)
+    //--------------------------------------------------------------------------
+    {
+      REPORT_LEGION_ERROR(ERROR_ILLEGAL_PARTITION_SFC,
+        "Illegal partition by space-filling curve performed in leaf "
+                     "task %s (ID %lld)", get_task_name(), get_unique_id())
+      return IndexPartition::NO_PART;
+    }
+
+    //--------------------------------------------------------------------------
+    IndexPartition LeafContext::create_partition_by_space_filling_curve(
+                                                LogicalRegion handle,
+                                                LogicalRegion parent_priv,
+                                                FieldID fid,
+                                                IndexSpace color_space,
+                                                SpaceFillingCurve curve,
+                                                Color color,
+                                                MapperID id, MappingTagID tag)
+    //--------------------------------------------------------------------------
+    {
+      REPORT_LEGION_ERROR(ERROR_ILLEGAL_PARTITION_SFC,
+        "Illegal partition by space-filling curve performed in leaf "
+                     "task %s (ID %lld)", get_task_name(), get_unique_id())
+      return IndexPartition::NO_PART;
+    }
+
     //--------------------------------------------------------------------------
     IndexPartition LeafContext::create_partition_by_image(
                                               IndexSpace handle,
@@ -211,6 +211,20 @@ namespace Legion {
                                             Color color,
                                             MapperID id, MappingTagID tag,
                                             PartitionKind part_kind) = 0;
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            IndexSpace parent,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color) = 0;
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            LogicalRegion handle,
+                                            LogicalRegion parent_priv,
+                                            FieldID fid,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color,
+                                            MapperID id, 
+                                            MappingTagID tag) = 0;
       virtual IndexPartition create_partition_by_image(
                                             IndexSpace handle,
                                             LogicalPartition projection,
@@ -1000,6 +1014,20 @@ namespace Legion {
                                             Color color,
                                             MapperID id, MappingTagID tag,
                                             PartitionKind part_kind);
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            IndexSpace parent,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color);
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            LogicalRegion handle,
+                                            LogicalRegion parent_priv,
+                                            FieldID fid,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color,
+                                            MapperID id, 
+                                            MappingTagID tag);
       virtual IndexPartition create_partition_by_image(
                                             IndexSpace handle,
                                             LogicalPartition projection,
@@ -1753,6 +1781,20 @@ namespace Legion {
                                             Color color,
                                             MapperID id, MappingTagID tag,
                                             PartitionKind part_kind);
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            IndexSpace parent,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color);
+      virtual IndexPartition create_partition_by_space_filling_curve(
+                                            LogicalRegion handle,
+                                            LogicalRegion parent_priv,
+                                            FieldID fid,
+                                            IndexSpace color_space,
+                                            SpaceFillingCurve curve,
+                                            Color color,
+                                            MapperID id, 
+                                            MappingTagID tag);
       virtual IndexPartition create_partition_by_image(
                                             IndexSpace handle,
                                             LogicalPartition projection,
@@ -252,6 +252,8 @@ module legion_fortran
     type(legion_accessor_array_1d_f_t) :: accessor
   contains
     procedure :: get_raw_ptr => legion_field_accessor_1d_get_raw_ptr
+    procedure :: read_rect => legion_field_accessor_1d_read_rect
+    procedure :: write_rect => legion_field_accessor_1d_write_rect
     procedure :: get_dense_array => legion_field_accessor_1d_get_dense_array_cptr
   end type FFieldAccessor1D
 
@@ -260,6 +262,8 @@ module legion_fortran
     type(legion_accessor_array_2d_f_t) :: accessor
   contains
     procedure :: get_raw_ptr => legion_field_accessor_2d_get_raw_ptr
+    procedure :: read_rect => legion_field_accessor_2d_read_rect
+    procedure :: write_rect => legion_field_accessor_2d_write_rect
   end type FFieldAccessor2D
 #endif
 
@@ -268,6 +272,8 @@ module legion_fortran
     type(legion_accessor_array_3d_f_t) :: accessor
   contains
     procedure :: get_raw_ptr => legion_field_accessor_3d_get_raw_ptr
+    procedure :: read_rect => legion_field_accessor_3d_read_rect
+    procedure :: write_rect => legion_field_accessor_3d_write_rect
   end type FFieldAccessor3D
 #endif
 
@@ -1501,6 +1507,30 @@ contains
     offset = tmp_offset%offset
   end subroutine legion_field_accessor_1d_get_raw_ptr
 
+  ! copies every point of rect to dst, with the first dimension fastest
+  subroutine legion_field_accessor_1d_read_rect(this, rect, dst)
+    implicit none
+
+    class(FFieldAccessor1D), intent(in) :: this
+    type(FRect1D), intent(in)           :: rect
+    type(c_ptr)                         :: dst
+
+    call assert_ne(this%privilege_mode, WRITE_DISCARD)
+    call legion_accessor_array_1d_read_rect_f(this%accessor, rect%rect, dst, this%data_size)
+  end subroutine legion_field_accessor_1d_read_rect
+
+  ! copies src to every point of rect, with the first dimension fastest
+  subroutine legion_field_accessor_1d_write_rect(this, rect, src)
+    implicit none
+
+    class(FFieldAccessor1D), intent(in) :: this
+    type(FRect1D), intent(in)           :: rect
+    type(c_ptr), intent(in)             :: src
+
+    call assert_ne(this%privilege_mode, READ_ONLY)
+    call legion_accessor_array_1d_write_rect_f(this%accessor, rect%rect, src, this%data_size)
+  end subroutine legion_field_accessor_1d_write_rect
+
   subroutine legion_field_accessor_1d_get_dense_array_cptr(this, rect, raw_ptr)
     implicit none
 
@@ -1550,6 +1580,30 @@ contains
     offset(1) = tmp_offset(1)%offset
     offset(2) = tmp_offset(2)%offset
   end subroutine legion_field_accessor_2d_get_raw_ptr
+
+  ! copies every point of rect to dst, with the first dimension fastest
+  subroutine legion_field_accessor_2d_read_rect(this, rect, dst)
+    implicit none
+
+    class(FFieldAccessor2D), intent(in) :: this
+    type(FRect2D), intent(in)           :: rect
+    type(c_ptr)                         :: dst
+
+    call assert_ne(this%privilege_mode, WRITE_DISCARD)
+    call legion_accessor_array_2d_read_rect_f(this%accessor, rect%rect, dst, this%data_size)
+  end subroutine legion_field_accessor_2d_read_rect
+
+  ! copies src to every point of rect, with the first dimension fastest
+  subroutine legion_field_accessor_2d_write_rect(this, rect, src)
+    implicit none
+
+    class(FFieldAccessor2D), intent(in) :: this
+    type(FRect2D), intent(in)           :: rect
+    type(c_ptr), intent(in)             :: src
+
+    call assert_ne(this%privilege_mode, READ_ONLY)
+    call legion_accessor_array_2d_write_rect_f(this%accessor, rect%rect, src, this%data_size)
+  end subroutine legion_field_accessor_2d_write_rect
 #endif
 
 #if LEGION_MAX_DIM >= 3
@@ -1570,6 +1624,30 @@ contains
     offset(2) = tmp_offset(2)%offset
     offset(3) = tmp_offset(3)%offset
   end subroutine legion_field_accessor_3d_get_raw_ptr
+
+  ! copies every point of rect to dst, with the first dimension fastest
+  subroutine legion_field_accessor_3d_read_rect(this, rect, dst)
+    implicit none
+
+    class(FFieldAccessor3D), intent(in) :: this
+    type(FRect3D), intent(in)           :: rect
+    type(c_ptr)                         :: dst
+
+    call assert_ne(this%privilege_mode, WRITE_DISCARD)
+    call legion_accessor_array_3d_read_rect_f(this%accessor, rect%rect, dst, this%data_size)
+  end subroutine legion_field_accessor_3d_read_rect
+
+  ! copies src to every point of rect, with the first dimension fastest
+  subroutine legion_field_accessor_3d_write_rect(this, rect, src)
+    implicit none
+
+    class(FFieldAccessor3D), intent(in) :: this
+    type(FRect3D), intent(in)           :: rect
+    type(c_ptr), intent(in)             :: src
+
+    call assert_ne(this%privilege_mode, READ_ONLY)
+    call legion_accessor_array_3d_write_rect_f(this%accessor, rect%rect, src, this%data_size)
+  end subroutine legion_field_accessor_3d_write_rect
 #endif
 
   ! ===============================================================================
@@ -1614,6 +1614,196 @@ module legion_fortran_c_interface
     end subroutine legion_accessor_array_3d_write_point_f
 #endif
 
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_1d_read_rect_f(handle, rect, dst, bytes) &
+        bind(C, name="legion_accessor_array_1d_read_rect")
+      use iso_c_binding
+      import legion_accessor_array_1d_f_t
+      import legion_rect_1d_f_t
+      implicit none
+
+      type(legion_accessor_array_1d_f_t), value, intent(in) :: handle
+      type(legion_rect_1d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_1d_read_rect_f
+
+#if LEGION_MAX_DIM >= 2
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_2d_read_rect_f(handle, rect, dst, bytes) &
+        bind(C, name="legion_accessor_array_2d_read_rect")
+      use iso_c_binding
+      import legion_accessor_array_2d_f_t
+      import legion_rect_2d_f_t
+      implicit none
+
+      type(legion_accessor_array_2d_f_t), value, intent(in) :: handle
+      type(legion_rect_2d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_2d_read_rect_f
+#endif
+
+#if LEGION_MAX_DIM >= 3
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_3d_read_rect_f(handle, rect, dst, bytes) &
+        bind(C, name="legion_accessor_array_3d_read_rect")
+      use iso_c_binding
+      import legion_accessor_array_3d_f_t
+      import legion_rect_3d_f_t
+      implicit none
+
+      type(legion_accessor_array_3d_f_t), value, intent(in) :: handle
+      type(legion_rect_3d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_3d_read_rect_f
+#endif
+
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_1d_write_rect_f(handle, rect, src, bytes) &
+        bind(C, name="legion_accessor_array_1d_write_rect")
+      use iso_c_binding
+      import legion_accessor_array_1d_f_t
+      import legion_rect_1d_f_t
+      implicit none
+
+      type(legion_accessor_array_1d_f_t), value, intent(in) :: handle
+      type(legion_rect_1d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_1d_write_rect_f
+
+#if LEGION_MAX_DIM >= 2
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_2d_write_rect_f(handle, rect, src, bytes) &
+        bind(C, name="legion_accessor_array_2d_write_rect")
+      use iso_c_binding
+      import legion_accessor_array_2d_f_t
+      import legion_rect_2d_f_t
+      implicit none
+
+      type(legion_accessor_array_2d_f_t), value, intent(in) :: handle
+      type(legion_rect_2d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_2d_write_rect_f
+#endif
+
+#if LEGION_MAX_DIM >= 3
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_3d_write_rect_f(handle, rect, src, bytes) &
+        bind(C, name="legion_accessor_array_3d_write_rect")
+      use iso_c_binding
+      import legion_accessor_array_3d_f_t
+      import legion_rect_3d_f_t
+      implicit none
+
+      type(legion_accessor_array_3d_f_t), value, intent(in) :: handle
+      type(legion_rect_3d_f_t), value, intent(in)           :: rect
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_3d_write_rect_f
+#endif
+
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_1d_read_points_f(handle, points, num_points, dst, bytes) &
+        bind(C, name="legion_accessor_array_1d_read_points")
+      use iso_c_binding
+      import legion_accessor_array_1d_f_t
+      import legion_point_1d_f_t
+      implicit none
+
+      type(legion_accessor_array_1d_f_t), value, intent(in) :: handle
+      type(legion_point_1d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_1d_read_points_f
+
+#if LEGION_MAX_DIM >= 2
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_2d_read_points_f(handle, points, num_points, dst, bytes) &
+        bind(C, name="legion_accessor_array_2d_read_points")
+      use iso_c_binding
+      import legion_accessor_array_2d_f_t
+      import legion_point_2d_f_t
+      implicit none
+
+      type(legion_accessor_array_2d_f_t), value, intent(in) :: handle
+      type(legion_point_2d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_2d_read_points_f
+#endif
+
+#if LEGION_MAX_DIM >= 3
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_3d_read_points_f(handle, points, num_points, dst, bytes) &
+        bind(C, name="legion_accessor_array_3d_read_points")
+      use iso_c_binding
+      import legion_accessor_array_3d_f_t
+      import legion_point_3d_f_t
+      implicit none
+
+      type(legion_accessor_array_3d_f_t), value, intent(in) :: handle
+      type(legion_point_3d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: dst ! should be OUT, set to IN to cheat compiler
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_3d_read_points_f
+#endif
+
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_1d_write_points_f(handle, points, num_points, src, bytes) &
+        bind(C, name="legion_accessor_array_1d_write_points")
+      use iso_c_binding
+      import legion_accessor_array_1d_f_t
+      import legion_point_1d_f_t
+      implicit none
+
+      type(legion_accessor_array_1d_f_t), value, intent(in) :: handle
+      type(legion_point_1d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_1d_write_points_f
+
+#if LEGION_MAX_DIM >= 2
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_2d_write_points_f(handle, points, num_points, src, bytes) &
+        bind(C, name="legion_accessor_array_2d_write_points")
+      use iso_c_binding
+      import legion_accessor_array_2d_f_t
+      import legion_point_2d_f_t
+      implicit none
+
+      type(legion_accessor_array_2d_f_t), value, intent(in) :: handle
+      type(legion_point_2d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_2d_write_points_f
+#endif
+
+#if LEGION_MAX_DIM >= 3
+    ! @see Legion::UnsafeFieldAccessor::ptr
+    subroutine legion_accessor_array_3d_write_points_f(handle, points, num_points, src, bytes) &
+        bind(C, name="legion_accessor_array_3d_write_points")
+      use iso_c_binding
+      import legion_accessor_array_3d_f_t
+      import legion_point_3d_f_t
+      implicit none
+
+      type(legion_accessor_array_3d_f_t), value, intent(in) :: handle
+      type(legion_point_3d_f_t), intent(in)                 :: points(*)
+      integer(c_size_t), value, intent(in)                  :: num_points
+      type(c_ptr), value, intent(in)                        :: src
+      integer(c_size_t), value, intent(in)                  :: bytes
+    end subroutine legion_accessor_array_3d_write_points_f
+#endif
+
     ! -----------------------------------------------------------------------
     ! Fill Field Operations
     ! -----------------------------------------------------------------------
@@ -2236,7 +2236,7 @@ namespace Legion {
         {
           RezCheck z(rez);
           rez.serialize(did);
-          rez.serialize(VALIDATE_MESSAGE);
+          rez.serialize(INVALIDATE_MESSAGE);
           rez.serialize(done_event);
         }
         runtime->send_collective_instance_message(*it, rez);
@@ -2245,7 +2245,7 @@ namespace Legion {
       prune_gc_events();
       for (std::vector<MemoryManager*>::const_iterator it = 
             memories.begin(); it != memories.end(); it++)
-        (*it)->validate_instance(this);
+        (*it)->invalidate_instance(this);
     }
 
     //--------------------------------------------------------------------------
@@ -24,6 +24,9 @@
 #include "legion/legion_instances.h"
 #include "legion/legion_views.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace Legion {
   namespace Internal {
 
@@ -13290,6 +13293,20 @@ namespace Legion {
         perform_logging();
     }
 
+    //--------------------------------------------------------------------------
+    void PendingPartitionOp::initialize_sfc_partition(InnerContext *ctx,
+                                 IndexPartition pid, SpaceFillingCurve curve)
+    //--------------------------------------------------------------------------
+    {
+      initialize_operation(ctx, true/*track*/);
+#ifdef DEBUG_LEGION
+      assert(thunk == NULL);
+#endif
+      thunk = new SFCPartitionThunk(pid, curve);
+      if (runtime->legion_spy_enabled)
+        perform_logging();
+    }
+
     //--------------------------------------------------------------------------
     void PendingPartitionOp::initialize_union_partition(InnerContext *ctx,
                                                         IndexPartition pid,
@@ -13590,6 +13607,15 @@ namespace Legion {
           WEIGHT_PARTITION);
     }
 
+    //--------------------------------------------------------------------------
+    void PendingPartitionOp::SFCPartitionThunk::perform_logging(
+                                                         PendingPartitionOp *op)
+    //--------------------------------------------------------------------------
+    {
+      LegionSpy::log_target_pending_partition(op->unique_op_id, pid.id,
+          SFC_PARTITION);
+    }
+
     //--------------------------------------------------------------------------
     void PendingPartitionOp::UnionPartitionThunk::perform_logging(
                                                          PendingPartitionOp* op)
@@ -13927,6 +13953,44 @@ namespace Legion {
         perform_logging();
     }
 
+    //--------------------------------------------------------------------------
+    void DependentPartitionOp::initialize_by_space_filling_curve(
+                                      InnerContext *ctx, IndexPartition pid,
+                                      LogicalRegion handle, 
+                                      LogicalRegion parent, FieldID fid,
+                                      SpaceFillingCurve curve,
+                                      MapperID id, MappingTagID t)
+    //--------------------------------------------------------------------------
+    {
+      // Weights are read as either int or size_t values; fields carry no
+      // type information so the size is all we can check here and
+      // floating-point fields of the same size are not supported
+      const size_t weight_size = 
+        runtime->forest->get_field_size(handle.get_field_space(), fid);
+      if ((weight_size != sizeof(int)) && (weight_size != sizeof(size_t)))
+        REPORT_LEGION_ERROR(ERROR_INVALID_PARTITION_BY_SFC_WEIGHT,
+                      "Field size %zd of field %d is not the size of an int "
+                      "or size_t (weight fields must be integral) for "
+                      "'partition_by_space_filling_curve' call "
+                      "in task %s (UID %lld)", weight_size, fid, 
+                      ctx->get_task_name(), ctx->get_unique_id())
+      parent_task = ctx->get_task();
+      initialize_operation(ctx, true/*track*/); 
+      // Start without the projection requirement, we'll ask
+      // the mapper later if it wants to turn this into an index launch
+      requirement = 
+        RegionRequirement(handle, LEGION_READ_ONLY, LEGION_EXCLUSIVE, parent);
+      requirement.add_field(fid);
+      map_id = id;
+      tag = t;
+#ifdef DEBUG_LEGION
+      assert(thunk == NULL);
+#endif
+      thunk = new BySpaceFillingCurveThunk(pid, curve, weight_size);
+      if (runtime->legion_spy_enabled)
+        perform_logging();
+    }
+
     //--------------------------------------------------------------------------
     void DependentPartitionOp::initialize_by_association(InnerContext *ctx,
                         LogicalRegion domain, LogicalRegion domain_parent, 
@@ -14617,6 +14681,16 @@ namespace Legion {
                                                   instances, instances_ready);
     }
 
+    //--------------------------------------------------------------------------
+    ApEvent DependentPartitionOp::BySpaceFillingCurveThunk::perform(
+     DependentPartitionOp *op, RegionTreeForest *forest,
+     ApEvent instances_ready, const std::vector<FieldDataDescriptor> &instances)
+    //--------------------------------------------------------------------------
+    {
+      return forest->create_partition_by_space_filling_curve(op, pid, curve,
+                                  instances, instances_ready, weight_size);
+    }
+
     //--------------------------------------------------------------------------
     ApEvent DependentPartitionOp::AssociationThunk::perform(
      DependentPartitionOp *op, RegionTreeForest *forest,
@@ -17444,6 +17518,7 @@ namespace Legion {
       launch_space = NULL;
       points_committed = 0;
       commit_request = false;
+      prefetch = false;
     }
 
     //--------------------------------------------------------------------------
@@ -17513,6 +17588,10 @@ namespace Legion {
             0/*fake*/, LEGION_WRITE_DISCARD, LEGION_EXCLUSIVE, launcher.parent);
       requirement.privilege_fields = launcher.privilege_fields;
       launch_space = launch_bounds;
+      prefetch = launcher.prefetch &&
+        ((launcher.resource == LEGION_EXTERNAL_POSIX_FILE) ||
+         (launcher.resource == LEGION_EXTERNAL_HDF5_FILE)) &&
+        (launcher.mode != LEGION_FILE_CREATE);
       // Do some error checking
       OrderingConstraint output_constraint;
       switch (launcher.resource)
@@ -17681,6 +17760,10 @@ namespace Legion {
     void IndexAttachOp::trigger_ready(void)
     //--------------------------------------------------------------------------
     {
+      // Get the file reads started before any of the points map so
+      // they overlap with everything else going on
+      if (prefetch)
+        issue_prefetches();
       std::set<RtEvent> mapped_preconditions;
       std::set<ApEvent> executed_preconditions;
       for (std::vector<PointAttachOp*>::const_iterator it =
@@ -17704,6 +17787,125 @@ namespace Legion {
         complete_execution();
     }
 
+    //--------------------------------------------------------------------------
+    void IndexAttachOp::issue_prefetches(void)
+    //--------------------------------------------------------------------------
+    {
+      // Each file is read on the node whose instance will be reading it, 
+      // with one meta-task per file so that all the shards a node is
+      // responsible for are read in parallel, but deduplicate files
+      // that are shared between multiple points
+      std::map<AddressSpaceID,std::set<std::string> > node_files;
+      for (std::vector<PointAttachOp*>::const_iterator it =
+            points.begin(); it != points.end(); it++)
+      {
+        if ((*it)->file_name == NULL)
+          continue;
+        AddressSpaceID owner = runtime->address_space;
+        const char *path = 
+          find_prefetch_target((*it)->resource, (*it)->file_name, owner);
+        node_files[owner].insert(path);
+      }
+      for (std::map<AddressSpaceID,std::set<std::string> >::const_iterator
+            nit = node_files.begin(); nit != node_files.end(); nit++)
+      {
+        if (nit->first == runtime->address_space)
+        {
+          for (std::set<std::string>::const_iterator it = 
+                nit->second.begin(); it != nit->second.end(); it++)
+          {
+            const PrefetchArgs args(this, it->c_str());
+            runtime->issue_runtime_meta_task(args, LG_LOW_PRIORITY);
+          }
+        }
+        else
+        {
+          Serializer rez;
+          {
+            RezCheck z(rez);
+            rez.serialize(unique_op_id);
+            rez.serialize<size_t>(nit->second.size());
+            for (std::set<std::string>::const_iterator it = 
+                  nit->second.begin(); it != nit->second.end(); it++)
+            {
+              rez.serialize<size_t>(it->size());
+              rez.serialize(it->c_str(), it->size());
+            }
+          }
+          runtime->send_attach_prefetch(nit->first, rez);
+        }
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    const char* IndexAttachOp::find_prefetch_target(ExternalResource resource,
+                                                    const char *file_name,
+                                              AddressSpaceID &owner) const
+    //--------------------------------------------------------------------------
+    {
+      // POSIX file instances are always made on this node, but HDF5 
+      // file names can start with a 'rank=N:' prefix that says which node
+      // the instance will be made on, and Realm removes everything up to 
+      // the first colon before it opens the file
+      if (resource != LEGION_EXTERNAL_HDF5_FILE)
+        return file_name;
+      const char *colon = strchr(file_name, ':');
+      if (colon == NULL)
+        return file_name;
+      if (strncmp(file_name, "rank=", 5) == 0)
+      {
+        char *end = NULL;
+        errno = 0;
+        const long rank = strtol(file_name + 5, &end, 10);
+        if ((errno == 0) && (end == colon) && (rank >= 0) && 
+            (rank < long(runtime->total_address_spaces)))
+          owner = rank;
+      }
+      return colon + 1;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexAttachOp::handle_remote_prefetch(Deserializer &derez,
+                                                          Runtime *runtime)
+    //--------------------------------------------------------------------------
+    {
+      DerezCheck z(derez);
+      UniqueID op_id;
+      derez.deserialize(op_id);
+      size_t num_files;
+      derez.deserialize(num_files);
+      for (unsigned idx = 0; idx < num_files; idx++)
+      {
+        size_t name_size;
+        derez.deserialize(name_size);
+        const std::string file_name(
+            (const char*)derez.get_current_pointer(), name_size);
+        derez.advance_pointer(name_size);
+        const PrefetchArgs args(op_id, file_name.c_str());
+        runtime->issue_runtime_meta_task(args, LG_LOW_PRIORITY);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexAttachOp::handle_prefetch(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const PrefetchArgs *pargs = (const PrefetchArgs*)args;
+#ifdef POSIX_FADV_WILLNEED
+      // Ask the kernel to read the whole file into the page cache with
+      // large sequential reads in the background, which lets the later
+      // per-instance copies be served from memory without blocking
+      // this thread for the duration of the reads
+      const int fd = open(pargs->file_name, O_RDONLY);
+      if (fd >= 0)
+      {
+        posix_fadvise(fd, 0, 0/*whole file*/, POSIX_FADV_WILLNEED);
+        close(fd);
+      }
+#endif
+      free(pargs->file_name);
+    }
+
     //--------------------------------------------------------------------------
     void IndexAttachOp::trigger_commit(void)
     //--------------------------------------------------------------------------
@@ -19336,6 +19538,307 @@ namespace Legion {
       complete_execution();
     }
 
+    ///////////////////////////////////////////////////////////// 
+    // Future Reduction Tree 
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    FutureReductionTree::FutureReductionTree(Runtime *rt, ReductionOpID id,
+                                             AllReduceOp *o)
+      : runtime(rt), redop_id(id), redop(rt->get_reduction(id)),
+        op(o), parent_space(rt->address_space),
+        parent(NULL), parent_slot(0),
+        task_name(o->get_context()->get_task_name()),
+        task_uid(o->get_context()->get_unique_id()),
+        accumulator(NULL), remaining(0)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    FutureReductionTree::FutureReductionTree(Runtime *rt, ReductionOpID id,
+                         AddressSpaceID space,
+                         FutureReductionTree *p, unsigned slot,
+                         const std::string &name, UniqueID uid)
+      : runtime(rt), redop_id(id), redop(rt->get_reduction(id)),
+        op(NULL), parent_space(space), parent(p),
+        parent_slot(slot), task_name(name), task_uid(uid),
+        accumulator(NULL), remaining(0)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    FutureReductionTree::FutureReductionTree(const FutureReductionTree &rhs)
+      : runtime(NULL), redop_id(0), redop(NULL),
+        op(NULL), parent_space(0), parent(NULL), parent_slot(0), task_uid(0)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+    }
+
+    //--------------------------------------------------------------------------
+    FutureReductionTree::~FutureReductionTree(void)
+    //--------------------------------------------------------------------------
+    {
+      if (accumulator != NULL)
+        free(accumulator);
+    }
+
+    //--------------------------------------------------------------------------
+    FutureReductionTree& FutureReductionTree::operator=(
+                                                const FutureReductionTree &rhs)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+      return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureReductionTree::start(const std::vector<Future> &local,
+                                    const std::vector<SpaceFutures> &remote,
+                                    RtEvent precondition)
+    //--------------------------------------------------------------------------
+    {
+      local_futures = local;
+      accumulator = malloc(redop->sizeof_rhs);
+      memcpy(accumulator, redop->identity, redop->sizeof_rhs);
+      const size_t radix = (runtime->legion_collective_radix > 0) ?
+        runtime->legion_collective_radix : 1;
+      const size_t num_children = std::min(radix, remote.size());
+      remaining = num_children + 1;
+      // Hand each child a contiguous block of the remaining spaces, the
+      // first space in each block is the one that will receive it
+      for (unsigned child = 0; child < num_children; child++)
+      {
+        const size_t first = (child * remote.size()) / num_children;
+        const size_t last = ((child + 1) * remote.size()) / num_children;
+        Serializer rez;
+        {
+          RezCheck z(rez);
+          rez.serialize(this);
+          rez.serialize(child + 1);
+          rez.serialize(redop_id);
+          rez.serialize<size_t>(task_name.size());
+          rez.serialize(task_name.c_str(), task_name.size());
+          rez.serialize(task_uid);
+          rez.serialize<size_t>(last - first);
+          for (unsigned idx = first; idx < last; idx++)
+          {
+            rez.serialize(remote[idx].space);
+            rez.serialize<size_t>(remote[idx].futures.size());
+            for (std::vector<std::pair<DistributedID,UniqueID> >::
+                  const_iterator it = remote[idx].futures.begin(); 
+                  it != remote[idx].futures.end(); it++)
+            {
+              rez.serialize(it->first);
+              rez.serialize(it->second);
+            }
+          }
+        }
+        runtime->send_future_reduction_request(remote[first].space, rez);
+      }
+      // Fold our local futures once their values are here
+      std::set<ApEvent> ready_events;
+      for (std::vector<Future>::const_iterator it = 
+            local_futures.begin(); it != local_futures.end(); it++)
+      {
+        const ApEvent ready = it->impl->subscribe();
+        if (ready.exists())
+          ready_events.insert(ready);
+      }
+      if (!ready_events.empty())
+      {
+        const RtEvent values_ready = 
+          Runtime::protect_merge_events(ready_events);
+        if (precondition.exists())
+          precondition = Runtime::merge_events(precondition, values_ready);
+        else
+          precondition = values_ready;
+      }
+      if (precondition.exists() && !precondition.has_triggered())
+      {
+        FoldFuturesArgs args(this);
+        runtime->issue_runtime_meta_task(args, 
+            LG_THROUGHPUT_DEFERRED_PRIORITY, precondition);
+      }
+      else
+        fold_local_futures();
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureReductionTree::fold_local_futures(void)
+    //--------------------------------------------------------------------------
+    {
+      void *local = malloc(redop->sizeof_rhs);
+      memcpy(local, redop->identity, redop->sizeof_rhs);
+      for (std::vector<Future>::const_iterator it = 
+            local_futures.begin(); it != local_futures.end(); it++)
+      {
+        FutureImpl *impl = it->impl;
+        const size_t future_size = impl->get_untyped_size(true/*internal*/);
+        if (future_size != redop->sizeof_rhs)
+          REPORT_LEGION_ERROR(ERROR_FUTURE_MAP_REDOP_TYPE_MISMATCH,
+              "Future in future map reduction in task %s (UID %lld) does not "
+              "have the right input size for the given reduction operator. "
+              "Future has size %zd bytes but reduction operator expects "
+              "RHS inputs of %zd bytes.", task_name.c_str(), task_uid,
+              future_size, redop->sizeof_rhs)
+        const void *data = impl->get_untyped_result(true,NULL,true/*internal*/);
+        (redop->cpu_fold_excl_fn)(local, 0, data, 0, 1, redop->userdata);
+      }
+      // Release our references on the futures now that we're done
+      local_futures.clear();
+      receive_partial(0/*slot*/, local, redop->sizeof_rhs);
+      free(local);
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureReductionTree::receive_partial(unsigned slot, 
+                                              const void *value, size_t size)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(size == redop->sizeof_rhs);
+#endif
+      bool done;
+      {
+        AutoLock t_lock(tree_lock);
+        (redop->cpu_fold_excl_fn)(accumulator, 0, value, 0, 
+                                  1, redop->userdata);
+#ifdef DEBUG_LEGION
+        assert(remaining > 0);
+#endif
+        done = (--remaining == 0);
+      }
+      if (done)
+        finish();
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureReductionTree::finish(void)
+    //--------------------------------------------------------------------------
+    {
+      if (op != NULL)
+      {
+        // The future takes ownership of the buffer
+        op->finish_all_reduce(accumulator);
+        accumulator = NULL;
+      }
+      else
+      {
+        Serializer rez;
+        {
+          RezCheck z(rez);
+          rez.serialize(parent);
+          rez.serialize(parent_slot);
+          rez.serialize(redop->sizeof_rhs);
+          rez.serialize(accumulator, redop->sizeof_rhs);
+        }
+        runtime->send_future_reduction_response(parent_space, rez);
+      }
+      delete this;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void FutureReductionTree::handle_fold_futures(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const FoldFuturesArgs *fargs = (const FoldFuturesArgs*)args;
+      fargs->tree->fold_local_futures();
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void FutureReductionTree::handle_reduction_request(
+                   Deserializer &derez, Runtime *runtime, AddressSpaceID source)
+    //--------------------------------------------------------------------------
+    {
+      DerezCheck z(derez);
+      FutureReductionTree *parent;
+      derez.deserialize(parent);
+      unsigned parent_slot;
+      derez.deserialize(parent_slot);
+      ReductionOpID redop_id;
+      derez.deserialize(redop_id);
+      size_t name_size;
+      derez.deserialize(name_size);
+      const std::string task_name(
+          (const char*)derez.get_current_pointer(), name_size);
+      derez.advance_pointer(name_size);
+      UniqueID task_uid;
+      derez.deserialize(task_uid);
+      size_t num_spaces;
+      derez.deserialize(num_spaces);
+#ifdef DEBUG_LEGION
+      assert(num_spaces > 0);
+#endif
+      // The first space is always us and we need handles on those
+      // futures, the rest we just pass on to our children
+      std::vector<Future> local;
+      std::vector<SpaceFutures> remote(num_spaces - 1);
+      std::set<RtEvent> applied_events;
+      WrapperReferenceMutator mutator(applied_events);
+      for (unsigned idx = 0; idx < num_spaces; idx++)
+      {
+        AddressSpaceID space;
+        derez.deserialize(space);
+        size_t num_futures;
+        derez.deserialize(num_futures);
+        if (idx == 0)
+        {
+#ifdef DEBUG_LEGION
+          assert(space == runtime->address_space);
+#endif
+          local.resize(num_futures);
+          for (unsigned fidx = 0; fidx < num_futures; fidx++)
+          {
+            DistributedID did;
+            derez.deserialize(did);
+            UniqueID context_uid;
+            derez.deserialize(context_uid);
+            FutureImpl *impl = 
+              runtime->find_or_create_future(did, context_uid, &mutator);
+            impl->add_base_gc_ref(FUTURE_HANDLE_REF, &mutator);
+            local[fidx] = Future(impl, false/*need reference*/);
+          }
+        }
+        else
+        {
+          SpaceFutures &target = remote[idx - 1];
+          target.space = space;
+          target.futures.resize(num_futures);
+          for (unsigned fidx = 0; fidx < num_futures; fidx++)
+          {
+            derez.deserialize(target.futures[fidx].first);
+            derez.deserialize(target.futures[fidx].second);
+          }
+        }
+      }
+      FutureReductionTree *tree = new FutureReductionTree(runtime, redop_id,
+          source, parent, parent_slot, task_name, task_uid);
+      tree->start(local, remote, applied_events.empty() ? 
+          RtEvent::NO_RT_EVENT : Runtime::merge_events(applied_events));
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void FutureReductionTree::handle_reduction_response(
+                                                            Deserializer &derez)
+    //--------------------------------------------------------------------------
+    {
+      DerezCheck z(derez);
+      FutureReductionTree *tree;
+      derez.deserialize(tree);
+      unsigned slot;
+      derez.deserialize(slot);
+      size_t size;
+      derez.deserialize(size);
+      const void *value = derez.get_current_pointer();
+      tree->receive_partial(slot, value, size);
+      derez.advance_pointer(size);
+    }
+
     ///////////////////////////////////////////////////////////// 
     // All Reduce Op 
     /////////////////////////////////////////////////////////////
@@ -19373,11 +19876,12 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     Future AllReduceOp::initialize(InnerContext *ctx, const FutureMap &fm, 
-                                   ReductionOpID redop_id,bool is_deterministic)
+                                   ReductionOpID id, bool is_deterministic)
     //--------------------------------------------------------------------------
     {
       initialize_operation(ctx, true/*track*/);
       future_map = fm;
+      redop_id = id;
       redop = runtime->get_reduction(redop_id);
       result = Future(new FutureImpl(parent_ctx, runtime, true/*register*/,
                   runtime->get_available_distributed_id(),
@@ -19454,24 +19958,6 @@ namespace Legion {
     {
       std::map<DomainPoint,Future> futures;
       future_map.impl->get_all_futures(futures);
-      void *result_buffer = malloc(redop->sizeof_rhs);
-      memcpy(result_buffer, redop->identity, redop->sizeof_rhs);
-      for (std::map<DomainPoint,Future>::const_iterator it = 
-            futures.begin(); it != futures.end(); it++)
-      {
-        FutureImpl *impl = it->second.impl;
-        const size_t future_size = impl->get_untyped_size(true/*internal*/);
-        if (future_size != redop->sizeof_rhs)
-          REPORT_LEGION_ERROR(ERROR_FUTURE_MAP_REDOP_TYPE_MISMATCH,
-              "Future in future map reduction in task %s (UID %lld) does not "
-              "have the right input size for the given reduction operator. "
-              "Future has size %zd bytes but reduction operator expects "
-              "RHS inputs of %zd bytes.", parent_ctx->get_task_name(),
-              parent_ctx->get_unique_id(), future_size, redop->sizeof_rhs)
-        const void *data = impl->get_untyped_result(true,NULL,true/*internal*/);
-        (redop->cpu_fold_excl_fn)(result_buffer, 0, data, 0,
-                                  1, redop->userdata);
-      }
       if (runtime->legion_spy_enabled)
       {
         for (std::map<DomainPoint,Future>::const_iterator it = 
@@ -19483,6 +19969,47 @@ namespace Legion {
             LegionSpy::log_future_use(unique_op_id, ready_event);
         }
       }
+      // Deterministic reductions bring every value here and fold them in
+      // point order. Otherwise group the futures by the address space that
+      // holds their values so that each space can fold its own futures and
+      // only send back a single value.
+      std::vector<Future> local_futures;
+      std::vector<FutureReductionTree::SpaceFutures> remote_futures;
+      std::map<AddressSpaceID,unsigned> remote_indexes;
+      for (std::map<DomainPoint,Future>::const_iterator it = 
+            futures.begin(); it != futures.end(); it++)
+      {
+        FutureImpl *impl = it->second.impl;
+        const AddressSpaceID space = deterministic ? runtime->address_space :
+          impl->find_result_space();
+        if (space == runtime->address_space)
+        {
+          local_futures.push_back(it->second);
+          continue;
+        }
+        std::map<AddressSpaceID,unsigned>::const_iterator finder =
+          remote_indexes.find(space);
+        if (finder == remote_indexes.end())
+        {
+          remote_indexes[space] = remote_futures.size();
+          remote_futures.resize(remote_futures.size() + 1);
+          remote_futures.back().space = space;
+          remote_futures.back().futures.push_back(
+              std::make_pair(impl->did, impl->context->get_unique_id()));
+        }
+        else
+          remote_futures[finder->second].futures.push_back(
+              std::make_pair(impl->did, impl->context->get_unique_id()));
+      }
+      FutureReductionTree *tree = 
+        new FutureReductionTree(runtime, redop_id, this);
+      tree->start(local_futures, remote_futures);
+    }
+
+    //--------------------------------------------------------------------------
+    void AllReduceOp::finish_all_reduce(void *result_buffer)
+    //--------------------------------------------------------------------------
+    {
       // Tell the future about the final result which it will own
       result.impl->set_result(result_buffer, redop->sizeof_rhs, true/*own*/);
 #ifdef LEGION_SPY
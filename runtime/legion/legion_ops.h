@@ -2608,6 +2608,7 @@ namespace Legion {
         DIFFERENCE_PARTITION,
         RESTRICTED_PARTITION,
         BY_DOMAIN_PARTITION,
+        SFC_PARTITION,
       };
       // Track pending partition operations as thunks
       class PendingPartitionThunk {
@@ -2648,6 +2649,22 @@ namespace Legion {
         FutureMap weights;
         size_t granularity;
       };
+      class SFCPartitionThunk : public PendingPartitionThunk {
+      public:
+        SFCPartitionThunk(IndexPartition id, SpaceFillingCurve c)
+          : pid(id), curve(c) { }
+        virtual ~SFCPartitionThunk(void) { }
+      public:
+        virtual ApEvent perform(PendingPartitionOp *op,
+                                RegionTreeForest *forest)
+        { return forest->create_partition_by_space_filling_curve(op, pid,
+            curve, std::vector<FieldDataDescriptor>(), 
+            ApEvent::NO_AP_EVENT, 0/*no weights*/); }
+        virtual void perform_logging(PendingPartitionOp *op);
+      protected:
+        IndexPartition pid;
+        SpaceFillingCurve curve;
+      };
       class UnionPartitionThunk : public PendingPartitionThunk {
       public:
         UnionPartitionThunk(IndexPartition id, 
@@ -2814,6 +2831,8 @@ namespace Legion {
                                       IndexPartition pid, size_t granularity);
       void initialize_weight_partition(InnerContext *ctx, IndexPartition pid,
                                 const FutureMap &weights, size_t granularity);
+      void initialize_sfc_partition(InnerContext *ctx, IndexPartition pid,
+                                    SpaceFillingCurve curve);
       void initialize_union_partition(InnerContext *ctx,
                                       IndexPartition pid, 
                                       IndexPartition handle1,
@@ -2984,6 +3003,23 @@ namespace Legion {
         IndexPartition pid;
         IndexPartition projection;
       };
+      class BySpaceFillingCurveThunk : public DepPartThunk {
+      public:
+        BySpaceFillingCurveThunk(IndexPartition p, SpaceFillingCurve c,
+                                 size_t size)
+          : pid(p), curve(c), weight_size(size) { }
+      public:
+        virtual ApEvent perform(DependentPartitionOp *op,
+            RegionTreeForest *forest, ApEvent instances_ready,
+            const std::vector<FieldDataDescriptor> &instances);
+        virtual PartitionKind get_kind(void) const 
+          { return BY_SPACE_FILLING_CURVE; }
+        virtual IndexPartition get_partition(void) const { return pid; }
+      protected:
+        IndexPartition pid;
+        SpaceFillingCurve curve;
+        size_t weight_size;
+      };
       class AssociationThunk : public DepPartThunk {
       public:
         AssociationThunk(IndexSpace d, IndexSpace r)
@@ -3025,6 +3061,11 @@ namespace Legion {
                                IndexPartition projection, LogicalRegion handle,
                                LogicalRegion parent, FieldID fid,
                                MapperID id, MappingTagID tag);
+      void initialize_by_space_filling_curve(InnerContext *ctx,
+                               IndexPartition pid, LogicalRegion handle,
+                               LogicalRegion parent, FieldID fid,
+                               SpaceFillingCurve curve,
+                               MapperID id, MappingTagID tag);
       void initialize_by_association(InnerContext *ctx, LogicalRegion domain,
                                LogicalRegion domain_parent, FieldID fid,
                                IndexSpace range, MapperID id, MappingTagID tag);
@@ -3458,6 +3499,18 @@ namespace Legion {
     class IndexAttachOp : public Operation,public LegionHeapify<IndexAttachOp> {
     public:
       static const AllocationType alloc_type = ATTACH_OP_ALLOC;
+      struct PrefetchArgs : public LgTaskArgs<PrefetchArgs> {
+      public:
+        static const LgTaskID TASK_ID = LG_ATTACH_PREFETCH_TASK_ID;
+      public:
+        PrefetchArgs(Operation *op, const char *file)
+          : LgTaskArgs<PrefetchArgs>(op->get_unique_op_id()),
+            file_name(strdup(file)) { }
+        PrefetchArgs(UniqueID op_id, const char *file)
+          : LgTaskArgs<PrefetchArgs>(op_id), file_name(strdup(file)) { }
+      public:
+        char *const file_name;
+      };
     public:
       IndexAttachOp(Runtime *rt);
       IndexAttachOp(const IndexAttachOp &rhs);
@@ -3487,8 +3540,14 @@ namespace Legion {
       virtual unsigned find_parent_index(unsigned idx);
     public:
       void handle_point_commit(void);
+      static void handle_prefetch(const void *args);
+      static void handle_remote_prefetch(Deserializer &derez, Runtime *rt);
     protected:
       void activate_index_attach(void);
+      void issue_prefetches(void);
+      const char* find_prefetch_target(ExternalResource resource,
+                                       const char *file_name,
+                                       AddressSpaceID &owner) const;
       void deactivate_index_attach(void);
       void compute_parent_index(void);
       void check_privilege(void);
@@ -3504,6 +3563,7 @@ namespace Legion {
       unsigned                                      parent_req_index;
       unsigned                                      points_committed;
       bool                                          commit_request;
+      bool                                          prefetch;
     };
     
     /**
@@ -3740,7 +3800,81 @@ namespace Legion {
     };
 
     /**
-     * \class AllReduceOp 
+     * \class FutureReductionTree
+     * A node in the tree used to reduce the futures of a future map
+     * without gathering every value on one node. Each node folds the
+     * futures whose values were produced in its own address space,
+     * hands the remaining address spaces to at most 'radix' children,
+     * and then folds their partial results into its own as soon as they
+     * arrive before sending a single value up to its parent. The order
+     * of the folds depends on when the partial results arrive, so it is
+     * only used for non-deterministic reductions.
+     */
+    class FutureReductionTree {
+    public:
+      struct FoldFuturesArgs : public LgTaskArgs<FoldFuturesArgs> {
+      public:
+        static const LgTaskID TASK_ID = LG_FOLD_FUTURE_REDUCTION_TASK_ID;
+      public:
+        FoldFuturesArgs(FutureReductionTree *t)
+          : LgTaskArgs<FoldFuturesArgs>(implicit_provenance), tree(t) { }
+      public:
+        FutureReductionTree *const tree;
+      };
+      // The names of the futures whose values live in one address space
+      struct SpaceFutures {
+      public:
+        AddressSpaceID space;
+        std::vector<std::pair<DistributedID,UniqueID> > futures;
+      };
+    public:
+      // The root of the tree on the node running the all-reduce
+      FutureReductionTree(Runtime *rt, ReductionOpID redop, AllReduceOp *op);
+      // An interior node with a parent on another node
+      FutureReductionTree(Runtime *rt, ReductionOpID redop,
+                          AddressSpaceID parent_space,
+                          FutureReductionTree *parent, unsigned parent_slot,
+                          const std::string &task_name, UniqueID task_uid);
+      FutureReductionTree(const FutureReductionTree &rhs);
+      ~FutureReductionTree(void);
+    public:
+      FutureReductionTree& operator=(const FutureReductionTree &rhs);
+    public:
+      // Fold the 'local' futures and distribute the 'remote' address
+      // spaces to children, the precondition guards any references
+      // that still need to be applied for the local futures
+      void start(const std::vector<Future> &local,
+                 const std::vector<SpaceFutures> &remote,
+                 RtEvent precondition = RtEvent::NO_RT_EVENT);
+      void fold_local_futures(void);
+      void receive_partial(unsigned slot, const void *value, size_t size);
+    protected:
+      void finish(void);
+    public:
+      static void handle_fold_futures(const void *args);
+      static void handle_reduction_request(Deserializer &derez,
+                                  Runtime *runtime, AddressSpaceID source);
+      static void handle_reduction_response(Deserializer &derez);
+    public:
+      Runtime *const runtime;
+      const ReductionOpID redop_id;
+      const ReductionOp *const redop;
+      AllReduceOp *const op;
+      const AddressSpaceID parent_space;
+      FutureReductionTree *const parent;
+      const unsigned parent_slot;
+      // The task that asked for the reduction for error messages
+      const std::string task_name;
+      const UniqueID task_uid;
+    protected:
+      mutable LocalLock tree_lock;
+      std::vector<Future> local_futures;
+      void *accumulator;
+      unsigned remaining;
+    };
+
+    /**
+     * \class AllReduceOp
      * Operation for reducing future maps down to futures
      */
     class AllReduceOp : public Operation, public LegionHeapify<AllReduceOp> {
@@ -3764,9 +3898,13 @@ namespace Legion {
       virtual void trigger_dependence_analysis(void);
       virtual void trigger_mapping(void);
       virtual void deferred_execute(void);
+    public:
+      // Called by the root of the reduction tree with the final value
+      void finish_all_reduce(void *result_buffer);
     protected:
       FutureMap future_map;
-      const ReductionOp *redop; 
+      ReductionOpID redop_id;
+      const ReductionOp *redop;
       Future result;
       bool deterministic;
     };
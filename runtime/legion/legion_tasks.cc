@@ -4895,14 +4895,11 @@ namespace Legion {
       if (this->redop != 0)
       {
         this->deterministic_redop = rhs->deterministic_redop;
-        if (!this->deterministic_redop)
-        {
-          // Only need to initialize this if we're not doing a 
-          // deterministic reduction operation
-          this->reduction_op = rhs->reduction_op;
-          this->serdez_redop_fns = rhs->serdez_redop_fns;
-          initialize_reduction_state();
-        }
+        // Deterministic slices still need the reduction state so that
+        // they can fold their own points before returning to the owner
+        this->reduction_op = rhs->reduction_op;
+        this->serdez_redop_fns = rhs->serdez_redop_fns;
+        initialize_reduction_state();
       }
       this->point_arguments = rhs->point_arguments;
       if (!rhs->point_futures.empty())
@@ -5073,14 +5070,9 @@ namespace Legion {
       if (redop > 0)
       {
         derez.deserialize(deterministic_redop);
-        // Only need to fill these in if we're not doing a 
-        // deterministic reduction operation
-        if (!deterministic_redop)
-        {
-          reduction_op = Runtime::get_reduction_op(redop);
-          serdez_redop_fns = Runtime::get_serdez_redop_fns(redop);
-          initialize_reduction_state();
-        }
+        reduction_op = Runtime::get_reduction_op(redop);
+        serdez_redop_fns = Runtime::get_serdez_redop_fns(redop);
+        initialize_reduction_state();
       }
       else
       {
@@ -8412,9 +8404,12 @@ namespace Legion {
 #ifdef DEBUG_LEGION
           assert(reduction_op != NULL);
 #endif
-          // Unpack these futures and save them so we can do a
+          // Remote slices fold their own points and send back one partial
+          // result keyed by their first point, save it so we can do a
           // deterministic reduction fold operation later
-          for (unsigned idx = 0; idx < points; idx++)
+          bool has_partial;
+          derez.deserialize(has_partial);
+          if (has_partial)
           {
             DomainPoint p;
             derez.deserialize(p);
@@ -9809,18 +9804,27 @@ namespace Legion {
       {
         if (deterministic_redop)
         {
-          // Same as above but without the extra rez check
 #ifdef DEBUG_LEGION
           assert(temporary_futures.size() == points.size());
 #endif
+          // Fold our points locally in point order and send back a single
+          // partial result keyed by our first point. The owner folds the
+          // partials in point order too, so the result is the same on every
+          // run that slices the launch the same way.
           for (std::map<DomainPoint,std::pair<void*,size_t> >::const_iterator 
                 it = temporary_futures.begin(); 
                 it != temporary_futures.end(); it++)
+            fold_reduction_future(it->second.first, it->second.second,
+                                  false/*owner*/, true/*exclusive*/);
+          if (!temporary_futures.empty())
           {
-            rez.serialize(it->first);
-            rez.serialize(it->second.second);
-            rez.serialize(it->second.first,it->second.second);
+            rez.serialize<bool>(true);
+            rez.serialize(temporary_futures.begin()->first);
+            rez.serialize(reduction_state_size);
+            rez.serialize(reduction_state,reduction_state_size);
           }
+          else
+            rez.serialize<bool>(false);
         }
         else
         {
@@ -90,6 +90,7 @@ namespace Legion {
   typedef ::legion_projection_type_t ProjectionType;
   typedef ::legion_partition_kind_t PartitionKind;
   typedef ::legion_external_resource_t ExternalResource;
+  typedef ::legion_space_filling_curve_t SpaceFillingCurve;
   typedef ::legion_timing_measurement_t TimingMeasurement;
   typedef ::legion_dependence_type_t DependenceType;
   typedef ::legion_mappable_type_id_t MappableType;
@@ -288,6 +289,7 @@ namespace Legion {
       DEP_PART_BY_PREIMAGE_RANGE = 13, // create partition by preimage range
       DEP_PART_ASSOCIATION = 14, // create an association
       DEP_PART_WEIGHTS = 15, // create partition by weights
+      DEP_PART_BY_SFC = 16, // create partition by space-filling curve
     };
 
     // Enumeration of Legion runtime tasks
@@ -390,6 +392,8 @@ namespace Legion {
       LG_DEFER_COLLECTIVE_MANAGER_TASK_ID,
       LG_DEFER_VERIFY_PARTITION_TASK_ID,
       LG_DEFER_RELEASE_ACQUIRED_TASK_ID,
+      LG_ATTACH_PREFETCH_TASK_ID,
+      LG_FOLD_FUTURE_REDUCTION_TASK_ID,
       LG_MALLOC_INSTANCE_TASK_ID,
       LG_FREE_INSTANCE_TASK_ID,
       LG_YIELD_TASK_ID,
@@ -504,6 +508,8 @@ namespace Legion {
         "Defer Reduction Manager Registration",                   \
         "Defer Verify Partition",                                 \
         "Defer Release Acquired Instances",                       \
+        "Attach Prefetch",                                        \
+        "Fold Future Reduction",                                  \
         "Malloc Instance",                                        \
         "Free Instance",                                          \
         "Yield",                                                  \
@@ -838,10 +844,13 @@ namespace Legion {
       SEND_LIBRARY_SERDEZ_RESPONSE,
       SEND_REMOTE_OP_REPORT_UNINIT,
       SEND_REMOTE_OP_PROFILING_COUNT_UPDATE,
+      SEND_FUTURE_REDUCTION_REQUEST,
+      SEND_FUTURE_REDUCTION_RESPONSE,
       SEND_REMOTE_TRACE_UPDATE,
       SEND_REMOTE_TRACE_RESPONSE,
       SEND_REMOTE_TRACE_EQ_REQUEST,
       SEND_REMOTE_TRACE_EQ_RESPONSE,
+      SEND_ATTACH_PREFETCH,
       SEND_SHUTDOWN_NOTIFICATION,
       SEND_SHUTDOWN_RESPONSE,
       LAST_SEND_KIND, // This one must be last
@@ -1021,10 +1030,13 @@ namespace Legion {
         "Send Library Serdez Response",                               \
         "Remote Op Report Uninitialized",                             \
         "Remote Op Profiling Count Update",                           \
+        "Send Future Reduction Request",                              \
+        "Send Future Reduction Response",                             \
         "Send Remote Trace Update",                                   \
         "Send Remote Trace Response",                                 \
         "Send Remote Trace Equivalence Sets Request",                 \
         "Send Remote Trace Equivalence Sets Response",                \
+        "Send Attach Prefetch",                                       \
         "Send Shutdown Notification",                                 \
         "Send Shutdown Response",                                     \
       };
@@ -1452,6 +1464,7 @@ namespace Legion {
     class TimingOp;
     class TunableOp;
     class AllReduceOp;
+    class FutureReductionTree;
     class ExternalMappable;
     class RemoteOp;
     class RemoteMapOp;
@@ -1687,6 +1700,7 @@ namespace Legion {
     friend class Internal::TimingOp;                        \
     friend class Internal::TunableOp;                       \
     friend class Internal::AllReduceOp;                     \
+    friend class Internal::FutureReductionTree;             \
     friend class Internal::TraceSummaryOp;                  \
     friend class Internal::ExternalMappable;                \
     friend class Internal::ExternalTask;                    \
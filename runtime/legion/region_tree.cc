@@ -664,6 +664,21 @@ namespace Legion {
                                                 instances, instances_ready);
     }
 
+    //--------------------------------------------------------------------------
+    ApEvent RegionTreeForest::create_partition_by_space_filling_curve(
+                                                        Operation *op,
+                                                        IndexPartition pending,
+                                                        SpaceFillingCurve curve,
+                             const std::vector<FieldDataDescriptor> &instances,
+                                                        ApEvent instances_ready,
+                                                        size_t weight_size)
+    //--------------------------------------------------------------------------
+    {
+      IndexPartNode *partition = get_node(pending);
+      return partition->parent->create_by_space_filling_curve(op, partition,
+                          curve, instances, instances_ready, weight_size);
+    }
+
     //--------------------------------------------------------------------------
     ApEvent RegionTreeForest::create_partition_by_image(Operation *op,
                                                         IndexPartition pending,
@@ -9144,9 +9159,12 @@ namespace Legion {
                   Runtime::merge_events(NULL, child_ready_events));
           }
           else
+          {
             // Make a new index space node ready when the partition is ready
             result = context->create_node(is, NULL/*realm is*/, false, this, c,
                                           did, initialized, partition_ready);
+            initialize_lazy_child(result);
+          }
           if (runtime->legion_spy_enabled)
             LegionSpy::log_index_subspace(handle.id, is.id, 
                           result->get_domain_point_color());
@@ -9267,13 +9285,21 @@ namespace Legion {
 #endif
       // Now do the pairwise disjointness tests
       disjoint = true;
-      if (is_complete(false/*from app*/, true/*false if not ready*/))
+      if (compute_lazy_disjointness(disjoint))
+      {
+        // Computed directly from the subspaces of the children
+      }
+      else if (is_complete(false/*from app*/, true/*false if not ready*/))
       {
         // If we're complete we can check this using a linear algorithm
         // by suming up the volumes of all the children
         const size_t parent_volume = parent->get_volume();
         size_t children_volume = 0;
-        if (total_children == max_linearized_color)
+        if (compute_lazy_volume(children_volume))
+        {
+          // Computed directly from the subspaces of the children
+        }
+        else if (total_children == max_linearized_color)
         {
           for (LegionColor color = 0; color < max_linearized_color; color++)
           {
@@ -9500,7 +9526,11 @@ namespace Legion {
 	//  of the parent domains
 	const size_t parent_volume = parent->get_volume();
 	size_t child_volume = 0;
-        if (total_children == max_linearized_color)
+        if (compute_lazy_volume(child_volume))
+        {
+          // Computed directly from the subspaces of the children
+        }
+        else if (total_children == max_linearized_color)
         {
           for (LegionColor c = 0; c < max_linearized_color; c++)
           {
@@ -9648,6 +9678,27 @@ namespace Legion {
       pending_children.erase(child_color);
     }
 
+    //--------------------------------------------------------------------------
+    void IndexPartNode::initialize_lazy_child(IndexSpaceNode *child)
+    //--------------------------------------------------------------------------
+    {
+      // Nothing to do unless the partition recorded subspaces lazily
+    }
+
+    //--------------------------------------------------------------------------
+    bool IndexPartNode::compute_lazy_volume(size_t &volume)
+    //--------------------------------------------------------------------------
+    {
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    bool IndexPartNode::compute_lazy_disjointness(bool &result)
+    //--------------------------------------------------------------------------
+    {
+      return false;
+    }
+
     //--------------------------------------------------------------------------
     /*static*/ void IndexPartNode::handle_pending_child_task(const void *args)
     //--------------------------------------------------------------------------
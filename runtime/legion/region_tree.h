@@ -232,6 +232,13 @@ namespace Legion {
                                         IndexPartition pending,
                     const std::vector<FieldDataDescriptor> &instances,
                                         ApEvent instances_ready);
+      // No instances means every point has the same weight
+      ApEvent create_partition_by_space_filling_curve(Operation *op,
+                                        IndexPartition pending,
+                                        SpaceFillingCurve curve,
+                    const std::vector<FieldDataDescriptor> &instances,
+                                        ApEvent instances_ready,
+                                        size_t weight_size);
       ApEvent create_partition_by_image(Operation *op,
                                         IndexPartition pending,
                                         IndexPartition projection,
@@ -1966,6 +1973,12 @@ namespace Legion {
                                       IndexPartNode *partition,
                 const std::vector<FieldDataDescriptor> &instances,
                                       ApEvent instances_ready) = 0;
+      virtual ApEvent create_by_space_filling_curve(Operation *op,
+                                      IndexPartNode *partition,
+                                      SpaceFillingCurve curve,
+                const std::vector<FieldDataDescriptor> &instances,
+                                      ApEvent instances_ready,
+                                      size_t weight_size) = 0;
       virtual ApEvent create_by_image(Operation *op,
                                       IndexPartNode *partition,
                                       IndexPartNode *projection,
@@ -2163,6 +2176,19 @@ namespace Legion {
                                      IndexPartNode *partition,
                 const std::vector<FieldDataDescriptor> &instances,
                                      ApEvent instances_ready);
+      virtual ApEvent create_by_space_filling_curve(Operation *op,
+                                      IndexPartNode *partition,
+                                      SpaceFillingCurve curve,
+                const std::vector<FieldDataDescriptor> &instances,
+                                      ApEvent instances_ready,
+                                      size_t weight_size);
+      template<int COLOR_DIM, typename COLOR_T>
+      ApEvent create_by_space_filling_curve_helper(Operation *op,
+                                      IndexPartNode *partition,
+                                      SpaceFillingCurve curve,
+                const std::vector<FieldDataDescriptor> &instances,
+                                      ApEvent instances_ready,
+                                      size_t weight_size);
       virtual ApEvent create_by_image(Operation *op,
                                       IndexPartNode *partition,
                                       IndexPartNode *projection,
@@ -2381,6 +2407,33 @@ namespace Legion {
         const std::vector<FieldDataDescriptor> &instances;
         ApEvent ready, result;
       };
+      struct CreateBySpaceFillingCurveHelper {
+      public:
+        CreateBySpaceFillingCurveHelper(IndexSpaceNodeT<DIM,T> *n,
+                            Operation *o, IndexPartNode *p, 
+                            SpaceFillingCurve c,
+                            const std::vector<FieldDataDescriptor> &i,
+                            ApEvent r, size_t w)
+          : node(n), op(o), partition(p), curve(c), instances(i), ready(r),
+            weight_size(w) { }
+      public:
+        template<typename COLOR_DIM, typename COLOR_T>
+        static inline void demux(CreateBySpaceFillingCurveHelper *creator)
+        {
+          creator->result = creator->node->template 
+            create_by_space_filling_curve_helper<COLOR_DIM::N,COLOR_T>(
+              creator->op, creator->partition, creator->curve, 
+              creator->instances, creator->ready, creator->weight_size);
+        }
+      public:
+        IndexSpaceNodeT<DIM,T> *node;
+        Operation *op;
+        IndexPartNode *partition;
+        SpaceFillingCurve curve;
+        const std::vector<FieldDataDescriptor> &instances;
+        ApEvent ready, result;
+        size_t weight_size;
+      };
       struct CreateByImageHelper {
       public:
         CreateByImageHelper(IndexSpaceNodeT<DIM,T> *n,
@@ -2738,6 +2791,13 @@ namespace Legion {
                              ApUserEvent &domain_ready);
       void remove_pending_child(const LegionColor child_color);
       static void handle_pending_child_task(const void *args);
+    protected:
+      // Partitions can record the subspaces of their children without
+      // making nodes for them, in which case these make the child nodes
+      // on demand and answer queries without making the child nodes
+      virtual void initialize_lazy_child(IndexSpaceNode *child);
+      virtual bool compute_lazy_volume(size_t &volume);
+      virtual bool compute_lazy_disjointness(bool &disjoint);
     public:
       ApEvent create_equal_children(Operation *op, size_t granularity);
       ApEvent create_by_weights(Operation *op, const FutureMap &weights,
@@ -2838,6 +2898,35 @@ namespace Legion {
       virtual ~IndexPartNodeT(void);
     public:
       IndexPartNodeT& operator=(const IndexPartNodeT &rhs);
+    public:
+      // Record the subspaces for the children of this partition, either
+      // in the order of the color space or for an explicit list of colors.
+      // On the owner node the child nodes are only made when they are
+      // first asked for, everywhere else they are made right away.
+      void record_child_subspaces(
+          const std::vector<Realm::IndexSpace<DIM,T> > &subspaces,
+          ApEvent subspaces_ready);
+      void record_child_subspaces(const std::vector<LegionColor> &colors,
+          const std::vector<Realm::IndexSpace<DIM,T> > &subspaces,
+          ApEvent subspaces_ready);
+    protected:
+      virtual void initialize_lazy_child(IndexSpaceNode *child);
+      virtual bool compute_lazy_volume(size_t &volume);
+      virtual bool compute_lazy_disjointness(bool &disjoint);
+      bool wait_for_lazy_children(void);
+    protected:
+      struct LazyChild {
+      public:
+        inline bool operator<(const LazyChild &rhs) const
+          { return (color < rhs.color); }
+      public:
+        LegionColor color;
+        Realm::IndexSpace<DIM,T> space;
+        bool made;
+      };
+      // Sorted by color, only written once by record_child_subspaces
+      std::vector<LazyChild> lazy_children;
+      ApEvent lazy_children_ready;
     };
 
     /**
@@ -3477,40 +3477,9 @@ namespace Legion {
 #ifdef LEGION_SPY
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,ready,result);
 #endif
-      // Enumerate the colors and assign the spaces
-      unsigned subspace_index = 0;
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color(); 
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 
@@ -3603,40 +3572,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),
                                     handle, precondition, result);
 #endif
-      // Now set the index spaces for the results
-      subspace_index = 0;
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 
@@ -3729,40 +3667,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),
                                     handle, precondition, result);
 #endif
-      // Now set the index spaces for the results
-      subspace_index = 0;
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 
@@ -3856,40 +3763,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),
                                     handle, precondition, result);
 #endif
-      // Now set the index spaces for the results
-      subspace_index = 0;
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 
@@ -3982,40 +3858,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),
                                     handle, precondition, result);
 #endif
-      // Now set the index spaces for the results
-      subspace_index = 0;
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(subspace_index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[subspace_index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 
@@ -4068,6 +3913,8 @@ namespace Legion {
       parent->get_realm_index_space(parent_is, true/*tight*/);
       Realm::IndexSpace<N,T> local_is;
       get_realm_index_space(local_is, true/*tight*/);
+      std::vector<LegionColor> child_colors;
+      std::vector<Realm::IndexSpace<M,T> > subspaces;
       // Iterate over our points (colors) and fill in the bounds
       for (Realm::IndexSpaceIterator<N,T> rect_itr(local_is); 
             rect_itr.valid; rect_itr.step())
@@ -4081,17 +3928,14 @@ namespace Legion {
           child_is.bounds = parent_is.bounds.intersection(
                               extent + transform * color_itr.p);
           // Get the legion color
-          LegionColor color = linearize_color(&color_itr.p, 
-                                              handle.get_type_tag());
-          // Get the appropriate child
-          IndexSpaceNodeT<M,T> *child = 
-            static_cast<IndexSpaceNodeT<M,T>*>(partition->get_child(color));
-          // Then set the new index space
-          if (child->set_realm_index_space(context->runtime->address_space, 
-                                           child_is))
-            assert(false); // should never hit this
+          child_colors.push_back(linearize_color(&color_itr.p, 
+                                                 handle.get_type_tag()));
+          subspaces.push_back(child_is);
         }
       }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<M,T>*>(partition)->record_child_subspaces(
+                      child_colors, subspaces, parent->index_space_ready);
       // Our only precondition is that the parent index space is computed
       return parent->index_space_ready;
     }
@@ -4151,6 +3995,28 @@ namespace Legion {
                    partition->color_space->handle.get_type_tag(), &creator);
       return creator.result;
     }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    ApEvent IndexSpaceNodeT<DIM,T>::create_by_space_filling_curve(
+                                                    Operation *op,
+                                                    IndexPartNode *partition,
+                                                    SpaceFillingCurve curve,
+                              const std::vector<FieldDataDescriptor> &instances,
+                                                    ApEvent instances_ready,
+                                                    size_t weight_size)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(partition->parent == this);
+#endif
+      // Demux the color space type to do the actual operations 
+      CreateBySpaceFillingCurveHelper creator(this, op, partition, curve,
+                                    instances, instances_ready, weight_size);
+      NT_TemplateHelper::demux<CreateBySpaceFillingCurveHelper>(
+                   partition->color_space->handle.get_type_tag(), &creator);
+      return creator.result;
+    }
 #endif // defined(DEFINE_NT_TEMPLATES)
 
 #ifdef DEFINE_NTNT_TEMPLATES
@@ -4182,6 +4048,8 @@ namespace Legion {
             parent_ready = op->get_execution_fence_event();
         }
       }
+      std::vector<LegionColor> child_colors;
+      std::vector<Realm::IndexSpace<DIM,T> > subspaces;
       // Make all the entries for the color space
       for (Realm::IndexSpaceIterator<COLOR_DIM,COLOR_T> 
             rect_iter(realm_color_space); rect_iter.valid; rect_iter.step())
@@ -4189,10 +4057,8 @@ namespace Legion {
         for (Realm::PointInRectIterator<COLOR_DIM,COLOR_T> 
               itr(rect_iter.rect); itr.valid; itr.step())
         {
-          LegionColor child_color = color_space->linearize_color(&itr.p,
-                                        color_space->handle.get_type_tag());
-          IndexSpaceNodeT<DIM,T> *child = static_cast<IndexSpaceNodeT<DIM,T>*>(
-                                            partition->get_child(child_color));
+          child_colors.push_back(color_space->linearize_color(&itr.p,
+                                    color_space->handle.get_type_tag()));
           Realm::IndexSpace<DIM,T> child_space;
           const DomainPoint key(Point<COLOR_DIM,COLOR_T>(itr.p));
           FutureImpl *future = future_map->find_future(key);
@@ -4223,14 +4089,16 @@ namespace Legion {
           }
           else
             child_space = Realm::IndexSpace<DIM,T>::make_empty();
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           child_space))
-            assert(false); // should never hit this
+          subspaces.push_back(child_space);
         }
       }
-      if (result_events.empty())
-        return ApEvent::NO_AP_EVENT;
-      return Runtime::merge_events(NULL, result_events);
+      ApEvent result;
+      if (!result_events.empty())
+        result = Runtime::merge_events(NULL, result_events);
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(child_colors, subspaces, result);
+      return result;
     }
 
     //--------------------------------------------------------------------------
@@ -4324,15 +4192,9 @@ namespace Legion {
 #ifdef LEGION_SPY
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,ready,result);
 #endif
-      for (unsigned idx = 0; idx < count; idx++)
-      {
-        IndexSpaceNodeT<DIM,T> *child = 
-            static_cast<IndexSpaceNodeT<DIM,T>*>(
-                partition->get_child(child_colors[idx]));
-        if (child->set_realm_index_space(context->runtime->address_space,
-                                         subspaces[idx]))
-            assert(false); // should never hit this
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(child_colors, subspaces, result);
       return result;
     }
 
@@ -4411,17 +4273,123 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
                                     precondition, result);
 #endif
-      // Update the children with the names of their subspaces 
+      // Record the subspaces, child nodes get made when they are used
+      std::vector<LegionColor> child_colors(colors.size());
       for (unsigned idx = 0; idx < colors.size(); idx++)
-      {
-        LegionColor child_color = color_space->linearize_color(&colors[idx],
+        child_colors[idx] = color_space->linearize_color(&colors[idx],
                                         color_space->handle.get_type_tag());
-        IndexSpaceNodeT<DIM,T> *child = static_cast<IndexSpaceNodeT<DIM,T>*>(
-                                            partition->get_child(child_color));
-        if (child->set_realm_index_space(context->runtime->address_space,
-                                         subspaces[idx]))
-          assert(false); // should never hit this
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(child_colors, subspaces, result);
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T> template<int COLOR_DIM, typename COLOR_T>
+    ApEvent IndexSpaceNodeT<DIM,T>::create_by_space_filling_curve_helper(
+                                                      Operation *op,
+                                                      IndexPartNode *partition,
+                                                      SpaceFillingCurve curve,
+                             const std::vector<FieldDataDescriptor> &instances,
+                                                       ApEvent instances_ready,
+                                                       size_t weight_size)
+    //--------------------------------------------------------------------------
+    {
+      IndexSpaceNodeT<COLOR_DIM,COLOR_T> *color_space = 
+       static_cast<IndexSpaceNodeT<COLOR_DIM,COLOR_T>*>(partition->color_space);
+      // Enumerate the color space, pieces of the curve are handed out
+      // to the colors in this order
+      Realm::IndexSpace<COLOR_DIM,COLOR_T> realm_color_space;
+      color_space->get_realm_index_space(realm_color_space, true/*tight*/);
+      const size_t count = realm_color_space.volume();
+      std::vector<LegionColor> child_colors(count);
+      unsigned color_index = 0;
+      for (Realm::IndexSpaceIterator<COLOR_DIM,COLOR_T> 
+            rect_iter(realm_color_space); rect_iter.valid; rect_iter.step())
+      {
+        for (Realm::PointInRectIterator<COLOR_DIM,COLOR_T> 
+              itr(rect_iter.rect); itr.valid; itr.step())
+          child_colors[color_index++] = color_space->linearize_color(&itr.p,
+                                          color_space->handle.get_type_tag());
+      }
+      const Realm::SpaceFillingCurve realm_curve = 
+        (curve == LEGION_MORTON_CURVE) ? Realm::SFC_MORTON : Realm::SFC_HILBERT;
+      // Translate the instances to realm field data descriptors
+      std::set<ApEvent> preconditions; 
+      std::vector<Realm::FieldDataDescriptor<Realm::IndexSpace<DIM,T>,int> >
+        int_descriptors;
+      std::vector<Realm::FieldDataDescriptor<Realm::IndexSpace<DIM,T>,size_t> >
+        long_descriptors;
+      for (unsigned idx = 0; idx < instances.size(); idx++)
+      {
+        const FieldDataDescriptor &src = instances[idx];
+        Realm::IndexSpace<DIM,T> inst_space;
+        IndexSpaceNodeT<DIM,T> *node = static_cast<IndexSpaceNodeT<DIM,T>*>(
+                                          context->get_node(src.index_space));
+        ApEvent ready = node->get_realm_index_space(inst_space, 
+                                                    false/*tight*/);
+        if (ready.exists())
+          preconditions.insert(ready);
+        if (weight_size == sizeof(int))
+        {
+          Realm::FieldDataDescriptor<Realm::IndexSpace<DIM,T>,int> dst;
+          dst.index_space = inst_space;
+          dst.inst = src.inst;
+          dst.field_offset = src.field_offset;
+          int_descriptors.push_back(dst);
+        }
+        else
+        {
+#ifdef DEBUG_LEGION
+          assert(weight_size == sizeof(size_t));
+#endif
+          Realm::FieldDataDescriptor<Realm::IndexSpace<DIM,T>,size_t> dst;
+          dst.index_space = inst_space;
+          dst.inst = src.inst;
+          dst.field_offset = src.field_offset;
+          long_descriptors.push_back(dst);
+        }
+      }
+      // Get the profiling requests
+      Realm::ProfilingRequestSet requests;
+      if (context->runtime->profiler != NULL)
+        context->runtime->profiler->add_partition_request(requests,
+                                            op, DEP_PART_BY_SFC);
+      // Perform the operation
+      std::vector<Realm::IndexSpace<DIM,T> > subspaces;
+      Realm::IndexSpace<DIM,T> local_space;
+      ApEvent ready = get_realm_index_space(local_space, false/*tight*/);
+      if (ready.exists())
+        preconditions.insert(ready);
+      if (instances_ready.exists())
+        preconditions.insert(instances_ready);
+      if (op->has_execution_fence_event())
+        preconditions.insert(op->get_execution_fence_event());
+      ApEvent precondition = Runtime::merge_events(NULL, preconditions);
+      ApEvent result;
+      if (!int_descriptors.empty())
+        result = ApEvent(local_space.create_subspaces_by_sfc(realm_curve,
+              count, int_descriptors, subspaces, requests, precondition));
+      else if (!long_descriptors.empty())
+        result = ApEvent(local_space.create_subspaces_by_sfc(realm_curve,
+              count, long_descriptors, subspaces, requests, precondition));
+      else
+        result = ApEvent(local_space.create_subspaces_by_sfc(realm_curve,
+              count, subspaces, requests, precondition));
+#ifdef LEGION_DISABLE_EVENT_PRUNING
+      if (!result.exists() || (result == precondition))
+      {
+        ApUserEvent new_result = Runtime::create_ap_user_event(NULL);
+        Runtime::trigger_event(NULL, new_result);
+        result = new_result;
       }
+#endif
+#ifdef LEGION_SPY
+      LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
+                                    precondition, result);
+#endif
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM,T>*>(partition)->
+        record_child_subspaces(child_colors, subspaces, result);
       return result;
     }
 #endif // defined(DEFINE_NTNT_TEMPLATES)
@@ -4544,39 +4512,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
                                     precondition, result);
 #endif
-      // Update the child subspaces of the image
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[color]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        unsigned index = 0;
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM1,T1>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 #endif // defined(DEFINE_NTNT_TEMPLATES)
@@ -4700,39 +4638,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
                                     precondition, result);
 #endif
-      // Update the child subspaces of the image
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[color]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        unsigned index = 0;
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM1,T1>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 #endif // defined(DEFINE_NTNT_TEMPLATES)
@@ -4855,39 +4763,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
                                     precondition, result);
 #endif
-      // Update the child subspace of the preimage
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[color]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        unsigned index = 0;
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM1,T1>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 #endif // defined(DEFINE_NTNT_TEMPLATES)
@@ -5011,39 +4889,9 @@ namespace Legion {
       LegionSpy::log_deppart_events(op->get_unique_op_id(),handle,
                                     precondition, result);
 #endif
-      // Update the child subspace of the preimage
-      if (partition->total_children == partition->max_linearized_color)
-      {
-        for (LegionColor color = 0; color < partition->total_children; color++)
-        {
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[color]))
-            assert(false); // should never hit this
-        }
-      }
-      else
-      {
-        unsigned index = 0;
-        ColorSpaceIterator *itr = 
-          partition->color_space->create_color_space_iterator();
-        while (itr->is_valid())
-        {
-          const LegionColor color = itr->yield_color();
-          // Get the child of the projection partition
-          IndexSpaceNodeT<DIM1,T1> *child = 
-           static_cast<IndexSpaceNodeT<DIM1,T1>*>(partition->get_child(color));
-#ifdef DEBUG_LEGION
-          assert(index < subspaces.size());
-#endif
-          if (child->set_realm_index_space(context->runtime->address_space,
-                                           subspaces[index++]))
-            assert(false); // should never hit this
-        }
-        delete itr;
-      }
+      // Record the subspaces, child nodes get made when they are used
+      static_cast<IndexPartNodeT<DIM1,T1>*>(partition)->
+        record_child_subspaces(subspaces, result);
       return result;
     }
 #endif // defined(DEFINE_NTNT_TEMPLATES)
@@ -5663,6 +5511,11 @@ namespace Legion {
     IndexPartNodeT<DIM,T>::~IndexPartNodeT(void)
     //--------------------------------------------------------------------------
     { 
+      // Clean up any subspaces that never had child nodes made for them
+      for (typename std::vector<LazyChild>::iterator it =
+            lazy_children.begin(); it != lazy_children.end(); it++)
+        if (!it->made)
+          it->space.destroy(lazy_children_ready);
     }
 
     //--------------------------------------------------------------------------
@@ -5675,6 +5528,207 @@ namespace Legion {
       assert(false);
       return *this;
     } 
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    void IndexPartNodeT<DIM,T>::record_child_subspaces(
+                       const std::vector<Realm::IndexSpace<DIM,T> > &subspaces,
+                       ApEvent subspaces_ready)
+    //--------------------------------------------------------------------------
+    {
+      std::vector<LegionColor> colors;
+      colors.reserve(subspaces.size());
+      if (total_children == max_linearized_color)
+      {
+        for (LegionColor color = 0; color < total_children; color++)
+          colors.push_back(color);
+      }
+      else
+      {
+        ColorSpaceIterator *itr = color_space->create_color_space_iterator();
+        while (itr->is_valid())
+          colors.push_back(itr->yield_color());
+        delete itr;
+      }
+      record_child_subspaces(colors, subspaces, subspaces_ready);
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    void IndexPartNodeT<DIM,T>::record_child_subspaces(
+                       const std::vector<LegionColor> &colors,
+                       const std::vector<Realm::IndexSpace<DIM,T> > &subspaces,
+                       ApEvent subspaces_ready)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(colors.size() == subspaces.size());
+#endif
+      const AddressSpaceID local_space = context->runtime->address_space;
+      if ((get_owner_space() != local_space) || partial_pending.exists())
+      {
+        // Only the owner makes child nodes on demand so set them all now
+        for (unsigned idx = 0; idx < colors.size(); idx++)
+        {
+          IndexSpaceNodeT<DIM,T> *child = 
+            static_cast<IndexSpaceNodeT<DIM,T>*>(get_child(colors[idx]));
+          if (child->set_realm_index_space(local_space, subspaces[idx]))
+            assert(false); // should never hit this
+        }
+        return;
+      }
+      // Any children that have already been made get their subspaces now
+      std::vector<std::pair<IndexSpaceNodeT<DIM,T>*,unsigned> > existing;
+      {
+        AutoLock n_lock(node_lock);
+#ifdef DEBUG_LEGION
+        assert(lazy_children.empty());
+#endif
+        lazy_children_ready = subspaces_ready;
+        lazy_children.resize(colors.size());
+        for (unsigned idx = 0; idx < colors.size(); idx++)
+        {
+          LazyChild &child = lazy_children[idx];
+          child.color = colors[idx];
+          child.space = subspaces[idx];
+          std::map<LegionColor,IndexSpaceNode*>::const_iterator finder =
+            color_map.find(colors[idx]);
+          child.made = (finder != color_map.end());
+          if (child.made)
+            existing.push_back(std::make_pair(
+                  static_cast<IndexSpaceNodeT<DIM,T>*>(finder->second), idx));
+        }
+        std::sort(lazy_children.begin(), lazy_children.end());
+      }
+      for (typename std::vector<std::pair<IndexSpaceNodeT<DIM,T>*,
+            unsigned> >::const_iterator it = existing.begin(); 
+            it != existing.end(); it++)
+        if (it->first->set_realm_index_space(local_space, 
+                                             subspaces[it->second]))
+          assert(false); // should never hit this
+      // Legion Spy and the profiler need to see every subspace in the
+      // tree, so make all the child nodes now if either of them is on
+      if (context->runtime->legion_spy_enabled || 
+          (context->runtime->profiler != NULL))
+      {
+        for (unsigned idx = 0; idx < colors.size(); idx++)
+          get_child(colors[idx]);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    void IndexPartNodeT<DIM,T>::initialize_lazy_child(IndexSpaceNode *child)
+    //--------------------------------------------------------------------------
+    {
+      Realm::IndexSpace<DIM,T> space;
+      {
+        AutoLock n_lock(node_lock);
+        if (lazy_children.empty())
+          return;
+        LazyChild key;
+        key.color = child->color;
+        typename std::vector<LazyChild>::iterator finder = 
+          std::lower_bound(lazy_children.begin(), lazy_children.end(), key);
+        if ((finder == lazy_children.end()) || 
+            (finder->color != child->color) || finder->made)
+          return;
+        finder->made = true;
+        space = finder->space;
+      }
+      if (static_cast<IndexSpaceNodeT<DIM,T>*>(child)->set_realm_index_space(
+            context->runtime->address_space, space))
+        assert(false); // should never hit this
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    bool IndexPartNodeT<DIM,T>::wait_for_lazy_children(void)
+    //--------------------------------------------------------------------------
+    {
+      {
+        AutoLock n_lock(node_lock,1,false/*exclusive*/);
+        if (lazy_children.size() != size_t(total_children))
+          return false;
+      }
+      // Once recorded the subspaces never change so we can read them
+      // without the lock, but Realm has to be done computing them and
+      // sparse subspaces need their sparsity maps valid on this node
+      std::set<ApEvent> valid_events;
+      if (lazy_children_ready.exists())
+        valid_events.insert(lazy_children_ready);
+      for (typename std::vector<LazyChild>::const_iterator it =
+            lazy_children.begin(); it != lazy_children.end(); it++)
+      {
+        const ApEvent valid(it->space.make_valid());
+        if (valid.exists())
+          valid_events.insert(valid);
+      }
+      if (!valid_events.empty())
+      {
+        const ApEvent wait_on = Runtime::merge_events(NULL, valid_events);
+        if (!wait_on.has_triggered())
+          wait_on.wait();
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    bool IndexPartNodeT<DIM,T>::compute_lazy_volume(size_t &volume)
+    //--------------------------------------------------------------------------
+    {
+      if (!wait_for_lazy_children())
+        return false;
+      volume = 0;
+      for (typename std::vector<LazyChild>::const_iterator it =
+            lazy_children.begin(); it != lazy_children.end(); it++)
+        volume += it->space.volume();
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    bool IndexPartNodeT<DIM,T>::compute_lazy_disjointness(bool &result)
+    //--------------------------------------------------------------------------
+    {
+      if (!wait_for_lazy_children())
+        return false;
+      // Sweep over the children in order of their lower bounds in the
+      // first dimension so we only test the children whose bounds overlap
+      // instead of testing every pair of children
+      std::vector<std::pair<T,unsigned> > order;
+      order.reserve(lazy_children.size());
+      for (unsigned idx = 0; idx < lazy_children.size(); idx++)
+        if (!lazy_children[idx].space.bounds.empty())
+          order.push_back(
+              std::make_pair(lazy_children[idx].space.bounds.lo[0], idx));
+      std::sort(order.begin(), order.end());
+      std::vector<unsigned> active;
+      result = true;
+      for (typename std::vector<std::pair<T,unsigned> >::const_iterator it =
+            order.begin(); it != order.end(); it++)
+      {
+        const Realm::IndexSpace<DIM,T> &space = lazy_children[it->second].space;
+        unsigned kept = 0;
+        for (unsigned idx = 0; idx < active.size(); idx++)
+        {
+          const Realm::IndexSpace<DIM,T> &other = 
+            lazy_children[active[idx]].space;
+          if (other.bounds.hi[0] < it->first)
+            continue;
+          if (other.bounds.overlaps(space.bounds) && other.overlaps(space))
+          {
+            result = false;
+            return true;
+          }
+          active[kept++] = active[idx];
+        }
+        active.resize(kept);
+        active.push_back(it->second);
+      }
+      return true;
+    }
 #endif // defined(DEFINE_NT_TEMPLATES)
 
   }; // namespace Internal
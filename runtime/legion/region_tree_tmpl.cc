@@ -80,6 +80,12 @@ namespace Legion {
 				     IndexPartNode *,	  \
 				     const std::vector<FieldDataDescriptor> &, \
 				     ApEvent); \
+  template ApEvent IndexSpaceNodeT<INST_N1,T1>:: \
+    create_by_space_filling_curve_helper<INST_N2,T2>(Operation *, \
+				     IndexPartNode *,	  \
+				     SpaceFillingCurve, \
+				     const std::vector<FieldDataDescriptor> &, \
+				     ApEvent, size_t); \
   template ApEvent IndexSpaceNodeT<INST_N1,T1>:: \
     create_by_image_helper<INST_N2,T2>(Operation *, \
 				     IndexPartNode *, \
@@ -628,6 +628,20 @@ namespace Legion {
       return result_size;
     }
 
+    //--------------------------------------------------------------------------
+    AddressSpaceID FutureImpl::find_result_space(void) const
+    //--------------------------------------------------------------------------
+    {
+      AutoLock f_lock(future_lock,1,false/*exclusive*/);
+      if (!empty)
+        return local_space;
+      // Only the owner knows where a remotely set result went, everyone
+      // else has to go through the owner to get it
+      if (is_owner())
+        return result_set_space;
+      return owner_space;
+    }
+
     //--------------------------------------------------------------------------
     bool FutureImpl::is_empty(bool block, bool silence_warnings,
                               const char *warning_string, bool internal)
@@ -2046,6 +2060,9 @@ namespace Legion {
       // reset mapped and valid
       mapped = false;
       valid = false;
+      // The instances can change when we are remapped
+      AutoLock l_lock(layout_lock);
+      affine_layouts.clear();
     }
 
     //--------------------------------------------------------------------------
@@ -2404,6 +2421,78 @@ namespace Legion {
       return PhysicalInstance::NO_INST;
     } 
 
+    //--------------------------------------------------------------------------
+    bool PhysicalRegionImpl::find_affine_layout(PrivilegeMode mode, 
+                                 FieldID fid, size_t field_size, 
+                                 TypeTag type_tag, bool check_field_size,
+                                 ReductionOpID redop, PhysicalInstance &instance,
+                                 Domain &domain, uintptr_t &base,
+                                 size_t *strides) const
+    //--------------------------------------------------------------------------
+    {
+      // There are only ever a few fields so a linear search is fine
+      AutoLock l_lock(layout_lock,1,false/*exclusive*/);
+      for (std::vector<AffineLayout>::const_iterator it = 
+            affine_layouts.begin(); it != affine_layouts.end(); it++)
+      {
+        if ((it->fid != fid) || (it->mode != mode) || 
+            (it->type_tag != type_tag) || (it->field_size != field_size) ||
+            (it->redop != redop))
+          continue;
+        // If we never checked the field size then we need to do that
+        if (check_field_size && !it->checked_field_size)
+          return false;
+        instance = it->instance;
+        domain = it->bounds;
+        base = it->base;
+        for (int i = 0; i < it->bounds.get_dim(); i++)
+          strides[i] = it->strides[i];
+        return true;
+      }
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalRegionImpl::record_affine_layout(PrivilegeMode mode, 
+                                 FieldID fid, size_t field_size, 
+                                 TypeTag type_tag, bool check_field_size,
+                                 ReductionOpID redop, PhysicalInstance instance,
+                                 const Domain &domain, uintptr_t base,
+                                 const size_t *strides)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(mapped);
+      assert(domain.get_dim() <= LEGION_MAX_DIM);
+#endif
+      AutoLock l_lock(layout_lock);
+      for (std::vector<AffineLayout>::iterator it = 
+            affine_layouts.begin(); it != affine_layouts.end(); it++)
+      {
+        if ((it->fid != fid) || (it->mode != mode) || 
+            (it->type_tag != type_tag) || (it->field_size != field_size) ||
+            (it->redop != redop))
+          continue;
+        // Already have it, just remember if the field size was checked
+        if (check_field_size)
+          it->checked_field_size = true;
+        return;
+      }
+      affine_layouts.resize(affine_layouts.size() + 1);
+      AffineLayout &layout = affine_layouts.back();
+      layout.mode = mode;
+      layout.fid = fid;
+      layout.field_size = field_size;
+      layout.type_tag = type_tag;
+      layout.redop = redop;
+      layout.checked_field_size = check_field_size;
+      layout.instance = instance;
+      layout.bounds = domain;
+      layout.base = base;
+      for (int i = 0; i < domain.get_dim(); i++)
+        layout.strides[i] = strides[i];
+    }
+
     //--------------------------------------------------------------------------
     void PhysicalRegionImpl::report_incompatible_accessor(
               const char *accessor_kind, PhysicalInstance instance, FieldID fid)
@@ -8984,6 +9073,17 @@ namespace Legion {
               runtime->handle_remote_op_profiling_count_update(derez);
               break;
             }
+          case SEND_FUTURE_REDUCTION_REQUEST:
+            {
+              runtime->handle_future_reduction_request(derez,
+                                                       remote_address_space);
+              break;
+            }
+          case SEND_FUTURE_REDUCTION_RESPONSE:
+            {
+              runtime->handle_future_reduction_response(derez);
+              break;
+            }
           case SEND_REMOTE_TRACE_UPDATE:
             {
               runtime->handle_remote_tracing_update(derez,remote_address_space);
@@ -9005,6 +9105,11 @@ namespace Legion {
               runtime->handle_remote_tracing_eq_response(derez);
               break;
             }
+          case SEND_ATTACH_PREFETCH:
+            {
+              runtime->handle_attach_prefetch(derez);
+              break;
+            }
           case SEND_SHUTDOWN_NOTIFICATION:
             {
 #ifdef DEBUG_LEGION
@@ -9347,6 +9452,21 @@ namespace Legion {
       RemoteOp::handle_report_profiling_count_update(derez);
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::handle_future_reduction_request(Deserializer &derez,
+                                                  AddressSpaceID source)
+    //--------------------------------------------------------------------------
+    {
+      FutureReductionTree::handle_reduction_request(derez, this, source);
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::handle_future_reduction_response(Deserializer &derez)
+    //--------------------------------------------------------------------------
+    {
+      FutureReductionTree::handle_reduction_response(derez);
+    }
+
     //--------------------------------------------------------------------------
     void Runtime::handle_remote_tracing_update(Deserializer &derez,
                                                AddressSpaceID source)
@@ -9377,6 +9497,13 @@ namespace Legion {
       RemoteMemoizable::handle_eq_response(derez, this);
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::handle_attach_prefetch(Deserializer &derez)
+    //--------------------------------------------------------------------------
+    {
+      IndexAttachOp::handle_remote_prefetch(derez, this);
+    }
+
     //--------------------------------------------------------------------------
     /*static*/ void ShutdownManager::handle_shutdown_notification(
                    Deserializer &derez, Runtime *runtime, AddressSpaceID source)
@@ -17476,6 +17603,24 @@ namespace Legion {
           DEFAULT_VIRTUAL_CHANNEL, true/*flush*/, true/*response*/);
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::send_future_reduction_request(AddressSpaceID target,
+                                                Serializer &rez)
+    //--------------------------------------------------------------------------
+    {
+      find_messenger(target)->send_message(rez, SEND_FUTURE_REDUCTION_REQUEST,
+                                      DEFAULT_VIRTUAL_CHANNEL, true/*flush*/);
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::send_future_reduction_response(AddressSpaceID target,
+                                                 Serializer &rez)
+    //--------------------------------------------------------------------------
+    {
+      find_messenger(target)->send_message(rez, SEND_FUTURE_REDUCTION_RESPONSE,
+                    DEFAULT_VIRTUAL_CHANNEL, true/*flush*/, true/*response*/);
+    }
+
     //--------------------------------------------------------------------------
     void Runtime::send_remote_trace_update(AddressSpaceID target, 
                                            Serializer &rez)
@@ -17520,6 +17665,15 @@ namespace Legion {
                     DEFAULT_VIRTUAL_CHANNEL, true/*flush*/, true/*response*/);
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::send_attach_prefetch(AddressSpaceID target, Serializer &rez)
+    //--------------------------------------------------------------------------
+    {
+      // Prefetches are only hints so they don't need to be ordered
+      find_messenger(target)->send_message(rez, SEND_ATTACH_PREFETCH,
+                                      THROUGHPUT_VIRTUAL_CHANNEL, true/*flush*/);
+    }
+
     //--------------------------------------------------------------------------
     void Runtime::send_shutdown_notification(AddressSpaceID target, 
                                              Serializer &rez)
@@ -24969,6 +25123,16 @@ namespace Legion {
             Operation::handle_deferred_release(args);
             break;
           }
+        case LG_ATTACH_PREFETCH_TASK_ID:
+          {
+            IndexAttachOp::handle_prefetch(args);
+            break;
+          }
+        case LG_FOLD_FUTURE_REDUCTION_TASK_ID:
+          {
+            FutureReductionTree::handle_fold_futures(args);
+            break;
+          }
 #ifdef LEGION_MALLOC_INSTANCES
         // LG_MALLOC_INSTANCE_TASK_ID should always run app processor
         case LG_FREE_INSTANCE_TASK_ID:
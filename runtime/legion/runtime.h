@@ -226,6 +226,8 @@ namespace Legion {
                     bool internal = false);
       size_t get_untyped_size(bool internal = false);
       ApEvent get_ready_event(void) const { return future_complete; }
+      // The address space that holds the value of this future if known
+      AddressSpaceID find_result_space(void) const;
     public:
       // This will simply save the value of the future
       void set_result(const void *args, size_t arglen, bool own);
@@ -451,6 +453,16 @@ namespace Legion {
                                          bool generic_accessor,
                                          bool check_field_size,
                                          ReductionOpID redop);
+      bool find_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              PhysicalInstance &instance, Domain &bounds,
+                              uintptr_t &base, size_t *strides) const;
+      void record_affine_layout(PrivilegeMode mode, FieldID fid,
+                              size_t field_size, TypeTag type_tag,
+                              bool check_field_size, ReductionOpID redop,
+                              PhysicalInstance instance, const Domain &bounds,
+                              uintptr_t base, const size_t *strides);
       void report_incompatible_accessor(const char *accessor_kind,
                              PhysicalInstance instance, FieldID fid);
       void report_incompatible_multi_accessor(unsigned index, FieldID fid,
@@ -495,6 +507,26 @@ namespace Legion {
       // whether it is currently valid -> mapped and ready_event has triggered
       bool valid; 
       bool made_accessor;
+    private:
+      struct AffineLayout {
+      public:
+        PrivilegeMode mode;
+        FieldID fid;
+        size_t field_size;
+        TypeTag type_tag;
+        ReductionOpID redop;
+        bool checked_field_size;
+        PhysicalInstance instance;
+        Domain bounds;
+        uintptr_t base;
+        size_t strides[LEGION_MAX_DIM];
+      };
+      // Layouts of fields that affine accessors have already been made
+      // for, cleared whenever the instances of the region change
+      // Accessors can be made concurrently by inner tasks with multiple
+      // threads (e.g. OpenMP) so this cache is protected by its own lock
+      mutable LocalLock layout_lock;
+      std::vector<AffineLayout> affine_layouts;
 #ifdef LEGION_BOUNDS_CHECKS
     private:
       Domain bounds;
@@ -2445,12 +2477,16 @@ namespace Legion {
                                                Serializer &rez);
       void send_remote_op_profiling_count_update(AddressSpaceID target,
                                                  Serializer &rez);
+      void send_future_reduction_request(AddressSpaceID target,Serializer &rez);
+      void send_future_reduction_response(AddressSpaceID target,
+                                          Serializer &rez);
       void send_remote_trace_update(AddressSpaceID target, Serializer &rez);
       void send_remote_trace_response(AddressSpaceID target, Serializer &rez);
       void send_remote_trace_equivalence_sets_request(AddressSpaceID target,
                                                       Serializer &rez);
       void send_remote_trace_equivalence_sets_response(AddressSpaceID target,
                                                        Serializer &rez);
+      void send_attach_prefetch(AddressSpaceID target, Serializer &rez);
       void send_shutdown_notification(AddressSpaceID target, Serializer &rez);
       void send_shutdown_response(AddressSpaceID target, Serializer &rez);
     public:
@@ -2706,12 +2742,16 @@ namespace Legion {
       void handle_library_serdez_response(Deserializer &derez);
       void handle_remote_op_report_uninitialized(Deserializer &derez);
       void handle_remote_op_profiling_count_update(Deserializer &derez);
+      void handle_future_reduction_request(Deserializer &derez,
+                                           AddressSpaceID source);
+      void handle_future_reduction_response(Deserializer &derez);
       void handle_remote_tracing_update(Deserializer &derez,
                                         AddressSpaceID source);
       void handle_remote_tracing_response(Deserializer &derez);
       void handle_remote_tracing_eq_request(Deserializer &derez,
                                             AddressSpaceID source);
       void handle_remote_tracing_eq_response(Deserializer &derez);
+      void handle_attach_prefetch(Deserializer &derez);
       void handle_shutdown_notification(Deserializer &derez, 
                                         AddressSpaceID source);
       void handle_shutdown_response(Deserializer &derez);
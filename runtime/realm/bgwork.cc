@@ -20,6 +20,7 @@
 #include "realm/logging.h"
 #include "realm/utils.h"
 #include "realm/numa/numasysif.h"
+#include "realm/sampling.h"
 
 static unsigned ctz(uint64_t v)
 {
@@ -99,7 +100,8 @@ namespace Realm {
 			 CoreReservationSet& crs,
 			 const std::string& _name,
 			 int _numa_domain,
-			 bool _pin_thread, size_t _stack_size);
+			 bool _pin_thread, size_t _stack_size,
+			 int _pool_index);
     ~BackgroundWorkThread(void);
 
     void main_loop(void);
@@ -111,6 +113,7 @@ namespace Realm {
     CoreReservation *rsrv;
     Thread *me;
     int numa_domain;
+    int pool_index; // -1 == not subject to adaptive sizing
   };
 
   BackgroundWorkThread::BackgroundWorkThread(BackgroundWorkManager *_manager,
@@ -118,9 +121,11 @@ namespace Realm {
 					     const std::string& _name,
 					     int _numa_domain,
 					     bool _pin_thread,
-					     size_t _stack_size)
+					     size_t _stack_size,
+					     int _pool_index)
     : manager(_manager)
     , numa_domain(_numa_domain)
+    , pool_index(_pool_index)
   {
     CoreReservationParameters params;
     params.set_numa_domain(_numa_domain);
@@ -149,16 +154,35 @@ namespace Realm {
     worker.set_manager(manager);
     worker.set_numa_domain(numa_domain);
 
-    log_bgwork.info() << "dedicated worker starting - worker=" << this << " numa=" << numa_domain;
+    log_bgwork.info() << "dedicated worker starting - worker=" << this << " numa=" << numa_domain << " pool_index=" << pool_index;
+
+    bool adaptive_spin = (manager->cfg.worker_spin_interval < 0);
+    long long idle_since = 0;
 
     while(manager->shutdown_flag.load() == 0) {
+      // parked workers stay out of the way until the pool grows again
+      if((pool_index >= 0) &&
+	 (unsigned(pool_index) >= manager->awake_generic_workers.load())) {
+	log_bgwork.info() << "dedicated worker parked - worker=" << this;
+	manager->park_worker(pool_index);
+	log_bgwork.info() << "dedicated worker unparked - worker=" << this;
+	idle_since = 0;
+	continue;
+      }
+
       // see if there is work to do
       if(manager->active_work_items.load() != 0) {
+	if(adaptive_spin && (idle_since > 0)) {
+	  manager->record_idle_gap(Clock::current_time_in_nanoseconds() - idle_since);
+	  idle_since = 0;
+	}
 	// do work until there's nothing left
 	while(worker.do_work(-1 /*max_time*/, 0 /*interrupt_flag*/)) {}
+	if(adaptive_spin)
+	  idle_since = Clock::current_time_in_nanoseconds();
       } else {
 	// (potentially) spin for a bit and then sleep
-	long long spin_until = (manager->cfg.worker_spin_interval +
+	long long spin_until = (manager->current_spin_interval() +
 				Clock::current_time_in_nanoseconds());
 	while(manager->active_work_items.load() == 0) {
 	  if(manager->shutdown_flag.load() != 0)
@@ -166,6 +190,10 @@ namespace Realm {
 	  if(Clock::current_time_in_nanoseconds() < spin_until) {
 	    Thread::yield();
 	  } else {
+	    // an idle worker at the top of an adaptive pool parks instead
+	    if((pool_index >= 0) && manager->try_shrink_pool(pool_index))
+	      break;
+
 	    log_bgwork.info() << "dedicated worker sleeping - worker=" << this;
 	    {
 	      AutoLock<> a(manager->mutex);
@@ -213,6 +241,15 @@ namespace Realm {
     , condvar(mutex)
     , shutdown_flag(0)
     , sleeping_workers(0)
+    , adaptive_pool(false)
+    , awake_generic_workers(0)
+    , avg_work_time(0)
+    , avg_idle_gap(0)
+    , adaptive_spin_interval(0)
+    , park_condvar(mutex)
+    , awake_workers_gauge(0)
+    , busy_workers_gauge(0)
+    , spin_interval_gauge(0)
   {
     for(unsigned i = 0; i < BITMASK_ARRAY_SIZE; i++)
       active_work_item_mask[i].store(0);
@@ -226,6 +263,9 @@ namespace Realm {
   BackgroundWorkManager::~BackgroundWorkManager(void)
   {
     assert(dedicated_workers.empty());
+    delete awake_workers_gauge;
+    delete busy_workers_gauge;
+    delete spin_interval_gauge;
   }
 
   unsigned BackgroundWorkManager::assign_slot(BackgroundWorkItem *item)
@@ -276,6 +316,8 @@ namespace Realm {
     assert((prev & mask) == 0);
 
     int prev_count = active_work_items.fetch_add(1);
+    if(adaptive_pool && (prev_count > 0))
+      maybe_grow_pool(prev_count + 1);
     if((prev_count == 0) && (sleeping_workers.load() > 0)) {
       AutoLock<> a(mutex);
       // check again - somebody else may have handled this
@@ -295,7 +337,10 @@ namespace Realm {
       .add_option_int("-ll:bgnumapin", cfg.pin_numa.val)
       .add_option_int("-ll:bgstack", cfg.worker_stacksize_in_kb.val)
       .add_option_int("-ll:bgspin", cfg.worker_spin_interval.val)
-      .add_option_int("-ll:bgslice", cfg.work_item_timeslice.val);
+      .add_option_int("-ll:bgspinmax", cfg.max_spin_interval.val)
+      .add_option_int("-ll:bgslice", cfg.work_item_timeslice.val)
+      .add_option_int("-ll:bgworkmax", cfg.max_generic_workers.val)
+      .add_option_int("-ll:bgworklat", cfg.pool_grow_latency.val);
 
     bool ok = cp.parse_command_line(cmdline);
     assert(ok);
@@ -307,13 +352,34 @@ namespace Realm {
 
   void BackgroundWorkManager::start_dedicated_workers(Realm::CoreReservationSet& crs)
   {
-    for(unsigned i = 0; i < cfg.generic_workers; i++)
+    awake_workers_gauge = new ProfilingGauges::AbsoluteRangeGauge<int>("realm/bgwork/awake workers");
+    busy_workers_gauge = new ProfilingGauges::AbsoluteRangeGauge<int>("realm/bgwork/busy workers");
+    // the busy count is updated around every work item, so don't pay for
+    //  the atomic updates unless somebody is actually sampling it
+    if(!busy_workers_gauge->is_sampled()) {
+      delete busy_workers_gauge;
+      busy_workers_gauge = 0;
+    }
+    spin_interval_gauge = new ProfilingGauges::AbsoluteGauge<unsigned long long>("realm/bgwork/spin interval");
+
+    // generic workers beyond the configured count start out parked
+    unsigned num_generic = cfg.generic_workers;
+    adaptive_pool = (cfg.max_generic_workers > cfg.generic_workers);
+    if(adaptive_pool)
+      num_generic = cfg.max_generic_workers;
+    awake_generic_workers.store(cfg.generic_workers);
+    *awake_workers_gauge = int(cfg.generic_workers);
+    *spin_interval_gauge = ((cfg.worker_spin_interval > 0) ?
+			      cfg.worker_spin_interval.val : 0);
+
+    for(unsigned i = 0; i < num_generic; i++)
       dedicated_workers.push_back(new BackgroundWorkThread(this,
 							   crs,
 							   stringbuilder() << "dedicated worker (generic) #" << (i + 1),
 							   -1, // numa
 							   cfg.pin_generic,
-							   cfg.worker_stacksize_in_kb << 10));
+							   cfg.worker_stacksize_in_kb << 10,
+							   adaptive_pool ? int(i) : -1));
 
     if(cfg.per_numa_workers > 0) {
       std::map<int, NumaNodeCpuInfo> cpuinfo;
@@ -335,7 +401,8 @@ namespace Realm {
 								 stringbuilder() << "dedicated worker (numa " << ci.node_id << ") #" << (i + 1),
 								 ci.node_id,
 								 cfg.pin_numa,
-								 cfg.worker_stacksize_in_kb << 10));
+								 cfg.worker_stacksize_in_kb << 10,
+								 -1 /*pool_index*/));
 	}
       } else {
 	log_bgwork.warning() << "numa support not found (or not working)";
@@ -352,6 +419,7 @@ namespace Realm {
       if(sleeping_workers.load() != 0)
 	condvar.broadcast();
       sleeping_workers.store(0);
+      park_condvar.broadcast();
     }
 
     // now join on all the threads
@@ -364,6 +432,86 @@ namespace Realm {
     dedicated_workers.clear();
   }
 
+  void BackgroundWorkManager::maybe_grow_pool(int queue_depth)
+  {
+    unsigned awake = awake_generic_workers.load();
+    if(awake >= cfg.max_generic_workers)
+      return;
+
+    // estimate how long the newly-advertised work will wait for an awake
+    //  worker - no estimate until some work has been timed
+    long long expected_wait = ((queue_depth * avg_work_time.load()) /
+			       ((awake > 0) ? awake : 1));
+    if(expected_wait < cfg.pool_grow_latency)
+      return;
+
+    AutoLock<> al(mutex);
+    // somebody else may have grown (or shrunk) the pool already
+    if(!awake_generic_workers.compare_exchange(awake, awake + 1))
+      return;
+    log_bgwork.info() << "growing worker pool: awake=" << (awake + 1)
+		      << " depth=" << queue_depth << " wait=" << expected_wait;
+    *awake_workers_gauge = int(awake + 1);
+    park_condvar.broadcast();
+  }
+
+  bool BackgroundWorkManager::try_shrink_pool(unsigned pool_index)
+  {
+    // only the highest awake worker parks, and never below the configured
+    //  number of generic workers
+    unsigned awake = awake_generic_workers.load();
+    if((pool_index + 1) != awake)
+      return false;
+    if(awake <= cfg.generic_workers)
+      return false;
+    if(!awake_generic_workers.compare_exchange(awake, awake - 1))
+      return false;
+    log_bgwork.info() << "shrinking worker pool: awake=" << (awake - 1);
+    *awake_workers_gauge = int(awake - 1);
+    return true;
+  }
+
+  void BackgroundWorkManager::park_worker(unsigned pool_index)
+  {
+    AutoLock<> al(mutex);
+    while((pool_index >= awake_generic_workers.load()) &&
+	  (shutdown_flag.load() == 0))
+      park_condvar.wait();
+  }
+
+  void BackgroundWorkManager::record_work_time(long long elapsed)
+  {
+    // exponential moving average - racing updates just lose a sample
+    long long prev = avg_work_time.load();
+    avg_work_time.store(prev + ((elapsed - prev) >> 3));
+  }
+
+  long long BackgroundWorkManager::current_spin_interval(void) const
+  {
+    if(cfg.worker_spin_interval >= 0)
+      return cfg.worker_spin_interval;
+    else
+      return adaptive_spin_interval.load();
+  }
+
+  void BackgroundWorkManager::record_idle_gap(long long gap)
+  {
+    // spin long enough to cover typical gaps, but if work usually takes
+    //  longer than the cap to show up, spinning is wasted - just sleep
+    long long sample = ((gap < cfg.max_spin_interval) ?
+			  gap :
+			  cfg.max_spin_interval.val);
+    long long prev = avg_idle_gap.load();
+    long long avg = prev + ((sample - prev) >> 3);
+    avg_idle_gap.store(avg);
+    long long spin = (((2 * avg) < cfg.max_spin_interval) ? (2 * avg) : 0);
+    if(spin != adaptive_spin_interval.load()) {
+      adaptive_spin_interval.store(spin);
+      if(spin_interval_gauge)
+	*spin_interval_gauge = spin;
+    }
+  }
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class BackgroundWorkItem
@@ -607,6 +755,8 @@ namespace Realm {
 #ifdef DEBUG_REALM
 	  item->make_inactive();
 #endif
+	  if(manager->busy_workers_gauge)
+	    *(manager->busy_workers_gauge) += 1;
           while(true) {
             bool requeue = item->do_work(TimeLimit::absolute(t_quantum, interrupt_flag));
             if(requeue) {
@@ -629,6 +779,10 @@ namespace Realm {
             } else
               break;
           }
+	  if(manager->busy_workers_gauge)
+	    *(manager->busy_workers_gauge) -= 1;
+	  if(manager->adaptive_pool)
+	    manager->record_work_time(Clock::current_time_in_nanoseconds() - t_start);
 #ifdef REALM_BGWORK_PROFILE
 	  long long t_stop = Clock::current_time_in_nanoseconds();
 	  long long elapsed = t_stop - t_start;
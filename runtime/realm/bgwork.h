@@ -34,6 +34,11 @@ namespace Realm {
   class BackgroundWorkItem;
   class BackgroundWorkThread;
 
+  namespace ProfilingGauges {
+    template <typename T> class AbsoluteGauge;
+    template <typename T> class AbsoluteRangeGauge;
+  };
+
   // a central theme with background workers is to place limits on how long
   //  they do any one task - this is described using a TimeLimit object
   class TimeLimit {
@@ -80,8 +85,14 @@ namespace Realm {
       WithDefault<bool, false> pin_generic;
       WithDefault<bool, false> pin_numa;
       WithDefault<size_t, 1024> worker_stacksize_in_kb;
-      WithDefault<long long, 0> worker_spin_interval;
+      WithDefault<long long, 0> worker_spin_interval; // -1 == adaptive
+      WithDefault<long long, 100000> max_spin_interval; // adaptive spin cap
       WithDefault<long long, 100000> work_item_timeslice;
+      // if larger than generic_workers, extra generic workers are started
+      //  parked and woken when the expected queueing delay for advertised
+      //  work exceeds pool_grow_latency (in ns)
+      WithDefault<unsigned, 0> max_generic_workers;
+      WithDefault<long long, 50000> pool_grow_latency;
     };
 
     void configure_from_cmdline(std::vector<std::string>& cmdline);
@@ -125,6 +136,18 @@ namespace Realm {
     void release_slot(unsigned slot);
     void advertise_work(unsigned slot);
 
+    // adaptive pool sizing - generic workers with a pool index at or above
+    //  'awake_generic_workers' are parked
+    void maybe_grow_pool(int queue_depth);
+    bool try_shrink_pool(unsigned pool_index);
+    void park_worker(unsigned pool_index);
+    void record_work_time(long long elapsed);
+
+    // adaptive spinning - the spin interval tracks how long workers are
+    //  typically idle before new work shows up
+    long long current_spin_interval(void) const;
+    void record_idle_gap(long long gap);
+
     Config cfg;
     atomic<unsigned> num_work_items;
     atomic<int> active_work_items;
@@ -140,6 +163,19 @@ namespace Realm {
     atomic<int> shutdown_flag;
     atomic<int> sleeping_workers;
     std::vector<BackgroundWorkThread *> dedicated_workers;
+
+    bool adaptive_pool;
+    atomic<unsigned> awake_generic_workers;
+    atomic<long long> avg_work_time;
+    atomic<long long> avg_idle_gap;
+    atomic<long long> adaptive_spin_interval;
+    CondVar park_condvar;
+
+    // pool utilization gauges, created when the dedicated workers start
+    //  (the busy gauge only if the sampling profiler records it)
+    ProfilingGauges::AbsoluteRangeGauge<int> *awake_workers_gauge;
+    ProfilingGauges::AbsoluteRangeGauge<int> *busy_workers_gauge;
+    ProfilingGauges::AbsoluteGauge<unsigned long long> *spin_interval_gauge;
   };
 
   class REALM_INTERNAL_API_EXTERNAL_LINKAGE BackgroundWorkItem {
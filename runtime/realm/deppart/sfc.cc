@@ -0,0 +1,852 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// space-filling-curve partitioning operations for Realm dependent partitioning
+
+#include "realm/deppart/sfc.h"
+
+#include "realm/deppart/deppart_config.h"
+#include "realm/deppart/rectlist.h"
+#include "realm/deppart/inst_helper.h"
+#include "realm/logging.h"
+
+namespace Realm {
+
+  extern Logger log_part;
+  extern Logger log_uop_timing;
+  extern Logger log_dpops;
+
+
+  template <int N, typename T>
+  Event IndexSpace<N,T>::create_subspaces_by_sfc(SpaceFillingCurve curve, size_t count,
+						 std::vector<IndexSpace<N,T> >& subspaces,
+						 const ProfilingRequestSet &reqs,
+						 Event wait_on /*= Event::NO_EVENT*/) const
+  {
+    // unit weights are computed from the parent's rectangles
+    std::vector<FieldDataDescriptor<IndexSpace<N,T>,int> > no_weights;
+    return create_subspaces_by_sfc(curve, count, no_weights,
+				   subspaces, reqs, wait_on);
+  }
+
+  template <int N, typename T>
+  template <typename FT>
+  Event IndexSpace<N,T>::create_subspaces_by_sfc(SpaceFillingCurve curve, size_t count,
+						 const std::vector<FieldDataDescriptor<IndexSpace<N,T>,FT> >& weights,
+						 std::vector<IndexSpace<N,T> >& subspaces,
+						 const ProfilingRequestSet &reqs,
+						 Event wait_on /*= Event::NO_EVENT*/) const
+  {
+    // output vector should start out empty
+    assert(subspaces.empty());
+    // must always be creating at least one subspace (no "divide by zero")
+    assert(count >= 1);
+
+    // a single subspace is just a copy of this one
+    if(count == 1) {
+      long long inline_start_time = reqs.empty() ? 0 : Clock::current_time_in_nanoseconds();
+      subspaces.resize(1, *this);
+      PartitioningOperation::do_inline_profiling(reqs, inline_start_time);
+      return wait_on;
+    }
+
+    GenEventImpl *finish_event = GenEventImpl::create_genevent();
+    Event e = finish_event->current_event();
+    SFCOperation<N,T,FT> *op = new SFCOperation<N,T,FT>(*this, curve, weights, reqs,
+							finish_event, ID(e).event_generation());
+
+    subspaces.resize(count);
+    for(size_t i = 0; i < count; i++) {
+      subspaces[i] = op->add_subspace();
+      log_dpops.info() << "sfc: " << *this << " curve=" << int(curve) << " " << i << " -> " << subspaces[i] << " (" << e << ")";
+    }
+
+    op->launch(wait_on);
+    return e;
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCGrid<N,T>
+
+  template <int N, typename T>
+  SFCGrid<N,T>::SFCGrid(const Rect<N,T>& _bounds, SpaceFillingCurve _curve)
+    : bounds(_bounds)
+    , curve(_curve)
+  {
+    // offsets are computed in unsigned 64-bit math so that signed and
+    //  unsigned coordinate types both work
+    unsigned long long max_span = 0;
+    for(int i = 0; i < N; i++) {
+      unsigned long long span = 0;
+      if(bounds.lo[i] < bounds.hi[i])
+	span = ((unsigned long long)(bounds.hi[i]) -
+		(unsigned long long)(bounds.lo[i]));
+      if(span > max_span) max_span = span;
+    }
+    // no more cells per dimension than the largest extent needs
+    int span_bits = 0;
+    while((span_bits < 64) && ((max_span >> span_bits) != 0))
+      span_bits++;
+    bits = std::min(MAX_KEY_BITS / N, span_bits);
+    for(int i = 0; i < N; i++) {
+      unsigned long long span = 0;
+      if(bounds.lo[i] < bounds.hi[i])
+	span = ((unsigned long long)(bounds.hi[i]) -
+		(unsigned long long)(bounds.lo[i]));
+      width[i] = (span >> bits) + 1;
+    }
+  }
+
+  template <int N, typename T>
+  bool SFCGrid<N,T>::cells_splittable(void) const
+  {
+    unsigned long long volume = 1;
+    for(int i = 0; i < N; i++) {
+      if(width[i] > (MAX_SPLIT_CELL_VOLUME / volume))
+	return false;
+      volume *= width[i];
+    }
+    return true;
+  }
+
+  template <int N, typename T>
+  size_t SFCGrid<N,T>::compute_key(const unsigned long long *coords) const
+  {
+    if(bits == 0)
+      return 0;
+
+    unsigned long long x[N];
+    for(int i = 0; i < N; i++)
+      x[i] = coords[i];
+
+    if(curve == SFC_HILBERT) {
+      // Skilling's transform of the axes into the transposed Hilbert index
+      //  ("Programming the Hilbert curve", AIP Conf. Proc. 707, 2004)
+      const unsigned long long m = 1ULL << (bits - 1);
+      for(unsigned long long q = m; q > 1; q >>= 1) {
+	unsigned long long p = q - 1;
+	for(int i = 0; i < N; i++)
+	  if(x[i] & q) {
+	    x[0] ^= p;
+	  } else {
+	    unsigned long long t = (x[0] ^ x[i]) & p;
+	    x[0] ^= t;
+	    x[i] ^= t;
+	  }
+      }
+      // gray encode
+      for(int i = 1; i < N; i++)
+	x[i] ^= x[i - 1];
+      unsigned long long t = 0;
+      for(unsigned long long q = m; q > 1; q >>= 1)
+	if(x[N - 1] & q)
+	  t ^= q - 1;
+      for(int i = 0; i < N; i++)
+	x[i] ^= t;
+    }
+
+    // both curves end by interleaving the bits, most significant first
+    size_t key = 0;
+    for(int b = bits - 1; b >= 0; b--)
+      for(int i = 0; i < N; i++)
+	key = (key << 1) | ((x[i] >> b) & 1);
+    return key;
+  }
+
+  template <int N, typename T>
+  template <typename F>
+  void SFCGrid<N,T>::for_each_cell(const Rect<N,T>& r, F& f) const
+  {
+    Rect<N,T> clipped = r.intersection(bounds);
+    if(clipped.empty())
+      return;
+
+    unsigned long long rlo[N], rhi[N], clo[N], chi[N], c[N];
+    for(int i = 0; i < N; i++) {
+      rlo[i] = ((unsigned long long)(clipped.lo[i]) -
+		(unsigned long long)(bounds.lo[i]));
+      rhi[i] = ((unsigned long long)(clipped.hi[i]) -
+		(unsigned long long)(bounds.lo[i]));
+      clo[i] = rlo[i] / width[i];
+      chi[i] = rhi[i] / width[i];
+      c[i] = clo[i];
+    }
+
+    while(true) {
+      Rect<N,T> subrect;
+      for(int i = 0; i < N; i++) {
+	unsigned long long lo = std::max(rlo[i], c[i] * width[i]);
+	unsigned long long hi = std::min(rhi[i], c[i] * width[i] + (width[i] - 1));
+	subrect.lo[i] = T((unsigned long long)(bounds.lo[i]) + lo);
+	subrect.hi[i] = T((unsigned long long)(bounds.lo[i]) + hi);
+      }
+      f(compute_key(c), subrect);
+
+      // step to the next cell
+      int i = 0;
+      while(i < N) {
+	if(c[i] < chi[i]) {
+	  c[i]++;
+	  break;
+	}
+	c[i] = clo[i];
+	i++;
+      }
+      if(i == N) break;
+    }
+  }
+
+
+  namespace {
+
+    // which piece the running weight 'w' along the curve falls in
+    size_t sfc_piece(long double w, double total_weight, size_t count)
+    {
+      size_t p = size_t(w * count / total_weight);
+      return ((p < count) ? p : (count - 1));
+    }
+
+    // finds the cells that one of the cuts between the pieces falls
+    //  strictly inside of - every other cell goes to a single piece whole
+    void sfc_find_split_keys(const std::vector<double>& histogram, size_t count,
+			     std::vector<size_t>& split_keys)
+    {
+      double total_weight = 0;
+      for(size_t i = 0; i < histogram.size(); i++)
+	total_weight += histogram[i];
+      if(total_weight <= 0)
+	return;
+
+      long double cum_weight = 0;
+      for(size_t i = 0; i < histogram.size(); i++) {
+	if(histogram[i] > 0) {
+	  // the first cut after the start of this cell
+	  size_t k = sfc_piece(cum_weight, total_weight, count) + 1;
+	  if((k < count) &&
+	     (((long double)k * total_weight / count) < (cum_weight + histogram[i])))
+	    split_keys.push_back(i);
+	}
+	cum_weight += histogram[i];
+      }
+    }
+
+    // orders points by cell, and then by coordinates within a cell
+    template <int N, typename T>
+    bool sfc_point_weight_less(const SFCPointWeight<N,T>& a,
+			       const SFCPointWeight<N,T>& b)
+    {
+      if(a.key != b.key)
+	return (a.key < b.key);
+      for(int i = 0; i < N; i++)
+	if(a.point[i] != b.point[i])
+	  return (a.point[i] < b.point[i]);
+      return false;
+    }
+
+    // per-cell callbacks used with SFCGrid::for_each_cell
+
+    template <int N, typename T>
+    struct SFCVolumeWeights {
+      SFCVolumeWeights(std::vector<double>& _histogram)
+	: histogram(_histogram) {}
+
+      void operator()(size_t key, const Rect<N,T>& subrect)
+      {
+	histogram[key] += subrect.volume();
+      }
+
+      std::vector<double>& histogram;
+    };
+
+    template <int N, typename T, typename FT>
+    struct SFCFieldWeights {
+      SFCFieldWeights(std::vector<double>& _histogram,
+		      const AffineAccessor<FT,N,T>& _weights)
+	: histogram(_histogram), weights(_weights) {}
+
+      void operator()(size_t key, const Rect<N,T>& subrect)
+      {
+	// negative weights count as zero
+	double total = 0;
+	for(PointInRectIterator<N,T> pir(subrect); pir.valid; pir.step()) {
+	  FT w = weights.read(pir.p);
+	  if(w > FT(0))
+	    total += double(w);
+	}
+	histogram[key] += total;
+      }
+
+      std::vector<double>& histogram;
+      const AffineAccessor<FT,N,T>& weights;
+    };
+
+    // collects the weight of every point in the cells being split (a null
+    //  accessor means unit weights)
+    template <int N, typename T, typename FT>
+    struct SFCSplitCellPoints {
+      SFCSplitCellPoints(const std::vector<size_t>& _split_keys,
+			 const AffineAccessor<FT,N,T> *_weights,
+			 std::vector<SFCPointWeight<N,T> >& _points)
+	: split_keys(_split_keys), weights(_weights), points(_points) {}
+
+      void operator()(size_t key, const Rect<N,T>& subrect)
+      {
+	if(!std::binary_search(split_keys.begin(), split_keys.end(), key))
+	  return;
+	for(PointInRectIterator<N,T> pir(subrect); pir.valid; pir.step()) {
+	  SFCPointWeight<N,T> pw;
+	  pw.key = key;
+	  pw.point = pir.p;
+	  pw.weight = 1;
+	  if(weights) {
+	    // negative weights count as zero
+	    FT w = weights->read(pir.p);
+	    pw.weight = ((w > FT(0)) ? double(w) : 0);
+	  }
+	  points.push_back(pw);
+	}
+      }
+
+      const std::vector<size_t>& split_keys;
+      const AffineAccessor<FT,N,T> *weights;
+      std::vector<SFCPointWeight<N,T> >& points;
+    };
+
+    template <int N, typename T>
+    struct SFCEmitRects {
+      SFCEmitRects(const std::vector<size_t>& _key_to_piece,
+		   std::vector<DenseRectangleList<N,T> >& _rect_lists)
+	: key_to_piece(_key_to_piece), rect_lists(_rect_lists) {}
+
+      // cells that were split have already handed out their points
+      static const size_t SPLIT_CELL = ~size_t(0);
+
+      void operator()(size_t key, const Rect<N,T>& subrect)
+      {
+	if(key_to_piece[key] != SPLIT_CELL)
+	  rect_lists[key_to_piece[key]].add_rect(subrect);
+      }
+
+      const std::vector<size_t>& key_to_piece;
+      std::vector<DenseRectangleList<N,T> >& rect_lists;
+    };
+
+  };
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCHistogramMicroOp<N,T,FT>
+
+  template <int N, typename T, typename FT>
+  SFCHistogramMicroOp<N,T,FT>::SFCHistogramMicroOp(IndexSpace<N,T> _parent_space,
+						   IndexSpace<N,T> _inst_space,
+						   RegionInstance _inst,
+						   size_t _field_offset,
+						   SpaceFillingCurve _curve)
+    : parent_space(_parent_space)
+    , inst_space(_inst_space)
+    , inst(_inst)
+    , field_offset(_field_offset)
+    , curve(_curve)
+    , histogram_op(0)
+  {
+    areg.force_instantiation();
+  }
+
+  template <int N, typename T, typename FT>
+  SFCHistogramMicroOp<N,T,FT>::~SFCHistogramMicroOp(void)
+  {}
+
+  template <int N, typename T, typename FT>
+  void SFCHistogramMicroOp<N,T,FT>::set_histogram_output(PartitioningOperation *op)
+  {
+    histogram_op = reinterpret_cast<intptr_t>(op);
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCHistogramMicroOp<N,T,FT>::set_split_keys(const std::vector<size_t>& _split_keys)
+  {
+    split_keys = _split_keys;
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCHistogramMicroOp<N,T,FT>::execute(void)
+  {
+    TimeStamp ts("SFCHistogramMicroOp::execute", true, &log_uop_timing);
+
+    SFCGrid<N,T> grid(parent_space.bounds, curve);
+
+    if(!split_keys.empty()) {
+      // second round - the weights of the points in the cells being split
+      AffineAccessor<FT,N,T> a_data(inst, field_offset);
+      std::vector<SFCPointWeight<N,T> > points;
+      SFCSplitCellPoints<N,T,FT> collector(split_keys, &a_data, points);
+      for(IndexSpaceIterator<N,T> it(inst_space); it.valid; it.step())
+	for(IndexSpaceIterator<N,T> it2(parent_space, it.rect); it2.valid; it2.step())
+	  grid.for_each_cell(it2.rect, collector);
+
+      log_part.info() << "sfc point weights for " << inst << ": " << points.size()
+		      << " points in " << split_keys.size() << " split cells";
+
+      if(requestor == Network::my_node_id) {
+	SFCOperation<N,T,FT> *op = reinterpret_cast<SFCOperation<N,T,FT> *>(histogram_op);
+	op->provide_point_weights(points.empty() ? 0 : &points[0], points.size());
+      } else {
+	size_t payload_size = points.size() * sizeof(SFCPointWeight<N,T>);
+	ActiveMessage<SFCPointWeightMessage<SFCOperation<N,T,FT> > > amsg(requestor, payload_size);
+	amsg->histogram_op = histogram_op;
+	if(!points.empty())
+	  amsg.add_payload(&points[0], payload_size);
+	amsg.commit();
+      }
+      return;
+    }
+    std::vector<double> histogram(grid.num_keys(), 0);
+
+    // for now, one access for the whole instance
+    AffineAccessor<FT,N,T> a_data(inst, field_offset);
+    SFCFieldWeights<N,T,FT> weights(histogram, a_data);
+
+    // double iteration - use the instance's space first, since it's probably smaller
+    for(IndexSpaceIterator<N,T> it(inst_space); it.valid; it.step())
+      for(IndexSpaceIterator<N,T> it2(parent_space, it.rect); it2.valid; it2.step())
+	grid.for_each_cell(it2.rect, weights);
+
+    // only send the cells that actually have weight
+    std::vector<SFCHistogramEntry> entries;
+    for(size_t i = 0; i < histogram.size(); i++)
+      if(histogram[i] != 0) {
+	SFCHistogramEntry e;
+	e.key = i;
+	e.weight = histogram[i];
+	entries.push_back(e);
+      }
+
+    log_part.info() << "sfc histogram for " << inst << ": " << entries.size()
+		    << " non-empty cells";
+
+    if(requestor == Network::my_node_id) {
+      SFCOperation<N,T,FT> *op = reinterpret_cast<SFCOperation<N,T,FT> *>(histogram_op);
+      op->provide_histogram(entries.empty() ? 0 : &entries[0], entries.size());
+    } else {
+      size_t payload_size = entries.size() * sizeof(SFCHistogramEntry);
+      ActiveMessage<SFCHistogramMessage<SFCOperation<N,T,FT> > > amsg(requestor, payload_size);
+      amsg->histogram_op = histogram_op;
+      if(!entries.empty())
+	amsg.add_payload(&entries[0], payload_size);
+      amsg.commit();
+    }
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCHistogramMicroOp<N,T,FT>::dispatch(PartitioningOperation *op, bool inline_ok)
+  {
+    // the weights are read on whichever node the field data lives
+    NodeID exec_node = ID(inst).instance_owner_node();
+
+    if(exec_node != Network::my_node_id) {
+      forward_microop<SFCHistogramMicroOp<N,T,FT> >(exec_node, op, this);
+      return;
+    }
+
+    // instance index spaces should always be valid
+    assert(inst_space.is_valid(true /*precise*/));
+
+    // need valid data for the parent space too
+    if(!parent_space.dense()) {
+      // it's safe to add the count after the registration only because we initialized
+      //  the count to 2 instead of 1
+      bool registered = SparsityMapImpl<N,T>::lookup(parent_space.sparsity)->add_waiter(this, true /*precise*/);
+      if(registered)
+	wait_count.fetch_add(1);
+    }
+
+    finish_dispatch(op, inline_ok);
+  }
+
+  template <int N, typename T, typename FT>
+  template <typename S>
+  bool SFCHistogramMicroOp<N,T,FT>::serialize_params(S& s) const
+  {
+    return((s << parent_space) &&
+	   (s << inst_space) &&
+	   (s << inst) &&
+	   (s << field_offset) &&
+	   (s << int(curve)) &&
+	   (s << histogram_op) &&
+	   (s << split_keys));
+  }
+
+  template <int N, typename T, typename FT>
+  template <typename S>
+  SFCHistogramMicroOp<N,T,FT>::SFCHistogramMicroOp(NodeID _requestor,
+						   AsyncMicroOp *_async_microop, S& s)
+    : PartitioningMicroOp(_requestor, _async_microop)
+  {
+    int curve_val = 0;
+    bool ok = ((s >> parent_space) &&
+	       (s >> inst_space) &&
+	       (s >> inst) &&
+	       (s >> field_offset) &&
+	       (s >> curve_val) &&
+	       (s >> histogram_op) &&
+	       (s >> split_keys));
+    assert(ok);
+    (void)ok;
+    curve = SpaceFillingCurve(curve_val);
+  }
+
+  template <int N, typename T, typename FT>
+  ActiveMessageHandlerReg<RemoteMicroOpMessage<SFCHistogramMicroOp<N,T,FT> > > SFCHistogramMicroOp<N,T,FT>::areg;
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCSplitMicroOp<N,T>
+
+  template <int N, typename T>
+  SFCSplitMicroOp<N,T>::SFCSplitMicroOp(IndexSpace<N,T> _parent_space,
+					SpaceFillingCurve _curve,
+					const std::vector<SparsityMap<N,T> >& _sparsity_outputs)
+    : parent_space(_parent_space)
+    , curve(_curve)
+    , sparsity_outputs(_sparsity_outputs)
+  {}
+
+  template <int N, typename T>
+  SFCSplitMicroOp<N,T>::~SFCSplitMicroOp(void)
+  {}
+
+  template <int N, typename T>
+  void SFCSplitMicroOp<N,T>::set_histogram(std::vector<double>& _histogram)
+  {
+    histogram.swap(_histogram);
+  }
+
+  template <int N, typename T>
+  void SFCSplitMicroOp<N,T>::set_point_weights(std::vector<SFCPointWeight<N,T> >& _point_weights)
+  {
+    point_weights.swap(_point_weights);
+  }
+
+  template <int N, typename T>
+  void SFCSplitMicroOp<N,T>::execute(void)
+  {
+    TimeStamp ts("SFCSplitMicroOp::execute", true, &log_uop_timing);
+
+    SFCGrid<N,T> grid(parent_space.bounds, curve);
+    const size_t num_keys = grid.num_keys();
+    const size_t count = sparsity_outputs.size();
+
+    if(histogram.empty()) {
+      // unit weights - the weight of each cell is the volume of the parent
+      //  that falls inside it
+      histogram.resize(num_keys, 0);
+      SFCVolumeWeights<N,T> weights(histogram);
+      for(IndexSpaceIterator<N,T> it(parent_space); it.valid; it.step())
+	grid.for_each_cell(it.rect, weights);
+
+      // and the points of the cells being split can be listed right here
+      std::vector<size_t> split_keys;
+      if(grid.cells_splittable())
+	sfc_find_split_keys(histogram, count, split_keys);
+      if(!split_keys.empty()) {
+	SFCSplitCellPoints<N,T,int> collector(split_keys, 0, point_weights);
+	for(IndexSpaceIterator<N,T> it(parent_space); it.valid; it.step())
+	  grid.for_each_cell(it.rect, collector);
+      }
+    }
+    assert(histogram.size() == num_keys);
+
+    double total_weight = 0;
+    for(size_t i = 0; i < num_keys; i++)
+      total_weight += histogram[i];
+
+    // walk the curve and give each cell to the piece that the middle of its
+    //  weight falls in - this keeps pieces contiguous along the curve - but
+    //  the points of a cell a cut falls in are handed out one at a time
+    std::sort(point_weights.begin(), point_weights.end(),
+	      sfc_point_weight_less<N,T>);
+    std::vector<size_t> key_to_piece(num_keys, 0);
+    std::vector<DenseRectangleList<N,T> > rect_lists(count);
+    if(total_weight > 0) {
+      long double cum_weight = 0;
+      size_t piece = 0;
+      size_t next_point = 0;
+      for(size_t i = 0; i < num_keys; i++) {
+	if((next_point < point_weights.size()) &&
+	   (point_weights[next_point].key == i)) {
+	  key_to_piece[i] = SFCEmitRects<N,T>::SPLIT_CELL;
+	  while((next_point < point_weights.size()) &&
+		(point_weights[next_point].key == i)) {
+	    const SFCPointWeight<N,T>& pw = point_weights[next_point++];
+	    size_t p = sfc_piece(cum_weight + 0.5L * pw.weight, total_weight, count);
+	    if(p > piece) piece = p;
+	    rect_lists[piece].add_point(pw.point);
+	    cum_weight += pw.weight;
+	  }
+	  continue;
+	}
+
+	size_t p = sfc_piece(cum_weight + 0.5L * histogram[i], total_weight, count);
+	if(p > piece) piece = p;
+	key_to_piece[i] = piece;
+	cum_weight += histogram[i];
+      }
+    }
+
+    SFCEmitRects<N,T> emitter(key_to_piece, rect_lists);
+    for(IndexSpaceIterator<N,T> it(parent_space); it.valid; it.step())
+      grid.for_each_cell(it.rect, emitter);
+
+    for(size_t i = 0; i < count; i++) {
+      SparsityMapImpl<N,T> *impl = SparsityMapImpl<N,T>::lookup(sparsity_outputs[i]);
+      if(!rect_lists[i].rects.empty())
+	impl->contribute_dense_rect_list(rect_lists[i].rects, true /*disjoint*/);
+      else
+	impl->contribute_nothing();
+    }
+  }
+
+  template <int N, typename T>
+  void SFCSplitMicroOp<N,T>::dispatch(PartitioningOperation *op, bool inline_ok)
+  {
+    // need valid data for the parent space
+    if(!parent_space.dense()) {
+      // it's safe to add the count after the registration only because we initialized
+      //  the count to 2 instead of 1
+      bool registered = SparsityMapImpl<N,T>::lookup(parent_space.sparsity)->add_waiter(this, true /*precise*/);
+      if(registered)
+	wait_count.fetch_add(1);
+    }
+
+    finish_dispatch(op, inline_ok);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCOperation<N,T,FT>
+
+  template <int N, typename T, typename FT>
+  SFCOperation<N,T,FT>::SFCOperation(const IndexSpace<N,T>& _parent,
+				     SpaceFillingCurve _curve,
+				     const std::vector<FieldDataDescriptor<IndexSpace<N,T>,FT> >& _field_data,
+				     const ProfilingRequestSet &reqs,
+				     GenEventImpl *_finish_event,
+				     EventImpl::gen_t _finish_gen)
+    : PartitioningOperation(reqs, _finish_event, _finish_gen)
+    , parent(_parent)
+    , curve(_curve)
+    , field_data(_field_data)
+    , remaining_histograms(0)
+    , dummy_histogram_uop(0)
+  {
+    areg.force_instantiation();
+    pw_areg.force_instantiation();
+  }
+
+  template <int N, typename T, typename FT>
+  SFCOperation<N,T,FT>::~SFCOperation(void)
+  {}
+
+  template <int N, typename T, typename FT>
+  IndexSpace<N,T> SFCOperation<N,T,FT>::add_subspace(void)
+  {
+    // an empty parent leads to trivially empty subspaces
+    if(parent.empty())
+      return IndexSpace<N,T>::make_empty();
+
+    // otherwise it'll be something smaller than the current parent
+    IndexSpace<N,T> subspace;
+    subspace.bounds = parent.bounds;
+
+    // the curve is cut on this node, so that's where the sparsity maps go
+    SparsityMap<N,T> sparsity = get_runtime()->get_available_sparsity_impl(Network::my_node_id)->me.convert<SparsityMap<N,T> >();
+    subspace.sparsity = sparsity;
+
+    subspaces.push_back(sparsity);
+
+    return subspace;
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCOperation<N,T,FT>::execute(void)
+  {
+    if(subspaces.empty())
+      return;
+
+    for(size_t i = 0; i < subspaces.size(); i++)
+      SparsityMapImpl<N,T>::lookup(subspaces[i])->set_contributor_count(1);
+
+    if(field_data.empty()) {
+      SFCSplitMicroOp<N,T> *uop = new SFCSplitMicroOp<N,T>(parent, curve, subspaces);
+      uop->dispatch(this, true /* ok to run in this thread */);
+      return;
+    }
+
+    histogram.resize(SFCGrid<N,T>(parent.bounds, curve).num_keys(), 0);
+    remaining_histograms.store(field_data.size());
+
+    // create a dummy async microop that lives until we've received all the histograms
+    dummy_histogram_uop = new AsyncMicroOp(this, 0);
+    add_async_work_item(dummy_histogram_uop);
+
+    for(size_t i = 0; i < field_data.size(); i++) {
+      SFCHistogramMicroOp<N,T,FT> *uop = new SFCHistogramMicroOp<N,T,FT>(parent,
+									 field_data[i].index_space,
+									 field_data[i].inst,
+									 field_data[i].field_offset,
+									 curve);
+      uop->set_histogram_output(this);
+      uop->dispatch(this, false /* do not run in this thread */);
+    }
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCOperation<N,T,FT>::provide_histogram(const SFCHistogramEntry *entries,
+					       size_t count)
+  {
+    {
+      AutoLock<> al(mutex);
+      for(size_t i = 0; i < count; i++) {
+	assert(entries[i].key < histogram.size());
+	histogram[entries[i].key] += entries[i].weight;
+      }
+    }
+
+    // the last histogram to arrive kicks off the split, unless cuts fall
+    //  inside some cells - then the weights of those cells' points are
+    //  needed first
+    int v = remaining_histograms.fetch_sub(1) - 1;
+    if(v == 0) {
+      std::vector<size_t> split_keys;
+      if(SFCGrid<N,T>(parent.bounds, curve).cells_splittable())
+	sfc_find_split_keys(histogram, subspaces.size(), split_keys);
+      if(split_keys.empty()) {
+	launch_split();
+	return;
+      }
+
+      remaining_histograms.store(field_data.size());
+      for(size_t i = 0; i < field_data.size(); i++) {
+	SFCHistogramMicroOp<N,T,FT> *uop = new SFCHistogramMicroOp<N,T,FT>(parent,
+									   field_data[i].index_space,
+									   field_data[i].inst,
+									   field_data[i].field_offset,
+									   curve);
+	uop->set_histogram_output(this);
+	uop->set_split_keys(split_keys);
+	uop->dispatch(this, false /* do not run in this thread */);
+      }
+    }
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCOperation<N,T,FT>::provide_point_weights(const SFCPointWeight<N,T> *entries,
+						   size_t count)
+  {
+    {
+      AutoLock<> al(mutex);
+      point_weights.insert(point_weights.end(), entries, entries + count);
+    }
+
+    int v = remaining_histograms.fetch_sub(1) - 1;
+    if(v == 0)
+      launch_split();
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCOperation<N,T,FT>::launch_split(void)
+  {
+    SFCSplitMicroOp<N,T> *uop = new SFCSplitMicroOp<N,T>(parent, curve, subspaces);
+    uop->set_histogram(histogram);
+    uop->set_point_weights(point_weights);
+    uop->dispatch(this, false /* do not run in this thread */);
+    dummy_histogram_uop->mark_finished(true /*successful*/);
+  }
+
+  template <int N, typename T, typename FT>
+  void SFCOperation<N,T,FT>::print(std::ostream& os) const
+  {
+    os << "SFCOperation(" << parent << ")";
+  }
+
+  template <int N, typename T, typename FT>
+  ActiveMessageHandlerReg<SFCHistogramMessage<SFCOperation<N,T,FT> > > SFCOperation<N,T,FT>::areg;
+
+  template <int N, typename T, typename FT>
+  ActiveMessageHandlerReg<SFCPointWeightMessage<SFCOperation<N,T,FT> > > SFCOperation<N,T,FT>::pw_areg;
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCHistogramMessage<T>
+
+  template <typename T>
+  /*static*/ void SFCHistogramMessage<T>::handle_message(NodeID sender,
+							 const SFCHistogramMessage<T> &msg,
+							 const void *data, size_t datalen)
+  {
+    T *op = reinterpret_cast<T *>(msg.histogram_op);
+    op->provide_histogram(static_cast<const SFCHistogramEntry *>(data),
+			  datalen / sizeof(SFCHistogramEntry));
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SFCPointWeightMessage<T>
+
+  template <typename T>
+  /*static*/ void SFCPointWeightMessage<T>::handle_message(NodeID sender,
+							   const SFCPointWeightMessage<T> &msg,
+							   const void *data, size_t datalen)
+  {
+    typedef SFCPointWeight<T::DIM, typename T::IDXTYPE> PW;
+    T *op = reinterpret_cast<T *>(msg.histogram_op);
+    op->provide_point_weights(static_cast<const PW *>(data),
+			      datalen / sizeof(PW));
+  }
+
+#define DOIT(N,T) \
+  template class SFCGrid<N,T>; \
+  template class SFCSplitMicroOp<N,T>; \
+  template Event IndexSpace<N,T>::create_subspaces_by_sfc(SpaceFillingCurve, size_t, \
+							  std::vector<IndexSpace<N,T> >&, \
+							  const ProfilingRequestSet &, \
+							  Event) const;
+#define DOIT_FT(N,T,F) \
+  template class SFCHistogramMicroOp<N,T,F>; \
+  template class SFCOperation<N,T,F>; \
+  template SFCHistogramMicroOp<N,T,F>::SFCHistogramMicroOp(NodeID, AsyncMicroOp *, Serialization::FixedBufferDeserializer&); \
+  template Event IndexSpace<N,T>::create_subspaces_by_sfc(SpaceFillingCurve, size_t, \
+							  const std::vector<FieldDataDescriptor<IndexSpace<N,T>,F> >&, \
+							  std::vector<IndexSpace<N,T> >&, \
+							  const ProfilingRequestSet &, \
+							  Event) const;
+#define DOIT_WEIGHTS(N,T) \
+  DOIT_FT(N,T,int) \
+  DOIT_FT(N,T,size_t) \
+  DOIT_FT(N,T,float) \
+  DOIT_FT(N,T,double)
+
+  FOREACH_NT(DOIT)
+  FOREACH_NT(DOIT_WEIGHTS)
+
+};
@@ -0,0 +1,209 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// space-filling-curve partitioning operations for Realm dependent partitioning
+
+#ifndef REALM_DEPPART_SFC_H
+#define REALM_DEPPART_SFC_H
+
+#include "realm/deppart/partitions.h"
+
+namespace Realm {
+
+  // the bounds of the parent space are covered by a grid of 2^bits cells in
+  //  each dimension, and the cells are numbered along the requested curve -
+  //  all balancing decisions are made at the granularity of these cells
+  template <int N, typename T>
+  class SFCGrid {
+  public:
+    // total key bits are capped so that a dense histogram over all the
+    //  cells stays small enough to ship around and scan quickly
+    static const int MAX_KEY_BITS = 16;
+
+    // cells that a cut falls in are split point by point, which means
+    //  shipping the weight of each of their points around, so that's only
+    //  done when cells are no bigger than this
+    static const unsigned long long MAX_SPLIT_CELL_VOLUME = 1 << 16;
+
+    SFCGrid(const Rect<N,T>& _bounds, SpaceFillingCurve _curve);
+
+    size_t num_keys(void) const { return size_t(1) << (N * bits); }
+
+    bool cells_splittable(void) const;
+
+    // calls 'f(key, subrect)' for every cell that overlaps 'r', with
+    //  'subrect' being the part of 'r' inside that cell
+    template <typename F>
+    void for_each_cell(const Rect<N,T>& r, F& f) const;
+
+  protected:
+    size_t compute_key(const unsigned long long *coords) const;
+
+    Rect<N,T> bounds;
+    SpaceFillingCurve curve;
+    int bits;
+    unsigned long long width[N];
+  };
+
+  // one entry of a sparse weight histogram
+  struct SFCHistogramEntry {
+    size_t key;
+    double weight;
+  };
+
+  // the weight of a single point in a cell that is split
+  template <int N, typename T>
+  struct SFCPointWeight {
+    size_t key;
+    Point<N,T> point;
+    double weight;
+  };
+
+  template <int N, typename T, typename FT>
+  class SFCHistogramMicroOp : public PartitioningMicroOp {
+  public:
+    static const int DIM = N;
+    typedef T IDXTYPE;
+    typedef FT FIELDTYPE;
+
+    SFCHistogramMicroOp(IndexSpace<N,T> _parent_space, IndexSpace<N,T> _inst_space,
+			RegionInstance _inst, size_t _field_offset,
+			SpaceFillingCurve _curve);
+    virtual ~SFCHistogramMicroOp(void);
+
+    void set_histogram_output(PartitioningOperation *op);
+
+    // instead of a histogram, report the weight of every point in the
+    //  given (sorted) cells
+    void set_split_keys(const std::vector<size_t>& _split_keys);
+
+    virtual void execute(void);
+
+    void dispatch(PartitioningOperation *op, bool inline_ok);
+
+  protected:
+    friend struct RemoteMicroOpMessage<SFCHistogramMicroOp<N,T,FT> >;
+    static ActiveMessageHandlerReg<RemoteMicroOpMessage<SFCHistogramMicroOp<N,T,FT> > > areg;
+
+    friend class PartitioningMicroOp;
+    template <typename S>
+    REALM_ATTR_WARN_UNUSED(bool serialize_params(S& s) const);
+
+    // construct from received packet
+    template <typename S>
+    SFCHistogramMicroOp(NodeID _requestor, AsyncMicroOp *_async_microop, S& s);
+
+    IndexSpace<N,T> parent_space, inst_space;
+    RegionInstance inst;
+    size_t field_offset;
+    SpaceFillingCurve curve;
+    intptr_t histogram_op;
+    std::vector<size_t> split_keys;
+  };
+
+  // runs on the node that launched the operation once all the weights are
+  //  known and cuts the curve into the output subspaces
+  template <int N, typename T>
+  class SFCSplitMicroOp : public PartitioningMicroOp {
+  public:
+    SFCSplitMicroOp(IndexSpace<N,T> _parent_space, SpaceFillingCurve _curve,
+		    const std::vector<SparsityMap<N,T> >& _sparsity_outputs);
+    virtual ~SFCSplitMicroOp(void);
+
+    // an empty histogram means every point has unit weight
+    void set_histogram(std::vector<double>& _histogram);
+
+    // weights of the points in the cells the cuts fall in
+    void set_point_weights(std::vector<SFCPointWeight<N,T> >& _point_weights);
+
+    virtual void execute(void);
+
+    void dispatch(PartitioningOperation *op, bool inline_ok);
+
+  protected:
+    IndexSpace<N,T> parent_space;
+    SpaceFillingCurve curve;
+    std::vector<SparsityMap<N,T> > sparsity_outputs;
+    std::vector<double> histogram;
+    std::vector<SFCPointWeight<N,T> > point_weights;
+  };
+
+  template <typename T>
+  struct SFCHistogramMessage;
+
+  template <typename T>
+  struct SFCPointWeightMessage;
+
+  template <int N, typename T, typename FT>
+  class SFCOperation : public PartitioningOperation {
+  public:
+    static const int DIM = N;
+    typedef T IDXTYPE;
+
+    SFCOperation(const IndexSpace<N,T>& _parent, SpaceFillingCurve _curve,
+		 const std::vector<FieldDataDescriptor<IndexSpace<N,T>,FT> >& _field_data,
+		 const ProfilingRequestSet &reqs,
+		 GenEventImpl *_finish_event, EventImpl::gen_t _finish_gen);
+
+    virtual ~SFCOperation(void);
+
+    IndexSpace<N,T> add_subspace(void);
+
+    virtual void execute(void);
+
+    virtual void print(std::ostream& os) const;
+
+    void provide_histogram(const SFCHistogramEntry *entries, size_t count);
+
+    void provide_point_weights(const SFCPointWeight<N,T> *entries, size_t count);
+
+  protected:
+    void launch_split(void);
+
+    static ActiveMessageHandlerReg<SFCHistogramMessage<SFCOperation<N,T,FT> > > areg;
+    static ActiveMessageHandlerReg<SFCPointWeightMessage<SFCOperation<N,T,FT> > > pw_areg;
+
+    IndexSpace<N,T> parent;
+    SpaceFillingCurve curve;
+    std::vector<FieldDataDescriptor<IndexSpace<N,T>,FT> > field_data;
+    std::vector<SparsityMap<N,T> > subspaces;
+    Mutex mutex;
+    std::vector<double> histogram;
+    std::vector<SFCPointWeight<N,T> > point_weights;
+    atomic<int> remaining_histograms;
+    AsyncMicroOp *dummy_histogram_uop;
+  };
+
+  template <typename T>
+  struct SFCHistogramMessage {
+    intptr_t histogram_op;
+
+    static void handle_message(NodeID sender,
+			       const SFCHistogramMessage<T> &msg,
+			       const void *data, size_t datalen);
+  };
+
+  template <typename T>
+  struct SFCPointWeightMessage {
+    intptr_t histogram_op;
+
+    static void handle_message(NodeID sender,
+			       const SFCPointWeightMessage<T> &msg,
+			       const void *data, size_t datalen);
+  };
+
+};
+
+#endif // REALM_DEPPART_SFC_H
@@ -19,6 +19,9 @@
 #define REALM_DYNAMIC_TABLE_H
 
 #include "realm/atomics.h"
+#include "realm/threads.h"
+
+#include <map>
 
 namespace Realm {
 
@@ -89,7 +92,12 @@ namespace Realm {
       typedef typename ALLOCATOR::ET ET;
       typedef typename ALLOCATOR::LT LT;
 
-      DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner);
+      // lists that are one of many of the same kind (e.g. one per node)
+      //  should not use magazines - a thread only has a few, and cycling
+      //  through more lists than that would just thrash them
+      DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner,
+			   bool _use_magazines = true);
+      ~DynamicTableFreeList(void);
 
       ET *alloc_entry(void);
       void free_entry(ET *entry);
@@ -103,6 +111,46 @@ namespace Realm {
       LT lock;
       atomic<ET *> first_free;
       IT next_alloc;
+
+    protected:
+      // each thread caches free entries of the last few free lists it used
+      //  in "magazines", which are refilled from and spilled to the shared
+      //  list MAGAZINE_BATCH entries at a time so that threads rarely touch
+      //  the shared list (or its lock) - when a thread needs a magazine for
+      //  another list, the least recently used one is spilled and reused,
+      //  and all of them are spilled when the thread exits
+      static const unsigned MAGAZINE_BATCH = 32;
+      static const unsigned MAGAZINES_PER_THREAD = 4;
+
+      struct Magazine {
+	unsigned serial;  // of the owning free list, 0 if unused
+	unsigned count;
+	unsigned last_use;
+	ET *head;
+      };
+
+      // returns the calling thread's magazine for this free list, making
+      //  one if needed
+      Magazine *get_magazine(void);
+      void refill_magazine(Magazine *mag, unsigned max_count);
+      void spill_magazine(Magazine *mag, unsigned max_count);
+
+      // empties a magazine back into its free list (if that still exists)
+      //  and marks it unused
+      static void release_magazine(Magazine *mag);
+      static void release_thread_magazines(void *);
+
+      // magazines are matched by serial number rather than address so that
+      //  a magazine left over from a destroyed free list is never used - the
+      //  free lists that still exist are found by serial when a magazine
+      //  has to be spilled
+      unsigned serial;  // 0 if this list doesn't use magazines
+      static atomic<unsigned> next_serial;
+      static LT live_lists_lock;
+      static std::map<unsigned, DynamicTableFreeList<ALLOCATOR> *> live_lists;
+      static REALM_THREAD_LOCAL Magazine thread_magazines[MAGAZINES_PER_THREAD];
+      static REALM_THREAD_LOCAL unsigned thread_magazine_clock;
+      static REALM_THREAD_LOCAL bool thread_magazines_release_registered;
     };
 	
 }; // namespace Realm
@@ -321,12 +321,166 @@ namespace Realm {
   //
 
   template <typename ALLOCATOR>
-  DynamicTableFreeList<ALLOCATOR>::DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner)
+  /*static*/ atomic<unsigned> DynamicTableFreeList<ALLOCATOR>::next_serial(1);
+
+  template <typename ALLOCATOR>
+  /*static*/ typename DynamicTableFreeList<ALLOCATOR>::LT DynamicTableFreeList<ALLOCATOR>::live_lists_lock;
+
+  template <typename ALLOCATOR>
+  /*static*/ std::map<unsigned, DynamicTableFreeList<ALLOCATOR> *> DynamicTableFreeList<ALLOCATOR>::live_lists;
+
+  template <typename ALLOCATOR>
+  /*static*/ REALM_THREAD_LOCAL typename DynamicTableFreeList<ALLOCATOR>::Magazine DynamicTableFreeList<ALLOCATOR>::thread_magazines[DynamicTableFreeList<ALLOCATOR>::MAGAZINES_PER_THREAD];
+
+  template <typename ALLOCATOR>
+  /*static*/ REALM_THREAD_LOCAL unsigned DynamicTableFreeList<ALLOCATOR>::thread_magazine_clock = 0;
+
+  template <typename ALLOCATOR>
+  /*static*/ REALM_THREAD_LOCAL bool DynamicTableFreeList<ALLOCATOR>::thread_magazines_release_registered = false;
+
+  template <typename ALLOCATOR>
+  DynamicTableFreeList<ALLOCATOR>::DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner,
+							bool _use_magazines /*= true*/)
     : table(_table), owner(_owner), first_free(0), next_alloc(0)
-  {}
+  {
+    if(!_use_magazines) {
+      serial = 0;
+      return;
+    }
+
+    serial = next_serial.fetch_add(1);
+
+    live_lists_lock.lock();
+    live_lists[serial] = this;
+    live_lists_lock.unlock();
+  }
+
+  template <typename ALLOCATOR>
+  DynamicTableFreeList<ALLOCATOR>::~DynamicTableFreeList(void)
+  {
+    if(serial == 0)
+      return;
+
+    // entries still in other threads' magazines are simply forgotten
+    live_lists_lock.lock();
+    live_lists.erase(serial);
+    live_lists_lock.unlock();
+  }
 
   template <typename ALLOCATOR>
   typename DynamicTableFreeList<ALLOCATOR>::ET *DynamicTableFreeList<ALLOCATOR>::alloc_entry(void)
+  {
+    if(serial == 0) {
+      // no magazines - take just one entry from the shared list
+      Magazine single;
+      refill_magazine(&single, 1);
+      return single.head;
+    }
+
+    Magazine *mag = get_magazine();
+    if(mag->count == 0)
+      refill_magazine(mag, MAGAZINE_BATCH);
+    ET *entry = mag->head;
+    mag->head = entry->next_free;
+    mag->count--;
+    entry->next_free = 0;
+    return entry;
+  }
+
+  template <typename ALLOCATOR>
+  void DynamicTableFreeList<ALLOCATOR>::free_entry(ET *entry)
+  {
+#ifdef DEBUG_REALM
+    assert(entry->next_free == 0);
+#endif
+
+    if(serial == 0) {
+      // no magazines - push just this entry onto the shared list
+      Magazine single;
+      single.count = 1;
+      single.head = entry;
+      entry->next_free = 0;
+      spill_magazine(&single, 1);
+      return;
+    }
+
+    Magazine *mag = get_magazine();
+    entry->next_free = mag->head;
+    mag->head = entry;
+    mag->count++;
+    // keep a batch's worth around for the next allocations
+    if(mag->count >= (2 * MAGAZINE_BATCH))
+      spill_magazine(mag, MAGAZINE_BATCH);
+  }
+
+  template <typename ALLOCATOR>
+  typename DynamicTableFreeList<ALLOCATOR>::Magazine *DynamicTableFreeList<ALLOCATOR>::get_magazine(void)
+  {
+    Magazine *unused = 0;
+    Magazine *oldest = 0;
+    for(unsigned i = 0; i < MAGAZINES_PER_THREAD; i++) {
+      Magazine *mag = &thread_magazines[i];
+      if(mag->serial == serial) {
+	mag->last_use = ++thread_magazine_clock;
+	return mag;
+      }
+      if(mag->serial == 0) {
+	if(!unused)
+	  unused = mag;
+      } else {
+	// compare ages so that the clock is allowed to wrap
+	if(!oldest || ((thread_magazine_clock - mag->last_use) >
+		       (thread_magazine_clock - oldest->last_use)))
+	  oldest = mag;
+      }
+    }
+    if(!unused) {
+      // all in use - give the least recently used one back to its list
+      unused = oldest;
+      release_magazine(unused);
+    }
+    if(!thread_magazines_release_registered) {
+      add_thread_exit_callback(release_thread_magazines, 0);
+      thread_magazines_release_registered = true;
+    }
+    unused->serial = serial;
+    unused->count = 0;
+    unused->last_use = ++thread_magazine_clock;
+    unused->head = 0;
+    return unused;
+  }
+
+  template <typename ALLOCATOR>
+  /*static*/ void DynamicTableFreeList<ALLOCATOR>::release_magazine(Magazine *mag)
+  {
+    if(mag->count > 0) {
+      // hold the lock until the entries are back on the list so that the
+      //  list can't be destroyed underneath us
+      live_lists_lock.lock();
+      typename std::map<unsigned, DynamicTableFreeList<ALLOCATOR> *>::const_iterator it = live_lists.find(mag->serial);
+      if(it != live_lists.end())
+	it->second->spill_magazine(mag, mag->count);
+      live_lists_lock.unlock();
+    }
+    mag->serial = 0;
+    mag->count = 0;
+    mag->head = 0;
+  }
+
+  template <typename ALLOCATOR>
+  /*static*/ void DynamicTableFreeList<ALLOCATOR>::release_thread_magazines(void *)
+  {
+    thread_magazines_release_registered = false;
+    for(unsigned i = 0; i < MAGAZINES_PER_THREAD; i++)
+      if(thread_magazines[i].serial != 0)
+	release_magazine(&thread_magazines[i]);
+  }
+
+  // moves up to 'max_count' entries (at least one) from the shared list
+  //  into an empty magazine
+  template <typename ALLOCATOR>
+  void DynamicTableFreeList<ALLOCATOR>::refill_magazine(Magazine *mag,
+							unsigned max_count)
   {
     // take the lock first, since we're messing with the free list
     lock.lock();
@@ -339,15 +493,22 @@ namespace Realm {
       ET *old_first = first_free.load_acquire();
 
       while(old_first) {
-        // look ahead one in the list (we have exclusive access to anything
-        //  already on the list) and try to swap that in place of the old
-        //  head
-        ET *new_first = old_first->next_free;
+        // pushers only ever change the head, so we have exclusive access
+        //  to everything already on the list - walk down to the end of a
+        //  batch and try to swap what follows in place of the old head
+        ET *last = old_first;
+        unsigned count = 1;
+        while((count < max_count) && last->next_free) {
+          last = last->next_free;
+          count++;
+        }
+        ET *new_first = last->next_free;
         if(first_free.compare_exchange(old_first, new_first)) {
-          typename DynamicTable<ALLOCATOR>::ET *entry = old_first;
           lock.unlock();
-          entry->next_free = 0;
-          return entry;
+          last->next_free = 0;
+          mag->head = old_first;
+          mag->count = count;
+          return;
         } else {
           // somebody pushed onto the list while were popping - try again
           //  without releasing the lock
@@ -371,19 +532,28 @@ namespace Realm {
     }
   }
 
+  // returns up to 'max_count' entries (at least one) from a magazine to
+  //  the shared list
   template <typename ALLOCATOR>
-  void DynamicTableFreeList<ALLOCATOR>::free_entry(ET *entry)
+  void DynamicTableFreeList<ALLOCATOR>::spill_magazine(Magazine *mag,
+						       unsigned max_count)
   {
-#ifdef DEBUG_REALM
-    assert(entry->next_free == 0);
-#endif
+    ET *first = mag->head;
+    ET *last = first;
+    unsigned count = 1;
+    while((count < max_count) && last->next_free) {
+      last = last->next_free;
+      count++;
+    }
+    mag->head = last->next_free;
+    mag->count -= count;
 
-    // no need for lock - use compare and swap to push item onto front of
-    //  free list (no ABA problem because the popper is mutex'd)
+    // push the whole chain with a single compare and swap - no lock needed
+    //  (and no ABA problem) because the popper is mutex'd
     ET *old_free = first_free.load();
     while(true) {
-      entry->next_free = old_free;
-      if(first_free.compare_exchange(old_free, entry))
+      last->next_free = old_free;
+      if(first_free.compare_exchange(old_free, first))
         return;
     }
   }
@@ -239,6 +239,10 @@ namespace Realm {
     // early out case too
     if(e->has_triggered(gen, poisoned)) return;
 
+    // spawns held in this thread's open batch may be what we're waiting for
+    if(ThreadLocal::spawn_batch_depth > 0)
+      get_runtime()->spawn_batcher.flush_thread_batches();
+
     // waiting on an event does not count against the low level's time
     DetailedTimer::ScopedPush sp2(TIME_NONE);
 
@@ -262,9 +266,14 @@ namespace Realm {
       if(interval)
         interval->record_wait_start();
     }
+    // another task may run on this thread while we wait, so this task's
+    //  (already flushed) spawn batch nesting is set aside until it resumes
+    int batch_depth = ThreadLocal::spawn_batch_depth;
+    ThreadLocal::spawn_batch_depth = 0;
     // describe the condition we want the thread to wait on
     thread->wait_for_condition(EventTriggeredCondition(e, gen, interval),
                                poisoned);
+    ThreadLocal::spawn_batch_depth = batch_depth;
     if(interval)
       interval->record_wait_end();
     log_event.info() << "thread resumed: thread=" << thread
@@ -302,6 +311,10 @@ namespace Realm {
     // early out case too
     if(e->has_triggered(gen, poisoned)) return;
     
+    // spawns held in this thread's open batch may be what we're waiting for
+    if(ThreadLocal::spawn_batch_depth > 0)
+      get_runtime()->spawn_batcher.flush_thread_batches();
+
     // waiting on an event does not count against the low level's time
     DetailedTimer::ScopedPush sp2(TIME_NONE);
     
@@ -347,6 +360,10 @@ namespace Realm {
     // early out case too
     if(e->has_triggered(gen, poisoned)) return true;
 
+    // spawns held in this thread's open batch may be what we're waiting for
+    if(ThreadLocal::spawn_batch_depth > 0)
+      get_runtime()->spawn_batcher.flush_thread_batches();
+
     // waiting on an event does not count against the low level's time
     DetailedTimer::ScopedPush sp2(TIME_NONE);
 
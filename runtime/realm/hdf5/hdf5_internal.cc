@@ -215,7 +215,6 @@ namespace Realm {
 	: XferDes(_dma_op, _channel, _launch_node, _guid,
 		  inputs_info, outputs_info,
 		  _priority, _fill_data, _fill_size)
-	, req_in_use(false)
       {
 	if((inputs_info.size() >= 1) &&
 	   (input_ports[0].mem->kind == MemoryImpl::MKIND_HDF)) {
@@ -227,30 +226,41 @@ namespace Realm {
 	  assert(0 && "neither source nor dest of HDFXferDes is hdf5!?");
 	}
 
-	hdf5_req.xd = this;
+	for(int i = 0; i < MAX_INFLIGHT_REQUESTS; i++) {
+	  hdf5_reqs[i].xd = this;
+	  free_reqs.push_back(&hdf5_reqs[i]);
+	}
       }
 
       bool HDF5XferDes::request_available()
       {
-	return !req_in_use;
+	AutoLock<> al(req_mutex);
+	return !free_reqs.empty();
       }
 
       Request* HDF5XferDes::dequeue_request()
       {
-	assert(!req_in_use);
-	req_in_use = true;
-	hdf5_req.is_read_done = false;
-	hdf5_req.is_write_done = false;
+	HDF5Request *req;
+	{
+	  AutoLock<> al(req_mutex);
+	  assert(!free_reqs.empty());
+	  req = free_reqs.back();
+	  free_reqs.pop_back();
+	}
+	req->is_read_done = false;
+	req->is_write_done = false;
 	// HDF5Request is handled by another thread, so must hold a reference
 	add_reference();
-        return &hdf5_req;
+        return req;
       }
 
       void HDF5XferDes::enqueue_request(Request* req)
       {
-	assert(req_in_use);
-	assert(req == &hdf5_req);
-	req_in_use = false;
+	{
+	  AutoLock<> al(req_mutex);
+	  assert(free_reqs.size() < size_t(MAX_INFLIGHT_REQUESTS));
+	  free_reqs.push_back(static_cast<HDF5Request *>(req));
+	}
         // update progress counter if iteration isn't completed yet - it might
         //  have been waiting for another request object
         if(!iteration_completed.load())
@@ -369,10 +379,67 @@ namespace Realm {
 	  new_req->src_port_idx = in_port_idx;
 	  new_req->dst_port_idx = out_port_idx;
 	  new_req->dim = Request::DIM_1D;
+	  new_req->ndims = hdf5_info.extent.size();
+	  new_req->num_blocks = 1;
+	  new_req->offsets = hdf5_info.offset;
+	  new_req->extents = hdf5_info.extent;
+
+	  // sparse or strided copies produce many small hyperslabs - keep
+	  //  stepping while the next one is in the same dataset, entirely
+	  //  after everything selected so far in the dataset's row-major
+	  //  order, and right after the previous piece in memory, so that
+	  //  HDF5 can move them all with a single multi-block selection
+	  // (not done with indirection, which tracks input bytes differently)
+	  if(in_port->indirect_port_idx < 0) {
+	    hsize_t max_outer = hdf5_info.offset[0] + hdf5_info.extent[0] - 1;
+	    size_t mem_next = mem_info.base_offset + hdf5_bytes;
+	    while((new_req->num_blocks < MAX_MERGED_BLOCKS) &&
+		  (hdf5_bytes < max_bytes)) {
+	      AddressInfoHDF5 next_info;
+	      size_t next_bytes = hdf5_iter->step_custom(max_bytes - hdf5_bytes,
+							 next_info,
+							 true /*tentative*/);
+	      if(next_bytes == 0)
+		break;
+	      if((next_info.filename != hdf5_info.filename) ||
+		 (next_info.dsetname != hdf5_info.dsetname) ||
+		 (next_info.offset[0] <= max_outer)) {
+		hdf5_iter->cancel_step();
+		break;
+	      }
+	      TransferIterator::AddressInfo next_mem;
+	      size_t next_mem_bytes = mem_iter->step(next_bytes, next_mem, 0,
+						     true /*tentative*/);
+	      if((next_mem_bytes != next_bytes) ||
+		 (next_mem.base_offset != mem_next)) {
+		if(next_mem_bytes > 0)
+		  mem_iter->cancel_step();
+		hdf5_iter->cancel_step();
+		break;
+	      }
+	      hdf5_iter->confirm_step();
+	      mem_iter->confirm_step();
+
+	      new_req->offsets.insert(new_req->offsets.end(),
+				      next_info.offset.begin(),
+				      next_info.offset.end());
+	      new_req->extents.insert(new_req->extents.end(),
+				      next_info.extent.begin(),
+				      next_info.extent.end());
+	      new_req->num_blocks++;
+	      max_outer = next_info.offset[0] + next_info.extent[0] - 1;
+	      mem_next += next_bytes;
+	      hdf5_bytes += next_bytes;
+	    }
+	    if(new_req->num_blocks > 1)
+	      log_request.info() << "hdf5 request merged " << new_req->num_blocks
+				 << " hyperslabs: bytes=" << hdf5_bytes;
+	  }
+
 	  new_req->mem_base = ((kind == XFER_HDF5_READ) ?
 			         out_port->mem :
 			         in_port->mem)->get_direct_ptr(mem_info.base_offset,
-							       mem_info.bytes_per_chunk);
+							       hdf5_bytes);
 	  // we'll open datasets on the first touch in this transfer
 	  // (TODO: pre-open at instance attach time, but in thread-safe way)
 	  HDF5Dataset *dset;
@@ -390,16 +457,7 @@ namespace Realm {
 	      datasets[key] = dset;
 	    }
 	  }
-
-	  new_req->dataset_id = dset->dset_id;
-	  new_req->datatype_id = dset->dtype_id;
-
-	  std::vector<hsize_t> mem_dims = hdf5_info.extent;
-	  CHECK_HDF5( new_req->mem_space_id = H5Screate_simple(mem_dims.size(), mem_dims.data(), NULL) );
-	  //std::vector<hsize_t> mem_start(DIM, 0);
-	  //CHECK_HDF5( H5Sselect_hyperslab(new_req->mem_space_id, H5S_SELECT_SET, ms_start, NULL, count, NULL) );
-          CHECK_HDF5( new_req->file_space_id = H5Scopy(dset->dspace_id) );
-	  CHECK_HDF5( H5Sselect_hyperslab(new_req->file_space_id, H5S_SELECT_SET, hdf5_info.offset.data(), 0, hdf5_info.extent.data(), 0) );
+	  new_req->dset = dset;
 
 	  new_req->nbytes = hdf5_bytes;
 
@@ -413,6 +471,10 @@ namespace Realm {
 	  new_req->write_seq_pos = out_port->local_bytes_total;
 	  new_req->write_seq_count = hdf5_bytes;
 	  out_port->local_bytes_total += hdf5_bytes;
+	  // requests may still be running on an I/O thread when iteration
+	  //  completes - completion detection waits for their writes to be
+	  //  reported for everything consumed here
+	  out_port->local_bytes_cons.fetch_add(hdf5_bytes);
 
 	  requests[idx++] = new_req;
 
@@ -490,6 +552,7 @@ namespace Realm {
               }
             }
 
+            HDF5APILock hdf5_lock;
             std::vector<hsize_t> mem_dims = hdf5_info.extent;
             hid_t mem_space_id, file_space_id;
             CHECK_HDF5( mem_space_id = H5Screate_simple(mem_dims.size(),
@@ -542,12 +605,6 @@ namespace Realm {
 
       void HDF5XferDes::notify_request_write_done(Request* req)
       {
-        HDF5Request* hdf_req = (HDF5Request*) req;
-        //pthread_rwlock_wrlock(&hdf_metadata->hdf_memory->rwlock);
-        CHECK_HDF5( H5Sclose(hdf_req->mem_space_id) );
-        CHECK_HDF5( H5Sclose(hdf_req->file_space_id) );
-        //pthread_rwlock_unlock(&hdf_metadata->hdf_memory->rwlock);
-
 	default_notify_request_write_done(req);
       }
 
@@ -573,6 +630,110 @@ namespace Realm {
       }
 
 
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class HDF5APILock
+
+      /*static*/ Mutex *HDF5APILock::mutex = 0;
+
+      HDF5APILock::HDF5APILock()
+	: held(mutex)
+      {
+	if(held)
+	  held->lock();
+      }
+
+      HDF5APILock::~HDF5APILock()
+      {
+	if(held)
+	  held->unlock();
+      }
+
+      /*static*/ void HDF5APILock::enable(void)
+      {
+	// called during channel creation, before any transfers exist
+	if(!mutex)
+	  mutex = new Mutex;
+      }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class HDF5IOThreadPool
+
+      HDF5IOThreadPool::HDF5IOThreadPool(CoreReservationSet& crs,
+					 int _num_threads)
+	: condvar(mutex)
+	, shutdown_flag(false)
+      {
+	CoreReservationParameters params;
+	params.set_num_cores(1);
+	params.set_alu_usage(params.CORE_USAGE_SHARED);
+	params.set_fpu_usage(params.CORE_USAGE_SHARED);
+	params.set_ldst_usage(params.CORE_USAGE_SHARED);
+	rsrv = new CoreReservation("hdf5 io threads", crs, params);
+
+	ThreadLaunchParameters tlp;
+	for(int i = 0; i < _num_threads; i++)
+	  workers.push_back(Thread::create_kernel_thread<HDF5IOThreadPool,
+			                                 &HDF5IOThreadPool::worker_loop>(this,
+											 tlp,
+											 *rsrv));
+      }
+
+      HDF5IOThreadPool::~HDF5IOThreadPool()
+      {
+	assert(workers.empty());
+	delete rsrv;
+      }
+
+      void HDF5IOThreadPool::enqueue_request(HDF5Request *req)
+      {
+	AutoLock<> al(mutex);
+	bool was_empty = pending.empty();
+	pending.push_back(req);
+	if(was_empty)
+	  condvar.broadcast();
+      }
+
+      void HDF5IOThreadPool::shutdown(void)
+      {
+	{
+	  AutoLock<> al(mutex);
+	  shutdown_flag = true;
+	  condvar.broadcast();
+	}
+	for(std::vector<Thread *>::iterator it = workers.begin();
+	    it != workers.end();
+	    ++it) {
+	  (*it)->join();
+	  delete *it;
+	}
+	workers.clear();
+      }
+
+      void HDF5IOThreadPool::worker_loop(void)
+      {
+	while(true) {
+	  HDF5Request *req;
+	  {
+	    AutoLock<> al(mutex);
+	    while(pending.empty() && !shutdown_flag)
+	      condvar.wait();
+	    if(pending.empty())
+	      break;
+	    req = pending.front();
+	    pending.pop_front();
+	    // let another thread start on the next request
+	    if(!pending.empty())
+	      condvar.signal();
+	  }
+
+	  HDF5Channel::perform_request(req);
+	}
+      }
+
+
     ////////////////////////////////////////////////////////////////////////
     //
     // class HDF5Channel
@@ -583,11 +744,17 @@ namespace Realm {
                                                     Memory::SOCKET_MEM };
       static const size_t num_cpu_mem_kinds = sizeof(cpu_mem_kinds) / sizeof(cpu_mem_kinds[0]);
 
-      HDF5Channel::HDF5Channel(BackgroundWorkManager *bgwork)
+      HDF5Channel::HDF5Channel(BackgroundWorkManager *bgwork,
+			       CoreReservationSet *crs /*= 0*/,
+			       int num_io_threads /*= 0*/)
 	: SingleXDQChannel<HDF5Channel, HDF5XferDes>(bgwork,
 						     XFER_NONE /*FIXME*/,
 						     "hdf5 channel")
+	, io_threads(0)
       {
+	if((num_io_threads > 0) && crs)
+	  io_threads = new HDF5IOThreadPool(*crs, num_io_threads);
+
 	unsigned bw = 0; // TODO
 	unsigned latency = 0;
 	// any combination of SYSTEM/REGDMA/Z_COPY_MEM
@@ -607,7 +774,19 @@ namespace Realm {
                  bw, latency, false, false, XFER_HDF5_WRITE);
       }
 
-      HDF5Channel::~HDF5Channel() {}
+      HDF5Channel::~HDF5Channel()
+      {
+	delete io_threads;
+      }
+
+      void HDF5Channel::shutdown()
+      {
+	// all transfers are done, so the I/O threads just need to exit
+	if(io_threads)
+	  io_threads->shutdown();
+
+	SingleXDQChannel<HDF5Channel, HDF5XferDes>::shutdown();
+      }
 
       XferDes *HDF5Channel::create_xfer_des(uintptr_t dma_op,
 					    NodeID launch_node,
@@ -633,22 +812,49 @@ namespace Realm {
 	  // no serdez support
 	  assert(req->xd->input_ports[req->src_port_idx].serdez_op == 0);
 	  assert(req->xd->output_ports[req->dst_port_idx].serdez_op == 0);
-          //pthread_rwlock_rdlock(req->rwlock);
-          if (req->xd->kind == XFER_HDF5_READ)
-            CHECK_HDF5( H5Dread(req->dataset_id, req->datatype_id,
-				req->mem_space_id, req->file_space_id,
-				H5P_DEFAULT, req->mem_base) );
+	  if(io_threads)
+	    io_threads->enqueue_request(req);
 	  else
-            CHECK_HDF5( H5Dwrite(req->dataset_id, req->datatype_id,
-				 req->mem_space_id, req->file_space_id,
-				 H5P_DEFAULT, req->mem_base) );
-          //pthread_rwlock_unlock(req->rwlock);
-          req->xd->notify_request_read_done(req);
-          req->xd->notify_request_write_done(req);
+	    perform_request(req);
         }
         return nr;
       }
 
+      /*static*/ void HDF5Channel::perform_request(HDF5Request *req)
+      {
+	{
+	  HDF5APILock hdf5_lock;
+
+	  // memory is always one contiguous range of elements
+	  hsize_t mem_elmts = req->nbytes / H5Tget_size(req->dset->dtype_id);
+	  hid_t mem_space_id, file_space_id;
+	  CHECK_HDF5( mem_space_id = H5Screate_simple(1, &mem_elmts, 0) );
+
+	  CHECK_HDF5( file_space_id = H5Scopy(req->dset->dspace_id) );
+	  for(size_t i = 0; i < req->num_blocks; i++)
+	    CHECK_HDF5( H5Sselect_hyperslab(file_space_id,
+					    ((i == 0) ? H5S_SELECT_SET :
+					                H5S_SELECT_OR),
+					    &req->offsets[i * req->ndims], 0,
+					    &req->extents[i * req->ndims], 0) );
+
+	  if(req->xd->kind == XFER_HDF5_READ)
+	    CHECK_HDF5( H5Dread(req->dset->dset_id, req->dset->dtype_id,
+				mem_space_id, file_space_id,
+				H5P_DEFAULT, req->mem_base) );
+	  else
+	    CHECK_HDF5( H5Dwrite(req->dset->dset_id, req->dset->dtype_id,
+				 mem_space_id, file_space_id,
+				 H5P_DEFAULT, req->mem_base) );
+
+	  CHECK_HDF5( H5Sclose(mem_space_id) );
+	  CHECK_HDF5( H5Sclose(file_space_id) );
+	}
+
+	req->xd->notify_request_read_done(req);
+	req->xd->notify_request_write_done(req);
+      }
+
 
     ////////////////////////////////////////////////////////////////////////
     //
@@ -20,6 +20,10 @@
 
 #include "realm/transfer/lowlevel_dma.h"
 #include "realm/transfer/channel.h"
+#include "realm/threads.h"
+#include "realm/mutex.h"
+
+#include <deque>
 
 #include <hdf5.h>
 
@@ -37,6 +41,28 @@ namespace Realm {
 
   namespace HDF5 {
 
+    namespace Config {
+      extern size_t max_open_files;
+      extern bool force_read_write;
+      extern int io_threads;
+      extern size_t chunk_cache_max;
+    };
+
+    // HDF5 calls may be made concurrently by several background workers and
+    //  by dedicated I/O threads, so they must be serialized unless the
+    //  library is thread-safe - this lock is a no-op in that case
+    class HDF5APILock {
+    public:
+      HDF5APILock();
+      ~HDF5APILock();
+
+      static void enable(void);
+
+    protected:
+      static Mutex *mutex;
+      Mutex *held;
+    };
+
     class HDF5Dataset {
     public:
       static HDF5Dataset *open(const char *filename,
@@ -84,8 +110,13 @@ namespace Realm {
     class HDF5Request : public Request {
     public:
       void *mem_base; // could be source or dest
-      hid_t dataset_id, datatype_id;
-      hid_t mem_space_id, file_space_id;
+      HDF5Dataset *dset;
+      // the file-side selection is the union of these hyperslabs (each
+      //  'ndims' entries in 'offsets'/'extents'), which are added in the
+      //  dataset's row-major order so that memory can be one contiguous range
+      int ndims;
+      size_t num_blocks;
+      std::vector<hsize_t> offsets, extents;
     };
     class HDF5Channel;
 
@@ -129,22 +160,57 @@ namespace Realm {
       bool progress_xd(HDF5Channel *channel, TimeLimit work_until);
 
     private:
-      bool req_in_use;
-      HDF5Request hdf5_req;
+      // several requests can be in flight when dedicated I/O threads are used
+      static const int MAX_INFLIGHT_REQUESTS = 4;
+      // cap on the number of hyperslabs merged into a single request
+      static const size_t MAX_MERGED_BLOCKS = 256;
+      Mutex req_mutex;
+      HDF5Request hdf5_reqs[MAX_INFLIGHT_REQUESTS];
+      std::vector<HDF5Request *> free_reqs;
       typedef std::pair<const std::string *, const std::string *> DatasetMapKey;
       typedef std::map<DatasetMapKey, HDF5Dataset *> DatasetMap;
       DatasetMap datasets;
       static const size_t MAX_FILL_SIZE_IN_BYTES = 65536;
     };
 
+    // dedicated threads that perform HDF5 reads and writes so that
+    //  background workers do not block on file I/O
+    class HDF5IOThreadPool {
+    public:
+      HDF5IOThreadPool(CoreReservationSet& crs, int _num_threads);
+      ~HDF5IOThreadPool();
+
+      void enqueue_request(HDF5Request *req);
+
+      void shutdown(void);
+
+    protected:
+      void worker_loop(void);
+
+      Mutex mutex;
+      CondVar condvar;
+      std::deque<HDF5Request *> pending;
+      bool shutdown_flag;
+      CoreReservation *rsrv;
+      std::vector<Thread *> workers;
+    };
+
     // single channel handles both HDF5 reads and writes
     class HDF5Channel : public SingleXDQChannel<HDF5Channel, HDF5XferDes> {
     public:
-      HDF5Channel(BackgroundWorkManager *bgwork);
+      HDF5Channel(BackgroundWorkManager *bgwork,
+                  CoreReservationSet *crs = 0, int num_io_threads = 0);
       ~HDF5Channel();
 
-      // handle HDF5 requests in order - no concurrency
-      static const bool is_ordered = true;
+      virtual void shutdown();
+
+      // builds the selections for a request and performs the read or write
+      static void perform_request(HDF5Request *req);
+
+      // requests may complete out of order (several can be in flight on the
+      //  I/O threads), so the xd queue isn't ordered either - a library that
+      //  isn't thread-safe is protected by HDF5APILock instead
+      static const bool is_ordered = false;
 
       virtual XferDes *create_xfer_des(uintptr_t dma_op,
 				       NodeID launch_node,
@@ -156,6 +222,9 @@ namespace Realm {
 				       const void *fill_data, size_t fill_size);
 
       long submit(Request** requests, long nr);
+
+    protected:
+      HDF5IOThreadPool *io_threads;
     };
 
   }; // namespace HDF5
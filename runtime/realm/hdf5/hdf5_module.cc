@@ -39,6 +39,8 @@ namespace Realm {
     namespace Config {
       size_t max_open_files = 0;
       bool force_read_write = false;
+      int io_threads = 0;
+      size_t chunk_cache_max = 64 << 20;
     };
     
     struct HDF5OpenFile {
@@ -49,6 +51,12 @@ namespace Realm {
     // files are indexed by filename and writeable-ness
     typedef std::map<std::pair<std::string, bool>, HDF5OpenFile> HDF5FileCache;
     HDF5FileCache file_cache;
+    // datasets are opened and closed by whichever background worker or I/O
+    //  thread gets to a transfer first, so the cache needs its own lock even
+    //  when the HDF5 library is thread-safe (and HDF5APILock does nothing) -
+    //  it is held for all of open/close so that a file can't be closed out
+    //  from under a dataset that is being opened in it
+    Mutex file_cache_mutex;
 
     
     ////////////////////////////////////////////////////////////////////////
@@ -65,6 +73,9 @@ namespace Realm {
 					      const char *dsetname,
 					      bool read_only)
     {
+      AutoLock<> al(file_cache_mutex);
+      HDF5APILock hdf5_lock;
+
       // strip off any filename prefix starting with a colon (e.g. rank=nn:)
       {
         const char *pos = strchr(filename, ':');
@@ -116,6 +127,55 @@ namespace Realm {
       hid_t dset_id;
       CHECK_HDF5( dset_id = H5Dopen2(loc_id, curpos, H5P_DEFAULT) );
       log_hdf5.info() << "H5Dopen2(" << it->second.file_id << ", \"" << dsetname << "\") = " << dset_id;
+
+      // the default chunk cache (1MB) thrashes when a transfer walks a
+      //  chunked dataset along its outermost dimension - reopen with a
+      //  cache that holds one slab of chunks spanning the inner dimensions
+      if((dset_id >= 0) && (Config::chunk_cache_max > 0)) {
+        size_t cache_bytes = 0;
+        size_t cache_chunks = 0;
+        hid_t dcpl_id;
+        CHECK_HDF5( dcpl_id = H5Dget_create_plist(dset_id) );
+        if(H5Pget_layout(dcpl_id) == H5D_CHUNKED) {
+          hsize_t chunk_dims[MAX_DIM], cur_dims[MAX_DIM];
+          int chunk_ndims = H5Pget_chunk(dcpl_id, MAX_DIM, chunk_dims);
+          hid_t space_id, type_id;
+          CHECK_HDF5( space_id = H5Dget_space(dset_id) );
+          CHECK_HDF5( type_id = H5Dget_type(dset_id) );
+          if((chunk_ndims > 0) &&
+             (H5Sget_simple_extent_dims(space_id, cur_dims, 0) == chunk_ndims)) {
+            cache_bytes = H5Tget_size(type_id);
+            cache_chunks = 1;
+            for(int i = 0; i < chunk_ndims; i++) {
+              cache_bytes *= chunk_dims[i];
+              if(i > 0)
+                cache_chunks *= ((cur_dims[i] + chunk_dims[i] - 1) / chunk_dims[i]);
+            }
+            cache_bytes *= cache_chunks;
+          }
+          CHECK_HDF5( H5Tclose(type_id) );
+          CHECK_HDF5( H5Sclose(space_id) );
+        }
+        CHECK_HDF5( H5Pclose(dcpl_id) );
+
+        if(cache_bytes > Config::chunk_cache_max) {
+          // round down to the number of whole chunks that fit
+          cache_chunks = (cache_chunks * Config::chunk_cache_max) / cache_bytes;
+          cache_bytes = Config::chunk_cache_max;
+        }
+        if(cache_bytes > (1 << 20)) {
+          hid_t dapl_id;
+          CHECK_HDF5( dapl_id = H5Pcreate(H5P_DATASET_ACCESS) );
+          // HDF5 recommends ~100 hash slots per cached chunk (ideally prime)
+          CHECK_HDF5( H5Pset_chunk_cache(dapl_id, (cache_chunks * 100) | 1,
+                                         cache_bytes, H5D_CHUNK_CACHE_W0_DEFAULT) );
+          CHECK_HDF5( H5Dclose(dset_id) );
+          CHECK_HDF5( dset_id = H5Dopen2(loc_id, curpos, dapl_id) );
+          CHECK_HDF5( H5Pclose(dapl_id) );
+          log_hdf5.info() << "chunk cache: dset=" << dset_id
+                          << " bytes=" << cache_bytes << " chunks=" << cache_chunks;
+        }
+      }
       if(loc_id != it->second.file_id)
 	CHECK_HDF5( H5Gclose(loc_id) );
       if(dset_id < 0)
@@ -160,6 +220,9 @@ namespace Realm {
 
     void HDF5Dataset::close()
     {
+      AutoLock<> al(file_cache_mutex);
+      HDF5APILock hdf5_lock;
+
       // find our file in the cache
       HDF5FileCache::iterator it = file_cache.begin();
       while((it != file_cache.end()) && (it->second.file_id != file_id)) ++it;
@@ -218,7 +281,9 @@ namespace Realm {
 
 	cp.add_option_bool("-hdf5:showerrors", m->cfg_showerrors)
 	  .add_option_int("-hdf5:openfiles", Config::max_open_files)
-	  .add_option_bool("-hdf5:forcerw", Config::force_read_write);
+	  .add_option_bool("-hdf5:forcerw", Config::force_read_write)
+	  .add_option_int("-hdf5:iothreads", Config::io_threads)
+	  .add_option_int_units("-hdf5:chunkcache", Config::chunk_cache_max, 'm');
 	
 	bool ok = cp.parse_command_line(cmdline);
 	if(!ok) {
@@ -293,7 +358,15 @@ namespace Realm {
     {
       Module::create_dma_channels(runtime);
 
-      runtime->add_dma_channel(new HDF5Channel(&runtime->bgwork));
+      // a library that isn't thread-safe needs calls from the I/O threads
+      //  and the channel's background work (which may run on several
+      //  background workers at once) serialized
+      if(!threadsafe)
+        HDF5APILock::enable();
+
+      runtime->add_dma_channel(new HDF5Channel(&runtime->bgwork,
+                                               &runtime->core_reservation_set(),
+                                               Config::io_threads));
     }
 
     // create any code translators provided by the module (default == do nothing)
@@ -309,6 +382,7 @@ namespace Realm {
       Module::cleanup();
 
       // close any files left open in the cache
+      AutoLock<> al(file_cache_mutex);
       for(HDF5FileCache::iterator it = file_cache.begin();
 	  it != file_cache.end();
 	  ++it) {
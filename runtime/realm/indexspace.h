@@ -128,6 +128,13 @@ namespace Realm {
     };
   };
 
+  // space-filling curves that can be used to order the points of an index
+  //  space for create_subspaces_by_sfc
+  enum SpaceFillingCurve {
+    SFC_MORTON,   // Z-order (bit interleaving of the coordinates)
+    SFC_HILBERT,  // Hilbert order (better locality, no long jumps)
+  };
+
   // a FieldDataDescriptor is used to describe field data provided for partitioning
   //  operations - it is templated on the dimensionality (N) and base type (T) of the
   //  index space that defines the domain over which the data is defined, and the
@@ -313,6 +320,27 @@ namespace Realm {
 				    const ProfilingRequestSet &reqs,
 				    Event wait_on = Event::NO_EVENT) const;
 
+    // curve-based: orders the points of the index space along a
+    //  space-filling curve and cuts the curve into 'count' contiguous pieces
+    //  of roughly equal size, or of roughly equal total weight when a weight
+    //  field (int, size_t, float or double, one value per point) is supplied
+    //  - weights are summed in double precision, so fractional weights are
+    //  honored - the curve is walked a cell at a time (2^16 cells total),
+    //  but a cell a cut falls in is split point by point when it holds no
+    //  more than 2^16 points, so each piece is then within one point's
+    //  weight of an even share
+    Event create_subspaces_by_sfc(SpaceFillingCurve curve, size_t count,
+				  std::vector<IndexSpace<N,T> >& subspaces,
+				  const ProfilingRequestSet &reqs,
+				  Event wait_on = Event::NO_EVENT) const;
+
+    template <typename FT>
+    Event create_subspaces_by_sfc(SpaceFillingCurve curve, size_t count,
+				  const std::vector<FieldDataDescriptor<IndexSpace<N,T>,FT> >& weights,
+				  std::vector<IndexSpace<N,T> >& subspaces,
+				  const ProfilingRequestSet &reqs,
+				  Event wait_on = Event::NO_EVENT) const;
+
     // field-based:
 
     template <typename FT>
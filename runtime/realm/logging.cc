@@ -21,6 +21,8 @@
 
 #include "realm/cmdline.h"
 #include "realm/timers.h"
+#include "realm/atomics.h"
+#include "realm/threads.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -31,9 +33,20 @@
 #include <set>
 #include <map>
 
+#include <algorithm>
+
 #ifdef REALM_ON_WINDOWS
 #include <windows.h>
 #include <processthreadsapi.h>
+#include <io.h>
+#else
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+#if defined(REALM_ON_LINUX) || defined(REALM_ON_FREEBSD)
+#include <link.h>
 #endif
 
 namespace Realm {
@@ -118,6 +131,16 @@ namespace Realm {
       fflush(f);
     }
 
+    // used from signal handlers - the interrupted thread may be holding the
+    //  mutex (and would never release it), so give up if it's taken
+    void flush_for_signal(void)
+    {
+      if(mutex.trylock()) {
+        fflush(f);
+        mutex.unlock();
+      }
+    }
+
   protected:
     virtual void write(const char *buffer, size_t len)
     {
@@ -134,6 +157,764 @@ namespace Realm {
     Mutex mutex;
   };
 
+  namespace {
+    // address ranges of the read-only segments of everything loaded when
+    //  the first binary stream was created, sorted by start address
+    std::vector<std::pair<uintptr_t, uintptr_t> > readonly_ranges;
+
+#if defined(REALM_ON_LINUX) || defined(REALM_ON_FREEBSD)
+    int add_readonly_ranges(struct dl_phdr_info *info, size_t size, void *data)
+    {
+      for(int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if((ph.p_type != PT_LOAD) || ((ph.p_flags & PF_W) != 0))
+          continue;
+        uintptr_t start = info->dlpi_addr + ph.p_vaddr;
+        readonly_ranges.push_back(std::make_pair(start, start + ph.p_memsz));
+      }
+      return 0;
+    }
+#endif
+
+    // called before any stream records are handed out - libraries loaded
+    //  after this just have their strings recorded as text
+    void find_readonly_ranges(void)
+    {
+      static bool done = false;
+      if(done) return;
+      done = true;
+#if defined(REALM_ON_LINUX) || defined(REALM_ON_FREEBSD)
+      dl_iterate_phdr(add_readonly_ranges, 0);
+      std::sort(readonly_ranges.begin(), readonly_ranges.end());
+#endif
+    }
+  };
+
+  // writes messages as compact binary records instead of formatted text -
+  //  each thread appends to its own ring buffer without taking any locks
+  //  (there is no text formatting of prefixes/timestamps either), and the
+  //  buffers are drained into the file when they fill up, periodically by
+  //  a background flusher thread, and whenever an error (or a fatal signal)
+  //  is seen
+  //
+  // messages from the printf-style interface are recorded as the id of
+  //  their format string plus the raw arguments, and LoggerMessage streams
+  //  as the ids of the string literals and the raw numbers that were
+  //  inserted, leaving the formatting to the decoder
+  //
+  // file layout (native byte order, decoded by tools/realm_log_decode.py):
+  //   header:   "REALMLOG" u32:version s32:node_id
+  //   category: u8:RECORD_CATEGORY u16:cat_id u16:name_len name
+  //   message:  u8:RECORD_MESSAGE u8:level u16:cat_id u64:thread s64:time_ns
+  //             u32:msg_len msg
+  //   format:   u8:RECORD_FORMAT u32:fmt_id u32:fmt_len fmt
+  //   printf:   u8:RECORD_PRINTF u8:level u16:cat_id u64:thread s64:time_ns
+  //             u32:fmt_id u32:args_len args
+  //   stream:   u8:RECORD_STREAM u8:level u16:cat_id u64:thread s64:time_ns
+  //             u32:items_len items
+  //  where the args of a printf record are, in the order the format consumes
+  //  them: integers (including '*' widths/precisions and pointers) as 8
+  //  bytes, floating point values as doubles, and strings as u32:len bytes,
+  //  and the items of a stream record are those of a LoggerStreamRecord,
+  //  except that literals are given as u32:fmt_id of a format record
+  class LoggerBinaryStream : public LoggerOutputStream {
+  public:
+    static const unsigned VERSION = 3;
+    static const size_t BUFFER_SIZE = 64 << 10;
+    static const size_t MAX_ARGS_SIZE = 4096;
+
+    enum RecordType {
+      RECORD_CATEGORY = 1,
+      RECORD_MESSAGE = 2,
+      RECORD_FORMAT = 3,
+      RECORD_PRINTF = 4,
+      RECORD_STREAM = 5,
+    };
+
+    LoggerBinaryStream(FILE *_f, bool _close_file, long long _flush_interval)
+      : f(_f), close_file(_close_file)
+      , generation(next_generation.fetch_add(1) + 1)
+      , flush_interval(_flush_interval)
+      , writer(0), buffer_list(0)
+      , flusher_shutdown(false), flusher_condvar(flusher_mutex)
+    {
+      // everything goes through the file descriptor (so that the signal
+      //  handler can write too), so push out anything stdio is holding
+      fflush(f);
+#ifdef REALM_ON_WINDOWS
+      fd = _fileno(f);
+#else
+      fd = fileno(f);
+#endif
+
+      char header[16];
+      size_t hdrlen = 0;
+      const char magic[8] = { 'R', 'E', 'A', 'L', 'M', 'L', 'O', 'G' };
+      memcpy(header, magic, sizeof(magic));
+      hdrlen += sizeof(magic);
+      pack<uint32_t>(header, hdrlen, VERSION);
+      pack<int32_t>(header, hdrlen, Network::my_node_id);
+      write_raw(header, hdrlen);
+
+#ifndef REALM_ON_WINDOWS
+      if(flush_interval > 0) {
+        int ret = pthread_create(&flusher_thread, 0, flusher_entry, this);
+        if(ret != 0) {
+          fprintf(stderr, "WARNING: could not start log flusher thread: %s\n",
+                  strerror(ret));
+          flush_interval = 0;
+        }
+      }
+
+      install_signal_handlers(this);
+#endif
+
+      find_readonly_ranges();
+    }
+
+    virtual ~LoggerBinaryStream(void)
+    {
+#ifndef REALM_ON_WINDOWS
+      install_signal_handlers(0);
+
+      if(flush_interval > 0) {
+        {
+          AutoLock<> al(flusher_mutex);
+          flusher_shutdown = true;
+          flusher_condvar.signal();
+        }
+        pthread_join(flusher_thread, 0);
+      }
+#endif
+
+      flush();
+      // threads' pointers to these buffers are tagged with our generation,
+      //  so they'll never be used again
+      ThreadBuffer *tb = buffer_list.load();
+      while(tb) {
+        ThreadBuffer *next = tb->next;
+        delete tb;
+        tb = next;
+      }
+      if(close_file)
+        fclose(f);
+    }
+
+    virtual void log_msg(Logger::LoggingLevel level, const char *name, const char *msgdata, size_t msglen)
+    {
+      ThreadBuffer *tb = get_thread_buffer();
+
+      char header[MAX_HEADER_SIZE];
+      size_t hdrlen = record_header(tb, header, RECORD_MESSAGE, level, name);
+      pack<uint32_t>(header, hdrlen, msglen);
+      add_record(tb, header, hdrlen, msgdata, msglen);
+
+      // errors are often followed closely by the process going away
+      if(level >= Logger::LEVEL_ERROR)
+        flush();
+    }
+
+    virtual void log_printf(Logger::LoggingLevel level, const char *name,
+                            const char *fmt, va_list args)
+    {
+      char argdata[MAX_ARGS_SIZE];
+      size_t arglen = 0;
+      bool ok;
+      {
+        va_list args_copy;
+        va_copy(args_copy, args);
+        ok = encode_printf_args(fmt, args_copy, argdata, arglen);
+        va_end(args_copy);
+      }
+      if(!ok) {
+        // something the decoder can't reproduce - record the text instead
+        LoggerOutputStream::log_printf(level, name, fmt, args);
+        return;
+      }
+
+      ThreadBuffer *tb = get_thread_buffer();
+
+      char header[MAX_HEADER_SIZE];
+      size_t hdrlen = record_header(tb, header, RECORD_PRINTF, level, name);
+      pack<uint32_t>(header, hdrlen, lookup_format(tb, fmt));
+      pack<uint32_t>(header, hdrlen, arglen);
+      add_record(tb, header, hdrlen, argdata, arglen);
+
+      if(level >= Logger::LEVEL_ERROR)
+        flush();
+    }
+
+    virtual bool wants_stream_records(void) const
+    {
+      return true;
+    }
+
+    virtual void log_stream(Logger::LoggingLevel level, const char *name,
+                            const char *msgdata, size_t msglen,
+                            const LoggerStreamRecord& record)
+    {
+      ThreadBuffer *tb = get_thread_buffer();
+
+      // literals shrink from a pointer to a format id, so the items always
+      //  fit in a record-sized buffer
+      char items[LoggerStreamRecord::MAX_SIZE];
+      size_t itemlen = 0;
+      size_t pos = 0;
+      while(pos < record.used) {
+        uint8_t type = record.data[pos];
+        items[itemlen++] = type;
+        pos++;
+        switch(type) {
+        case LoggerStreamRecord::ITEM_LITERAL:
+          {
+            const char *literal;
+            memcpy(&literal, record.data + pos, sizeof(literal));
+            pos += sizeof(literal);
+            pack<uint32_t>(items, itemlen, lookup_format(tb, literal));
+            break;
+          }
+        case LoggerStreamRecord::ITEM_TEXT:
+          {
+            uint32_t len;
+            memcpy(&len, record.data + pos, sizeof(len));
+            memcpy(items + itemlen, record.data + pos, sizeof(len) + len);
+            pos += sizeof(len) + len;
+            itemlen += sizeof(len) + len;
+            break;
+          }
+        default:
+          {
+            // numbers are all 8 bytes
+            memcpy(items + itemlen, record.data + pos, 8);
+            pos += 8;
+            itemlen += 8;
+          }
+        }
+      }
+
+      char header[MAX_HEADER_SIZE];
+      size_t hdrlen = record_header(tb, header, RECORD_STREAM, level, name);
+      pack<uint32_t>(header, hdrlen, itemlen);
+      add_record(tb, header, hdrlen, items, itemlen);
+
+      if(level >= Logger::LEVEL_ERROR)
+        flush();
+    }
+
+    virtual void flush()
+    {
+      lock_writer();
+      for(ThreadBuffer *tb = buffer_list.load_acquire(); tb; tb = tb->next)
+        drain(tb);
+      unlock_writer();
+    }
+
+    // best-effort write of whatever is buffered when the process is about
+    //  to die - this never waits on the interrupted thread: if it holds the
+    //  writer lock, we give up, and another thread holding it is only
+    //  waited on for a little while (records an interrupted thread was in
+    //  the middle of adding aren't committed, so they're just lost)
+    void flush_for_signal(void)
+    {
+      static const int MAX_TRIES = 10000;
+      uint64_t me = current_thread();
+      uint64_t expected = 0;
+      int tries = 0;
+      while(!writer.compare_exchange(expected, me)) {
+        if((expected == me) || (++tries > MAX_TRIES))
+          return;
+        expected = 0;
+        sched_yield();
+      }
+      for(ThreadBuffer *tb = buffer_list.load_acquire(); tb; tb = tb->next)
+        drain(tb);
+      unlock_writer();
+    }
+
+  protected:
+    // each thread's buffer is a single-producer ring - the owning thread
+    //  copies in complete records and then advances 'committed', while
+    //  whoever holds the writer lock copies out [drained, committed) and
+    //  then advances 'drained' (positions are running totals, taken modulo
+    //  BUFFER_SIZE to index 'data')
+    struct ThreadBuffer {
+      ThreadBuffer(void) : next(0), committed(0), drained(0) {}
+
+      struct FormatEntry {
+        uint32_t fmt_id;
+        std::string fmt;
+      };
+
+      ThreadBuffer *next;
+      atomic<size_t> committed;
+      atomic<size_t> drained;
+      // only used by the owning thread
+      std::map<const char *, uint16_t> category_ids;
+      std::map<const char *, FormatEntry> format_ids;
+      char data[BUFFER_SIZE];
+    };
+
+    // u8:type u8:level u16:cat_id u64:thread s64:time_ns plus two u32s
+    static const size_t MAX_HEADER_SIZE = 32;
+
+    template <typename T>
+    static void pack(char *buffer, size_t& len, T val)
+    {
+      memcpy(buffer + len, &val, sizeof(T));
+      len += sizeof(T);
+    }
+
+    size_t record_header(ThreadBuffer *tb, char *header, uint8_t rectype,
+                         Logger::LoggingLevel level, const char *name)
+    {
+      size_t hdrlen = 0;
+      pack<uint8_t>(header, hdrlen, rectype);
+      pack<uint8_t>(header, hdrlen, level);
+      pack<uint16_t>(header, hdrlen, lookup_category(tb, name));
+      pack<uint64_t>(header, hdrlen, current_thread());
+      pack<int64_t>(header, hdrlen, current_time());
+      return hdrlen;
+    }
+
+    // appends a record to the calling thread's buffer - the record only
+    //  becomes visible to flushes once it is complete
+    void add_record(ThreadBuffer *tb, const char *header, size_t hdrlen,
+                    const char *payload, size_t paylen)
+    {
+      size_t needed = hdrlen + paylen;
+      size_t head = tb->committed.load();  // we're the only writer
+      if(needed > BUFFER_SIZE) {
+        // too big to buffer - everything already buffered goes first, and
+        //  the record is written in pieces under the writer lock
+        lock_writer();
+        drain(tb);
+        write_raw(header, hdrlen);
+        write_raw(payload, paylen);
+        unlock_writer();
+        return;
+      }
+      if((head + needed - tb->drained.load_acquire()) > BUFFER_SIZE) {
+        lock_writer();
+        drain(tb);
+        unlock_writer();
+      }
+      copy_in(tb, head, header, hdrlen);
+      copy_in(tb, head + hdrlen, payload, paylen);
+      tb->committed.store_release(head + needed);
+    }
+
+    static void copy_in(ThreadBuffer *tb, size_t pos,
+                        const char *src, size_t len)
+    {
+      size_t ofs = pos % BUFFER_SIZE;
+      size_t first = std::min(len, BUFFER_SIZE - ofs);
+      memcpy(tb->data + ofs, src, first);
+      if(first < len)
+        memcpy(tb->data, src + first, len - first);
+    }
+
+    // writes out everything committed to a buffer - caller holds the writer
+    //  lock
+    void drain(ThreadBuffer *tb)
+    {
+      size_t start = tb->drained.load();
+      size_t end = tb->committed.load_acquire();
+      if(start == end)
+        return;
+      size_t ofs = start % BUFFER_SIZE;
+      size_t len = end - start;
+      size_t first = std::min(len, BUFFER_SIZE - ofs);
+      write_raw(tb->data + ofs, first);
+      if(first < len)
+        write_raw(tb->data, len - first);
+      tb->drained.store_release(end);
+    }
+
+    ThreadBuffer *get_thread_buffer(void)
+    {
+      // there is only one binary stream at a time, but a thread's buffer may
+      //  belong to a previous one (e.g. across a runtime re-init) that has
+      //  since been destroyed, so it is tagged with the owner's generation
+      static REALM_THREAD_LOCAL ThreadBuffer *my_buffer = 0;
+      static REALM_THREAD_LOCAL unsigned my_generation = 0;
+      if(REALM_UNLIKELY(my_generation != generation)) {
+        my_buffer = new ThreadBuffer;
+        my_generation = generation;
+        // buffers are never removed, so a push is all the list needs
+        ThreadBuffer *head = buffer_list.load();
+        do {
+          my_buffer->next = head;
+        } while(!buffer_list.compare_exchange(head, my_buffer));
+      }
+      return my_buffer;
+    }
+
+    // assigns an id to a category the first time any thread uses it and
+    //  writes the name record straight to the file
+    uint16_t lookup_category(ThreadBuffer *tb, const char *name)
+    {
+      std::map<const char *, uint16_t>::const_iterator it = tb->category_ids.find(name);
+      if(it != tb->category_ids.end())
+        return it->second;
+
+      AutoLock<> al(registry_mutex);
+      uint16_t cat_id;
+      std::map<std::string, uint16_t>::const_iterator it2 = categories.find(name);
+      if(it2 != categories.end()) {
+        cat_id = it2->second;
+      } else {
+        cat_id = categories.size();
+        categories[name] = cat_id;
+        char header[MAX_HEADER_SIZE];
+        size_t hdrlen = 0;
+        uint16_t name_len = strlen(name);
+        pack<uint8_t>(header, hdrlen, RECORD_CATEGORY);
+        pack<uint16_t>(header, hdrlen, cat_id);
+        pack<uint16_t>(header, hdrlen, name_len);
+        lock_writer();
+        write_raw(header, hdrlen);
+        write_raw(name, name_len);
+        unlock_writer();
+      }
+      tb->category_ids[name] = cat_id;
+      return cat_id;
+    }
+
+    // same for format strings (and stream literals) - these are usually
+    //  literals, but the per-thread cache is keyed by address, so check the
+    //  contents too
+    uint32_t lookup_format(ThreadBuffer *tb, const char *fmt)
+    {
+      std::map<const char *, ThreadBuffer::FormatEntry>::const_iterator it = tb->format_ids.find(fmt);
+      if((it != tb->format_ids.end()) && (it->second.fmt == fmt))
+        return it->second.fmt_id;
+
+      AutoLock<> al(registry_mutex);
+      uint32_t fmt_id;
+      std::map<std::string, uint32_t>::const_iterator it2 = formats.find(fmt);
+      if(it2 != formats.end()) {
+        fmt_id = it2->second;
+      } else {
+        fmt_id = formats.size();
+        formats[fmt] = fmt_id;
+        char header[MAX_HEADER_SIZE];
+        size_t hdrlen = 0;
+        uint32_t fmt_len = strlen(fmt);
+        pack<uint8_t>(header, hdrlen, RECORD_FORMAT);
+        pack<uint32_t>(header, hdrlen, fmt_id);
+        pack<uint32_t>(header, hdrlen, fmt_len);
+        lock_writer();
+        write_raw(header, hdrlen);
+        write_raw(fmt, fmt_len);
+        unlock_writer();
+      }
+      ThreadBuffer::FormatEntry& e = tb->format_ids[fmt];
+      e.fmt_id = fmt_id;
+      e.fmt = fmt;
+      return fmt_id;
+    }
+
+    template <typename T>
+    static bool encode_value(char *argdata, size_t& arglen, const T& val)
+    {
+      if((arglen + sizeof(T)) > MAX_ARGS_SIZE)
+        return false;
+      memcpy(argdata + arglen, &val, sizeof(T));
+      arglen += sizeof(T);
+      return true;
+    }
+
+    // walks the conversions in 'fmt' and copies out the arguments they
+    //  consume - returns false for anything the decoder won't reproduce
+    //  faithfully (e.g. %n, wide characters) or for too much argument data
+    static bool encode_printf_args(const char *fmt, va_list args,
+                                   char *argdata, size_t& arglen)
+    {
+      enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_LD };
+
+      const char *p = fmt;
+      while(*p) {
+        if(*p++ != '%')
+          continue;
+        if(*p == '%') {
+          p++;
+          continue;
+        }
+        // flags
+        while(*p && strchr("-+ #0", *p))
+          p++;
+        // width
+        if(*p == '*') {
+          if(!encode_value<int64_t>(argdata, arglen, va_arg(args, int)))
+            return false;
+          p++;
+        } else
+          while((*p >= '0') && (*p <= '9')) p++;
+        // precision
+        if(*p == '.') {
+          p++;
+          if(*p == '*') {
+            if(!encode_value<int64_t>(argdata, arglen, va_arg(args, int)))
+              return false;
+            p++;
+          } else
+            while((*p >= '0') && (*p <= '9')) p++;
+        }
+        // length modifier
+        int len = LEN_NONE;
+        switch(*p) {
+        case 'h': len = ((p[1] == 'h') ? LEN_HH : LEN_H); break;
+        case 'l': len = ((p[1] == 'l') ? LEN_LL : LEN_L); break;
+        case 'j': len = LEN_J; break;
+        case 'z': len = LEN_Z; break;
+        case 't': len = LEN_T; break;
+        case 'L': len = LEN_LD; break;
+        }
+        if(len != LEN_NONE)
+          p += (((len == LEN_HH) || (len == LEN_LL)) ? 2 : 1);
+
+        bool ok;
+        switch(*p++) {
+        case 'd': case 'i':
+          {
+            int64_t v;
+            switch(len) {
+            case LEN_HH: v = (signed char)va_arg(args, int); break;
+            case LEN_H: v = (short)va_arg(args, int); break;
+            case LEN_L: v = va_arg(args, long); break;
+            case LEN_LL: v = va_arg(args, long long); break;
+            case LEN_J: v = va_arg(args, intmax_t); break;
+            case LEN_Z: v = va_arg(args, ptrdiff_t); break;
+            case LEN_T: v = va_arg(args, ptrdiff_t); break;
+            default: v = va_arg(args, int); break;
+            }
+            ok = encode_value(argdata, arglen, v);
+            break;
+          }
+        case 'u': case 'o': case 'x': case 'X':
+          {
+            uint64_t v;
+            switch(len) {
+            case LEN_HH: v = (unsigned char)va_arg(args, unsigned); break;
+            case LEN_H: v = (unsigned short)va_arg(args, unsigned); break;
+            case LEN_L: v = va_arg(args, unsigned long); break;
+            case LEN_LL: v = va_arg(args, unsigned long long); break;
+            case LEN_J: v = va_arg(args, uintmax_t); break;
+            case LEN_Z: v = va_arg(args, size_t); break;
+            case LEN_T: v = va_arg(args, ptrdiff_t); break;
+            default: v = va_arg(args, unsigned); break;
+            }
+            ok = encode_value(argdata, arglen, v);
+            break;
+          }
+        case 'c':
+          {
+            if(len != LEN_NONE) return false;
+            ok = encode_value<int64_t>(argdata, arglen, va_arg(args, int));
+            break;
+          }
+        case 'p':
+          {
+            ok = encode_value<uint64_t>(argdata, arglen,
+                                        (uintptr_t)va_arg(args, void *));
+            break;
+          }
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+          {
+            double v;
+            if(len == LEN_LD)
+              v = va_arg(args, long double);
+            else
+              v = va_arg(args, double);
+            ok = encode_value(argdata, arglen, v);
+            break;
+          }
+        case 's':
+          {
+            if(len != LEN_NONE) return false;
+            const char *str = va_arg(args, const char *);
+            if(!str) str = "(null)";
+            uint32_t slen = strlen(str);
+            ok = (encode_value(argdata, arglen, slen) &&
+                  ((arglen + slen) <= MAX_ARGS_SIZE));
+            if(ok) {
+              memcpy(argdata + arglen, str, slen);
+              arglen += slen;
+            }
+            break;
+          }
+        default:
+          // %n, %C, %S, %m, or a malformed conversion
+          return false;
+        }
+        if(!ok)
+          return false;
+      }
+      return true;
+    }
+
+    static uint64_t current_thread(void)
+    {
+#ifdef REALM_ON_WINDOWS
+      return GetCurrentThreadId();
+#else
+      return (uint64_t)pthread_self();
+#endif
+    }
+
+    static int64_t current_time(void)
+    {
+      // same "0.0 until we have a common time base" rule as the text stream
+      return ((Clock::get_zero_time() != 0) ?
+                Clock::current_time_in_nanoseconds() :
+                0);
+    }
+
+    // the writer lock serializes writes to the file - it's a spin lock
+    //  that records its holder (it's only held for the length of a write),
+    //  so that the signal handler can tell if the interrupted thread has it
+    void lock_writer(void)
+    {
+      uint64_t me = current_thread();
+      uint64_t expected = 0;
+      while(!writer.compare_exchange(expected, me)) {
+        expected = 0;
+#ifdef REALM_ON_WINDOWS
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+      }
+    }
+
+    void unlock_writer(void)
+    {
+      writer.store_release(0);
+    }
+
+    // writes straight to the file descriptor - stdio isn't safe to use from
+    //  a signal handler
+    void write_raw(const char *buffer, size_t len)
+    {
+      while(len > 0) {
+#ifdef REALM_ON_WINDOWS
+        int amt = _write(fd, buffer, unsigned(len));
+#else
+        ssize_t amt = ::write(fd, buffer, len);
+#endif
+        if(amt < 0) {
+          if(errno == EINTR)
+            continue;
+          // nothing useful to be done about a failed log write
+          return;
+        }
+        buffer += amt;
+        len -= amt;
+      }
+    }
+
+#ifndef REALM_ON_WINDOWS
+    static void *flusher_entry(void *arg)
+    {
+      static_cast<LoggerBinaryStream *>(arg)->flusher_loop();
+      return 0;
+    }
+
+    void flusher_loop(void)
+    {
+      AutoLock<> al(flusher_mutex);
+      while(!flusher_shutdown) {
+        flusher_condvar.timedwait(flush_interval * 1000000LL);
+        if(flusher_shutdown)
+          break;
+        al.release();
+        flush();
+        al.reacquire();
+      }
+    }
+
+    static const int NUM_FATAL_SIGNALS = 5;
+
+    static const int *fatal_signals(void)
+    {
+      static const int sigs[NUM_FATAL_SIGNALS] = { SIGABRT, SIGSEGV, SIGBUS,
+                                                   SIGFPE, SIGILL };
+      return sigs;
+    }
+
+    static void signal_handler(int sig)
+    {
+      int saved_errno = errno;
+      LoggerBinaryStream *s = signal_stream;
+      if(s)
+        s->flush_for_signal();
+      errno = saved_errno;
+
+      // put back whatever was there before and let it handle the signal
+      const int *sigs = fatal_signals();
+      for(int i = 0; i < NUM_FATAL_SIGNALS; i++)
+        if(sigs[i] == sig)
+          sigaction(sig, &prev_actions[i], 0);
+      raise(sig);
+    }
+
+    // flushes buffered records on the way out from an abort() or crash (the
+    //  Realm runtime's own error handlers flush explicitly, since they
+    //  replace these if enabled) - pass 0 to restore the previous handlers
+    static void install_signal_handlers(LoggerBinaryStream *s)
+    {
+      const int *sigs = fatal_signals();
+      if(s) {
+        signal_stream = s;
+        struct sigaction action;
+        action.sa_handler = signal_handler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_ONSTACK;
+        for(int i = 0; i < NUM_FATAL_SIGNALS; i++)
+          sigaction(sigs[i], &action, &prev_actions[i]);
+      } else {
+        for(int i = 0; i < NUM_FATAL_SIGNALS; i++) {
+          // only restore handlers that are still ours
+          struct sigaction cur;
+          if((sigaction(sigs[i], 0, &cur) == 0) &&
+             (cur.sa_handler == signal_handler))
+            sigaction(sigs[i], &prev_actions[i], 0);
+        }
+        signal_stream = 0;
+      }
+    }
+
+    static LoggerBinaryStream *volatile signal_stream;
+    static struct sigaction prev_actions[NUM_FATAL_SIGNALS];
+#endif
+
+    static atomic<unsigned> next_generation;
+
+    FILE *f;
+    int fd;
+    bool close_file;
+    unsigned generation;
+    long long flush_interval;  // msec, 0 = no background flushing
+    atomic<uint64_t> writer;  // thread holding the writer lock, or 0
+    atomic<ThreadBuffer *> buffer_list;
+    Mutex registry_mutex;  // protects categories and formats
+    std::map<std::string, uint16_t> categories;
+    std::map<std::string, uint32_t> formats;
+    Mutex flusher_mutex;
+    bool flusher_shutdown;
+    CondVar flusher_condvar;
+#ifndef REALM_ON_WINDOWS
+    pthread_t flusher_thread;
+#endif
+  };
+
+  /*static*/ atomic<unsigned> LoggerBinaryStream::next_generation(0);
+#ifndef REALM_ON_WINDOWS
+  /*static*/ LoggerBinaryStream *volatile LoggerBinaryStream::signal_stream = 0;
+  /*static*/ struct sigaction LoggerBinaryStream::prev_actions[LoggerBinaryStream::NUM_FATAL_SIGNALS];
+#endif
+
   class LoggerConfig {
   protected:
     LoggerConfig(void);
@@ -143,6 +924,7 @@ namespace Realm {
     static LoggerConfig *get_config(void);
 
     static void flush_all_streams(void);
+    static void flush_all_streams_for_signal(void);
 
     void read_command_line(std::vector<std::string>& cmdline);
     void set_default_output(LoggerOutputStream *s);
@@ -160,6 +942,8 @@ namespace Realm {
     bool cmdline_read;
     Logger::LoggingLevel default_level, stderr_level;
     bool include_timestamp;
+    bool binary_output;
+    long long binary_flush_interval;
     std::map<std::string, Logger::LoggingLevel> category_levels;
     std::string cats_enabled;
     std::set<Logger *> pending_configs;
@@ -172,6 +956,8 @@ namespace Realm {
     , default_level(Logger::LEVEL_PRINT)
     , stderr_level(Logger::LEVEL_ERROR)
     , include_timestamp(true)
+    , binary_output(false)
+    , binary_flush_interval(100)
     , stream(0)
     , stderr_stream(0)
     , default_output(0)
@@ -195,6 +981,21 @@ namespace Realm {
       cfg->stream->flush();
   }
 
+  /*static*/ void LoggerConfig::flush_all_streams_for_signal(void)
+  {
+    LoggerConfig *cfg = get_config();
+    if(!cfg->stream)
+      return;
+    // we created this stream, so we know which kind it is
+#ifndef REALM_ON_WINDOWS
+    if(cfg->binary_output) {
+      static_cast<LoggerBinaryStream *>(cfg->stream)->flush_for_signal();
+      return;
+    }
+#endif
+    static_cast<LoggerFileStream *>(cfg->stream)->flush_for_signal();
+  }
+
   template <>
   bool convert_integer_cmdline_argument<Logger::LoggingLevel>(const std::string& s, Logger::LoggingLevel& target)
   {
@@ -308,6 +1109,8 @@ namespace Realm {
       .add_option_method("-level", this, &LoggerConfig::parse_level_argument)
       .add_option_int("-errlevel", stderr_level)
       .add_option_int("-logtime", include_timestamp)
+      .add_option_int("-logbinary", binary_output)
+      .add_option_int("-logflush", binary_flush_interval)
       .parse_command_line(cmdline);
 
     if(!ok) {
@@ -319,6 +1122,13 @@ namespace Realm {
     if(stream)
       return;
 
+    // binary records are useless on a terminal
+    if(binary_output && (logname.empty() ||
+                         (logname == "stdout") || (logname == "stderr"))) {
+      fprintf(stderr, "WARNING: -logbinary requires a -logfile - using text output\n");
+      binary_output = false;
+    }
+
     // lots of choices for log output
     if(logname.empty()) {
       // the gasnet UDP job spawner (amudprun) seems to buffer stdout, so make stderr the default
@@ -371,9 +1181,14 @@ namespace Realm {
           exit(1);
         }
       }
-      // TODO: consider buffering in some cases?
-      setbuf(f, 0); // disable output buffering
-      stream = new LoggerFileStream(f, true, include_timestamp);
+      if(binary_output) {
+        // the binary stream does its own buffering
+        stream = new LoggerBinaryStream(f, true, binary_flush_interval);
+      } else {
+        // TODO: consider buffering in some cases?
+        setbuf(f, 0); // disable output buffering
+        stream = new LoggerFileStream(f, true, include_timestamp);
+      }
 
       // when logging to a file, also sent critical-enough messages to stderr
       if(stderr_level < Logger::LEVEL_NONE)
@@ -510,6 +1325,7 @@ namespace Realm {
   Logger::Logger(const std::string& _name)
     : name(_name), log_level(LEVEL_SPEW)
     , configured(false)
+    , stream_records(false)
     , delayed_message_head(0)
     , delayed_message_tail(&delayed_message_head)
   {
@@ -543,6 +1359,16 @@ namespace Realm {
     LoggerConfig::get_config()->read_command_line(cmdline);
   }
 
+  /*static*/ void Logger::flush_all_streams(void)
+  {
+    LoggerConfig::flush_all_streams();
+  }
+
+  /*static*/ void Logger::flush_all_streams_for_signal(void)
+  {
+    LoggerConfig::flush_all_streams_for_signal();
+  }
+
   /*static*/ void Logger::set_default_output(LoggerOutputStream *s)
   {
     LoggerConfig::get_config()->set_default_output(s);
@@ -553,7 +1379,8 @@ namespace Realm {
     LoggerConfig::get_config()->set_logger_output(name, s);
   }
 
-  void Logger::log_msg(LoggingLevel level, const char *msgdata, size_t msglen)
+  void Logger::log_msg(LoggingLevel level, const char *msgdata, size_t msglen,
+                       const LoggerStreamRecord *record)
   {
     // if we're not configured yet, delay the message
     if(!configured) {
@@ -570,10 +1397,13 @@ namespace Realm {
       return;
     }
 
-    // no logging of empty messages
-    if(msglen == 0)
+    // no logging of empty messages (a record may hold values whose text
+    //  was never formatted though)
+    if((msglen == 0) && !(record && (record->used > 0)))
       return;
 
+    std::string rendered;
+
     // go through all the streams
     for(std::vector<LogStream>::iterator it = streams.begin();
               it != streams.end();
@@ -581,7 +1411,42 @@ namespace Realm {
       if(level < it->min_level)
               continue;
 
-      it->s->log_msg(level, name.c_str(), msgdata, msglen);
+      if(record && record->valid && it->s->wants_stream_records())
+        it->s->log_stream(level, name.c_str(), msgdata, msglen, *record);
+      else if(record && record->text_skipped) {
+        // the stream's text was only partly formatted, so put it together
+        //  from the record once for every stream that needs it
+        if(rendered.empty())
+          record->render(rendered, msgdata, msglen);
+        it->s->log_msg(level, name.c_str(), rendered.data(), rendered.size());
+      } else
+        it->s->log_msg(level, name.c_str(), msgdata, msglen);
+
+      if(it->flush_each_write)
+        it->s->flush();
+    }
+  }
+
+  void Logger::log_printf(LoggingLevel level, const char *fmt, va_list args)
+  {
+    // if we're not configured yet, format the message now and delay it
+    //  like any other
+    if(!configured) {
+      LoggerMessage msg(this, true, level);
+      msg.vprintf(fmt, args);
+      return;
+    }
+
+    for(std::vector<LogStream>::iterator it = streams.begin();
+              it != streams.end();
+              it++) {
+      if(level < it->min_level)
+              continue;
+
+      va_list args_copy;
+      va_copy(args_copy, args);
+      it->s->log_printf(level, name.c_str(), fmt, args_copy);
+      va_end(args_copy);
 
       if(it->flush_each_write)
         it->s->flush();
@@ -607,9 +1472,12 @@ namespace Realm {
     log_level = LEVEL_NONE;
     for(std::vector<LogStream>::iterator it = streams.begin();
 	it != streams.end();
-	it++)
+	it++) {
       if(it->min_level < log_level)
 	log_level = it->min_level;
+      if(it->s->wants_stream_records())
+        stream_records = true;
+    }
 
     // and now handle any delayed messages
     while(delayed_message_head != 0) {
@@ -625,6 +1493,184 @@ namespace Realm {
     }
   }
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class LoggerOutputStream
+
+  /*virtual*/ void LoggerOutputStream::log_printf(Logger::LoggingLevel level,
+                                                  const char *name,
+                                                  const char *fmt,
+                                                  va_list args)
+  {
+    // same rules as LoggerMessage::vprintf - truncate long messages unless
+    //  they're warnings or worse
+    static const int MAXLEN = 4096;
+    char msg[MAXLEN];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int full = vsnprintf(msg, MAXLEN, fmt, args_copy);
+    va_end(args_copy);
+    if(full <= 0)
+      return;
+    if((full < MAXLEN) || (level < Logger::LEVEL_WARNING)) {
+      log_msg(level, name, msg, ((full < MAXLEN) ? full : (MAXLEN - 1)));
+      return;
+    }
+    char *full_msg = (char *)malloc(full + 1);
+    vsnprintf(full_msg, full + 1, fmt, args);
+    log_msg(level, name, full_msg, full);
+    free(full_msg);
+  }
+
+  /*virtual*/ bool LoggerOutputStream::wants_stream_records(void) const
+  {
+    return false;
+  }
+
+  /*virtual*/ void LoggerOutputStream::log_stream(Logger::LoggingLevel level,
+                                                  const char *name,
+                                                  const char *msgdata,
+                                                  size_t msglen,
+                                                  const LoggerStreamRecord& record)
+  {
+    if(record.text_skipped) {
+      std::string text;
+      record.render(text, msgdata, msglen);
+      log_msg(level, name, text.data(), text.size());
+    } else
+      log_msg(level, name, msgdata, msglen);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class LoggerStreamRecord
+
+  namespace {
+    REALM_THREAD_LOCAL LoggerStreamRecord *cached_stream_record = 0;
+    REALM_THREAD_LOCAL bool cached_stream_record_registered = false;
+
+    void delete_cached_stream_record(void *)
+    {
+      delete cached_stream_record;
+      cached_stream_record = 0;
+    }
+  };
+
+  /*static*/ const int LoggerStreamRecord::stream_index = std::ios_base::xalloc();
+
+  /*static*/ LoggerStreamRecord *LoggerStreamRecord::acquire(const Logger *logger,
+                                                             Logger::LoggingLevel level)
+  {
+    LoggerStreamRecord *record = cached_stream_record;
+    if(record) {
+      cached_stream_record = 0;
+      record->valid = true;
+      record->covered = 0;
+      record->used = 0;
+      record->text_skipped = false;
+    } else
+      record = new LoggerStreamRecord;
+
+    // values only need to be formatted if some stream takes text
+    record->text_needed = false;
+    for(std::vector<Logger::LogStream>::const_iterator it = logger->streams.begin();
+        it != logger->streams.end();
+        ++it)
+      if((level >= it->min_level) && !it->s->wants_stream_records()) {
+        record->text_needed = true;
+        break;
+      }
+    return record;
+  }
+
+  /*static*/ void LoggerStreamRecord::release(LoggerStreamRecord *record)
+  {
+    // a thread only has more than one record when messages are nested
+    if(cached_stream_record) {
+      delete record;
+      return;
+    }
+    if(!cached_stream_record_registered) {
+      add_thread_exit_callback(delete_cached_stream_record, 0);
+      cached_stream_record_registered = true;
+    }
+    cached_stream_record = record;
+  }
+
+  void LoggerStreamRecord::render(std::string& text,
+                                  const char *msgdata, size_t msglen) const
+  {
+    // the values were only recorded if the stream's formatting was the
+    //  default, which a fresh stream's is too
+    std::ostringstream oss;
+    size_t pos = 0;
+    while(pos < used) {
+      uint8_t type = data[pos++];
+      switch(type) {
+      case ITEM_LITERAL:
+        {
+          const char *literal;
+          memcpy(&literal, data + pos, sizeof(literal));
+          pos += sizeof(literal);
+          oss << literal;
+          break;
+        }
+      case ITEM_SIGNED:
+        {
+          int64_t val;
+          memcpy(&val, data + pos, sizeof(val));
+          pos += sizeof(val);
+          oss << val;
+          break;
+        }
+      case ITEM_UNSIGNED:
+        {
+          uint64_t val;
+          memcpy(&val, data + pos, sizeof(val));
+          pos += sizeof(val);
+          oss << val;
+          break;
+        }
+      case ITEM_DOUBLE:
+        {
+          double val;
+          memcpy(&val, data + pos, sizeof(val));
+          pos += sizeof(val);
+          oss << val;
+          break;
+        }
+      case ITEM_TEXT:
+        {
+          uint32_t len;
+          memcpy(&len, data + pos, sizeof(len));
+          oss.write(data + pos + sizeof(len), len);
+          pos += sizeof(len) + len;
+          break;
+        }
+      default:
+        assert(0);
+      }
+    }
+    // anything after the items was never recorded
+    oss.write(msgdata + covered, msglen - covered);
+    text = oss.str();
+  }
+
+  /*static*/ bool LoggerStreamRecord::is_literal(const char *s)
+  {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(s);
+    // find the last range starting at or before 'addr'
+    std::vector<std::pair<uintptr_t, uintptr_t> >::const_iterator it =
+      std::upper_bound(readonly_ranges.begin(), readonly_ranges.end(),
+                       std::make_pair(addr, ~uintptr_t(0)));
+    if(it == readonly_ranges.begin())
+      return false;
+    --it;
+    return (addr < it->second);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class LoggerMessage
@@ -39,6 +39,7 @@ namespace Realm {
 #endif
   
   class LoggerMessage;
+  class LoggerStreamRecord;
   typedef int LoggerMessageID;
   static const LoggerMessageID RESERVED_LOGGER_MESSAGE_ID = 0;
   class LoggerConfig;
@@ -64,6 +65,13 @@ namespace Realm {
     static void configure_from_cmdline(std::vector<std::string>& cmdline);
     static void set_default_output(LoggerOutputStream *s);
     static void set_logger_output(const std::string& name, LoggerOutputStream *s);
+
+    // writes out anything the logging streams are holding in buffers - used
+    //  on fatal error paths before the process goes away
+    static void flush_all_streams(void);
+    // same, but for use in signal handlers - never waits on a lock the
+    //  interrupted thread might hold, so output may be lost instead
+    static void flush_all_streams_for_signal(void);
     
     const std::string& get_name(void) const;
     LoggingLevel get_level(void) const;
@@ -117,9 +125,13 @@ namespace Realm {
     
   protected:
     friend class LoggerMessage;
+    friend class LoggerStreamRecord;
 
     REALM_INTERNAL_API_EXTERNAL_LINKAGE
-    void log_msg(LoggingLevel level, const char *msgdata, size_t msglen);
+    void log_msg(LoggingLevel level, const char *msgdata, size_t msglen,
+                 const LoggerStreamRecord *record = 0);
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    void log_printf(LoggingLevel level, const char *fmt, va_list args);
     
     friend class LoggerConfig;
 
@@ -140,11 +152,103 @@ namespace Realm {
     std::vector<LogStream> streams;
     LoggingLevel log_level;  // the min level of any stream
     bool configured;
+    bool stream_records;  // does any stream want LoggerStreamRecords?
     // remember messages that are emitted before we're configured
     DelayedMessage *delayed_message_head;
     DelayedMessage **delayed_message_tail;
   };
   
+  // marks a string that lives for the whole run (i.e. a string literal) so
+  //  that a binary stream can record it once, by reference, instead of
+  //  copying its text into every message - other strings are recorded the
+  //  same way only if they are in read-only data (where string literals
+  //  live), and as text otherwise (e.g. stack buffers)
+  struct LoggerLiteral {
+    explicit LoggerLiteral(const char *_str) : str(_str) {}
+    const char *str;
+  };
+
+  // the '""' makes anything but a string literal a compile error
+  #define REALM_LOGGER_LITERAL(s) ::Realm::LoggerLiteral("" s)
+
+  std::ostream& operator<<(std::ostream& os, const LoggerLiteral& lit);
+
+  // the contents of a LoggerMessage as the sequence of values that were
+  //  inserted into it, so that a binary stream can record string literals
+  //  and numbers without formatting them - anything else (or anything
+  //  inserted with non-default stream formatting) is kept as the text the
+  //  ostream produced for it
+  class LoggerStreamRecord {
+  public:
+    static const size_t MAX_SIZE = 512;
+
+    // each item is a u8 type followed by its value
+    enum ItemType {
+      ITEM_LITERAL = 1,   // const char * of a literal
+      ITEM_SIGNED = 2,    // int64_t
+      ITEM_UNSIGNED = 3,  // uint64_t
+      ITEM_DOUBLE = 4,    // double, formatted like %g
+      ITEM_TEXT = 5,      // u32:len bytes
+    };
+
+    LoggerStreamRecord(void);
+
+    // records are only needed while binary logging, so each thread keeps
+    //  one around for its next message, and a message finds its record
+    //  through its ostream's pword slot rather than a member of its own
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static LoggerStreamRecord *acquire(const Logger *logger,
+                                       Logger::LoggingLevel level);
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static void release(LoggerStreamRecord *record);
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static const int stream_index;
+
+    // records 'val' as a value if it can be, returning false if its text is
+    //  needed instead (the caller must check the stream's formatting state)
+    template <typename T>
+    bool add(const T& val);
+
+    // records any text written to the stream without going through add()
+    void catch_up(const char *msgdata, size_t msglen);
+
+    // the text of the message, for when add() skipped formatting values -
+    //  'msgdata' holds whatever was written after the last recorded item
+    void render(std::string& text, const char *msgdata, size_t msglen) const;
+
+    // is 's' in read-only data, and therefore safe to record by address?
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static bool is_literal(const char *s);
+
+    bool valid;         // false once the items no longer fit
+    bool text_needed;   // does any stream want this message as text?
+    bool text_skipped;  // were any values recorded without their text?
+    size_t covered;     // bytes of the message text accounted for
+    size_t used;
+    char data[MAX_SIZE];
+
+  protected:
+    template <typename T>
+    bool add_item(ItemType type, T val);
+    void add_text(const char *text, size_t len);
+
+    // values that can be recorded without their text
+    template <typename T>
+    bool add_value(const T& val);
+    bool add_value(const LoggerLiteral& val);
+    bool add_value(const char *val);
+    bool add_value(short val);
+    bool add_value(int val);
+    bool add_value(long val);
+    bool add_value(long long val);
+    bool add_value(unsigned short val);
+    bool add_value(unsigned val);
+    bool add_value(unsigned long val);
+    bool add_value(unsigned long long val);
+    bool add_value(float val);
+    bool add_value(double val);
+  };
+
   class REALM_PUBLIC_API LoggerMessage {
   protected:
     // can only be created by a Logger
@@ -186,6 +290,17 @@ namespace Realm {
 
     virtual void log_msg(Logger::LoggingLevel level, const char *name,
                          const char *msgdata, size_t msglen) = 0;
+    // printf-style messages - the default formats the message and passes
+    //  it to log_msg
+    virtual void log_printf(Logger::LoggingLevel level, const char *name,
+                            const char *fmt, va_list args);
+    // streams that return true here are given LoggerMessage contents in
+    //  pieces - values in the record may be missing from the text, so the
+    //  default log_stream renders the record back into text for log_msg
+    virtual bool wants_stream_records(void) const;
+    virtual void log_stream(Logger::LoggingLevel level, const char *name,
+                            const char *msgdata, size_t msglen,
+                            const LoggerStreamRecord& record);
     virtual void flush() = 0;
   };
 
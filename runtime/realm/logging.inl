@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 // static checks in here require these to be #define's instead of the enums
 //  defined in logging.h - we'll push/pop these to avoid polluting
@@ -355,7 +356,9 @@ namespace Realm {
       return buffer;
   }
   
-  // old printf-style interface
+  // old printf-style interface - these go straight to the output streams so
+  //  that a binary stream can record the format and raw arguments instead
+  //  of the formatted text
   inline void Logger::spew(const char *fmt, ...)
   {
 #ifdef REALM_LOGGING_DO_SPEW              // static early out
@@ -364,7 +367,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    spew().vprintf(fmt, args);
+    log_printf(LEVEL_SPEW, fmt, args);
     va_end(args);
 #endif
   }
@@ -394,7 +397,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    debug().vprintf(fmt, args);
+    log_printf(LEVEL_DEBUG, fmt, args);
     va_end(args);
 #endif
   }
@@ -422,7 +425,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    info().vprintf(fmt, args);
+    log_printf(LEVEL_INFO, fmt, args);
     va_end(args);
 #endif
   }
@@ -450,7 +453,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    print().vprintf(fmt, args);
+    log_printf(LEVEL_PRINT, fmt, args);
     va_end(args);
 #endif
   }
@@ -478,7 +481,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    warning().vprintf(fmt, args);
+    log_printf(LEVEL_WARNING, fmt, args);
     va_end(args);
 #endif
   }
@@ -506,7 +509,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    error().vprintf(fmt, args);
+    log_printf(LEVEL_ERROR, fmt, args);
     va_end(args);
 #endif
   }
@@ -534,7 +537,7 @@ namespace Realm {
     
     va_list args;
     va_start(args, fmt);
-    fatal().vprintf(fmt, args);
+    log_printf(LEVEL_FATAL, fmt, args);
     va_end(args);
 #endif
   }
@@ -554,6 +557,103 @@ namespace Realm {
 #endif
   }
   
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // struct LoggerLiteral
+
+  inline std::ostream& operator<<(std::ostream& os, const LoggerLiteral& lit)
+  {
+    return os << lit.str;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class LoggerStreamRecord
+
+  inline LoggerStreamRecord::LoggerStreamRecord(void)
+    : valid(true), text_needed(true), text_skipped(false), covered(0), used(0)
+  {}
+
+  template <typename T>
+  inline bool LoggerStreamRecord::add(const T& val)
+  {
+    return (valid && add_value(val));
+  }
+
+  inline void LoggerStreamRecord::catch_up(const char *msgdata, size_t msglen)
+  {
+    if(!valid || (covered == msglen)) return;
+    add_text(msgdata + covered, msglen - covered);
+    // text that didn't fit stays uncovered, to be rendered after the items
+    if(valid)
+      covered = msglen;
+  }
+
+  template <typename T>
+  inline bool LoggerStreamRecord::add_item(ItemType type, T val)
+  {
+    if((used + 1 + sizeof(T)) > MAX_SIZE) {
+      // the value's text is needed after all
+      valid = false;
+      return false;
+    }
+    data[used] = type;
+    memcpy(data + used + 1, &val, sizeof(T));
+    used += 1 + sizeof(T);
+    return true;
+  }
+
+  inline void LoggerStreamRecord::add_text(const char *text, size_t len)
+  {
+    if(len == 0) return;
+    if((used + 1 + sizeof(uint32_t) + len) > MAX_SIZE) {
+      valid = false;
+      return;
+    }
+    uint32_t len32 = len;
+    data[used] = ITEM_TEXT;
+    memcpy(data + used + 1, &len32, sizeof(uint32_t));
+    memcpy(data + used + 1 + sizeof(uint32_t), text, len);
+    used += 1 + sizeof(uint32_t) + len;
+  }
+
+  template <typename T>
+  inline bool LoggerStreamRecord::add_value(const T& val)
+  {
+    return false;
+  }
+
+  inline bool LoggerStreamRecord::add_value(const LoggerLiteral& val)
+  {
+    return add_item(ITEM_LITERAL, val.str);
+  }
+
+  inline bool LoggerStreamRecord::add_value(const char *val)
+  {
+    return (is_literal(val) && add_item(ITEM_LITERAL, val));
+  }
+
+  inline bool LoggerStreamRecord::add_value(short val)
+  { return add_item<int64_t>(ITEM_SIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(int val)
+  { return add_item<int64_t>(ITEM_SIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(long val)
+  { return add_item<int64_t>(ITEM_SIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(long long val)
+  { return add_item<int64_t>(ITEM_SIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(unsigned short val)
+  { return add_item<uint64_t>(ITEM_UNSIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(unsigned val)
+  { return add_item<uint64_t>(ITEM_UNSIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(unsigned long val)
+  { return add_item<uint64_t>(ITEM_UNSIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(unsigned long long val)
+  { return add_item<uint64_t>(ITEM_UNSIGNED, val); }
+  inline bool LoggerStreamRecord::add_value(float val)
+  { return add_item<double>(ITEM_DOUBLE, val); }
+  inline bool LoggerStreamRecord::add_value(double val)
+  { return add_item<double>(ITEM_DOUBLE, val); }
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class LoggerMessage
@@ -566,28 +666,45 @@ namespace Realm {
   inline LoggerMessage::LoggerMessage(Logger *_logger, bool _active, Logger::LoggingLevel _level)
     : messageID(RESERVED_LOGGER_MESSAGE_ID), logger(_logger), active(_active), level(_level)
   {
-    if(active)
+    if(active) {
       stream.construct(buffer.construct());
+      if(logger->stream_records)
+        stream->pword(LoggerStreamRecord::stream_index) = LoggerStreamRecord::acquire(logger, level);
+    }
   }
   
   inline LoggerMessage::LoggerMessage(LoggerMessageID messageID, Logger *_logger, bool _active, Logger::LoggingLevel _level)
     : messageID(messageID), logger(_logger), active(_active), level(_level)
   {
-    if(active)
+    if(active) {
       stream.construct(buffer.construct());
+      if(logger->stream_records)
+        stream->pword(LoggerStreamRecord::stream_index) = LoggerStreamRecord::acquire(logger, level);
+    }
   }
   
   inline LoggerMessage::LoggerMessage(const LoggerMessage& to_copy)
     : messageID(to_copy.messageID), logger(to_copy.logger), active(to_copy.active), level(to_copy.level)
   {
-    if(active)
+    if(active) {
       stream.construct(buffer.construct());
+      if(logger->stream_records)
+        stream->pword(LoggerStreamRecord::stream_index) = LoggerStreamRecord::acquire(logger, level);
+    }
   }
   
   inline LoggerMessage::~LoggerMessage(void)
   {
     if(active) {
-      logger->log_msg(level, buffer->data(), buffer->size());
+      LoggerStreamRecord *record = 0;
+      if(logger->stream_records)
+        record = static_cast<LoggerStreamRecord *>(stream->pword(LoggerStreamRecord::stream_index));
+      if(record) {
+        record->catch_up(buffer->data(), buffer->size());
+        logger->log_msg(level, buffer->data(), buffer->size(), record);
+        LoggerStreamRecord::release(record);
+      } else
+        logger->log_msg(level, buffer->data(), buffer->size());
       active = false;
     }
   }
@@ -596,8 +713,31 @@ namespace Realm {
   inline LoggerMessage& LoggerMessage::operator<<(const T& val)
   {
     // send through to normal ostringstream formatting routines if active
-    if(active)
-      get_stream() << val;
+    if(active) {
+      std::ostream& os = get_stream();
+      LoggerStreamRecord *record = 0;
+      if(logger->stream_records)
+        record = static_cast<LoggerStreamRecord *>(os.pword(LoggerStreamRecord::stream_index));
+      if(record && record->valid) {
+        // anything written to the stream directly comes first
+        record->catch_up(buffer->data(), buffer->size());
+        bool plain = ((os.flags() == (std::ios_base::dec |
+                                      std::ios_base::skipws)) &&
+                      (os.width() == 0) && (os.precision() == 6));
+        if(plain && record->add(val)) {
+          // only format the value if some stream takes the message as text
+          if(record->text_needed)
+            os << val;
+          else
+            record->text_skipped = true;
+          record->covered = buffer->size();
+        } else {
+          os << val;
+          record->catch_up(buffer->data(), buffer->size());
+        }
+      } else
+        os << val;
+    }
     return *this;
   }
   
@@ -471,6 +471,37 @@ namespace Realm {
 	  }
 	  break;
 
+	case NODE_ANNOUNCE_PROC_RANGE:
+	  {
+	    Processor first;
+	    int count;
+	    Processor::Kind kind;
+	    int num_cores;
+	    ok = (ok &&
+		  (fbd >> first) &&
+		  (fbd >> count) &&
+		  (fbd >> kind) &&
+		  (fbd >> num_cores));
+	    if(ok) {
+	      assert(NodeID(ID(first).proc_owner_node()) == node_id);
+	      log_annc.debug() << "adding procs " << first << "+" << count
+			       << " (kind = " << kind
+			       << " num_cores = " << num_cores << ")";
+	      if(remote) {
+		unsigned first_idx = ID(first).proc_proc_idx();
+		if(n.processors.size() < (first_idx + count))
+		  n.processors.resize(first_idx + count, 0);
+		for(int i = 0; i < count; i++) {
+		  Processor p = ID::make_processor(node_id,
+						   first_idx + i).convert<Processor>();
+		  n.processors[first_idx + i] = new RemoteProcessor(p, kind,
+								    num_cores);
+		}
+	      }
+	    }
+	  }
+	  break;
+
 	case NODE_ANNOUNCE_MEM:
 	  {
 	    Memory m;
@@ -615,6 +646,41 @@ namespace Realm {
 	  }
 	  break;
 
+	case NODE_ANNOUNCE_PMA_GROUP:
+	  {
+	    Processor first;
+	    int count;
+	    std::vector<Memory> mems;
+	    std::vector<unsigned> bandwidths, latencies;
+	    ok = (ok &&
+		  (fbd >> first) &&
+		  (fbd >> count) &&
+		  (fbd >> mems) &&
+		  (fbd >> bandwidths) &&
+		  (fbd >> latencies) &&
+		  (bandwidths.size() == mems.size()) &&
+		  (latencies.size() == mems.size()));
+	    if(ok) {
+	      // expand processor by processor to match the order in which
+	      //  individual PMA entries would have been added
+	      unsigned first_idx = ID(first).proc_proc_idx();
+	      for(int i = 0; i < count; i++)
+		for(size_t j = 0; j < mems.size(); j++) {
+		  Machine::ProcessorMemoryAffinity pma;
+		  pma.p = ID::make_processor(node_id,
+					     first_idx + i).convert<Processor>();
+		  pma.m = mems[j];
+		  pma.bandwidth = bandwidths[j];
+		  pma.latency = latencies[j];
+		  log_annc.debug() << "adding affinity " << pma.p << " -> " << pma.m
+				   << " (bw = " << pma.bandwidth << ", latency = " << pma.latency << ")";
+
+		  add_proc_mem_affinity(pma, true /*lock held*/);
+		}
+	    }
+	  }
+	  break;
+
 	case NODE_ANNOUNCE_MMA:
 	  {
 	    Machine::MemoryMemoryAffinity mma;
@@ -650,6 +716,30 @@ namespace Realm {
 	  }
 	  break;
 
+	case NODE_ANNOUNCE_RDMA_INFO:
+	  {
+	    Memory m;
+	    ByteArray rdma_info;
+	    ok = (ok &&
+		  (fbd >> m) &&
+		  (fbd >> rdma_info));
+	    if(ok) {
+	      assert(NodeID(ID(m).memory_owner_node()) == node_id);
+	      // used when the template is instantiated for this node
+	      if(remote)
+		templated_nodes[node_id][m].swap(rdma_info);
+	    }
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_TEMPLATE:
+	  {
+	    log_annc.debug() << "node " << node_id << " is described by the template";
+	    if(remote)
+	      templated_nodes[node_id];
+	  }
+	  break;
+
 	default:
 	  log_annc.fatal() << "unknown tag: " << tag;
 	  assert(0);
@@ -659,6 +749,201 @@ namespace Realm {
       assert(ok && (fbd.bytes_left() == 0));
     }
 
+    void MachineImpl::set_announce_template(const void *data, size_t datalen)
+    {
+      AutoLock<> al(mutex);
+      announce_template.set(data, datalen);
+    }
+
+    // the template only names node 0's processors and memories - anything
+    //  else (e.g. an affinity to another node's memory) can't be relocated
+    static bool relocate_processor(Processor& p, NodeID node_id)
+    {
+      ID id(p);
+      if(id.proc_owner_node() != 0)
+	return false;
+      p = ID::make_processor(node_id, id.proc_proc_idx()).convert<Processor>();
+      return true;
+    }
+
+    static bool relocate_memory(Memory& m, NodeID node_id)
+    {
+      ID id(m);
+      if(id.memory_owner_node() != 0)
+	return false;
+      if(id.is_ib_memory())
+	m = ID::make_ib_memory(node_id, id.memory_mem_idx()).convert<Memory>();
+      else
+	m = ID::make_memory(node_id, id.memory_mem_idx()).convert<Memory>();
+      return true;
+    }
+
+    bool MachineImpl::instantiate_announce_template(NodeID node_id,
+						    const std::map<Memory, ByteArray>& rdma_infos,
+						    Serialization::DynamicBufferSerializer& dbs) const
+    {
+      // re-serialize each entry of the template with node 0's processors
+      //  and memories replaced by the ones 'node_id' has at the same index,
+      //  and its memories' rdma info replaced by that node's own
+      Serialization::FixedBufferDeserializer fbd(announce_template.base(),
+						 announce_template.size());
+      bool ok = true;
+      while(ok && (fbd.bytes_left() > 0)) {
+	NodeAnnounceTag tag;
+	if(!(fbd >> tag)) return false;
+
+	switch(tag) {
+	case NODE_ANNOUNCE_PROC:
+	  {
+	    Processor p;
+	    Processor::Kind kind;
+	    int num_cores;
+	    ok = ((fbd >> p) &&
+		  (fbd >> kind) &&
+		  (fbd >> num_cores) &&
+		  relocate_processor(p, node_id) &&
+		  (dbs << tag) &&
+		  (dbs << p) &&
+		  (dbs << kind) &&
+		  (dbs << num_cores));
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_PROC_RANGE:
+	  {
+	    Processor first;
+	    int count;
+	    Processor::Kind kind;
+	    int num_cores;
+	    ok = ((fbd >> first) &&
+		  (fbd >> count) &&
+		  (fbd >> kind) &&
+		  (fbd >> num_cores) &&
+		  relocate_processor(first, node_id) &&
+		  (dbs << tag) &&
+		  (dbs << first) &&
+		  (dbs << count) &&
+		  (dbs << kind) &&
+		  (dbs << num_cores));
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_MEM:
+	case NODE_ANNOUNCE_IB_MEM:
+	  {
+	    Memory m;
+	    Memory::Kind kind;
+	    size_t size;
+	    bool has_rdma_info = false;
+	    ByteArray rdma_info;
+	    ok = ((fbd >> m) &&
+		  (fbd >> kind) &&
+		  (fbd >> size) &&
+		  (fbd >> has_rdma_info));
+	    if(has_rdma_info)
+	      ok = ok && (fbd >> rdma_info);
+	    ok = ok && relocate_memory(m, node_id);
+	    if(ok) {
+	      std::map<Memory, ByteArray>::const_iterator it = rdma_infos.find(m);
+	      has_rdma_info = (it != rdma_infos.end());
+	      ok = ((dbs << tag) &&
+		    (dbs << m) &&
+		    (dbs << kind) &&
+		    (dbs << size) &&
+		    (dbs << has_rdma_info));
+	      if(has_rdma_info)
+		ok = ok && (dbs << it->second);
+	    }
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_PMA:
+	  {
+	    Processor p;
+	    Memory m;
+	    unsigned bandwidth, latency;
+	    ok = ((fbd >> p) &&
+		  (fbd >> m) &&
+		  (fbd >> bandwidth) &&
+		  (fbd >> latency) &&
+		  relocate_processor(p, node_id) &&
+		  relocate_memory(m, node_id) &&
+		  (dbs << tag) &&
+		  (dbs << p) &&
+		  (dbs << m) &&
+		  (dbs << bandwidth) &&
+		  (dbs << latency));
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_PMA_GROUP:
+	  {
+	    Processor first;
+	    int count;
+	    std::vector<Memory> mems;
+	    std::vector<unsigned> bandwidths, latencies;
+	    ok = ((fbd >> first) &&
+		  (fbd >> count) &&
+		  (fbd >> mems) &&
+		  (fbd >> bandwidths) &&
+		  (fbd >> latencies) &&
+		  relocate_processor(first, node_id));
+	    for(size_t i = 0; ok && (i < mems.size()); i++)
+	      ok = relocate_memory(mems[i], node_id);
+	    ok = (ok &&
+		  (dbs << tag) &&
+		  (dbs << first) &&
+		  (dbs << count) &&
+		  (dbs << mems) &&
+		  (dbs << bandwidths) &&
+		  (dbs << latencies));
+	  }
+	  break;
+
+	case NODE_ANNOUNCE_MMA:
+	  {
+	    Memory m1, m2;
+	    unsigned bandwidth, latency;
+	    ok = ((fbd >> m1) &&
+		  (fbd >> m2) &&
+		  (fbd >> bandwidth) &&
+		  (fbd >> latency) &&
+		  relocate_memory(m1, node_id) &&
+		  relocate_memory(m2, node_id) &&
+		  (dbs << tag) &&
+		  (dbs << m1) &&
+		  (dbs << m2) &&
+		  (dbs << bandwidth) &&
+		  (dbs << latency));
+	  }
+	  break;
+
+	default:
+	  // anything else (e.g. dma channels) is never part of a template
+	  return false;
+	}
+      }
+      return ok;
+    }
+
+    void MachineImpl::parse_templated_announcements(void)
+    {
+      // all announcements have arrived, so nothing else touches these now
+      for(std::map<NodeID, std::map<Memory, ByteArray> >::const_iterator it = templated_nodes.begin();
+	  it != templated_nodes.end();
+	  ++it) {
+	Serialization::DynamicBufferSerializer dbs(4096);
+	bool ok = instantiate_announce_template(it->first, it->second, dbs);
+	if(!ok) {
+	  log_annc.fatal() << "could not instantiate announcement template for node " << it->first;
+	  assert(0);
+	}
+	parse_node_announce_data(it->first, dbs.get_buffer(), dbs.bytes_used(),
+				 true /*remote*/);
+      }
+      templated_nodes.clear();
+    }
+
     void MachineImpl::get_all_memories(std::set<Memory>& mset) const
     {
       // TODO: consider using a reader/writer lock here instead
@@ -3058,6 +3343,7 @@ namespace Realm {
 
   static atomic<int> announcements_received(0);
   static atomic<int> announce_fragments_expected(0);
+  static atomic<int> announce_template_received(0);
 
   /*static*/ void NodeAnnounceMessage::handle_message(NodeID sender, const NodeAnnounceMessage &args,
 						      const void *data, size_t datalen)
@@ -3074,6 +3360,11 @@ namespace Realm {
       announcements_received.fetch_add_acqrel(1);
     }
 
+    if(args.is_template) {
+      get_machine()->set_announce_template(data, datalen);
+      announce_template_received.store_release(1);
+    }
+
     get_machine()->parse_node_announce_data(sender,
                                             data, datalen, true);
 
@@ -3081,6 +3372,12 @@ namespace Realm {
     announce_fragments_expected.fetch_sub_acqrel(1);
   }
 
+  /*static*/ void NodeAnnounceMessage::await_template(void)
+  {
+    while(announce_template_received.load_acquire() == 0)
+      Thread::yield();
+  }
+
   /*static*/ void NodeAnnounceMessage::await_all_announcements(void)
   {
     // two steps:
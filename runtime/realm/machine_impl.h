@@ -22,9 +22,12 @@
 #include "realm/network.h"
 #include "realm/mutex.h"
 #include "realm/atomics.h"
+#include "realm/bytearray.h"
+#include "realm/serialize.h"
 
 #include <vector>
 #include <set>
+#include <map>
 
 namespace Realm {
 
@@ -120,6 +123,16 @@ namespace Realm {
 				    const void *args, size_t arglen,
 				    bool remote);
 
+      // nodes built like node 0 are announced by the rdma info of their
+      //  memories alone - node 0's description is kept as a template (empty
+      //  if node 0 could not send one) and instantiated for each such node
+      //  once every announcement has arrived
+      void set_announce_template(const void *data, size_t datalen);
+      bool instantiate_announce_template(NodeID node_id,
+					 const std::map<Memory, ByteArray>& rdma_infos,
+					 Serialization::DynamicBufferSerializer& dbs) const;
+      void parse_templated_announcements(void);
+
       void add_proc_mem_affinity(const Machine::ProcessorMemoryAffinity& pma,
 				 bool lock_held = false);
       void add_mem_mem_affinity(const Machine::MemoryMemoryAffinity& mma,
@@ -132,6 +145,8 @@ namespace Realm {
       std::vector<Machine::ProcessorMemoryAffinity> proc_mem_affinities;
       std::vector<Machine::MemoryMemoryAffinity> mem_mem_affinities;
       std::set<Machine::MachineUpdateSubscriber *> subscribers;
+      ByteArray announce_template;
+      std::map<NodeID, std::map<Memory, ByteArray> > templated_nodes;
 
       std::map<int, MachineNodeInfo *> nodeinfos;
 
@@ -372,14 +387,20 @@ namespace Realm {
     NODE_ANNOUNCE_PMA,  // PMA proc_id mem_id bw latency
     NODE_ANNOUNCE_MMA,  // MMA mem1_id mem2_id bw latency
     NODE_ANNOUNCE_DMA_CHANNEL,
+    NODE_ANNOUNCE_PROC_RANGE, // PROC_RANGE first_id count kind num_cores
+    NODE_ANNOUNCE_PMA_GROUP,  // PMA_GROUP first_id count mem_ids bws latencies
+    NODE_ANNOUNCE_RDMA_INFO,  // RDMA_INFO mem_id rdma_info
+    NODE_ANNOUNCE_TEMPLATE,   // TEMPLATE (node is described by node 0's template)
   };
 
   struct NodeAnnounceMessage {
     int num_fragments;
+    bool is_template;  // node 0's description, which other nodes may reuse
 
     static void handle_message(NodeID sender, const NodeAnnounceMessage &msg,
 			       const void *data, size_t datalen);
 
+    static void await_template(void);
     static void await_all_announcements(void);
   };
 
@@ -23,6 +23,14 @@
 #include "realm/profiling.h"
 #include "realm/utils.h"
 #include "realm/activemsg.h"
+#include "realm/numa/numasysif.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef REALM_ON_LINUX
+#include <sys/mman.h>
+#endif
 
 namespace Realm {
 
@@ -35,6 +43,13 @@ namespace Realm {
     // if true, Realm memories attempt to satisfy instance allocation requests
     //  on the basis of deferred instance destructions
     bool deferred_instance_allocation = true;
+
+    // if nonzero, the page size to use for the system and registered memory
+    //  arenas
+    size_t hugepage_size = 0;
+
+    // if true, the system and registered memory arenas are touched at startup
+    bool prefault_memory = false;
   };
 
 
@@ -457,12 +472,20 @@ namespace Realm {
 		       void *prealloc_base, NetworkSegment *_segment)
       : MemoryImpl(_me, _size, _kind, _lowlevel_kind, _segment)
       , base(static_cast<char *>(prealloc_base))
+      , usage(0), peak_usage(0), active_allocs(0)
+      , num_allocs(0), num_shrunk(0), num_deferred(0)
     {
       free_blocks[0] = _size;
     }
 
     IBMemory::~IBMemory()
     {
+      if(num_allocs > 0)
+	log_malloc.info() << "ib memory " << me << ": size=" << size
+			  << " peak=" << peak_usage
+			  << " allocs=" << num_allocs
+			  << " shrunk=" << num_shrunk
+			  << " deferred=" << num_deferred;
     }
 
     // old-style allocation used by IB memories
@@ -472,7 +495,59 @@ namespace Realm {
     off_t IBMemory::alloc_bytes_local(size_t size)
     {
       AutoLock<> al(mutex);
+      return alloc_bytes_locked(size);
+    }
+
+    off_t IBMemory::alloc_bytes_elastic(size_t max_size, size_t min_size,
+					unsigned waiters, size_t& granted)
+    {
+      AutoLock<> al(mutex);
+
+      size_t want = max_size;
+      if(min_size < max_size) {
+	// split the memory evenly between everybody holding or waiting for a
+	//  buffer, holding one share back for the next request to arrive
+	size_t share = this->size / (active_allocs + waiters + 2);
+	want = std::min(want, share);
+	// and rather than wait for a big enough block, take what's free now
+	//  (allowing for the padding to 256B below)
+	size_t largest = largest_free_block() & ~size_t(255);
+	want = std::min(want, largest);
+	if(want < max_size) {
+	  want -= want % min_size;
+	  if(want < min_size)
+	    want = min_size;  // will fail, but a queued request is fine
+	}
+      }
 
+      off_t offset = alloc_bytes_locked(want);
+      if(offset >= 0) {
+	granted = want;
+	if(want < max_size)
+	  num_shrunk++;
+      } else
+	num_deferred++;
+
+      log_malloc.info() << "ib alloc: mem=" << me
+			<< " req=" << min_size << "-" << max_size
+			<< " waiters=" << waiters
+			<< " granted=" << ((offset >= 0) ? want : 0)
+			<< " usage=" << usage << "/" << this->size;
+      return offset;
+    }
+
+    size_t IBMemory::largest_free_block(void) const
+    {
+      size_t largest = 0;
+      for(std::map<off_t, off_t>::const_iterator it = free_blocks.begin();
+	  it != free_blocks.end();
+	  ++it)
+	largest = std::max(largest, size_t(it->second));
+      return largest;
+    }
+
+    off_t IBMemory::alloc_bytes_locked(size_t size)
+    {
       // for zero-length allocations, return a special "offset"
       if(size == 0) {
 	return this->size + ZERO_SIZE_INSTANCE_OFFSET;
@@ -503,12 +578,10 @@ namespace Realm {
 	    off_t retval = it->first;
 	    free_blocks.erase(it);
 	    log_malloc.info("alloc full block: mem=" IDFMT " size=%zd ofs=%zd", me.id, size, (ssize_t)retval);
-#if 0
 	    usage += size;
 	    if(usage > peak_usage) peak_usage = usage;
-	    size_t footprint = this->size - retval;
-	    if(footprint > peak_footprint) peak_footprint = footprint;
-#endif
+	    active_allocs++;
+	    num_allocs++;
 	    return retval;
 	  }
 	
@@ -518,12 +591,10 @@ namespace Realm {
 	    off_t retval = it->first + leftover;
 	    it->second = leftover;
 	    log_malloc.info("alloc partial block: mem=" IDFMT " size=%zd ofs=%zd", me.id, size, (ssize_t)retval);
-#if 0
 	    usage += size;
 	    if(usage > peak_usage) peak_usage = usage;
-	    size_t footprint = this->size - retval;
-	    if(footprint > peak_footprint) peak_footprint = footprint;
-#endif
+	    active_allocs++;
+	    num_allocs++;
 	    return retval;
 	  }
 	} while(it != free_blocks.begin());
@@ -556,10 +627,8 @@ namespace Realm {
 	}
       }
 
-#if 0
       usage -= size;
-      // only made things smaller, so can't impact the peak usage
-#endif
+      active_allocs--;
 
       if(free_blocks.size() > 0) {
 	// find the first existing block that comes _after_ us
@@ -1378,31 +1447,176 @@ namespace Realm {
   // class LocalCPUMemory
   //
 
+  namespace {
+
+#ifdef REALM_ON_LINUX
+    // maps 'bytes' of anonymous memory - if 'page_size' is nonzero, explicit
+    //  (hugetlbfs) pages of that size are tried first, followed by a mapping
+    //  aligned to 'page_size' for which transparent huge pages are requested
+    // returns 0 if no mapping could be made, otherwise sets 'mapped_bytes'
+    //  to the length that must eventually be unmapped
+    char *map_host_arena(size_t bytes, size_t page_size, size_t& mapped_bytes)
+    {
+      if(page_size == 0) {
+        void *base = mmap(0, bytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(base == MAP_FAILED)
+          return 0;
+        mapped_bytes = bytes;
+        return static_cast<char *>(base);
+      }
+
+      // always map a whole number of huge pages
+      size_t rounded = ((bytes + page_size - 1) / page_size) * page_size;
+
+#ifdef MAP_HUGETLB
+      {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        // request the exact page size rather than the system default
+        int log2_size = 0;
+        while((size_t(1) << log2_size) < page_size)
+          log2_size++;
+        flags |= (log2_size << MAP_HUGE_SHIFT);
+#endif
+        void *base = mmap(0, rounded, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(base != MAP_FAILED) {
+          log_malloc.info() << "explicit huge pages: base=" << base
+                            << " bytes=" << rounded
+                            << " page_size=" << page_size;
+          mapped_bytes = rounded;
+          return static_cast<char *>(base);
+        }
+        log_malloc.warning() << "explicit huge pages unavailable, trying transparent huge pages: bytes="
+                             << rounded << " page_size=" << page_size
+                             << " error=" << strerror(errno);
+      }
+#endif
+
+      // over-map so that the arena can start on a huge page boundary, and
+      //  then give back the unaligned head and tail
+      size_t padded = rounded + page_size;
+      void *raw = mmap(0, padded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(raw == MAP_FAILED)
+        return 0;
+      char *base = static_cast<char *>(raw);
+      size_t misalign = reinterpret_cast<uintptr_t>(base) % page_size;
+      size_t head = (misalign > 0) ? (page_size - misalign) : 0;
+      if(head > 0)
+        munmap(base, head);
+      size_t tail = padded - head - rounded;
+      if(tail > 0)
+        munmap(base + head + rounded, tail);
+      base += head;
+      mapped_bytes = rounded;
+
+#ifdef MADV_HUGEPAGE
+      if(madvise(base, rounded, MADV_HUGEPAGE) != 0)
+        log_malloc.warning() << "transparent huge pages unavailable, falling back to default pages: bytes="
+                             << rounded << " error=" << strerror(errno);
+#else
+      log_malloc.warning() << "transparent huge pages not supported, falling back to default pages: bytes="
+                           << rounded;
+#endif
+      return base;
+    }
+
+    // asks for transparent huge pages on memory someone else allocated -
+    //  only the huge-page-aligned interior of the range can benefit
+    void advise_host_arena(char *base, size_t bytes, size_t page_size)
+    {
+      uintptr_t start = ((reinterpret_cast<uintptr_t>(base) + page_size - 1) /
+                         page_size) * page_size;
+      uintptr_t end = ((reinterpret_cast<uintptr_t>(base) + bytes) /
+                       page_size) * page_size;
+      if(end <= start) {
+        log_malloc.warning() << "memory too small for huge pages, using default pages: base="
+                             << static_cast<void *>(base) << " bytes=" << bytes;
+        return;
+      }
+#ifdef MADV_HUGEPAGE
+      if(madvise(reinterpret_cast<void *>(start), end - start, MADV_HUGEPAGE) != 0)
+        log_malloc.warning() << "transparent huge pages unavailable, falling back to default pages: base="
+                             << static_cast<void *>(base) << " error=" << strerror(errno);
+#else
+      log_malloc.warning() << "transparent huge pages not supported, falling back to default pages: base="
+                           << static_cast<void *>(base);
+#endif
+    }
+#endif
+
+    // writes one byte in every page so that the kernel populates the whole
+    //  range now rather than during the application's first timestep
+    void prefault_host_arena(char *base, size_t bytes)
+    {
+      const size_t stride = 4096;  // smallest page size we expect to see
+      for(size_t ofs = 0; ofs < bytes; ofs += stride)
+        *static_cast<volatile char *>(base + ofs) = 0;
+    }
+
+  };
+
   LocalCPUMemory::LocalCPUMemory(Memory _me, size_t _size, 
                                  int _numa_node, Memory::Kind _lowlevel_kind,
 				 void *prealloc_base /*= 0*/,
 				 NetworkSegment *_segment /*= 0*/)
     : LocalManagedMemory(_me, _size, MKIND_SYSMEM, ALIGNMENT,
 			 _lowlevel_kind, _segment),
-      numa_node(_numa_node)
+      numa_node(_numa_node),
+      mapped_bytes(0)
   {
     if(prealloc_base) {
       base = (char *)prealloc_base;
       prealloced = true;
+
+      // the network chose how this memory is backed, so the best we can do
+      //  is ask for transparent huge pages
+      if(Config::hugepage_size > 0) {
+#ifdef REALM_ON_LINUX
+        advise_host_arena(base, _size, Config::hugepage_size);
+#else
+        log_malloc.warning() << "huge pages not supported on this platform, using default pages";
+#endif
+      }
     } else {
       // allocate our own space
-      // enforce alignment on the whole memory range
-      base_orig = static_cast<char *>(malloc(_size + ALIGNMENT - 1));
-      if(!base_orig) {
-	log_malloc.fatal() << "insufficient system memory: "
-			   << size << " bytes needed (from -ll:csize)";
-	abort();
+      base_orig = 0;
+#ifdef REALM_ON_LINUX
+      // huge pages and NUMA binding both need a page-aligned mapping
+      if((Config::hugepage_size > 0) || (_numa_node >= 0)) {
+        base_orig = map_host_arena(_size, Config::hugepage_size, mapped_bytes);
+        if(!base_orig)
+          log_malloc.warning() << "mmap failed, falling back to malloc: bytes="
+                               << _size << " error=" << strerror(errno);
       }
-      size_t ofs = reinterpret_cast<size_t>(base_orig) % ALIGNMENT;
-      if(ofs > 0) {
-	base = base_orig + (ALIGNMENT - ofs);
+#else
+      if(Config::hugepage_size > 0)
+        log_malloc.warning() << "huge pages not supported on this platform, using default pages";
+      if(_numa_node >= 0)
+        log_malloc.warning() << "NUMA binding not supported on this platform, using default policy";
+#endif
+      if(base_orig) {
+        // mappings are always page-aligned
+        base = base_orig;
+        if((_numa_node >= 0) &&
+           !numasysif_bind_mem(_numa_node, base, mapped_bytes, false /*!pin*/))
+          log_malloc.warning() << "could not bind memory to NUMA node "
+                               << _numa_node << ", using default policy";
       } else {
-	base = base_orig;
+        // enforce alignment on the whole memory range
+        base_orig = static_cast<char *>(malloc(_size + ALIGNMENT - 1));
+        if(!base_orig) {
+          log_malloc.fatal() << "insufficient system memory: "
+                             << size << " bytes needed (from -ll:csize)";
+          abort();
+        }
+        size_t ofs = reinterpret_cast<size_t>(base_orig) % ALIGNMENT;
+        if(ofs > 0) {
+          base = base_orig + (ALIGNMENT - ofs);
+        } else {
+          base = base_orig;
+        }
       }
       prealloced = false;
 
@@ -1413,15 +1627,25 @@ namespace Realm {
 			   base, _size);
       segment = &local_segment;
     }
-    log_malloc.debug("CPU memory at %p, size = %zd%s%s", base, _size, 
+    if(Config::prefault_memory)
+      prefault_host_arena(base, _size);
+    log_malloc.debug("CPU memory at %p, size = %zd%s%s%s", base, _size, 
 		     prealloced ? " (prealloced)" : "",
-		     (segment && segment->single_network) ? " (registered)" : "");
+		     (segment && segment->single_network) ? " (registered)" : "",
+		     Config::prefault_memory ? " (prefaulted)" : "");
   }
 
   LocalCPUMemory::~LocalCPUMemory(void)
   {
-    if(!prealloced)
+    if(!prealloced) {
+#ifdef REALM_ON_LINUX
+      if(mapped_bytes > 0) {
+        munmap(base_orig, mapped_bytes);
+        return;
+      }
+#endif
       free(base_orig);
+    }
   }
 
   void LocalCPUMemory::get_bytes(off_t offset, void *dst, size_t size)
@@ -36,6 +36,15 @@ namespace Realm {
     // if true, Realm memories attempt to satisfy instance allocation requests
     //  on the basis of deferred instance destructions
     extern bool deferred_instance_allocation;
+
+    // if nonzero, the page size Realm attempts to use for the system and
+    //  registered memory arenas (explicit huge pages are tried first, then
+    //  transparent huge pages)
+    extern size_t hugepage_size;
+
+    // if true, every page of the system and registered memory arenas is
+    //  touched at startup instead of being faulted in on first use
+    extern bool prefault_memory;
   };
 
   class RegionInstanceImpl;
@@ -168,6 +177,19 @@ namespace Realm {
     virtual off_t alloc_bytes_local(size_t size);
     virtual void free_bytes_local(off_t offset, size_t size);
 
+    // allocates an intermediate buffer of up to 'max_size' bytes, shrinking
+    //  it (to a multiple of 'min_size') rather than taking more than a fair
+    //  share of the memory or waiting for a large enough free block -
+    //  'waiters' is the number of other requests queued on this memory
+    // this is only a cap applied when the buffer is granted: the share is
+    //  computed from the contention seen at that moment, and a granted
+    //  buffer keeps its size until it is freed (it is not shrunk if more
+    //  requests arrive later, nor grown if the memory becomes idle)
+    // returns -1 if not even 'min_size' bytes are available, otherwise sets
+    //  'granted' to the size actually allocated
+    off_t alloc_bytes_elastic(size_t max_size, size_t min_size,
+			      unsigned waiters, size_t& granted);
+
     virtual void *get_direct_ptr(off_t offset, size_t size);
     
     // not used by IB memories
@@ -190,10 +212,19 @@ namespace Realm {
     }
 
   protected:
+    // both of these expect the mutex to be held
+    off_t alloc_bytes_locked(size_t size);
+    size_t largest_free_block(void) const;
+
     Mutex mutex; // protection for resizing vectors
     std::map<off_t, off_t> free_blocks;
     char *base;
     NetworkSegment *segment;
+
+    // occupancy statistics (also protected by the mutex)
+    size_t usage, peak_usage;
+    unsigned active_allocs;
+    size_t num_allocs, num_shrunk, num_deferred;
   };
 
   // manages a basic free list of ranges (using range type RT) and allocated
@@ -329,6 +360,7 @@ namespace Realm {
     public: //protected:
       char *base, *base_orig;
       bool prealloced;
+      size_t mapped_bytes;  // nonzero if base_orig came from mmap
       NetworkSegment local_segment;
     };
 
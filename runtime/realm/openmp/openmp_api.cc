@@ -19,6 +19,9 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 
 namespace Realm {
   extern Logger log_omp;
@@ -27,6 +30,18 @@ namespace Realm {
   void openmp_api_force_linkage(void)
   {}
 
+  // counts the enclosing parallel regions that have more than one thread
+  static int count_active_levels(ThreadPool::WorkerInfo *wi)
+  {
+    int levels = 0;
+    for(ThreadPool::WorkItem *item = wi->work_item;
+	item;
+	item = item->parent_work_item)
+      if(item->num_threads > 1)
+	levels++;
+    return levels;
+  }
+
 };
 
 // application-visible OpenMP API calls - always generated
@@ -97,6 +112,87 @@ extern "C" {
       return 0;
   }
 
+  REALM_PUBLIC_API
+  int omp_get_active_level(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      return Realm::count_active_levels(wi);
+    else
+      return 0;
+  }
+
+  REALM_PUBLIC_API
+  int omp_get_ancestor_thread_num(int level)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    int cur_level = omp_get_level();
+    if((level < 0) || (level > cur_level))
+      return -1;
+    if(!wi || (level == 0))
+      return 0;
+    // each work item remembers the thread id its creator had one level up
+    int thread_id = wi->thread_id;
+    Realm::ThreadPool::WorkItem *item = wi->work_item;
+    while(cur_level > level) {
+      thread_id = item->prev_thread_id;
+      item = item->parent_work_item;
+      cur_level--;
+    }
+    return thread_id;
+  }
+
+  REALM_PUBLIC_API
+  int omp_get_team_size(int level)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    int cur_level = omp_get_level();
+    if((level < 0) || (level > cur_level))
+      return -1;
+    if(!wi || (level == 0))
+      return 1;
+    Realm::ThreadPool::WorkItem *item = wi->work_item;
+    while(cur_level > level) {
+      item = item->parent_work_item;
+      cur_level--;
+    }
+    return item->num_threads;
+  }
+
+  REALM_PUBLIC_API
+  void omp_set_max_active_levels(int max_levels)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi) {
+      if(max_levels >= 0)
+	wi->pool->max_active_levels.store(max_levels);
+    } else {
+      log_omp.warning() << "omp_set_max_active_levels(" << max_levels << ") called on non-OpenMP Realm proessor - ignoring";
+    }
+  }
+
+  REALM_PUBLIC_API
+  int omp_get_max_active_levels(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      return wi->pool->max_active_levels.load();
+    else
+      return 1;
+  }
+
+  REALM_PUBLIC_API
+  void omp_set_nested(int nested)
+  {
+    omp_set_max_active_levels(nested ? INT_MAX : 1);
+  }
+
+  REALM_PUBLIC_API
+  int omp_get_nested(void)
+  {
+    return (omp_get_max_active_levels() > 1);
+  }
+
   REALM_PUBLIC_API
   void omp_set_num_threads(int num_threads)
   {
@@ -107,10 +203,125 @@ extern "C" {
       log_omp.warning() << "omp_set_num_threads(" << num_threads << ") called on non-OpenMP Realm proessor - ignoring";
     }
   }
+
+  REALM_PUBLIC_API
+  int omp_in_final(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi) {
+      ThreadPool::TaskItem *task = wi->get_current_task();
+      return ((task && task->final) ? 1 : 0);
+    } else
+      return 0;
+  }
 };
 
 // runtime API calls used by compiler to interact with GOMP-style runtime
 #ifdef REALM_OPENMP_GOMP_SUPPORT
+namespace Realm {
+
+  // flags passed by the compiler to GOMP_task and GOMP_taskloop
+  enum {
+    GOMP_TASK_FLAG_UNTIED = 1,
+    GOMP_TASK_FLAG_FINAL = 2,
+    GOMP_TASK_FLAG_MERGEABLE = 4,
+    GOMP_TASK_FLAG_DEPEND = 8,
+    GOMP_TASK_FLAG_PRIORITY = 16,
+    GOMP_TASK_FLAG_UP = 256,
+    GOMP_TASK_FLAG_GRAINSIZE = 512,
+    GOMP_TASK_FLAG_IF = 1024,
+    GOMP_TASK_FLAG_NOGROUP = 2048,
+  };
+
+  // copies a task's arguments into a heap buffer that lives until the
+  //  task has run - 'alloc' is what needs to be free()'d
+  static void *gomp_copy_task_args(void *data, void (*cpyfn)(void *, void *),
+				   long arg_size, long arg_align,
+				   void *&alloc)
+  {
+    if(arg_align < 1) arg_align = 1;
+    alloc = malloc(arg_size + arg_align - 1);
+    assert(alloc != 0);
+    void *args = reinterpret_cast<void *>((reinterpret_cast<uintptr_t>(alloc) +
+					   arg_align - 1) &
+					  ~uintptr_t(arg_align - 1));
+    if(cpyfn)
+      (*cpyfn)(args, data);
+    else
+      memcpy(args, data, arg_size);
+    return args;
+  }
+
+  // templated code for GOMP_taskloop{,_ull} - the first two values in each
+  //  task's arguments are the start and end of its iterations
+  template <typename T>
+  static void gomp_taskloop(void (*fnptr)(void *data), void *data,
+			    void (*cpyfn)(void *, void *),
+			    long arg_size, long arg_align, unsigned flags,
+			    unsigned long num_tasks, T start, T end, T step,
+			    bool up)
+  {
+    // count the iterations, rounding up a partial last step
+    uint64_t count;
+    if(up) {
+      if(start >= end) return;
+      count = (((uint64_t)end - (uint64_t)start) +
+	       ((uint64_t)step - 1)) / (uint64_t)step;
+    } else {
+      if(start <= end) return;
+      count = (((uint64_t)start - (uint64_t)end) +
+	       (-(uint64_t)step - 1)) / -(uint64_t)step;
+    }
+
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+
+    if(flags & GOMP_TASK_FLAG_GRAINSIZE) {
+      // 'num_tasks' is actually the minimum iterations per task
+      uint64_t grainsize = (num_tasks ? num_tasks : 1);
+      num_tasks = count / grainsize;
+      if(num_tasks == 0) num_tasks = 1;
+    } else if(num_tasks == 0)
+      num_tasks = (wi ? wi->num_threads : 1);
+    if(num_tasks > count)
+      num_tasks = count;
+
+    bool deferrable = (wi && (flags & GOMP_TASK_FLAG_IF) &&
+		       wi->work_item && (wi->num_threads > 1));
+    bool group = (wi && !(flags & GOMP_TASK_FLAG_NOGROUP));
+    if(group)
+      wi->start_taskgroup();
+
+    // spread the iterations as evenly as possible
+    uint64_t share = count / num_tasks;
+    uint64_t extra = count - (share * num_tasks);
+    uint64_t pos = 0;
+    for(unsigned long i = 0; i < num_tasks; i++) {
+      uint64_t n = share + ((i < extra) ? 1 : 0);
+      void *alloc;
+      T *args = static_cast<T *>(gomp_copy_task_args(data, cpyfn,
+						     arg_size, arg_align,
+						     alloc));
+      args[0] = (T)((uint64_t)start + (pos * (uint64_t)step));
+      pos += n;
+      args[1] = ((i == (num_tasks - 1)) ?
+		   end :
+		   (T)((uint64_t)start + (pos * (uint64_t)step)));
+      if(wi) {
+	ThreadPool::TaskItem *task = wi->create_task(fnptr, args, alloc,
+						     (flags & GOMP_TASK_FLAG_FINAL) != 0);
+	wi->spawn_task(task, deferrable);
+      } else {
+	(*fnptr)(args);
+	free(alloc);
+      }
+    }
+
+    if(group)
+      wi->end_taskgroup();
+  }
+
+};
+
 extern "C" {
 
   using namespace Realm;
@@ -123,8 +334,12 @@ extern "C" {
     if(!wi)
       return;
 
+    // a nested region reuses whichever pool workers are idle, unless it's
+    //  past the active level limit
     std::set<int> worker_ids;
-    wi->pool->claim_workers(nthreads - 1, worker_ids);
+    if((nthreads != 1) &&
+       (count_active_levels(wi) < wi->pool->max_active_levels.load()))
+      wi->pool->claim_workers(nthreads - 1, worker_ids);
     int act_threads = 1 + worker_ids.size();
 
     ThreadPool::WorkItem *work = new ThreadPool::WorkItem(act_threads);
@@ -152,6 +367,9 @@ extern "C" {
     if(!wi)
       return;
 
+    // the end of the region is a barrier for any explicit tasks
+    wi->drain_tasks();
+
     ThreadPool::WorkItem *work = wi->pop_work_item();
     assert(work != 0);
     // make sure all workers have finished
@@ -203,6 +421,10 @@ extern "C" {
 
     //log_omp.print() << "barrier enter: id=" << wi->thread_id;
 
+    // all explicit tasks of the team have to be done before anybody
+    //  leaves the barrier, so help run them first
+    wi->drain_tasks();
+
     if(wi->work_item && (wi->num_threads > 1)) {
       // step 1: observe that barrier is not still being exited
       int c;
@@ -267,9 +489,53 @@ extern "C" {
     return more;
   }
 
+  static bool gomp_loop_dynamic_start(long start, long end,
+				      long incr, long chunk,
+				      long *istart, long *iend,
+				      bool monotonic)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+    if(!wi) {
+      // give back the whole loop and hope for the best
+      *istart = start;
+      *iend = end;
+      return (start < end);
+    }
+
+    // loops must be inside work items
+    assert(wi->work_item != 0);
+
+    log_omp.debug() << "loop dynamic start: start=" << start
+		    << " end=" << end << " incr=" << incr
+		    << " chunk=" << chunk << " monotonic=" << monotonic;
+
+    wi->work_item->schedule.start_dynamic(start, end, incr, chunk,
+					  wi->thread_id, monotonic);
+    int64_t span_start, span_end;
+    int64_t stride = 0; // not used
+    bool more = wi->work_item->schedule.next_dynamic(span_start, span_end,
+						     stride, wi->thread_id);
+    if(more) {
+      *istart = span_start;
+      *iend = span_end;
+    }
+    return more;
+  }
+
+  // gcc only uses this entry point for schedule(monotonic:dynamic) and
+  //  (before gcc 9) for schedule(dynamic), both of which promise each
+  //  thread its chunks in increasing order
   REALM_PUBLIC_API
   bool GOMP_loop_dynamic_start(long start, long end, long incr, long chunk,
 			       long *istart, long *iend)
+  {
+    return gomp_loop_dynamic_start(start, end, incr, chunk, istart, iend,
+				   true /*monotonic*/);
+  }
+
+  REALM_PUBLIC_API
+  bool GOMP_loop_guided_start(long start, long end, long incr, long chunk,
+			      long *istart, long *iend)
   {
     Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
     if(!wi) {
@@ -282,14 +548,15 @@ extern "C" {
     // loops must be inside work items
     assert(wi->work_item != 0);
 
-    log_omp.debug() << "loop dynamic start: start=" << start
+    log_omp.debug() << "loop guided start: start=" << start
 		    << " end=" << end << " incr=" << incr
 		    << " chunk=" << chunk;
 
-    wi->work_item->schedule.start_dynamic(start, end, incr, chunk);
+    wi->work_item->schedule.start_guided(start, end, incr, chunk);
     int64_t span_start, span_end;
-    long stride = 0; // not used
-    bool more = wi->work_item->schedule.next_dynamic(span_start, span_end, stride);
+    int64_t stride = 0; // not used
+    bool more = wi->work_item->schedule.next_dynamic(span_start, span_end,
+						     stride, wi->thread_id);
     if(more) {
       *istart = span_start;
       *iend = span_end;
@@ -297,6 +564,35 @@ extern "C" {
     return more;
   }
 
+  // newer compilers use the nonmonotonic entry points for schedule(dynamic)
+  //  and schedule(guided) - only these are free to use work stealing
+  REALM_PUBLIC_API
+  bool GOMP_loop_nonmonotonic_dynamic_start(long start, long end,
+					    long incr, long chunk,
+					    long *istart, long *iend)
+  {
+    return gomp_loop_dynamic_start(start, end, incr, chunk, istart, iend,
+				   false /*!monotonic*/);
+  }
+
+  REALM_PUBLIC_API
+  bool GOMP_loop_nonmonotonic_guided_start(long start, long end,
+					   long incr, long chunk,
+					   long *istart, long *iend)
+  {
+    return GOMP_loop_guided_start(start, end, incr, chunk, istart, iend);
+  }
+
+  // there's no OMP_SCHEDULE support, so schedule(runtime) is dynamic (and
+  //  monotonic, since we can't know what schedule the user asked for)
+  REALM_PUBLIC_API
+  bool GOMP_loop_runtime_start(long start, long end, long incr,
+			       long *istart, long *iend)
+  {
+    return gomp_loop_dynamic_start(start, end, incr, 0 /*auto*/,
+				   istart, iend, true /*monotonic*/);
+  }
+
   REALM_PUBLIC_API
   void GOMP_loop_end_nowait(void)
   {
@@ -324,6 +620,8 @@ extern "C" {
 
     log_omp.debug() << "loop end";
 
+    // the implicit barrier has to wait for explicit tasks too
+    wi->drain_tasks();
     wi->work_item->schedule.end_loop(true /*wait*/);
   }
 
@@ -337,7 +635,9 @@ extern "C" {
     // loops must be inside work items
     assert(wi->work_item != 0);
 
-    int64_t span_start, span_end;
+    // the schedule steps from the previous span
+    int64_t span_start = *istart;
+    int64_t span_end = *iend;
     bool more = wi->work_item->schedule.next_static(span_start, span_end);
 
     if(more) {
@@ -366,7 +666,7 @@ extern "C" {
 
     int64_t span_start, span_end, stride;
     bool more = wi->work_item->schedule.next_dynamic(span_start, span_end,
-						     stride);
+						     stride, wi->thread_id);
 
     if(more) {
       *istart = span_start;
@@ -379,6 +679,32 @@ extern "C" {
     return more;
   }
 
+  // the schedule remembers which kind of loop it is, so guided and
+  //  runtime loops continue the same way dynamic ones do
+  REALM_PUBLIC_API
+  bool GOMP_loop_guided_next(long *istart, long *iend)
+  {
+    return GOMP_loop_dynamic_next(istart, iend);
+  }
+
+  REALM_PUBLIC_API
+  bool GOMP_loop_nonmonotonic_dynamic_next(long *istart, long *iend)
+  {
+    return GOMP_loop_dynamic_next(istart, iend);
+  }
+
+  REALM_PUBLIC_API
+  bool GOMP_loop_nonmonotonic_guided_next(long *istart, long *iend)
+  {
+    return GOMP_loop_dynamic_next(istart, iend);
+  }
+
+  REALM_PUBLIC_API
+  bool GOMP_loop_runtime_next(long *istart, long *iend)
+  {
+    return GOMP_loop_dynamic_next(istart, iend);
+  }
+
   static unsigned hash_gomp_critical_name(void **pptr)
   {
     uintptr_t v = reinterpret_cast<uintptr_t>(pptr);
@@ -454,6 +780,100 @@ extern "C" {
   {
     gomp_atomic_mutex.unlock();
   }
+
+  REALM_PUBLIC_API
+  void GOMP_task(void (*fnptr)(void *data), void *data,
+		 void (*cpyfn)(void *, void *),
+		 long arg_size, long arg_align, bool if_clause,
+		 unsigned flags, void **depend, int priority)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+
+    // dependences aren't tracked, so a task with any waits for all of its
+    //  earlier siblings and then runs right away, which satisfies them
+    if(wi && (flags & GOMP_TASK_FLAG_DEPEND)) {
+      wi->wait_for_children();
+      if_clause = false;
+    }
+
+    bool deferrable = (wi && if_clause && wi->work_item &&
+		       (wi->num_threads > 1));
+
+    // tasks that are run right away only need a copy of their arguments
+    //  if the compiler wants to run copy constructors
+    void *alloc = 0;
+    void *args = data;
+    if(deferrable || cpyfn)
+      args = gomp_copy_task_args(data, cpyfn, arg_size, arg_align, alloc);
+
+    if(!wi) {
+      (*fnptr)(args);
+      free(alloc);
+      return;
+    }
+
+    ThreadPool::TaskItem *task = wi->create_task(fnptr, args, alloc,
+						 (flags & GOMP_TASK_FLAG_FINAL) != 0);
+    wi->spawn_task(task, deferrable);
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskwait(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->wait_for_children();
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskyield(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    // a yielding task is suspended just like a waiting one, so it may
+    //  only be replaced by one of its own descendants
+    if(wi)
+      wi->run_queued_task(wi->get_current_task());
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskgroup_start(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->start_taskgroup();
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskgroup_end(void)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->end_taskgroup();
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskloop(void (*fnptr)(void *data), void *data,
+		     void (*cpyfn)(void *, void *),
+		     long arg_size, long arg_align, unsigned flags,
+		     unsigned long num_tasks, int priority,
+		     long start, long end, long step)
+  {
+    gomp_taskloop<long>(fnptr, data, cpyfn, arg_size, arg_align, flags,
+			num_tasks, start, end, step, (step > 0));
+  }
+
+  REALM_PUBLIC_API
+  void GOMP_taskloop_ull(void (*fnptr)(void *data), void *data,
+			 void (*cpyfn)(void *, void *),
+			 long arg_size, long arg_align, unsigned flags,
+			 unsigned long num_tasks, int priority,
+			 unsigned long long start, unsigned long long end,
+			 unsigned long long step)
+  {
+    gomp_taskloop<unsigned long long>(fnptr, data, cpyfn, arg_size, arg_align,
+				      flags, num_tasks, start, end, step,
+				      (flags & GOMP_TASK_FLAG_UP) != 0);
+  }
 };
 #endif
 
@@ -1011,6 +1431,99 @@ namespace Realm {
     }
   };
 
+  // explicit tasks are allocated by the runtime but laid out by the
+  //  compiler - these must match what clang/icc expect
+  struct kmp_task;
+  typedef kmp_int32 (*kmp_routine_entry_t)(kmp_int32 gtid, kmp_task *task);
+
+  union kmp_cmplrdata_t {
+    kmp_int32 priority;
+    kmp_routine_entry_t destructors;
+  };
+
+  typedef struct kmp_task {
+    void *shareds;
+    kmp_routine_entry_t routine;
+    kmp_int32 part_id;
+    kmp_cmplrdata_t data1;
+    kmp_cmplrdata_t data2;
+    // private variables follow, allocated by the runtime
+  } kmp_task_t;
+
+  // flags passed by the compiler to __kmpc_omp_task_alloc
+  enum {
+    KMP_TASK_FLAG_TIED = 1,
+    KMP_TASK_FLAG_FINAL = 2,
+    KMP_TASK_FLAG_MERGED_IF0 = 4,
+    KMP_TASK_FLAG_DESTRUCTORS = 8,
+  };
+
+  // our own bookkeeping sits just in front of each kmp_task_t
+  struct kmp_task_header {
+    size_t task_size;     // sizeof_kmp_task_t passed at allocation
+    size_t shareds_size;
+    kmp_int32 flags;
+    ThreadPool::TaskItem *if0_task;  // set between begin_if0/complete_if0
+  };
+
+  static const size_t KMP_TASK_HEADER_SIZE = ((sizeof(kmp_task_header) + 15) &
+					      ~size_t(15));
+
+  static kmp_task_header *kmp_get_task_header(kmp_task_t *task)
+  {
+    return reinterpret_cast<kmp_task_header *>(reinterpret_cast<char *>(task) -
+					       KMP_TASK_HEADER_SIZE);
+  }
+
+  static kmp_task_t *kmp_allocate_task(size_t task_size, size_t shareds_size,
+				       kmp_int32 flags)
+  {
+    // shareds go after the task (and its privates), pointer-aligned
+    size_t shareds_ofs = ((task_size + sizeof(void *) - 1) &
+			  ~(sizeof(void *) - 1));
+    char *raw = static_cast<char *>(malloc(KMP_TASK_HEADER_SIZE + shareds_ofs +
+					   shareds_size));
+    assert(raw != 0);
+    kmp_task_header *hdr = reinterpret_cast<kmp_task_header *>(raw);
+    hdr->task_size = task_size;
+    hdr->shareds_size = shareds_size;
+    hdr->flags = flags;
+    hdr->if0_task = 0;
+    kmp_task_t *task = reinterpret_cast<kmp_task_t *>(raw + KMP_TASK_HEADER_SIZE);
+    task->shareds = (shareds_size ? (raw + KMP_TASK_HEADER_SIZE + shareds_ofs) : 0);
+    task->part_id = 0;
+    return task;
+  }
+
+  static void kmp_run_destructors(kmp_task_t *task)
+  {
+    if(kmp_get_task_header(task)->flags & KMP_TASK_FLAG_DESTRUCTORS)
+      (*task->data1.destructors)(0, task);
+  }
+
+  // entry point given to the thread pool for queued kmp tasks
+  static void kmp_invoke_task(void *data)
+  {
+    kmp_task_t *task = static_cast<kmp_task_t *>(data);
+    (*task->routine)(0, task);
+    kmp_run_destructors(task);
+  }
+
+  // hands a task to the thread pool, which frees it once it has run
+  static void kmp_spawn_task(kmp_task_t *task, bool deferrable)
+  {
+    kmp_task_header *hdr = kmp_get_task_header(task);
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+    if(!wi) {
+      kmp_invoke_task(task);
+      free(hdr);
+      return;
+    }
+    ThreadPool::TaskItem *item = wi->create_task(kmp_invoke_task, task, hdr,
+						 (hdr->flags & KMP_TASK_FLAG_FINAL) != 0);
+    wi->spawn_task(item, deferrable);
+  }
+
 };
 
 extern "C" {
@@ -1135,7 +1648,8 @@ extern "C" {
     }
 
     std::set<int> worker_ids;
-    if(wi->app_num_threads != 1)
+    if((wi->app_num_threads != 1) &&
+       (count_active_levels(wi) < wi->pool->max_active_levels.load()))
       wi->pool->claim_workers(wi->app_num_threads - 1, worker_ids);
     int act_threads = 1 + worker_ids.size();
 
@@ -1156,6 +1670,7 @@ extern "C" {
     (*invoker)(&thunk);
 
     // and then we immediately clean things up (c.f. GOMP_parallel_end)
+    wi->drain_tasks();
     ThreadPool::WorkItem *work2 = wi->pop_work_item();
     assert(work == work2);
     // make sure all workers have finished
@@ -1214,6 +1729,26 @@ namespace Realm {
 	return;
       }
 
+    case 33 /* kmp_sch_static_chunked */:
+      {
+	if(chunk < 1) chunk = 1;
+	T iters;
+	if(incr > 0) {
+	  iters = 1 + (*pupper - *plower) / incr;
+	} else {
+	  iters = 1 + (*plower - *pupper) / -incr;
+	}
+	T num_chunks = (iters + chunk - 1) / chunk;
+	// chunks are dealt out round-robin - the compiler advances both
+	//  bounds by the stride and stops once the lower bound passes the
+	//  original upper bound, clamping the upper bound itself
+	*plastiter = (((T)(wi->thread_id)) == ((num_chunks - 1) % wi->num_threads));
+	*pstride = incr * chunk * wi->num_threads;
+	*plower += incr * chunk * wi->thread_id;
+	*pupper = *plower + incr * (chunk - 1);
+	return;
+      }
+
     default: assert(false);
     }
   }
@@ -1244,7 +1779,23 @@ namespace Realm {
 		    << " end=" << ub << " incr=" << st
 		    << " chunk=" << chunk;
 
-    wi->work_item->schedule.start_dynamic(lb, ub, st, chunk);
+    // only an explicit monotonic modifier rules out work stealing - a
+    //  dynamic schedule without either modifier is nonmonotonic
+    bool monotonic = ((schedtype & (1 << 29)) != 0);
+
+    // strip the monotonic/nonmonotonic modifier bits
+    switch(schedtype & ~((1 << 29) | (1 << 30))) {
+    case 36 /* kmp_sch_guided_chunked */:
+    case 42 /* kmp_sch_guided_iterative_chunked */:
+    case 43 /* kmp_sch_guided_analytical_chunked */:
+      wi->work_item->schedule.start_guided(lb, ub, st, chunk);
+      break;
+
+    default:
+      wi->work_item->schedule.start_dynamic(lb, ub, st, chunk,
+					    wi->thread_id, monotonic);
+      break;
+    }
   }
 
   // templated code for __kmpc_dispatch_init_{4,4u,8,8u}
@@ -1262,7 +1813,7 @@ namespace Realm {
 
     int64_t span_start, span_end, stride;
     if(wi->work_item->schedule.next_dynamic(span_start, span_end,
-					    stride)) {
+					    stride, wi->thread_id)) {
       log_omp.debug() << "loop dynamic next: start=" << span_start
 		      << " end=" << span_end;
 
@@ -1514,6 +2065,10 @@ extern "C" {
 
     //log_omp.print() << "barrier enter: id=" << wi->thread_id;
 
+    // all explicit tasks of the team have to be done before anybody
+    //  leaves the barrier, so help run them first
+    wi->drain_tasks();
+
     if(wi->work_item && (wi->num_threads > 1)) {
       // step 1: observe that barrier is not still being exited
       int c;
@@ -1595,5 +2150,204 @@ extern "C" {
     assert((orig & mask) != 0);
   }
 
+  REALM_PUBLIC_API
+  kmp_task_t *__kmpc_omp_task_alloc(ident_t *loc, kmp_int32 gtid,
+				    kmp_int32 flags, size_t sizeof_kmp_task_t,
+				    size_t sizeof_shareds,
+				    kmp_routine_entry_t task_entry)
+  {
+    kmp_task_t *task = kmp_allocate_task(sizeof_kmp_task_t, sizeof_shareds,
+					 flags);
+    task->routine = task_entry;
+    return task;
+  }
+
+  REALM_PUBLIC_API
+  kmp_int32 __kmpc_omp_task(ident_t *loc, kmp_int32 gtid, kmp_task_t *new_task)
+  {
+    kmp_spawn_task(new_task, true /*deferrable*/);
+    return 0;
+  }
+
+  // dependences aren't tracked, so a task with any waits for all of its
+  //  earlier siblings and then runs right away, which satisfies them
+  REALM_PUBLIC_API
+  kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc, kmp_int32 gtid,
+				      kmp_task_t *new_task,
+				      kmp_int32 ndeps, void *dep_list,
+				      kmp_int32 ndeps_noalias,
+				      void *noalias_dep_list)
+  {
+    if(ndeps + ndeps_noalias > 0) {
+      Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+      if(wi)
+	wi->wait_for_children();
+    }
+    kmp_spawn_task(new_task, (ndeps + ndeps_noalias) == 0);
+    return 0;
+  }
+
+  REALM_PUBLIC_API
+  void __kmpc_omp_wait_deps(ident_t *loc, kmp_int32 gtid, kmp_int32 ndeps,
+			    void *dep_list, kmp_int32 ndeps_noalias,
+			    void *noalias_dep_list)
+  {
+    if(ndeps + ndeps_noalias > 0) {
+      Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+      if(wi)
+	wi->wait_for_children();
+    }
+  }
+
+  // undeferred tasks (i.e. if(0)) are run by the compiler between these two
+  //  calls
+  REALM_PUBLIC_API
+  void __kmpc_omp_task_begin_if0(ident_t *loc, kmp_int32 gtid,
+				 kmp_task_t *task)
+  {
+    kmp_task_header *hdr = kmp_get_task_header(task);
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+    if(!wi)
+      return;
+    hdr->if0_task = wi->create_task(kmp_invoke_task, task, hdr,
+				    (hdr->flags & KMP_TASK_FLAG_FINAL) != 0);
+    wi->begin_task(hdr->if0_task);
+  }
+
+  REALM_PUBLIC_API
+  void __kmpc_omp_task_complete_if0(ident_t *loc, kmp_int32 gtid,
+				    kmp_task_t *task)
+  {
+    kmp_task_header *hdr = kmp_get_task_header(task);
+    kmp_run_destructors(task);
+    if(hdr->if0_task) {
+      // frees the task along with the TaskItem
+      Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+      wi->end_task(hdr->if0_task);
+    } else
+      free(hdr);
+  }
+
+  REALM_PUBLIC_API
+  kmp_int32 __kmpc_omp_taskwait(ident_t *loc, kmp_int32 gtid)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->wait_for_children();
+    return 0;
+  }
+
+  REALM_PUBLIC_API
+  kmp_int32 __kmpc_omp_taskyield(ident_t *loc, kmp_int32 gtid, int end_part)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->run_queued_task(wi->get_current_task());
+    return 0;
+  }
+
+  REALM_PUBLIC_API
+  void __kmpc_taskgroup(ident_t *loc, kmp_int32 gtid)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->start_taskgroup();
+  }
+
+  REALM_PUBLIC_API
+  void __kmpc_end_taskgroup(ident_t *loc, kmp_int32 gtid)
+  {
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(false);
+    if(wi)
+      wi->end_taskgroup();
+  }
+
+  // the compiler fills in a "pattern" task whose bounds live at 'lb'/'ub'
+  //  (inclusive) - each chunk of iterations gets a copy of it, and the
+  //  pattern itself is never run
+  REALM_PUBLIC_API
+  void __kmpc_taskloop(ident_t *loc, int gtid, kmp_task_t *task, int if_val,
+		       kmp_uint64 *lb, kmp_uint64 *ub, kmp_int64 st,
+		       int nogroup, int sched, kmp_uint64 grainsize,
+		       void *task_dup)
+  {
+    typedef void (*kmp_task_dup_t)(kmp_task_t *dst, kmp_task_t *src,
+				   kmp_int32 lastpriv);
+    kmp_task_header *hdr = kmp_get_task_header(task);
+    size_t lb_ofs = reinterpret_cast<char *>(lb) - reinterpret_cast<char *>(task);
+    size_t ub_ofs = reinterpret_cast<char *>(ub) - reinterpret_cast<char *>(task);
+    kmp_uint64 lower = *lb;
+    kmp_uint64 upper = *ub;
+
+    // trip count, computed the same way as the llvm runtime
+    kmp_uint64 count = 0;
+    if((st > 0) ? (kmp_int64(upper - lower) >= 0) :
+                  (kmp_int64(lower - upper) >= 0)) {
+      if(st == 1)
+	count = upper - lower + 1;
+      else if(st < 0)
+	count = (lower - upper) / kmp_uint64(-st) + 1;
+      else
+	count = (upper - lower) / kmp_uint64(st) + 1;
+    }
+
+    Realm::ThreadPool::WorkerInfo *wi = Realm::ThreadPool::get_worker_info(true);
+
+    kmp_uint64 num_tasks;
+    switch(sched) {
+    case 1:  // grainsize - minimum iterations per task
+      num_tasks = count / (grainsize ? grainsize : 1);
+      break;
+    case 2:  // num_tasks
+      num_tasks = grainsize;
+      break;
+    default:  // same default as the llvm runtime
+      num_tasks = (wi ? wi->num_threads : 1) * 10;
+      break;
+    }
+    if(num_tasks == 0) num_tasks = 1;
+    if(num_tasks > count) num_tasks = count;
+
+    bool group = (wi && !nogroup);
+    if(group)
+      wi->start_taskgroup();
+
+    // spread the iterations as evenly as possible
+    kmp_uint64 share = (num_tasks ? (count / num_tasks) : 0);
+    kmp_uint64 extra = count - (share * num_tasks);
+    kmp_uint64 pos = 0;
+    size_t shareds_ofs = (task->shareds ?
+			  (reinterpret_cast<char *>(task->shareds) -
+			   reinterpret_cast<char *>(task)) :
+			  0);
+    for(kmp_uint64 i = 0; i < num_tasks; i++) {
+      kmp_uint64 n = share + ((i < extra) ? 1 : 0);
+      kmp_task_t *chunk = kmp_allocate_task(hdr->task_size, hdr->shareds_size,
+					    hdr->flags);
+      void *chunk_shareds = chunk->shareds;
+      memcpy(chunk, task, hdr->task_size);
+      chunk->shareds = chunk_shareds;
+      if(chunk_shareds)
+	memcpy(chunk_shareds, reinterpret_cast<char *>(task) + shareds_ofs,
+	       hdr->shareds_size);
+      kmp_uint64 chunk_lb = lower + (pos * kmp_uint64(st));
+      pos += n;
+      kmp_uint64 chunk_ub = lower + ((pos - 1) * kmp_uint64(st));
+      *reinterpret_cast<kmp_uint64 *>(reinterpret_cast<char *>(chunk) + lb_ofs) = chunk_lb;
+      *reinterpret_cast<kmp_uint64 *>(reinterpret_cast<char *>(chunk) + ub_ofs) = chunk_ub;
+      if(task_dup)
+	(*reinterpret_cast<kmp_task_dup_t>(task_dup))(chunk, task,
+						      (i == (num_tasks - 1)) ? 1 : 0);
+      kmp_spawn_task(chunk, (if_val != 0));
+    }
+
+    if(group)
+      wi->end_taskgroup();
+
+    // the pattern task's privates were constructed, so must be destroyed
+    kmp_run_destructors(task);
+    free(hdr);
+  }
+
 };
 #endif
@@ -18,6 +18,9 @@
 
 #include "realm/logging.h"
 
+#include <climits>
+#include <stdlib.h>
+
 namespace Realm {
 
   Logger log_pool("threadpool");
@@ -35,6 +38,11 @@ namespace Realm {
     num_workers = _num_workers;
     loop_pos.store(0);
     loop_barrier.store(0);
+    loop_mode.store(LOOP_STATIC);
+    // an empty range is any with start >= end, so zeroes are fine
+    if(num_workers > 1)
+      steal_ranges.resize(num_workers * STEAL_RANGE_STRIDE,
+			  atomic<uint64_t>(0));
   }
 
   static inline uint64_t index_to_pos(int64_t index,
@@ -62,6 +70,22 @@ namespace Realm {
       return (base - (pos * -incr));
   }
   
+  uint64_t LoopSchedule::compute_limit(int64_t start, int64_t end,
+				       int64_t incr)
+  {
+    // compute the iteration count, dealing with the negative stride cases
+    //  and rounding up when the stride doesn't divide the span
+    if(incr > 0) {
+      if(end <= start) return 0;
+      uint64_t delta = (uint64_t)end - (uint64_t)start;
+      return ((incr == 1) ? delta : ((delta + (incr - 1)) / incr));
+    } else {
+      if(end >= start) return 0;
+      uint64_t delta = (uint64_t)start - (uint64_t)end;
+      return ((incr == -1) ? delta : ((delta + (-incr - 1)) / -incr));
+    }
+  }
+
   bool LoopSchedule::start_static(int64_t start, int64_t end,
 				  int64_t incr, int64_t chunk,
 				  int thread_id,
@@ -70,17 +94,7 @@ namespace Realm {
     // make sure nobody's still on the previous loop
     while(loop_barrier.load() >= num_workers) Thread::yield();
 
-    // compute the loop limit, dealing with the negative stride cases
-    uint64_t limit;
-    if(incr > 0) {
-      limit = ((end >= start) ?
-	         index_to_pos(end, start, incr) :
-	         0);
-    } else {
-      limit = ((end <= start) ?
-	         index_to_pos(end, start, incr) :
-	         0);
-    }
+    uint64_t limit = compute_limit(start, end, incr);
 
     // if the chunk wasn't specified, divide the work as evenly as
     //  possible into a single chunk per thread
@@ -97,6 +111,7 @@ namespace Realm {
     loop_base.store(start);
     loop_incr.store(incr);
     loop_chunk.store(chunk);
+    loop_mode.store(LOOP_STATIC);
 
     // signal that we're in the loop
     loop_barrier.fetch_add(1);
@@ -138,22 +153,13 @@ namespace Realm {
   }
 
   void LoopSchedule::start_dynamic(int64_t start, int64_t end,
-				   int64_t incr, int64_t chunk)
+				   int64_t incr, int64_t chunk,
+				   int thread_id, bool monotonic)
   {
     // make sure nobody's still on the previous loop
     while(loop_barrier.load() >= num_workers) Thread::yield();
 
-    // compute the loop limit, dealing with the negative stride cases
-    uint64_t limit;
-    if(incr > 0) {
-      limit = ((end >= start) ?
-	         index_to_pos(end, start, incr) :
-	         0);
-    } else {
-      limit = ((end <= start) ?
-	         index_to_pos(end, start, incr) :
-	         0);
-    }
+    uint64_t limit = compute_limit(start, end, incr);
 
     // if the chunk wasn't specified, pick a value that aims for ~8
     //  chunks per thread to get some dynamic scheduling goodness
@@ -162,11 +168,18 @@ namespace Realm {
       if(chunk == 0) chunk = 1;
     }
 
-    // if the chunk size is so large that n-1 of the workers can
-    //  cause an overshoot that wraps around, we have a problem
-    uint64_t limit_overshoot = (limit + ((num_workers - 1) *
-					 (uint64_t)chunk));
-    assert(limit_overshoot >= limit);
+    // work stealing needs positions to fit in half a word - larger loops
+    //  (or single-threaded or monotonic ones) use a shared position instead
+    bool stealing = (!monotonic && !steal_ranges.empty() &&
+		     (limit < (uint64_t(1) << 32)));
+
+    if(!stealing) {
+      // if the chunk size is so large that n-1 of the workers can
+      //  cause an overshoot that wraps around, we have a problem
+      uint64_t limit_overshoot = (limit + ((num_workers - 1) *
+					   (uint64_t)chunk));
+      assert(limit_overshoot >= limit);
+    }
 
     // the compiler promises all threads will have the same value, so
     //  everybody can just store knowing that either they're first or
@@ -176,32 +189,148 @@ namespace Realm {
     loop_base.store(start);
     loop_incr.store(incr);
     loop_chunk.store(chunk);
+    loop_mode.store(stealing ? LOOP_STEALING : LOOP_DYNAMIC);
+
+    if(stealing) {
+      // claim this thread's share - every range was left empty by the
+      //  previous loop, so nobody can steal from a worker that hasn't
+      //  gotten here yet
+      uint64_t share = limit / num_workers;
+      uint64_t extra = limit - (share * num_workers);
+      uint64_t lo = ((thread_id * share) +
+		     std::min((uint64_t)thread_id, extra));
+      uint64_t hi = lo + share + ((uint64_t(thread_id) < extra) ? 1 : 0);
+      steal_ranges[thread_id * STEAL_RANGE_STRIDE].store_release((lo << 32) | hi);
+    }
 
     // signal that we're in the loop
     loop_barrier.fetch_add(1);
   }
 
+  void LoopSchedule::start_guided(int64_t start, int64_t end,
+				  int64_t incr, int64_t chunk)
+  {
+    // make sure nobody's still on the previous loop
+    while(loop_barrier.load() >= num_workers) Thread::yield();
+
+    uint64_t limit = compute_limit(start, end, incr);
+
+    // the chunk is the minimum size here
+    if(chunk <= 0)
+      chunk = 1;
+
+    loop_limit.store(limit);
+    loop_base.store(start);
+    loop_incr.store(incr);
+    loop_chunk.store(chunk);
+    loop_mode.store(LOOP_GUIDED);
+
+    // signal that we're in the loop
+    loop_barrier.fetch_add(1);
+  }
+
+  bool LoopSchedule::next_stealing(uint64_t& pos, uint64_t& count,
+				   int thread_id)
+  {
+    const uint64_t LO_MASK = (uint64_t(1) << 32) - 1;
+    uint64_t chunk = loop_chunk.load();
+    atomic<uint64_t>& mine = steal_ranges[thread_id * STEAL_RANGE_STRIDE];
+
+    while(true) {
+      // take a chunk off the front of our own range if we can
+      uint64_t range = mine.load_acquire();
+      uint64_t lo = range >> 32;
+      uint64_t hi = range & LO_MASK;
+      if(lo < hi) {
+	uint64_t take = std::min(chunk, hi - lo);
+	if(mine.compare_exchange(range, ((lo + take) << 32) | hi)) {
+	  pos = lo;
+	  count = take;
+	  return true;
+	}
+	continue;  // lost a race with a thief - try again
+      }
+
+      // our range is empty - steal the back half of someone else's,
+      //  starting with our neighbor to spread thieves out
+      bool stole = false;
+      for(int i = 1; (i < num_workers) && !stole; i++) {
+	int victim = (thread_id + i) % num_workers;
+	atomic<uint64_t>& theirs = steal_ranges[victim * STEAL_RANGE_STRIDE];
+	uint64_t vrange = theirs.load_acquire();
+	while(true) {
+	  uint64_t vlo = vrange >> 32;
+	  uint64_t vhi = vrange & LO_MASK;
+	  if(vlo >= vhi) break;
+	  uint64_t mid = vlo + ((vhi - vlo) / 2);
+	  // don't split ranges that are down to a single chunk
+	  if((vhi - vlo) <= chunk)
+	    mid = vlo;
+	  if(theirs.compare_exchange(vrange, (vlo << 32) | mid)) {
+	    // nobody steals from an empty range, so we can just install
+	    //  the stolen iterations as our own
+	    mine.store_release((mid << 32) | vhi);
+	    stole = true;
+	    break;
+	  }
+	}
+      }
+      if(!stole)
+	return false;
+    }
+  }
+
   bool LoopSchedule::next_dynamic(int64_t& span_start, int64_t& span_end,
-				  int64_t& stride)
+				  int64_t& stride, int thread_id)
   {
     // we use these a bunch, and it's ok to cache them
     int64_t base = loop_base.load();
     int64_t incr = loop_incr.load();
     int64_t chunk = loop_chunk.load();
     uint64_t limit = loop_limit.load();
-      
-    // atomic increment to claim a new chunk
-    uint64_t new_pos = loop_pos.fetch_add(chunk);
 
-    if(new_pos < limit) {
-      uint64_t count = std::min((uint64_t)chunk,
-				(limit - new_pos));
-      span_start = pos_to_index(new_pos, base, incr);
-      span_end = pos_to_index(new_pos + count, base, incr);
-      stride = incr;
-      return true;
-    } else
-      return false;
+    uint64_t new_pos, count;
+    switch(loop_mode.load()) {
+    case LOOP_STEALING:
+      {
+	if(!next_stealing(new_pos, count, thread_id))
+	  return false;
+	break;
+      }
+
+    case LOOP_GUIDED:
+      {
+	// claim a chunk proportional to what's left, splitting the
+	//  remainder among the workers
+	new_pos = loop_pos.load();
+	while(true) {
+	  if(new_pos >= limit)
+	    return false;
+	  uint64_t remaining = limit - new_pos;
+	  count = remaining / num_workers;
+	  if(count < (uint64_t)chunk)
+	    count = std::min((uint64_t)chunk, remaining);
+	  if(loop_pos.compare_exchange(new_pos, new_pos + count))
+	    break;
+	}
+	break;
+      }
+
+    default:
+      {
+	// atomic increment to claim a new chunk
+	new_pos = loop_pos.fetch_add(chunk);
+	if(new_pos >= limit)
+	  return false;
+	count = std::min((uint64_t)chunk, (limit - new_pos));
+	break;
+      }
+    }
+
+    span_start = pos_to_index(new_pos, base, incr);
+    span_end = pos_to_index(new_pos + count, base, incr);
+    stride = incr;
+    return true;
   }
 
   void LoopSchedule::end_loop(bool wait)
@@ -244,12 +373,37 @@ namespace Realm {
   // class ThreadPool::WorkItem
 
   ThreadPool::WorkItem::WorkItem(int _num_threads)
-    : remaining_workers(_num_threads)
+    : num_threads(_num_threads)
+    , remaining_workers(_num_threads)
     , single_winner(-1)
     , barrier_count(0)
     , critical_flags(0)
+    , tasks_pending(0)
   {
     schedule.initialize(_num_threads);
+
+    implicit_tasks = new TaskItem[num_threads];
+    for(int i = 0; i < num_threads; i++) {
+      TaskItem& t = implicit_tasks[i];
+      t.fnptr = 0;
+      t.data = 0;
+      t.alloc = 0;
+      t.parent = 0;
+      t.prev_task = 0;
+      t.group = 0;
+      t.cur_group = 0;
+      t.final = false;
+      t.refcount.store(1);
+    }
+    task_queues = new TaskQueue[num_threads];
+  }
+
+  ThreadPool::WorkItem::~WorkItem(void)
+  {
+    // every explicit task must have been run by the end of the region
+    assert(tasks_pending.load() == 0);
+    delete[] implicit_tasks;
+    delete[] task_queues;
   }
 
 
@@ -261,8 +415,10 @@ namespace Realm {
   {
     new_work->prev_thread_id = thread_id;
     new_work->prev_num_threads = num_threads;
+    new_work->prev_task = current_task;
     new_work->parent_work_item = work_item;
     work_item = new_work;
+    current_task = 0;
   }
 
   ThreadPool::WorkItem *ThreadPool::WorkerInfo::pop_work_item(void)
@@ -270,10 +426,217 @@ namespace Realm {
     WorkItem *old_item = work_item;
     thread_id = old_item->prev_thread_id;
     num_threads = old_item->prev_num_threads;
+    current_task = old_item->prev_task;
     work_item = old_item->parent_work_item;
     return old_item;
   }
 
+  ThreadPool::TaskItem *ThreadPool::WorkerInfo::get_current_task(void)
+  {
+    if(current_task)
+      return current_task;
+    if(work_item)
+      return &work_item->implicit_tasks[thread_id];
+    return 0;
+  }
+
+  ThreadPool::TaskItem *ThreadPool::WorkerInfo::create_task(void (*fnptr)(void *data),
+							    void *data,
+							    void *alloc,
+							    bool final)
+  {
+    TaskItem *parent = get_current_task();
+    TaskItem *task = new TaskItem;
+    task->fnptr = fnptr;
+    task->data = data;
+    task->alloc = alloc;
+    task->parent = parent;
+    task->prev_task = 0;
+    // tasks created by this task's descendants count against the same
+    //  group until one of them starts a group of its own
+    task->group = (parent ? parent->cur_group : 0);
+    task->cur_group = task->group;
+    task->final = final || (parent && parent->final);
+    task->refcount.store(1);
+    if(parent)
+      parent->refcount.fetch_add(1);
+    if(task->group)
+      task->group->pending.fetch_add(1);
+    return task;
+  }
+
+  static void release_task(ThreadPool::TaskItem *task)
+  {
+    // implicit tasks keep their own reference, so never get here
+    if(task && (task->refcount.fetch_sub_acqrel(1) == 1))
+      delete task;
+  }
+
+  void ThreadPool::WorkerInfo::spawn_task(TaskItem *task, bool deferrable)
+  {
+    // run immediately unless there's somebody else to run the task - also
+    //  stop queueing once the team has plenty of work to limit the memory
+    //  held by pending tasks (just as libgomp does)
+    if(!deferrable || task->final || !work_item ||
+       (num_threads == 1) ||
+       (work_item->tasks_pending.load() > (64 * num_threads))) {
+      run_task(task);
+      return;
+    }
+
+    // count the task before anybody can see it so that a drain can't miss it
+    work_item->tasks_pending.fetch_add(1);
+    TaskQueue& q = work_item->task_queues[thread_id];
+    AutoLock<> al(q.mutex);
+    q.tasks.push_back(task);
+  }
+
+  void ThreadPool::WorkerInfo::begin_task(TaskItem *task)
+  {
+    task->prev_task = current_task;
+    current_task = task;
+  }
+
+  void ThreadPool::WorkerInfo::end_task(TaskItem *task)
+  {
+    assert(current_task == task);
+    current_task = task->prev_task;
+
+    if(task->alloc) {
+      free(task->alloc);
+      task->alloc = 0;
+    }
+    if(task->group)
+      task->group->pending.fetch_sub_acqrel(1);
+    // the task may outlive itself until its children are done, but
+    //  its hold on its parent goes away now
+    TaskItem *parent = task->parent;
+    release_task(task);
+    release_task(parent);
+  }
+
+  void ThreadPool::WorkerInfo::run_task(TaskItem *task)
+  {
+    begin_task(task);
+    (task->fnptr)(task->data);
+    end_task(task);
+  }
+
+  static bool is_descendant(const ThreadPool::TaskItem *task,
+			    const ThreadPool::TaskItem *ancestor)
+  {
+    // a queued task holds a reference on its parent, so the whole chain
+    //  stays alive while we walk it
+    for(const ThreadPool::TaskItem *t = task->parent; t; t = t->parent)
+      if(t == ancestor)
+	return true;
+    return false;
+  }
+
+  // removes the newest (back) or oldest (front) task in the queue that
+  //  descends from 'ancestor' (or any task, if 'ancestor' is null)
+  static ThreadPool::TaskItem *take_task(ThreadPool::TaskQueue& q,
+					 bool newest,
+					 const ThreadPool::TaskItem *ancestor)
+  {
+    AutoLock<> al(q.mutex);
+    if(q.tasks.empty())
+      return 0;
+    if(!ancestor) {
+      ThreadPool::TaskItem *task;
+      if(newest) {
+	task = q.tasks.back();
+	q.tasks.pop_back();
+      } else {
+	task = q.tasks.front();
+	q.tasks.pop_front();
+      }
+      return task;
+    }
+    size_t count = q.tasks.size();
+    for(size_t i = 0; i < count; i++) {
+      size_t idx = (newest ? (count - 1 - i) : i);
+      ThreadPool::TaskItem *task = q.tasks[idx];
+      if(is_descendant(task, ancestor)) {
+	q.tasks.erase(q.tasks.begin() + idx);
+	return task;
+      }
+    }
+    return 0;
+  }
+
+  bool ThreadPool::WorkerInfo::run_queued_task(TaskItem *ancestor /*= 0*/)
+  {
+    WorkItem *item = work_item;
+    if(!item || (item->tasks_pending.load() == 0))
+      return false;
+
+    // take the newest task from our own deque first
+    TaskItem *task = take_task(item->task_queues[thread_id],
+			       true /*newest*/, ancestor);
+
+    // then steal the oldest task from another thread, starting with our
+    //  neighbor to spread thieves out
+    for(int i = 1; !task && (i < item->num_threads); i++)
+      task = take_task(item->task_queues[(thread_id + i) % item->num_threads],
+		       false /*!newest*/, ancestor);
+
+    if(!task)
+      return false;
+
+    run_task(task);
+    item->tasks_pending.fetch_sub_acqrel(1);
+    return true;
+  }
+
+  void ThreadPool::WorkerInfo::wait_for_children(void)
+  {
+    TaskItem *task = get_current_task();
+    if(!task)
+      return;
+    // only descendants of the waiting task may run here - anything else
+    //  could end up waiting on this (tied) task and never finish
+    while(task->refcount.load_acquire() > 1)
+      if(!run_queued_task(task))
+	Thread::yield();
+  }
+
+  void ThreadPool::WorkerInfo::start_taskgroup(void)
+  {
+    TaskItem *task = get_current_task();
+    if(!task)
+      return;
+    TaskGroup *group = new TaskGroup;
+    group->parent = task->cur_group;
+    group->pending.store(0);
+    task->cur_group = group;
+  }
+
+  void ThreadPool::WorkerInfo::end_taskgroup(void)
+  {
+    TaskItem *task = get_current_task();
+    if(!task)
+      return;
+    TaskGroup *group = task->cur_group;
+    assert(group != 0);
+    // every task counted by the group descends from this task, and
+    //  those are the only ones we're allowed to run while we wait
+    while(group->pending.load_acquire() > 0)
+      if(!run_queued_task(task))
+	Thread::yield();
+    task->cur_group = group->parent;
+    delete group;
+  }
+
+  void ThreadPool::WorkerInfo::drain_tasks(void)
+  {
+    if(!work_item)
+      return;
+    while(work_item->tasks_pending.load_acquire() > 0)
+      if(!run_queued_task())
+	Thread::yield();
+  }
+
 
   ////////////////////////////////////////////////////////////////////////
   //
@@ -283,7 +646,8 @@ namespace Realm {
 			 const std::string& _name_prefix,
 			 int _numa_node, size_t _stack_size,
 			 CoreReservationSet& crs)
-    : num_workers(_num_workers)
+    : max_active_levels(INT_MAX)
+    , num_workers(_num_workers)
     , workers_running(false)
   {
     // create per-worker core reservations
@@ -314,6 +678,7 @@ namespace Realm {
       wi.fnptr = 0;
       wi.data = 0;
       wi.work_item = 0;
+      wi.current_task = 0;
     }
 
     log_pool.info() << "pool " << (void *)this << " started - " << num_workers << " workers";
@@ -384,6 +749,8 @@ namespace Realm {
 	{
 	  log_pool.info() << "worker " << wi->thread_id << "/" << wi->num_threads << " executing: " << (void *)(wi->fnptr) << "(" << wi->data << ")";
 	  (wi->fnptr)(wi->data);
+	  // the end of the region is a barrier for any explicit tasks
+	  wi->drain_tasks();
 	  log_pool.info() << "worker " << wi->thread_id << "/" << wi->num_threads << " done";
 	  wi->work_item->remaining_workers.fetch_sub_acqrel(1);
 	  wi->status.store(WorkerInfo::WORKER_IDLE);
@@ -489,6 +856,7 @@ namespace Realm {
     wi->fnptr = fnptr;
     wi->data = data;
     wi->work_item = work_item;
+    wi->current_task = 0;
     int expval = WorkerInfo::WORKER_CLAIMED;
     bool ok = wi->status.compare_exchange(expval,
 					  WorkerInfo::WORKER_ACTIVE);
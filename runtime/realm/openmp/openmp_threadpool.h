@@ -19,6 +19,9 @@
 
 #include "realm/threads.h"
 #include "realm/logging.h"
+#include "realm/mutex.h"
+
+#include <deque>
 
 namespace Realm {
 
@@ -43,12 +46,25 @@ namespace Realm {
     // starts a dynamic loop, blocking if the previous loop in the
     //  work item has any stragglers - does not actually request any
     //  work - use next_dynamic for that
+    // each worker starts with an even share of the iterations and claims
+    //  chunks from the front of it, stealing the back half of another
+    //  worker's remaining share once its own is exhausted
+    // a monotonic loop must hand each thread its chunks in increasing
+    //  order, which stealing can't promise, so those claim chunks from a
+    //  shared position instead
     void start_dynamic(int64_t start, int64_t end,
-		       int64_t incr, int64_t chunk);
+		       int64_t incr, int64_t chunk,
+		       int thread_id, bool monotonic);
+
+    // starts a guided loop - like start_dynamic, but chunks are claimed
+    //  from a shared position and shrink in proportion to the number of
+    //  iterations left (never going below 'chunk')
+    void start_guided(int64_t start, int64_t end,
+		      int64_t incr, int64_t chunk);
 
-    // continues a dynamic loop
+    // continues a dynamic or guided loop
     bool next_dynamic(int64_t& span_start, int64_t& span_end,
-		      int64_t& stride);
+		      int64_t& stride, int thread_id);
 
     // indicates this thread is done with the current loop - blocks
     //  if other threads haven't even entered the loop yet
@@ -56,12 +72,27 @@ namespace Realm {
     void end_loop(bool wait);
 
   protected:
+    enum LoopMode {
+      LOOP_STATIC,
+      LOOP_DYNAMIC,  // shared position, fixed chunks
+      LOOP_STEALING, // per-worker ranges, fixed chunks
+      LOOP_GUIDED,   // shared position, decreasing chunks
+    };
+
+    uint64_t compute_limit(int64_t start, int64_t end, int64_t incr);
+    bool next_stealing(uint64_t& pos, uint64_t& count, int thread_id);
+
     int num_workers;
     // loop bounds and position are done with unsigned values to
     //  allow detection of overflow
     atomic<uint64_t> loop_pos, loop_limit;
     atomic<int64_t> loop_base, loop_incr, loop_chunk;
     atomic<int> loop_barrier;
+    atomic<int> /*LoopMode*/ loop_mode;
+    // each worker's remaining range of a work-stealing loop, packed as
+    //  (start << 32) | end and spaced out to avoid false sharing
+    static const size_t STEAL_RANGE_STRIDE = 8;
+    std::vector<atomic<uint64_t> > steal_ranges;
   };
 
   class ThreadPool {
@@ -81,17 +112,53 @@ namespace Realm {
     // entry point for workers - does not return until thread pool is shut down
     void worker_entry(void);
 
+    struct TaskGroup;
+
+    // an explicit (i.e. "omp task") task - it is run by whichever thread
+    //  of the team that created it gets to it first
+    struct TaskItem {
+      void (*fnptr)(void *data);
+      void *data;
+      void *alloc;  // free()'d once the task has run, if non-null
+      TaskItem *parent;  // null for tasks created outside of a team
+      TaskItem *prev_task;  // task the running thread was in before this one
+      TaskGroup *group;  // group this task counts against, if any
+      TaskGroup *cur_group;  // innermost group for tasks this one creates
+      bool final;
+      // one reference for the task itself and one per incomplete child
+      atomic<int> refcount;
+    };
+
+    struct TaskGroup {
+      TaskGroup *parent;
+      atomic<int> pending;
+    };
+
+    // each thread in a team pushes and pops tasks at the back of its own
+    //  deque, while idle threads steal from the front of other deques
+    struct TaskQueue {
+      Mutex mutex;
+      std::deque<TaskItem *> tasks;
+    };
+
     struct WorkItem {
       WorkItem(int _num_threads);
+      ~WorkItem(void);
 
+      int num_threads;
       int prev_thread_id;
       int prev_num_threads;
+      TaskItem *prev_task;
       WorkItem *parent_work_item;
       atomic<int> remaining_workers;
       atomic<int> single_winner;  // worker currently assigned as the "single" one
       atomic<int> barrier_count;
       atomic<uint64_t> critical_flags;
       LoopSchedule schedule;
+      // the implicit task of each thread in the team, and its task deque
+      TaskItem *implicit_tasks;
+      TaskQueue *task_queues;
+      atomic<int> tasks_pending;  // queued or running explicit tasks
     };
 
     struct WorkerInfo {
@@ -112,9 +179,47 @@ namespace Realm {
       void (*fnptr)(void *data);
       void *data;
       WorkItem *work_item;
+      TaskItem *current_task;  // explicit task being run, if any
 
       void push_work_item(WorkItem *new_work);
       WorkItem *pop_work_item(void);
+
+      // returns the explicit task being run by this thread, or the
+      //  thread's implicit task if there isn't one
+      TaskItem *get_current_task(void);
+
+      // creates a child of the current task - 'alloc' (if non-null) is
+      //  free()'d once the task has run
+      TaskItem *create_task(void (*fnptr)(void *data), void *data,
+			    void *alloc, bool final);
+
+      // queues a task for the team if allowed and useful, otherwise runs
+      //  it immediately
+      void spawn_task(TaskItem *task, bool deferrable);
+
+      // runs a task on this thread - begin/end_task are for callers that
+      //  run the task body themselves
+      void run_task(TaskItem *task);
+      void begin_task(TaskItem *task);
+      void end_task(TaskItem *task);
+
+      // runs one queued task of the team (stealing if needed) - returns
+      //  false if there was nothing to run - if 'ancestor' is given, only
+      //  tasks descended from it are considered, which is what keeps a
+      //  thread that is waiting inside a tied task from picking up an
+      //  unrelated task that might in turn wait on the one it suspended
+      bool run_queued_task(TaskItem *ancestor = 0);
+
+      // waits for the children of the current task, running queued
+      //  descendants of the current task while it waits
+      void wait_for_children(void);
+
+      void start_taskgroup(void);
+      void end_taskgroup(void);
+
+      // runs queued tasks until the team has no explicit tasks left -
+      //  used at barriers and the end of a parallel region
+      void drain_tasks(void);
     };
       
     // returns the WorkerInfo (if any) associated with the caller (which
@@ -137,6 +242,11 @@ namespace Realm {
 
     int get_num_workers() const { return num_workers; }
 
+    // parallel regions nested more than this many active (i.e. more than
+    //  one thread) levels deep are given a single thread - nested regions
+    //  otherwise claim whichever workers are idle at the time
+    atomic<int> max_active_levels;
+
   protected:
     int num_workers;
     bool workers_running;
@@ -331,19 +331,10 @@ namespace Realm {
   // class OperationTable::TableEntry
   //
 
-#if 0
-  OperationTable::TableEntry::TableEntry(Event _finish_event)
-    : finish_event(_finish_event)
-    , local_op(0)
-    , remote_node(-1)
-    , pending_cancellation(false)
-  {}
-#endif
-
   void OperationTable::TableEntry::event_triggered(bool poisoned,
 						   TimeLimit work_until)
   {
-    table->event_triggered(finish_event);
+    table->event_triggered(this);
   }
 
   void OperationTable::TableEntry::print(std::ostream& os) const
@@ -357,49 +348,68 @@ namespace Realm {
   }
 
 
-#if 0
   ////////////////////////////////////////////////////////////////////////
   //
-  // class OperationTable::TableCleaner
+  // class OperationTable
   //
 
-  OperationTable::TableCleaner::TableCleaner(OperationTable *_table)
-    : table(_table)
-  {}
+  OperationTable::OperationTable(void)
+  {
+#ifdef REALM_USE_OPERATION_TABLE
+    mutexes = new Mutex[NUM_LOCKS];
+    buckets = new TableEntry *[NUM_BUCKETS];
+    for(size_t i = 0; i < NUM_BUCKETS; i++)
+      buckets[i] = 0;
+#endif
+  }
 
-  bool OperationTable::TableCleaner::event_triggered(Event e, bool poisoned)
+  OperationTable::~OperationTable(void)
   {
-    table->event_triggered(e);
-    return false;  // never delete us
+#ifdef REALM_USE_OPERATION_TABLE
+    delete[] buckets;
+    delete[] mutexes;
+#endif
   }
 
-  void OperationTable::TableCleaner::print(std::ostream& os) const
+#ifdef REALM_USE_OPERATION_TABLE
+  /*static*/ size_t OperationTable::bucket_index(Event finish_event)
   {
-    os << "operation table cleaner (table=" << table << ")";
+    // consecutive events differ only in a few low bits (or only in the
+    //  generation), so mix all of the id's bits into the top ones
+    uint64_t h = finish_event.id * 0x9E3779B97F4A7C15ULL;
+    return (h >> (64 - LOG2_NUM_BUCKETS));
   }
 
-  Event OperationTable::TableCleaner::get_finish_event(void) const
+  Mutex& OperationTable::bucket_mutex(size_t index)
   {
-    return Event::NO_EVENT;
+    return mutexes[index % NUM_LOCKS];
   }
-#endif
 
+  OperationTable::TableEntry *OperationTable::lookup_entry(size_t index,
+							   Event finish_event)
+  {
+    for(TableEntry *e = buckets[index]; e; e = e->next_in_bucket)
+      if(e->finish_event == finish_event)
+	return e;
+    return 0;
+  }
 
-  ////////////////////////////////////////////////////////////////////////
-  //
-  // class OperationTable
-  //
+  void OperationTable::link_entry(size_t index, TableEntry *entry)
+  {
+    entry->next_in_bucket = buckets[index];
+    if(entry->next_in_bucket)
+      entry->next_in_bucket->prev_in_bucket = &entry->next_in_bucket;
+    entry->prev_in_bucket = &buckets[index];
+    buckets[index] = entry;
+  }
 
-  OperationTable::OperationTable(void)
-#ifdef REALM_USE_OPERATION_TABLE
-#if 0
-    : cleaner(this)
-#endif
+  void OperationTable::unlink_entry(TableEntry *entry)
+  {
+    *(entry->prev_in_bucket) = entry->next_in_bucket;
+    if(entry->next_in_bucket)
+      entry->next_in_bucket->prev_in_bucket = entry->prev_in_bucket;
+  }
 #endif
-  {}
-
-  OperationTable::~OperationTable(void)
-  {}
 
   // Operations are 'owned' by the table - the table will free them once it
   //  gets the completion event for it
@@ -409,64 +419,29 @@ namespace Realm {
     // cast local_op to void * to avoid pretty-printing
     log_optable.info() << "event " << finish_event << " added: local_op=" << (void *)local_op;
 
-    // "hash" the id to figure out which subtable to use
-    int subtable = finish_event.id % NUM_TABLES;
-    Mutex& mutex = mutexes[subtable];
-    Table& table = tables[subtable];
+    // the entry lives in the operation and inherits the caller's reference
+    TableEntry *entry = &local_op->table_entry;
+    entry->table = this;
+    entry->finish_event = finish_event;
+    entry->local_op = local_op;
+    entry->remote_node = -1;
 
-    bool cancel_immediately = false;
-    void *reason_data = 0;
-    size_t reason_size = 0;
-    TableEntry *entry = 0;
+    size_t index = bucket_index(finish_event);
     {
-      AutoLock<> al(mutex);
-
-      // see if we have any info for this event?
-      Table::iterator it = table.find(finish_event);
-      if(it == table.end()) {
-	// new entry - create one and it inherits the refcount
-	TableEntry& e = table[finish_event];
-	e.local_op = local_op;
-	e.remote_node = -1;
-	e.pending_cancellation = false;
-	e.reason_data = 0;
-	e.reason_size = 0;
-	e.table = this;
-	e.finish_event = finish_event;
-	entry = &e;
-      } else {
-	// existing entry should only occur if there's a pending cancellation
-	TableEntry& e = it->second;
-	assert(e.local_op == 0);
-	assert(e.remote_node == -1);
-	assert(e.pending_cancellation);
-	assert(e.table == this);
-	assert(e.finish_event == finish_event);
-
-	// put the operation in the table in case anybody else comes along while we're trying to
-	//  cancel it - add a reference since we're keeping one
-	e.local_op = local_op;
-	entry = &e;
-	local_op->add_reference();
-	cancel_immediately = true;
-	reason_data = e.reason_data;
-	reason_size = e.reason_size;
-      }
-    }
+      AutoLock<> al(bucket_mutex(index));
 
-    // either way there's an entry in the table for this now, so make sure our cleaner knows
-    //  to clean it up
-    EventImpl::add_waiter(finish_event, entry/*&cleaner*/);
+      // no duplicates allowed here - a cancellation request that arrives
+      //  before the operation is added is ignored (checking walks the
+      //  whole chain, which gets long with many operations in flight)
+#ifdef DEBUG_REALM
+      assert(lookup_entry(index, finish_event) == 0);
+#endif
 
-    // and finally, perform a delayed cancellation if requested
-    if(cancel_immediately) {
-      bool did_cancel = local_op->attempt_cancellation(Realm::Faults::ERROR_CANCELLED,
-						       reason_data, reason_size);
-      if(reason_data)
-	free(reason_data);
-      log_optable.info() << "event " << finish_event << " - operation " << (void *)local_op << " cancelled=" << did_cancel;
-      local_op->remove_reference();
+      link_entry(index, entry);
     }
+
+    // the entry removes itself once the operation is complete
+    EventImpl::add_waiter(finish_event, entry);
 #endif
   }
 
@@ -475,61 +450,50 @@ namespace Realm {
 #ifdef REALM_USE_OPERATION_TABLE
     log_optable.info() << "event " << finish_event << " added: remote_node=" << remote_node;
 
-    // "hash" the id to figure out which subtable to use
-    int subtable = finish_event.id % NUM_TABLES;
-    Mutex& mutex = mutexes[subtable];
-    Table& table = tables[subtable];
-    TableEntry *entry = 0;
+    TableEntry *entry = new TableEntry;
+    entry->table = this;
+    entry->finish_event = finish_event;
+    entry->local_op = 0;
+    entry->remote_node = remote_node;
 
+    size_t index = bucket_index(finish_event);
     {
-      AutoLock<> al(mutex);
+      AutoLock<> al(bucket_mutex(index));
 
       // no duplicates allowed here - a local cancellation request cannot occur until we
       //  return
-      assert(table.find(finish_event) == table.end());
-
-      TableEntry& e = table[finish_event];
-      e.local_op = 0;
-      e.remote_node = remote_node;
-      e.pending_cancellation = false;
-      e.reason_data = 0;
-      e.reason_size = 0;
-      e.table = this;
-      e.finish_event = finish_event;
-      entry = &e;
+#ifdef DEBUG_REALM
+      assert(lookup_entry(index, finish_event) == 0);
+#endif
+
+      link_entry(index, entry);
     }
 
     // we can remove this entry once we know the operation is complete
-    EventImpl::add_waiter(finish_event, entry/*&cleaner*/);
+    EventImpl::add_waiter(finish_event, entry);
 #endif
   }
 
-  void OperationTable::event_triggered(Event finish_event)
+  void OperationTable::event_triggered(TableEntry *entry)
   {
 #ifdef REALM_USE_OPERATION_TABLE
-    // "hash" the id to figure out which subtable to use
-    int subtable = finish_event.id % NUM_TABLES;
-    Mutex& mutex = mutexes[subtable];
-    Table& table = tables[subtable];
-
-    Operation *local_op = 0;
+    Event finish_event = entry->finish_event;
+    size_t index = bucket_index(finish_event);
     {
-      AutoLock<> al(mutex);
-
-      // get the entry - it must exist
-      Table::iterator it = table.find(finish_event);
-      assert(it != table.end());
+      AutoLock<> al(bucket_mutex(index));
 
-      // if there was a local op, remember it so we can remove the reference outside of this mutex
-      local_op = it->second.local_op;
-
-      table.erase(it);
+      unlink_entry(entry);
     }
 
+    // if there was a local op, remove our reference outside of the mutex -
+    //  this may delete the entry along with the operation
+    Operation *local_op = entry->local_op;
     log_optable.info() << "event " << finish_event << " cleaned: local_op=" << (void *)local_op;
 
     if(local_op)
       local_op->remove_reference();
+    else
+      delete entry;
 #else
     assert(0);
 #endif
@@ -539,30 +503,26 @@ namespace Realm {
 					    const void *reason_data, size_t reason_size)
   {
 #ifdef REALM_USE_OPERATION_TABLE
-    // "hash" the id to figure out which subtable to use
-    int subtable = finish_event.id % NUM_TABLES;
-    Mutex& mutex = mutexes[subtable];
-    Table& table = tables[subtable];
+    size_t index = bucket_index(finish_event);
 
     bool found = false;
     Operation *local_op = 0;
     int remote_node = -1;
     {
-      AutoLock<> al(mutex);
+      AutoLock<> al(bucket_mutex(index));
 
-      Table::iterator it = table.find(finish_event);
+      TableEntry *entry = lookup_entry(index, finish_event);
 
-      if(it != table.end()) {
+      if(entry) {
 	found = true;
 
 	// if there's a local op, we need to take a reference in case it completes successfully
 	//  before we get to it below
-	if(it->second.local_op) {
-	  local_op = it->second.local_op;
+	if(entry->local_op) {
+	  local_op = entry->local_op;
 	  local_op->add_reference();
 	}
-	remote_node = it->second.remote_node;
-	assert(!it->second.pending_cancellation);
+	remote_node = entry->remote_node;
       }
     }
 
@@ -602,29 +562,26 @@ namespace Realm {
   void OperationTable::set_priority(Event finish_event, int new_priority)
   {
 #ifdef REALM_USE_OPERATION_TABLE
-    // "hash" the id to figure out which subtable to use
-    int subtable = finish_event.id % NUM_TABLES;
-    Mutex& mutex = mutexes[subtable];
-    Table& table = tables[subtable];
+    size_t index = bucket_index(finish_event);
 
     bool found = false;
     Operation *local_op = 0;
     int remote_node = -1;
     {
-      AutoLock<> al(mutex);
+      AutoLock<> al(bucket_mutex(index));
 
-      Table::iterator it = table.find(finish_event);
+      TableEntry *entry = lookup_entry(index, finish_event);
 
-      if(it != table.end()) {
+      if(entry) {
 	found = true;
 
 	// if there's a local op, we need to take a reference in case it completes successfully
 	//  before we get to it below
-	if(it->second.local_op) {
-	  local_op = it->second.local_op;
+	if(entry->local_op) {
+	  local_op = entry->local_op;
 	  local_op->add_reference();
 	}
-	remote_node = it->second.remote_node;
+	remote_node = entry->remote_node;
       }
     }
 
@@ -666,21 +623,16 @@ namespace Realm {
 #ifdef REALM_USE_OPERATION_TABLE
     os << "OperationTable(node=" << Network::my_node_id << ") {\n";
 
-    for(int subtable = 0; subtable < NUM_TABLES; subtable++) {
-      Mutex& mutex = mutexes[subtable];
-      Table& table = tables[subtable];
-
-      // taking the lock on the subtable also guarantees that none of the
-      //  operations in the subtable will be deleted during our iteration
-      AutoLock<> al(mutex);
+    for(size_t index = 0; index < NUM_BUCKETS; index++) {
+      // taking the lock on the bucket also guarantees that none of the
+      //  operations in the bucket will be deleted during our iteration
+      AutoLock<> al(bucket_mutex(index));
 
-      for(Table::const_iterator it = table.begin();
-	  it != table.end();
-	  ++it) {
-	if(it->second.local_op) {
-	  os << "  " << it->first << ": " << it->second.local_op << "\n";
+      for(const TableEntry *e = buckets[index]; e; e = e->next_in_bucket) {
+	if(e->local_op) {
+	  os << "  " << e->finish_event << ": " << e->local_op << "\n";
 	} else {
-	  os << "  " << it->first << ": remote - node=" << it->second.remote_node << "\n";
+	  os << "  " << e->finish_event << ": remote - node=" << e->remote_node << "\n";
 	}
       }
     }
@@ -695,33 +647,27 @@ namespace Realm {
     std::vector<Event> remote_completions;
     int errors = 0;
 
-    for(int subtable = 0; subtable < NUM_TABLES; subtable++) {
-      Mutex& mutex = mutexes[subtable];
-      Table& table = tables[subtable];
-
-      // taking the lock on the subtable also guarantees that none of the
-      //  operations in the subtable will be deleted during our iteration
-      AutoLock<> al(mutex);
-
-      if(!table.empty())
-	for(Table::const_iterator it = table.begin();
-	    it != table.end();
-	    ++it) {
-	  // tolerate races between shutdown and table cleaners - this is
-	  //  safe because we won't destroy the operation table until all the
-	  //  threads running cleaners are stopped
-	  if(it->second.finish_event.has_triggered()) continue;
-
-	  if(it->second.local_op) {
-	    log_optable.error() << "operation pending during shutdown: "
-				<< it->first << " = " << it->second.local_op;
-	    errors++;
-	  } else {
-	    log_optable.info() << "awaiting remote op completion during shutdown: node=" << it->second.remote_node << " event=" << it->second.finish_event;
-	    remote_completions.push_back(it->second.finish_event);
-	    it->second.finish_event.subscribe();
-	  }
+    for(size_t index = 0; index < NUM_BUCKETS; index++) {
+      // taking the lock on the bucket also guarantees that none of the
+      //  operations in the bucket will be deleted during our iteration
+      AutoLock<> al(bucket_mutex(index));
+
+      for(const TableEntry *e = buckets[index]; e; e = e->next_in_bucket) {
+	// tolerate races between shutdown and table cleaners - this is
+	//  safe because we won't destroy the operation table until all the
+	//  threads running cleaners are stopped
+	if(e->finish_event.has_triggered()) continue;
+
+	if(e->local_op) {
+	  log_optable.error() << "operation pending during shutdown: "
+			      << e->finish_event << " = " << e->local_op;
+	  errors++;
+	} else {
+	  log_optable.info() << "awaiting remote op completion during shutdown: node=" << e->remote_node << " event=" << e->finish_event;
+	  remote_completions.push_back(e->finish_event);
+	  e->finish_event.subscribe();
 	}
+      }
     }
 
     if(errors > 0) {
@@ -27,6 +27,71 @@
 
 namespace Realm {
 
+  class Operation;
+
+  class OperationTable {
+  public:
+    OperationTable(void);
+    ~OperationTable(void);
+
+    // Operations are 'owned' by the table - the table will free them once it
+    //  gets the completion event for it
+    void add_local_operation(Event finish_event, Operation *local_op);
+    void add_remote_operation(Event finish_event, int remote_note);
+
+    void request_cancellation(Event finish_event, const void *reason_data, size_t reason_size);
+
+    void set_priority(Event finish_event, int new_priority);
+
+    void print_operations(std::ostream& os);
+    
+    static void register_handlers(void);
+
+    // checks that all operations have finished before shutdown
+    void shutdown_check(void);
+
+    // entries are intrusive - a local operation carries its own (see
+    //  Operation::table_entry), so only remote operations allocate one
+    struct TableEntry : public EventWaiter {
+      virtual void event_triggered(bool poisoned, TimeLimit work_until);
+      virtual void print(std::ostream& os) const;
+      virtual Event get_finish_event(void) const;
+
+      OperationTable *table;
+      Event finish_event;
+      Operation *local_op;
+      int remote_node;
+      // the pointer that points at this entry (the bucket head or the
+      //  previous entry's next_in_bucket), so that unlinking a finished
+      //  operation doesn't have to walk the chain
+      TableEntry *next_in_bucket;
+      TableEntry **prev_in_bucket;
+    };
+
+  protected:
+    void event_triggered(TableEntry *entry);
+
+#ifdef REALM_USE_OPERATION_TABLE
+    // in-flight operations are hashed by finish event into chained buckets,
+    //  and each lock covers every NUM_LOCKS'th bucket - with this many locks,
+    //  unrelated operations rarely contend
+    static const unsigned LOG2_NUM_BUCKETS = 12;
+    static const size_t NUM_BUCKETS = size_t(1) << LOG2_NUM_BUCKETS;
+    static const size_t NUM_LOCKS = 256;
+
+    static size_t bucket_index(Event finish_event);
+    Mutex& bucket_mutex(size_t index);
+
+    // caller must hold the bucket's lock
+    TableEntry *lookup_entry(size_t index, Event finish_event);
+    void link_entry(size_t index, TableEntry *entry);
+    void unlink_entry(TableEntry *entry);
+
+    Mutex *mutexes;
+    TableEntry **buckets;
+#endif
+  };
+
   class Operation {
   protected:
     // must be subclassed
@@ -140,69 +205,11 @@ namespace Realm {
     atomic<int> failed_work_items;
     
     friend std::ostream& operator<<(std::ostream& os, Operation *op);
-  };
-
-  class OperationTable {
-  public:
-    OperationTable(void);
-    ~OperationTable(void);
-
-    // Operations are 'owned' by the table - the table will free them once it
-    //  gets the completion event for it
-    void add_local_operation(Event finish_event, Operation *local_op);
-    void add_remote_operation(Event finish_event, int remote_note);
-
-    void request_cancellation(Event finish_event, const void *reason_data, size_t reason_size);
-
-    void set_priority(Event finish_event, int new_priority);
 
-    void print_operations(std::ostream& os);
-    
-    static void register_handlers(void);
-
-    // checks that all operations have finished before shutdown
-    void shutdown_check(void);
-
-  protected:
-    void event_triggered(Event e);
-
-#if 0
-    class TableCleaner : public EventWaiter {
-    public:
-      TableCleaner(OperationTable *_table);
-      virtual bool event_triggered(bool poisoned);
-      virtual void print(std::ostream& os) const;
-      virtual Event get_finish_event(void) const;
-
-    protected:
-      OperationTable *table;
-    };
-#endif
-
-    struct TableEntry : public EventWaiter {
-      virtual void event_triggered(bool poisoned, TimeLimit work_until);
-      virtual void print(std::ostream& os) const;
-      virtual Event get_finish_event(void) const;
-
-      OperationTable *table;
-      Event finish_event;
-      Operation *local_op;
-      int remote_node;
-      bool pending_cancellation;
-      void *reason_data;
-      size_t reason_size;
-    };
-    typedef std::map<Event, TableEntry> Table;
-
-#ifdef REALM_USE_OPERATION_TABLE
-    // event table is protected by a mutex
-    // try to avoid a serial bottleneck by splitting events over 4 different tables
-    static const int NUM_TABLES = 4;
-    
-    Mutex mutexes[NUM_TABLES];
-    Table tables[NUM_TABLES];
-    //TableCleaner cleaner;
-#endif
+    // the operation table keeps the operation in this entry while it's in
+    //  flight
+    friend class OperationTable;
+    OperationTable::TableEntry table_entry;
   };
 
   struct CancelOperationMessage {
@@ -45,6 +45,13 @@ namespace Realm {
     // if nonzero, prevents application thread from yielding execution
     //  resources on an Event wait
     REALM_THREAD_LOCAL int scheduler_lock = 0;
+
+    REALM_THREAD_LOCAL int spawn_batch_depth = 0;
+  };
+
+  namespace Config {
+    int remote_spawn_batch_window = 0;
+    size_t remote_spawn_batch_bytes = 16 << 10;
   };
 
     Processor::Kind Processor::kind(void) const
@@ -413,6 +420,18 @@ namespace Realm {
     ThreadLocal::scheduler_lock--;
   }
 
+  /*static*/ void Processor::begin_spawn_batch(void)
+  {
+    ThreadLocal::spawn_batch_depth++;
+  }
+
+  /*static*/ void Processor::end_spawn_batch(void)
+  {
+    assert(ThreadLocal::spawn_batch_depth > 0);
+    if(--ThreadLocal::spawn_batch_depth == 0)
+      get_runtime()->spawn_batcher.flush_thread_batches();
+  }
+
 
   ////////////////////////////////////////////////////////////////////////
   //
@@ -767,6 +786,10 @@ namespace Realm {
 			 << " finish=" << e;
 
 	get_runtime()->optable.add_remote_operation(e, target);
+	if(get_runtime()->spawn_batcher.add_spawn(me, target, func_id,
+						  args, arglen, reqs,
+						  start_event, e, priority))
+	  return;
 	Serialization::ByteCountSerializer bcs;
 	{
 	  bool ok = (bcs.append_bytes(args, arglen) &&
@@ -945,6 +968,10 @@ namespace Realm {
       }
 
       get_runtime()->optable.add_remote_operation(e, target);
+      if(get_runtime()->spawn_batcher.add_spawn(me, target, func_id,
+						args, arglen, reqs,
+						start_event, e, priority))
+	return;
       Serialization::ByteCountSerializer bcs;
       {
 	bool ok = (bcs.append_bytes(args, arglen) &&
@@ -1386,6 +1413,338 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SpawnTaskBatchMessage
+  //
+  /*static*/ void SpawnTaskBatchMessage::handle_message(NodeID sender,
+							   const SpawnTaskBatchMessage &args,
+							   const void *data,
+							   size_t datalen)
+  {
+    DetailedTimer::ScopedPush sp(TIME_LOW_LEVEL);
+    ProcessorImpl *p = get_runtime()->get_processor_impl(args.proc);
+
+    log_task.debug() << "received remote spawn batch:"
+		     << " proc=" << args.proc
+		     << " tasks=" << args.num_tasks;
+
+    Serialization::FixedBufferDeserializer fbd(data, datalen);
+
+    // tasks whose preconditions have already triggered are handed to the
+    //  processor in a single enqueue - anything else takes the normal spawn
+    //  path so that it can be deferred (or cancelled if poisoned)
+    Task::TaskList ready_tasks;
+    size_t num_ready = 0;
+    Task *ready_head = 0;
+
+    for(unsigned i = 0; i < args.num_tasks; i++) {
+      Event start_event, finish_event;
+      int priority;
+      Processor::TaskFuncID func_id;
+      size_t arglen;
+      bool ok = ((fbd >> start_event) &&
+		 (fbd >> finish_event) &&
+		 (fbd >> priority) &&
+		 (fbd >> func_id) &&
+		 (fbd >> arglen));
+      assert(ok);
+
+      const void *taskargs = fbd.peek_bytes(arglen);
+      ProfilingRequestSet prs;
+      ok = (fbd.extract_bytes(0, arglen) &&
+	    (fbd >> prs));
+      assert(ok);
+
+      GenEventImpl *finish_impl = get_runtime()->get_genevent_impl(finish_event);
+      EventImpl::gen_t finish_gen = ID(finish_event).event_generation();
+
+      bool ready = true;
+      if(start_event.exists()) {
+	EventImpl *start_impl = get_runtime()->get_event_impl(start_event);
+	bool poisoned = false;
+	ready = (start_impl->has_triggered(ID(start_event).event_generation(),
+					   poisoned) &&
+		 !poisoned);
+      }
+
+      if(!ready) {
+	p->spawn_task(func_id, taskargs, arglen, prs,
+		      start_event, finish_impl, finish_gen, priority);
+	continue;
+      }
+
+      Task *task = new Task(args.proc, func_id, taskargs, arglen, prs,
+			    start_event, finish_impl, finish_gen, priority);
+      get_runtime()->optable.add_local_operation(finish_event, task);
+      // enqueue_tasks only marks the first task ready, so the rest are
+      //  chained to it just like a deferred spawn group
+      if(ready_head)
+	task->join_ready_group(ready_head);
+      else
+	ready_head = task;
+      ready_tasks.push_back(task);
+      num_ready++;
+    }
+    assert(fbd.bytes_left() == 0);
+
+    if(num_ready > 0)
+      p->enqueue_tasks(ready_tasks, num_ready);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class RemoteSpawnBatcher
+  //
+
+  RemoteSpawnBatcher::PendingBatch::PendingBatch(NodeID _target)
+    : target(_target)
+    , num_tasks(0)
+    , first_spawn_time(Clock::current_time_in_nanoseconds())
+    , dbs(4096)
+  {}
+
+  /*static*/ REALM_THREAD_LOCAL std::map<Processor, RemoteSpawnBatcher::PendingBatch *> *RemoteSpawnBatcher::thread_batches = 0;
+
+  RemoteSpawnBatcher::RemoteSpawnBatcher(void)
+    : condvar(mutex)
+    , shutdown_flag(false)
+    , timer_rsrv(0)
+    , timer_thread(0)
+  {}
+
+  RemoteSpawnBatcher::~RemoteSpawnBatcher(void)
+  {
+    assert(pending.empty());
+    assert(timer_thread == 0);
+  }
+
+  bool RemoteSpawnBatcher::add_spawn(Processor proc, NodeID target,
+				     Processor::TaskFuncID func_id,
+				     const void *args, size_t arglen,
+				     const ProfilingRequestSet &reqs,
+				     Event start_event, Event finish_event,
+				     int priority)
+  {
+    bool explicit_batch = (ThreadLocal::spawn_batch_depth > 0);
+    if(!explicit_batch && (timer_thread == 0))
+      return false;
+
+    // a spawn that doesn't fit in a batch on its own is sent by itself, but
+    //  not ahead of anything already batched for the same processor
+    size_t max_bytes = std::min(Config::remote_spawn_batch_bytes,
+				ActiveMessage<SpawnTaskBatchMessage>::recommended_max_payload(target, false /*!with_congestion*/));
+    Serialization::ByteCountSerializer bcs;
+    {
+      bool ok = ((bcs << start_event) &&
+		 (bcs << finish_event) &&
+		 (bcs << priority) &&
+		 (bcs << func_id) &&
+		 (bcs << arglen) &&
+		 bcs.append_bytes(args, arglen) &&
+		 (bcs << reqs));
+      assert(ok);
+    }
+    if(bcs.bytes_used() > max_bytes) {
+      if(thread_batches) {
+	std::map<Processor, PendingBatch *>::iterator it = thread_batches->find(proc);
+	if(it != thread_batches->end()) {
+	  send_batch(proc, it->second);
+	  thread_batches->erase(it);
+	}
+      }
+      flush_timed_batch(proc);
+      return false;
+    }
+
+    PendingBatch *full_batch = 0;
+    PendingBatch *batch;
+    if(explicit_batch) {
+      // only this thread touches its explicit batches, so no lock needed
+      if(!thread_batches)
+	thread_batches = new std::map<Processor, PendingBatch *>;
+      PendingBatch *&tbatch = (*thread_batches)[proc];
+      if(tbatch && ((tbatch->dbs.bytes_used() + bcs.bytes_used()) > max_bytes)) {
+	full_batch = tbatch;
+	tbatch = 0;
+      }
+      if(!tbatch) {
+	// anything queued for this processor in a shared batch must go first
+	if(timer_thread != 0)
+	  flush_timed_batch(proc);
+	tbatch = new PendingBatch(target);
+      }
+      batch = tbatch;
+    } else {
+      AutoLock<> al(mutex);
+
+      PendingBatch *&sbatch = pending[proc];
+      if(sbatch && ((sbatch->dbs.bytes_used() + bcs.bytes_used()) > max_bytes)) {
+	full_batch = sbatch;
+	sbatch = 0;
+      }
+      if(!sbatch) {
+	sbatch = new PendingBatch(target);
+	// the timer thread sleeps indefinitely when there's nothing pending
+	if(pending.size() == 1)
+	  condvar.signal();
+      }
+      batch = sbatch;
+
+      // fill the shared batch while holding the lock so that the timer
+      //  thread doesn't send it out from under us
+      bool ok = ((batch->dbs << start_event) &&
+		 (batch->dbs << finish_event) &&
+		 (batch->dbs << priority) &&
+		 (batch->dbs << func_id) &&
+		 (batch->dbs << arglen) &&
+		 batch->dbs.append_bytes(args, arglen) &&
+		 (batch->dbs << reqs));
+      assert(ok);
+      batch->num_tasks++;
+      batch = 0;
+    }
+
+    if(batch) {
+      bool ok = ((batch->dbs << start_event) &&
+		 (batch->dbs << finish_event) &&
+		 (batch->dbs << priority) &&
+		 (batch->dbs << func_id) &&
+		 (batch->dbs << arglen) &&
+		 batch->dbs.append_bytes(args, arglen) &&
+		 (batch->dbs << reqs));
+      assert(ok);
+      batch->num_tasks++;
+    }
+
+    if(full_batch)
+      send_batch(proc, full_batch);
+
+    return true;
+  }
+
+  void RemoteSpawnBatcher::flush_thread_batches(void)
+  {
+    if(!thread_batches)
+      return;
+
+    for(std::map<Processor, PendingBatch *>::iterator it = thread_batches->begin();
+	it != thread_batches->end();
+	++it)
+      send_batch(it->first, it->second);
+    delete thread_batches;
+    thread_batches = 0;
+  }
+
+  void RemoteSpawnBatcher::flush_timed_batch(Processor proc)
+  {
+    PendingBatch *batch = 0;
+    {
+      AutoLock<> al(mutex);
+      std::map<Processor, PendingBatch *>::iterator it = pending.find(proc);
+      if(it != pending.end()) {
+	batch = it->second;
+	pending.erase(it);
+      }
+    }
+    if(batch)
+      send_batch(proc, batch);
+  }
+
+  void RemoteSpawnBatcher::start_timer_thread(CoreReservationSet& crs)
+  {
+    if(Config::remote_spawn_batch_window <= 0)
+      return;
+
+    // the timer thread spends nearly all its time asleep
+    CoreReservationParameters params;
+    timer_rsrv = new CoreReservation("spawn batch timer", crs, params);
+    ThreadLaunchParameters tlp;
+    timer_thread = Thread::create_kernel_thread<RemoteSpawnBatcher,
+						&RemoteSpawnBatcher::timer_thread_loop>(this,
+											tlp,
+											*timer_rsrv);
+  }
+
+  void RemoteSpawnBatcher::stop_timer_thread(void)
+  {
+    if(timer_thread == 0)
+      return;
+
+    {
+      AutoLock<> al(mutex);
+      shutdown_flag = true;
+      condvar.signal();
+    }
+    timer_thread->join();
+    delete timer_thread;
+    timer_thread = 0;
+    delete timer_rsrv;
+    timer_rsrv = 0;
+  }
+
+  void RemoteSpawnBatcher::timer_thread_loop(void)
+  {
+    const long long window = 1000LL * Config::remote_spawn_batch_window;
+    std::vector<std::pair<Processor, PendingBatch *> > to_send;
+
+    AutoLock<> al(mutex);
+    while(true) {
+      // send everything whose window has expired and sleep until the next
+      //  one does (or indefinitely, until a new batch is started)
+      long long now = Clock::current_time_in_nanoseconds();
+      long long next_deadline = -1;
+      std::map<Processor, PendingBatch *>::iterator it = pending.begin();
+      while(it != pending.end()) {
+	long long deadline = it->second->first_spawn_time + window;
+	if(shutdown_flag || (deadline <= now)) {
+	  to_send.push_back(*it);
+	  pending.erase(it++);
+	} else {
+	  if((next_deadline < 0) || (deadline < next_deadline))
+	    next_deadline = deadline;
+	  ++it;
+	}
+      }
+
+      if(!to_send.empty()) {
+	al.release();
+	for(size_t i = 0; i < to_send.size(); i++)
+	  send_batch(to_send[i].first, to_send[i].second);
+	to_send.clear();
+	al.reacquire();
+	continue;
+      }
+
+      if(shutdown_flag)
+	break;
+
+      if(next_deadline < 0)
+	condvar.wait();
+      else
+	condvar.timedwait(next_deadline - now);
+    }
+  }
+
+  /*static*/ void RemoteSpawnBatcher::send_batch(Processor proc,
+						 PendingBatch *batch)
+  {
+    log_task.debug() << "sending remote spawn batch:"
+		     << " proc=" << proc
+		     << " tasks=" << batch->num_tasks;
+
+    size_t bytes = batch->dbs.bytes_used();
+    ActiveMessage<SpawnTaskBatchMessage> amsg(batch->target, bytes);
+    amsg->proc = proc;
+    amsg->num_tasks = batch->num_tasks;
+    amsg.add_payload(batch->dbs.get_buffer(), bytes);
+    amsg.commit();
+
+    delete batch;
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class ProcGroupCreateMessage
@@ -1447,6 +1806,7 @@ namespace Realm {
 
 
   ActiveMessageHandlerReg<SpawnTaskMessage> spawn_task_message_handler;
+  ActiveMessageHandlerReg<SpawnTaskBatchMessage> spawn_task_batch_message_handler;
   ActiveMessageHandlerReg<RegisterTaskMessage> register_task_message_handler;
   ActiveMessageHandlerReg<RegisterTaskCompleteMessage> register_task_complete_message_handler;
   ActiveMessageHandlerReg<ProcGroupCreateMessage> proc_group_create_message_handler;
@@ -32,6 +32,7 @@
 #include "realm/tasks.h"
 #include "realm/threads.h"
 #include "realm/codedesc.h"
+#include "realm/serialize.h"
 
 namespace Realm {
 
@@ -41,6 +42,18 @@ namespace Realm {
       // if nonzero, prevents application thread from yielding execution
       //  resources on an Event wait
       extern REALM_THREAD_LOCAL int scheduler_lock;
+
+      // nesting depth of Processor::begin_spawn_batch calls
+      extern REALM_THREAD_LOCAL int spawn_batch_depth;
+    };
+
+    namespace Config {
+      // if nonzero, remote spawns to the same processor made within this
+      //  many microseconds of the first are coalesced into one message
+      extern int remote_spawn_batch_window;
+
+      // a pending batch is sent as soon as its payload reaches this size
+      extern size_t remote_spawn_batch_bytes;
     };
 
     class ProcessorImpl {
@@ -357,6 +370,72 @@ namespace Realm {
 				 const void *data, size_t datalen);
     };
 
+    // several spawns onto the same processor - the payload is a sequence of
+    //  (start, finish, priority, func_id, arglen, args, profiling requests)
+    struct SpawnTaskBatchMessage {
+      Processor proc;
+      unsigned num_tasks;
+
+      static void handle_message(NodeID sender,const SpawnTaskBatchMessage &msg,
+				 const void *data, size_t datalen);
+    };
+
+    // collects remote spawns to the same processor so that they can be sent
+    //  as a single SpawnTaskBatchMessage - explicit batches belong to the
+    //  thread that began them and are sent when it ends the batch, while
+    //  coalescing-window batches are shared and are sent by a timer thread
+    //  when their window expires
+    class RemoteSpawnBatcher {
+    public:
+      RemoteSpawnBatcher(void);
+      ~RemoteSpawnBatcher(void);
+
+      // returns true if the spawn was added to a batch, or false if the
+      //  caller should send it on its own (in which case anything batched
+      //  earlier for the same processor has already been sent)
+      bool add_spawn(Processor proc, NodeID target,
+		     Processor::TaskFuncID func_id,
+		     const void *args, size_t arglen,
+		     const ProfilingRequestSet &reqs,
+		     Event start_event, Event finish_event,
+		     int priority);
+
+      // sends the calling thread's explicit batches - this is also done
+      //  before the thread waits on an event, in case it waits on one of
+      //  the batched spawns (an open batch keeps collecting afterwards)
+      void flush_thread_batches(void);
+
+      // the timer thread only exists if a coalescing window is configured
+      void start_timer_thread(CoreReservationSet& crs);
+      void stop_timer_thread(void);
+
+    protected:
+      struct PendingBatch {
+	PendingBatch(NodeID _target);
+
+	NodeID target;
+	unsigned num_tasks;
+	long long first_spawn_time;
+	Serialization::DynamicBufferSerializer dbs;
+      };
+
+      // sends the shared batch for 'proc', if any
+      void flush_timed_batch(Processor proc);
+
+      void timer_thread_loop(void);
+
+      static void send_batch(Processor proc, PendingBatch *batch);
+
+      static REALM_THREAD_LOCAL std::map<Processor, PendingBatch *> *thread_batches;
+
+      Mutex mutex;
+      CondVar condvar;
+      std::map<Processor, PendingBatch *> pending;
+      bool shutdown_flag;
+      CoreReservation *timer_rsrv;
+      Thread *timer_thread;
+    };
+
     struct ProcGroupCreateMessage {
       ProcessorGroup pgrp;
       size_t num_members;
@@ -102,6 +102,15 @@ namespace Realm {
       static void enable_scheduler_lock(void);
       static void disable_scheduler_lock(void);
 
+      // remote spawns made by the calling thread between these calls are
+      //  coalesced per target processor and sent as a single message when
+      //  the outermost 'end_spawn_batch' is called (or earlier, if the
+      //  thread waits on an Event) - nesting is permitted, and a task that
+      //  waits has its batch set aside so other tasks on its thread don't
+      //  join it
+      static void begin_spawn_batch(void);
+      static void end_spawn_batch(void);
+
       // dynamic task registration - this may be done for:
       //  1) a specific processor/group (anywhere in the system)
       //  2) for all processors of a given type, either in the local address space/process,
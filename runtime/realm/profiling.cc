@@ -16,6 +16,7 @@
 // implementation of profiling stuff for Realm
 
 #include "realm/profiling.h"
+#include "realm/atomics.h"
 
 namespace Realm {
 
@@ -70,42 +71,99 @@ namespace Realm {
   // class ProfilingRequestSet
   //
 
+  namespace {
+    // every request held by a ProfilingRequestSet is one of these, so that
+    //  copies of a set can share requests without a reference count in the
+    //  (public) ProfilingRequest itself
+    class SharedProfilingRequest : public ProfilingRequest {
+    public:
+      SharedProfilingRequest(Processor _response_proc,
+			     Processor::TaskFuncID _response_task_id,
+			     int _priority, bool _report_if_empty)
+	: ProfilingRequest(_response_proc, _response_task_id,
+			   _priority, _report_if_empty)
+	, refcount(1), shareable(false)
+      {}
+
+      // a copy is never handed out for modification, so it can be shared
+      SharedProfilingRequest(const ProfilingRequest& to_copy)
+	: ProfilingRequest(to_copy)
+	, refcount(1), shareable(true)
+      {}
+
+      // number of ProfilingRequestSets holding this request
+      atomic<int> refcount;
+      // requests returned by add_request can still be modified by the
+      //  caller, so they are never shared - copying their set copies them
+      //  once, and only those copies are shared
+      bool shareable;
+    };
+
+    void release_request(ProfilingRequest *pr)
+    {
+      SharedProfilingRequest *spr = static_cast<SharedProfilingRequest *>(pr);
+      if(spr->refcount.fetch_sub_acqrel(1) == 1)
+	delete spr;
+    }
+  };
+
   ProfilingRequestSet::ProfilingRequestSet(void)
   {}
 
   ProfilingRequestSet::ProfilingRequestSet(const ProfilingRequestSet& to_copy)
   {
-    // deep copy
-    for(std::vector<ProfilingRequest *>::const_iterator it = to_copy.requests.begin();
-	it != to_copy.requests.end();
-	it++)
-      requests.push_back(new ProfilingRequest(**it));
+    copy_requests(to_copy);
   }
 
   ProfilingRequestSet::~ProfilingRequestSet(void)
   {
-    // destroy all of our set members
+    // release all of our set members
     for(std::vector<ProfilingRequest *>::iterator it = requests.begin();
 	it != requests.end();
 	it++)
-      delete *it;
+      release_request(*it);
   }
 
   ProfilingRequestSet& ProfilingRequestSet::operator=(const ProfilingRequestSet &rhs)
   {
+    if(this == &rhs)
+      return *this;
     for(std::vector<ProfilingRequest *>::iterator it = requests.begin();
 	it != requests.end();
 	it++)
-      delete *it;
+      release_request(*it);
     requests.clear();
-    // deep copy
-    for(std::vector<ProfilingRequest *>::const_iterator it = rhs.requests.begin();
-	it != rhs.requests.end();
-	it++)
-      requests.push_back(new ProfilingRequest(**it));
+    copy_requests(rhs);
     return *this;
   }
 
+  void ProfilingRequestSet::copy_requests(const ProfilingRequestSet& from)
+  {
+    requests.reserve(from.requests.size());
+    for(std::vector<ProfilingRequest *>::const_iterator it = from.requests.begin();
+	it != from.requests.end();
+	it++) {
+      SharedProfilingRequest *spr = static_cast<SharedProfilingRequest *>(*it);
+      if(spr->shareable) {
+	spr->refcount.fetch_add_acqrel(1);
+	requests.push_back(spr);
+      } else {
+	// copy before anyone else can see it - the caller of add_request
+	//  may still be modifying the original
+	requests.push_back(new SharedProfilingRequest(*spr));
+      }
+    }
+  }
+
+  /*static*/ ProfilingRequest *ProfilingRequestSet::new_request(Processor response_proc,
+								 Processor::TaskFuncID response_task_id,
+								 int priority,
+								 bool report_if_empty)
+  {
+    return new SharedProfilingRequest(response_proc, response_task_id,
+				      priority, report_if_empty);
+  }
+
   ProfilingRequest& ProfilingRequestSet::add_request(Processor response_proc, 
 						     Processor::TaskFuncID response_task_id,
 						     const void *payload /*= 0*/,
@@ -113,8 +171,8 @@ namespace Realm {
 						     int priority /*= 0*/,
 						     bool report_if_empty /*= false*/)
   {
-    ProfilingRequest *pr = new ProfilingRequest(response_proc, response_task_id,
-						priority, report_if_empty);
+    ProfilingRequest *pr = new_request(response_proc, response_task_id,
+				       priority, report_if_empty);
 
     if(payload)
       pr->add_user_data(payload, payload_size);
@@ -139,7 +197,7 @@ namespace Realm {
     for (std::vector<ProfilingRequest*>::iterator it = 
           requests.begin(); it != requests.end(); it++)
     {
-      delete (*it);
+      release_request(*it);
     }
     requests.clear();
   }
@@ -337,6 +337,7 @@ namespace Realm {
     friend class ProfilingMeasurementCollection;
 
     template <typename S> friend bool serialize(S &s, const ProfilingRequest &pr);
+    template <typename S> friend bool deserialize(S &s, ProfilingRequestSet &prs);
 
     Processor response_proc;
     Processor::TaskFuncID response_task_id;
@@ -346,7 +347,9 @@ namespace Realm {
     std::set<ProfilingMeasurementID> requested_measurements;
   };
 
-  // manages a set of profiling requests attached to a Realm operation
+  // manages a set of profiling requests attached to a Realm operation - a
+  //  copy of a set gets its own copy of any request the caller can still
+  //  modify, and shares the rest with the set it was copied from
   class REALM_PUBLIC_API ProfilingRequestSet {
   public:
     ProfilingRequestSet(void);
@@ -373,6 +376,14 @@ namespace Realm {
     template <typename S> friend bool serialize(S &s, const ProfilingRequestSet &prs);
     template <typename S> friend bool deserialize(S &s, ProfilingRequestSet &prs);
 
+    void copy_requests(const ProfilingRequestSet& from);
+
+    // requests in a set must be allocated by the set, so that they can be
+    //  shared with copies of it
+    static ProfilingRequest *new_request(Processor response_proc,
+					 Processor::TaskFuncID response_task_id,
+					 int priority, bool report_if_empty);
+
     std::vector<ProfilingRequest *> requests;
   };
 
@@ -374,9 +374,22 @@ namespace Realm {
     prs.clear(); // erase any existing data cleanly
     prs.requests.reserve(len);
     for(size_t i = 0; i < len; i++) {
-      ProfilingRequest *pr = ProfilingRequest::deserialize_new(s);
-      if(!pr) return false;
+      // same as ProfilingRequest::deserialize_new, but the request has to be
+      //  allocated by the set
+      Processor p;
+      Processor::TaskFuncID fid;
+      int priority;
+      bool report_if_empty;
+      if(!(s >> p)) return false;
+      if(!(s >> fid)) return false;
+      if(!(s >> priority)) return false;
+      if(!(s >> report_if_empty)) return false;
+      ProfilingRequest *pr = ProfilingRequestSet::new_request(p, fid, priority,
+							      report_if_empty);
       prs.requests.push_back(pr);
+      if(!(s >> pr->user_data) ||
+	 !(s >> pr->requested_measurements))
+	return false;
     }
     return true;
   }
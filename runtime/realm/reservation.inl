@@ -165,9 +165,13 @@ namespace Realm {
 	  return;
       }
     } else {
-      if(REALM_LIKELY(((cur_state & STATE_READER_COUNT_MASK) != 0) &&
-		      ((cur_state & (STATE_WRITER |
-				     STATE_BASE_RSRV_WAITING)) == 0))) {
+      // other readers coming and going will cause the compare/swap to fail
+      //  without taking us off the fast path, so retry (with the updated
+      //  value of cur_state) until it succeeds or the state becomes
+      //  exceptional
+      while(REALM_LIKELY(((cur_state & STATE_READER_COUNT_MASK) != 0) &&
+			 ((cur_state & (STATE_WRITER |
+					STATE_BASE_RSRV_WAITING)) == 0))) {
 	State new_state = cur_state - 1;
 	bool ok = state.compare_exchange(cur_state, new_state);
 	if(REALM_LIKELY(ok))
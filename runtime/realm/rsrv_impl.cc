@@ -305,6 +305,11 @@ namespace Realm {
       remote_waiter_mask = NodeSet(); 
       remote_sharer_mask = NodeSet();
       requested = false;
+      local_grants = 0;
+      outgoing_requests = 0;
+      ownership_transfers = 0;
+      remote_request_counts.clear();
+      local_grant_streak = 0;
       if(_data_size) {
 	local_data = malloc(_data_size);
 	local_data_size = _data_size;
@@ -356,8 +361,10 @@ namespace Realm {
 	if(impl->local_data_size > 0)
           memcpy(impl->local_data, pos, impl->local_data_size);
 
-	if(args.mode == 0) // take ownership if given exclusive access
+	if(args.mode == 0) { // take ownership if given exclusive access
 	  impl->owner = Network::my_node_id;
+	  impl->local_grant_streak = 0;
+	}
 	impl->mode = args.mode;
 	impl->requested = false;
 
@@ -459,6 +466,11 @@ namespace Realm {
 	    requested = true;
 	  }
 	}
+
+	if(got_lock)
+	  local_grants++;
+	if(lock_request_target != -1)
+	  outgoing_requests++;
   
 	log_reservation.debug(            "local reservation result: reservation=" IDFMT " got=%d req=%d count=%d",
 		 me.id, got_lock ? 1 : 0, requested ? 1 : 0, count);
@@ -603,6 +615,51 @@ namespace Realm {
       return false;
     }
 
+    NodeID ReservationImpl::select_remote_waiter(void)
+    {
+      // by default, the lowest-numbered waiter gets ownership
+      NodeID first = *remote_waiter_mask.begin();
+      if(Config::reservation_migrate_threshold == 0)
+	return first;
+
+      // otherwise migrate ownership toward the node that has been asking for
+      //  the reservation most often, but only if it has asked at least
+      //  'threshold' more times than the default choice, so that nodes with
+      //  similar demand don't keep trading places
+      NodeID best = first;
+      unsigned best_count = 0;
+      for(NodeSet::const_iterator it = remote_waiter_mask.begin();
+	  it != remote_waiter_mask.end();
+	  ++it) {
+	std::map<NodeID, unsigned>::const_iterator it2 = remote_request_counts.find(*it);
+	if((it2 != remote_request_counts.end()) && (it2->second > best_count)) {
+	  best = *it;
+	  best_count = it2->second;
+	}
+      }
+      std::map<NodeID, unsigned>::const_iterator it = remote_request_counts.find(first);
+      unsigned first_count = ((it != remote_request_counts.end()) ? it->second : 0);
+      if(best_count >= (first_count + Config::reservation_migrate_threshold))
+	return best;
+      else
+	return first;
+    }
+
+    void ReservationImpl::decay_remote_request_counts(void)
+    {
+      // halve the counts each time ownership moves on, so that a node's
+      //  earlier demand still counts if ownership comes back here, but
+      //  fades out if it stops asking
+      std::map<NodeID, unsigned>::iterator it = remote_request_counts.begin();
+      while(it != remote_request_counts.end()) {
+	it->second >>= 1;
+	if(it->second == 0)
+	  remote_request_counts.erase(it++);
+	else
+	  ++it;
+      }
+    }
+
     void ReservationImpl::release(TimeLimit work_until)
     {
       // make a list of events that we be woken - can't do it while holding the
@@ -643,15 +700,27 @@ namespace Realm {
 	  break;
 	}
 
-	// case 2: we own the lock, so we can give it to a local waiter (or a retry list)
-	bool any_local = select_local_waiters(to_wake, retry_trigger);
-	if(any_local)
-	  break;
+	// case 2: we own the lock, so we can give it to a local waiter (or a
+	//  retry list) - unless local waiters have already had it enough times
+	//  in a row while another node has been waiting
+	bool yield_to_remote = ((Config::reservation_local_grant_limit > 0) &&
+				!remote_waiter_mask.empty() &&
+				retries.empty() &&
+				(local_grant_streak >= Config::reservation_local_grant_limit));
+	if(!yield_to_remote) {
+	  bool any_local = select_local_waiters(to_wake, retry_trigger);
+	  if(any_local) {
+	    if(!remote_waiter_mask.empty())
+	      local_grant_streak++;
+	    break;
+	  }
+	}
 
 	// case 3: we can grant to a remote waiter (if any) if we don't expect any local retries
 	if(!remote_waiter_mask.empty() && retries.empty()) {
-	  // nobody local wants it, but another node does
-          NodeID new_owner = *remote_waiter_mask.begin();
+	  // nobody local wants it (or they've had their turn), but another
+	  //  node does
+          NodeID new_owner = select_remote_waiter();
 	  remote_waiter_mask.remove(new_owner);
 
 #ifdef RSRV_DEBUG_MSGS
@@ -662,7 +731,17 @@ namespace Realm {
 	  grant_target = new_owner;
           copy_waiters.swap(remote_waiter_mask);
 
+	  // any local waiters we passed over get in line at the new owner
+	  if(!local_excl_waiters.empty() || !local_shared.empty()) {
+	    assert(!requested);
+	    copy_waiters.add(Network::my_node_id);
+	    requested = true;
+	  }
+
 	  owner = new_owner;
+	  ownership_transfers++;
+	  decay_remote_request_counts();
+	  local_grant_streak = 0;
 	}
 
 	// nobody wants it?  just sits in available state
@@ -752,7 +831,15 @@ namespace Realm {
       	in_use = false;
 	count = ZERO_COUNT;
       }
-      log_reservation.info() << "releasing reservation: reservation=" << me;
+      log_reservation.info() << "releasing reservation: reservation=" << me
+			     << " local_grants=" << local_grants
+			     << " outgoing_requests=" << outgoing_requests
+			     << " transfers=" << ownership_transfers;
+      local_grants = 0;
+      outgoing_requests = 0;
+      ownership_transfers = 0;
+      remote_request_counts.clear();
+      local_grant_streak = 0;
 
       get_runtime()->local_reservation_free_list->free_entry(this);
     }
@@ -840,6 +927,9 @@ namespace Realm {
 
   namespace Config {
     bool use_fast_reservation_fallback = false;
+    bool fast_reservation_writer_preference = true;
+    unsigned reservation_local_grant_limit = 0;
+    unsigned reservation_migrate_threshold = 0;
   };
 
   FastReservation::FastReservation(Reservation _rsrv /*= Reservation::NO_RESERVATION*/)
@@ -967,12 +1057,23 @@ namespace Realm {
 	  //  new readers from taking the lock until we (or some other writer)
 	  //  get our turn
           // unfortunately, this update is not atomic with the test above,
-          //  so only set the flag if the state has not been changed to avoid
-          //  setting the WAITING flag and then possibly going to sleep if
-          //  some exceptional condition comes along - if the CAS fails
-          //  because the read count changed, that's not the end of the world
-	  state.compare_exchange(cur_state,
-				 cur_state | STATE_WRITER_WAITING);
+          //  so only set the flag if no exceptional condition has shown up
+          //  in the meantime to avoid setting the WAITING flag and then
+          //  possibly going to sleep - with writer preference, a CAS that
+          //  fails only because the read count changed is retried, as giving
+          //  up there lets a steady stream of readers starve the writer
+	  if(Config::fast_reservation_writer_preference) {
+	    State expected = state.load();
+	    while(((expected & (STATE_SLOW_FALLBACK |
+				STATE_BASE_RSRV | STATE_BASE_RSRV_WAITING |
+				STATE_SLEEPER | STATE_WRITER_WAITING)) == 0) &&
+		  ((expected & (STATE_WRITER | STATE_READER_COUNT_MASK)) != 0))
+	      if(state.compare_exchange(expected,  // updates expected
+					expected | STATE_WRITER_WAITING))
+		break;
+	  } else
+	    state.compare_exchange(cur_state,
+				   cur_state | STATE_WRITER_WAITING);
 
 	  mm_pause();
 	  continue;
@@ -1525,6 +1626,9 @@ namespace Realm {
           copy_waiters = impl->remote_waiter_mask;
 
 	  impl->owner = args.node;
+	  impl->ownership_transfers++;
+	  impl->decay_remote_request_counts();
+	  impl->local_grant_streak = 0;
 	  break;
 	}
 
@@ -1534,6 +1638,7 @@ namespace Realm {
 	log_reservation.debug("deferring reservation request: reservation=" IDFMT ", node=%d, mode=%d (count=%d cmode=%d)",
 			      args.lock.id, args.node, args.mode, impl->count, impl->mode);
         impl->remote_waiter_mask.add(args.node);
+	impl->remote_request_counts[args.node]++;
       } while(0);
 
       if(req_forward_target != -1)
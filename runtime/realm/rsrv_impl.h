@@ -48,6 +48,24 @@ namespace Realm {
 
     namespace Config {
       extern bool use_fast_reservation_fallback;
+
+      // if true (the default), a writer spinning on a FastReservation
+      //  prevents new readers from acquiring it until the writer gets a turn
+      //  - if false, the writer makes a single attempt to hold off new
+      //  readers, which fails whenever the reader count changes under it
+      extern bool fast_reservation_writer_preference;
+
+      // if nonzero, the owner of a reservation grants it to local waiters at
+      //  most this many times in a row while another node is waiting before
+      //  handing ownership to the most active remote requester
+      extern unsigned reservation_local_grant_limit;
+
+      // if nonzero, ownership of a reservation goes to the remote waiter
+      //  that has sent the most requests (rather than the lowest-numbered
+      //  one) when it has sent at least this many more than the
+      //  lowest-numbered waiter - request counts are halved whenever
+      //  ownership moves on
+      extern unsigned reservation_migrate_threshold;
     };
 
     class ReservationImpl {
@@ -98,6 +116,14 @@ namespace Realm {
       std::map<unsigned, RetryInfo> retries;
       bool requested; // do we have a request for the lock in flight?
 
+      // acquire locality statistics - local grants and the requests this
+      //  node has sent to the owner are reported on destruction, while the
+      //  requests seen from each remote node (while we are the owner) pick
+      //  where ownership migrates next when -ll:rsrv_migrate is set
+      unsigned local_grants, outgoing_requests, ownership_transfers;
+      std::map<NodeID, unsigned> remote_request_counts;
+      unsigned local_grant_streak;
+
       // local data protected by lock
       void *local_data;
       size_t local_data_size;
@@ -128,6 +154,13 @@ namespace Realm {
 
       bool select_local_waiters(WaiterList& to_wake, Event& retry);
 
+      // picks the remote waiter that gets ownership next - ASSUMES LOCK HELD
+      NodeID select_remote_waiter(void);
+
+      // ages the per-node request counts when ownership is handed off -
+      //  ASSUMES LOCK HELD
+      void decay_remote_request_counts(void);
+
       void release(TimeLimit work_until);
 
       bool is_locked(unsigned check_mode, bool excl_ok);
@@ -96,6 +96,7 @@ namespace Realm {
   Logger log_collective("collective");
   extern Logger log_task; // defined in proc_impl.cc
   extern Logger log_taskreg; // defined in proc_impl.cc
+  extern Logger log_annc; // defined in machine_impl.cc
   
   ////////////////////////////////////////////////////////////////////////
   //
@@ -164,6 +165,9 @@ namespace Realm {
                       process_id, hostname);
       fflush(stderr);
 
+      // don't leave buffered log output sitting in memory
+      Logger::flush_all_streams_for_signal();
+
       // now that we've stopped, don't catch any further SIGINTs
       struct sigaction action;
       action.sa_handler = SIG_DFL;
@@ -658,6 +662,7 @@ namespace Realm {
     , num_cpu_procs(1), num_util_procs(1), num_io_procs(0)
     , concurrent_io_threads(1)  // Legion does not support values > 1 right now
     , sysmem_size(512 << 20), stack_size(2 << 20)
+    , sysmem_numa_node(-1)
     , pin_util_procs(false)
     , cpu_bgwork_timeslice(0)
     , util_bgwork_timeslice(0)
@@ -678,6 +683,7 @@ namespace Realm {
       .add_option_int("-ll:io", m->num_io_procs)
       .add_option_int("-ll:concurrent_io", m->concurrent_io_threads)
       .add_option_int_units("-ll:csize", m->sysmem_size, 'm')
+      .add_option_int("-ll:cnuma", m->sysmem_numa_node)
       .add_option_int_units("-ll:stacksize", m->stack_size, 'm', true /*binary*/, true /*keep*/)
       .add_option_bool("-ll:pin_util", m->pin_util_procs)
       .add_option_int("-ll:cpu_bgwork", m->cpu_bgwork_timeslice)
@@ -696,7 +702,7 @@ namespace Realm {
     if(sysmem_size > 0) {
       Memory m = runtime->next_local_memory_id();
       MemoryImpl *mi = new LocalCPUMemory(m, sysmem_size,
-          -1/*don't care numa domain*/, Memory::SYSTEM_MEM);
+          sysmem_numa_node, Memory::SYSTEM_MEM);
       runtime->add_memory(mi);
     }
   }
@@ -1048,18 +1054,25 @@ namespace Realm {
       return true;
     }
 
+    // a run of processors with consecutive indices and identical kind and
+    //  core count is announced as a single entry
+    struct ProcessorAnnounceRange {
+      Processor first;
+      int count;
+      Processor::Kind kind;
+      int num_cores;
+    };
+
     template <typename T>
-    static bool serialize_announce(T& serializer, ProcessorImpl *impl,
+    static bool serialize_announce(T& serializer,
+                                   const ProcessorAnnounceRange& range,
                                    NetworkModule *net)
     {
-      Processor p = impl->me;
-      Processor::Kind k = impl->me.kind();
-      int num_cores = impl->num_cores;
-
-      bool ok = ((serializer << NODE_ANNOUNCE_PROC) &&
-                 (serializer << p) &&
-                 (serializer << k) &&
-                 (serializer << num_cores));
+      bool ok = ((serializer << NODE_ANNOUNCE_PROC_RANGE) &&
+                 (serializer << range.first) &&
+                 (serializer << range.count) &&
+                 (serializer << range.kind) &&
+                 (serializer << range.num_cores));
       return ok;
     }
 
@@ -1101,16 +1114,29 @@ namespace Realm {
       return ok;
     }
 
+    // a run of processors with consecutive indices and identical lists of
+    //  memory affinities is announced once - the receiver expands it
+    //  processor by processor, so the affinities are added in the same
+    //  order as if each one were announced separately
+    struct ProcessorMemoryAffinityGroup {
+      Processor first;
+      int count;
+      std::vector<Memory> mems;
+      std::vector<unsigned> bandwidths;
+      std::vector<unsigned> latencies;
+    };
+
     template <typename T>
     static bool serialize_announce(T& serializer,
-                                   const Machine::ProcessorMemoryAffinity& pma,
+                                   const ProcessorMemoryAffinityGroup& group,
                                    NetworkModule *net)
     {
-      bool ok = ((serializer << NODE_ANNOUNCE_PMA) &&
-                 (serializer << pma.p) &&
-                 (serializer << pma.m) &&
-                 (serializer << pma.bandwidth) &&
-                 (serializer << pma.latency));
+      bool ok = ((serializer << NODE_ANNOUNCE_PMA_GROUP) &&
+                 (serializer << group.first) &&
+                 (serializer << group.count) &&
+                 (serializer << group.mems) &&
+                 (serializer << group.bandwidths) &&
+                 (serializer << group.latencies));
       return ok;
     }
 
@@ -1138,12 +1164,40 @@ namespace Realm {
       return ok;
     }
 
+    // a node built like node 0 sends just the rdma info of each memory that
+    //  has some, followed by a marker that node 0's template describes it
+    struct MemoryRdmaInfoAnnounce {
+      Memory m;
+      const ByteArray *rdma_info;
+    };
+
+    template <typename T>
+    static bool serialize_announce(T& serializer,
+                                   const MemoryRdmaInfoAnnounce& info,
+                                   NetworkModule *net)
+    {
+      bool ok = ((serializer << NODE_ANNOUNCE_RDMA_INFO) &&
+                 (serializer << info.m) &&
+                 (serializer << *info.rdma_info));
+      return ok;
+    }
+
+    struct TemplateAnnounceMarker {};
+
+    template <typename T>
+    static bool serialize_announce(T& serializer,
+                                   const TemplateAnnounceMarker& marker,
+                                   NetworkModule *net)
+    {
+      return (serializer << NODE_ANNOUNCE_TEMPLATE);
+    }
+
     template <typename T>
     static int fragmented_announce(const NodeSet& targets,
                                    NetworkModule *net,
                                    Serialization::DynamicBufferSerializer& dbs,
                                    size_t max_frag_size,
-                                   T thing)
+                                   const T& thing)
     {
       size_t prev_size = dbs.bytes_used();
       bool ok = serialize_announce(dbs, thing, net);
@@ -1155,6 +1209,7 @@ namespace Realm {
         assert(prev_size > 0);
         ActiveMessage<NodeAnnounceMessage> amsg(targets, dbs.get_buffer(), prev_size);
         amsg->num_fragments = 0; // count not known yet
+        amsg->is_template = false;
         amsg.commit();
         dbs.reset();
         // re-serialize this object
@@ -1168,6 +1223,161 @@ namespace Realm {
         return 0;
     }
 
+    // the entries of a node's announcement that describe its shape (i.e.
+    //  everything but its dma channels) go either out as fragments or into a
+    //  single buffer, via one of these
+    struct AnnounceFragmenter {
+      const NodeSet& targets;
+      NetworkModule *net;
+      Serialization::DynamicBufferSerializer& dbs;
+      size_t max_frag_size;
+      int num_fragments;
+
+      AnnounceFragmenter(const NodeSet& _targets, NetworkModule *_net,
+                         Serialization::DynamicBufferSerializer& _dbs,
+                         size_t _max_frag_size)
+        : targets(_targets), net(_net), dbs(_dbs)
+        , max_frag_size(_max_frag_size), num_fragments(0)
+      {}
+
+      template <typename T>
+      void operator()(const T& thing)
+      {
+        num_fragments += fragmented_announce(targets, net, dbs,
+                                             max_frag_size, thing);
+      }
+    };
+
+    struct AnnounceCollector {
+      NetworkModule *net;
+      Serialization::DynamicBufferSerializer& dbs;
+
+      AnnounceCollector(NetworkModule *_net,
+                        Serialization::DynamicBufferSerializer& _dbs)
+        : net(_net), dbs(_dbs)
+      {}
+
+      template <typename T>
+      void operator()(const T& thing)
+      {
+        bool ok = serialize_announce(dbs, thing, net);
+        assert(ok);
+      }
+    };
+
+    template <typename SINK>
+    static void announce_node_shape(SINK& sink, const Node *n,
+                                    MachineImpl *machine)
+    {
+      // announce processors, collapsing runs of identical ones into ranges
+      {
+        ProcessorAnnounceRange range;
+        range.count = 0;
+        for(std::vector<ProcessorImpl *>::const_iterator it = n->processors.begin();
+            it != n->processors.end();
+            it++) {
+          if(!*it) continue;
+          Processor p = (*it)->me;
+          if((range.count > 0) &&
+             (ID(p).proc_proc_idx() == (ID(range.first).proc_proc_idx() +
+                                        unsigned(range.count))) &&
+             (p.kind() == range.kind) &&
+             ((*it)->num_cores == range.num_cores)) {
+            range.count++;
+            continue;
+          }
+          if(range.count > 0)
+            sink(range);
+          range.first = p;
+          range.count = 1;
+          range.kind = p.kind();
+          range.num_cores = (*it)->num_cores;
+        }
+        if(range.count > 0)
+          sink(range);
+      }
+
+      // now each memory
+      for(std::vector<MemoryImpl *>::const_iterator it = n->memories.begin();
+          it != n->memories.end();
+          it++)
+        if(*it)
+          sink(*it);
+
+      for (std::vector<IBMemory *>::const_iterator it = n->ib_memories.begin();
+           it != n->ib_memories.end();
+           it++)
+        if(*it)
+          sink(*it);
+
+      // announce processors' affinities, collapsing runs of processors whose
+      //  affinities are identical
+      {
+        ProcessorMemoryAffinityGroup group;
+        group.count = 0;
+        for(std::vector<ProcessorImpl *>::const_iterator it = n->processors.begin();
+            it != n->processors.end();
+            it++) {
+          if(!*it) continue;
+          Processor p = (*it)->me;
+          std::vector<Machine::ProcessorMemoryAffinity> pmas;
+          machine->get_proc_mem_affinity(pmas, p);
+
+          if((group.count > 0) &&
+             (ID(p).proc_proc_idx() == (ID(group.first).proc_proc_idx() +
+                                        unsigned(group.count))) &&
+             (pmas.size() == group.mems.size())) {
+            bool same = true;
+            for(size_t i = 0; same && (i < pmas.size()); i++)
+              same = ((pmas[i].m == group.mems[i]) &&
+                      (pmas[i].bandwidth == group.bandwidths[i]) &&
+                      (pmas[i].latency == group.latencies[i]));
+            if(same) {
+              group.count++;
+              continue;
+            }
+          }
+          if(group.count > 0)
+            sink(group);
+          group.first = p;
+          group.count = 1;
+          group.mems.clear();
+          group.bandwidths.clear();
+          group.latencies.clear();
+          for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = pmas.begin();
+              it2 != pmas.end();
+              it2++) {
+            group.mems.push_back(it2->m);
+            group.bandwidths.push_back(it2->bandwidth);
+            group.latencies.push_back(it2->latency);
+          }
+        }
+        if(group.count > 0)
+          sink(group);
+      }
+
+      // now each memory's affinities with other memories
+      for(std::vector<MemoryImpl *>::const_iterator it = n->memories.begin();
+          it != n->memories.end();
+          it++)
+        if(*it) {
+          Memory m = (*it)->me;
+          std::vector<Machine::MemoryMemoryAffinity> mmas;
+          machine->get_mem_mem_affinity(mmas, m);
+
+          for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = mmas.begin();
+              it2 != mmas.end();
+              it2++) {
+            // only announce intra-node ones and only those with this memory as m1 to avoid
+            //  duplicates
+            if((it2->m1 != m) || ((NodeID)(it2->m2.address_space()) != Network::my_node_id))
+              continue;
+
+            sink(*it2);
+          }
+        }
+    }
+
     bool RuntimeImpl::configure_from_command_line(std::vector<std::string> &cmdline)
     {
       // very first thing - let the logger initialization happen
@@ -1223,6 +1433,7 @@ namespace Realm {
       int bitset_twolevel = -1024; // i.e. yes if > 1024 nodes
       int active_msg_handler_threads = 0; // default is none (use bgwork)
       bool active_msg_handler_bgwork = true;
+      bool use_tsc_clock = true;
 
       CommandLineParser cp;
       cp.add_option_int_units("-ll:rsize", reg_mem_size, 'm')
@@ -1252,12 +1463,20 @@ namespace Realm {
       cp.add_option_int("-realm:eventloopcheck", Config::event_loop_detection_limit);
       cp.add_option_bool("-ll:force_kthreads", Config::force_kernel_threads);
       cp.add_option_bool("-ll:frsrv_fallback", Config::use_fast_reservation_fallback);
+      cp.add_option_int("-ll:frsrv_writer_pref", Config::fast_reservation_writer_preference);
+      cp.add_option_int("-ll:rsrv_local_limit", Config::reservation_local_grant_limit);
+      cp.add_option_int("-ll:rsrv_migrate", Config::reservation_migrate_threshold);
+      cp.add_option_int("-ll:spawn_batch", Config::remote_spawn_batch_window);
+      cp.add_option_int_units("-ll:spawn_batch_size", Config::remote_spawn_batch_bytes, 'k');
       cp.add_option_int("-ll:machine_query_cache", Config::use_machine_query_cache);
       cp.add_option_int("-ll:defalloc", Config::deferred_instance_allocation);
+      cp.add_option_int_units("-ll:hugepage", Config::hugepage_size, 'm');
+      cp.add_option_bool("-ll:prefault", Config::prefault_memory);
       cp.add_option_int("-ll:amprofile", Config::profile_activemsg_handlers);
       cp.add_option_int("-ll:aminline", Config::max_inline_message_time);
       cp.add_option_int("-ll:ahandlers", active_msg_handler_threads);
       cp.add_option_int("-ll:handler_bgwork", active_msg_handler_bgwork);
+      cp.add_option_int("-ll:tsc", use_tsc_clock);
 
       bool cmdline_ok = cp.parse_command_line(cmdline);
 
@@ -1352,7 +1571,7 @@ namespace Realm {
 					atomic<DynamicTable<SparsityMapTableAllocator> *>(0));
 	  DynamicTable<SparsityMapTableAllocator> *m = new DynamicTable<SparsityMapTableAllocator>;
 	  nodes[i].sparsity_maps[Network::my_node_id].store(m);
-	  local_sparsity_map_free_lists[i] = new SparsityMapTableAllocator::FreeList(*m, i /*owner_node*/);
+	  local_sparsity_map_free_lists[i] = new SparsityMapTableAllocator::FreeList(*m, i /*owner_node*/, false /*!use_magazines*/);
 	}
 
 	local_subgraph_free_lists.resize(Network::max_node_id + 1);
@@ -1361,7 +1580,7 @@ namespace Realm {
 				    atomic<DynamicTable<SubgraphTableAllocator> *>(0));
 	  DynamicTable<SubgraphTableAllocator> *m = new DynamicTable<SubgraphTableAllocator>;
 	  nodes[i].subgraphs[Network::my_node_id].store(m);
-	  local_subgraph_free_lists[i] = new SubgraphTableAllocator::FreeList(*m, i /*owner_node*/);
+	  local_subgraph_free_lists[i] = new SubgraphTableAllocator::FreeList(*m, i /*owner_node*/, false /*!use_magazines*/);
 	}
 
 	local_proc_group_free_lists.resize(Network::max_node_id + 1);
@@ -1370,7 +1589,7 @@ namespace Realm {
 				    atomic<DynamicTable<ProcessorGroupTableAllocator> *>(0));
 	  DynamicTable<ProcessorGroupTableAllocator> *m = new DynamicTable<ProcessorGroupTableAllocator>;
 	  nodes[i].proc_groups[Network::my_node_id].store(m);
-	  local_proc_group_free_lists[i] = new ProcessorGroupTableAllocator::FreeList(*m, i /*owner_node*/);
+	  local_proc_group_free_lists[i] = new ProcessorGroupTableAllocator::FreeList(*m, i /*owner_node*/, false /*!use_magazines*/);
 	}
       }
 
@@ -1440,6 +1659,9 @@ namespace Realm {
           assert(0);
 	}
 
+      // pick the clock source before establishing the zero time
+      Realm::Clock::calibrate(use_tsc_clock);
+
       {
 	// try to get all nodes to have roughly the same idea of the "zero
 	//  "time" by using network barriers
@@ -1487,6 +1709,8 @@ namespace Realm {
       
       bgwork.start_dedicated_workers(*core_reservations);
 
+      spawn_batcher.start_timer_thread(*core_reservations);
+
       PartitioningOpQueue::start_worker_threads(*core_reservations, &bgwork);
 
 #ifdef EVENT_TRACING
@@ -1711,7 +1935,10 @@ namespace Realm {
 	}
       }
 
-      // announce by network type
+      // announce by network type - every node still sends an announcement
+      //  to every other node, so the number of startup messages grows with
+      //  the square of the node count; the range/group encodings and node 0's
+      //  template below only shrink each node's share of the traffic
       for(std::vector<NetworkModule *>::iterator nit = network_modules.begin();
 	  nit != network_modules.end();
 	  ++nit) {
@@ -1730,7 +1957,6 @@ namespace Realm {
         // when the preferred message size is small, we'll send multiple
         //  fragments
         size_t max_frag_size = ActiveMessage<NodeAnnounceMessage>::recommended_max_payload(targets, false /*!with_congestion*/);
-        int num_fragments = 0;
 
 #ifdef DEBUG_REALM_STARTUP
 	if(Network::my_node_id == 0) {
@@ -1739,78 +1965,88 @@ namespace Realm {
 	}
 #endif
 
-	// announce each processor
-	for(std::vector<ProcessorImpl *>::const_iterator it = n->processors.begin();
-	    it != n->processors.end();
-	    it++)
-	  if(*it)
-            num_fragments += fragmented_announce(targets, *nit,
-                                                 dbs, max_frag_size, *it);
-
-	// now each memory
-	for(std::vector<MemoryImpl *>::const_iterator it = n->memories.begin();
-	    it != n->memories.end();
-	    it++)
-	  if(*it)
-            num_fragments += fragmented_announce(targets, *nit,
-                                                 dbs, max_frag_size, *it);
-
-        for (std::vector<IBMemory *>::const_iterator it = n->ib_memories.begin();
-             it != n->ib_memories.end();
-             it++)
-          if(*it)
-            num_fragments += fragmented_announce(targets, *nit,
-                                                 dbs, max_frag_size, *it);
-
-	// announce each processor's affinities
-	for(std::vector<ProcessorImpl *>::const_iterator it = n->processors.begin();
-	    it != n->processors.end();
-	    it++)
-	  if(*it) {
-	    Processor p = (*it)->me;
-	    std::vector<Machine::ProcessorMemoryAffinity> pmas;
-	    machine->get_proc_mem_affinity(pmas, p);
-
-	    for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = pmas.begin();
-		it2 != pmas.end();
-		it2++)
-              num_fragments += fragmented_announce(targets, *nit,
-                                                   dbs, max_frag_size, *it2);
-	  }
-
-	// now each memory's affinities with other memories
-	for(std::vector<MemoryImpl *>::const_iterator it = n->memories.begin();
-	    it != n->memories.end();
-	    it++)
-	  if(*it) {
-	    Memory m = (*it)->me;
-	    std::vector<Machine::MemoryMemoryAffinity> mmas;
-	    machine->get_mem_mem_affinity(mmas, m);
-
-	    for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = mmas.begin();
-		it2 != mmas.end();
-		it2++) {
-	      // only announce intra-node ones and only those with this memory as m1 to avoid
-	      //  duplicates
-	      if((it2->m1 != m) || ((NodeID)(it2->m2.address_space()) != Network::my_node_id))
-		continue;
-
-              num_fragments += fragmented_announce(targets, *nit,
-                                                   dbs, max_frag_size, *it2);
-	    }
-	  }
-
+        AnnounceFragmenter fragmenter(targets, *nit, dbs, max_frag_size);
+
+        // with a single network, node 0 offers its description as a template
+        //  and any other node built the same way (i.e. the same processors,
+        //  memories and affinities at the same indices) only sends the rdma
+        //  info of its memories - nodes that differ, and all dma channels,
+        //  are still announced in full
+        if(network_modules.size() == 1) {
+          Serialization::DynamicBufferSerializer shape(4096);
+          AnnounceCollector collector(*nit, shape);
+          announce_node_shape(collector, n, machine);
+
+          if(Network::my_node_id == 0) {
+            // an empty template if ours doesn't fit in one message
+            bool fits = (shape.bytes_used() <= max_frag_size);
+            size_t template_size = (fits ? shape.bytes_used() : 0);
+            machine->set_announce_template(shape.get_buffer(), template_size);
+            ActiveMessage<NodeAnnounceMessage> amsg(targets,
+                                                    shape.get_buffer(),
+                                                    template_size);
+            amsg->num_fragments = 0; // count not known yet
+            amsg->is_template = true;
+            amsg.commit();
+            fragmenter.num_fragments++;
+            if(!fits)
+              announce_node_shape(fragmenter, n, machine);
+          } else {
+            NodeAnnounceMessage::await_template();
+
+            std::map<Memory, ByteArray> rdma_infos;
+            for(std::vector<MemoryImpl *>::const_iterator it = n->memories.begin();
+                it != n->memories.end();
+                it++)
+              if(*it) {
+                const ByteArray *rdma_info = (*it)->get_rdma_info(*nit);
+                if(rdma_info)
+                  rdma_infos[(*it)->me] = *rdma_info;
+              }
+            for(std::vector<IBMemory *>::const_iterator it = n->ib_memories.begin();
+                it != n->ib_memories.end();
+                it++)
+              if(*it) {
+                const ByteArray *rdma_info = (*it)->get_rdma_info(*nit);
+                if(rdma_info)
+                  rdma_infos[(*it)->me] = *rdma_info;
+              }
+
+            Serialization::DynamicBufferSerializer instance(4096);
+            bool same = (machine->instantiate_announce_template(Network::my_node_id,
+                                                                rdma_infos,
+                                                                instance) &&
+                         (instance.bytes_used() == shape.bytes_used()) &&
+                         !memcmp(instance.get_buffer(), shape.get_buffer(),
+                                 shape.bytes_used()));
+            if(same) {
+              log_annc.info() << "node " << Network::my_node_id
+                              << " is announced by template";
+              for(std::map<Memory, ByteArray>::const_iterator it = rdma_infos.begin();
+                  it != rdma_infos.end();
+                  ++it) {
+                MemoryRdmaInfoAnnounce info;
+                info.m = it->first;
+                info.rdma_info = &it->second;
+                fragmenter(info);
+              }
+              fragmenter(TemplateAnnounceMarker());
+            } else
+              announce_node_shape(fragmenter, n, machine);
+          }
+        } else
+          announce_node_shape(fragmenter, n, machine);
 	for(std::vector<Channel *>::const_iterator it = n->dma_channels.begin();
 	    it != n->dma_channels.end();
 	    ++it)
 	  if(*it)
-            num_fragments += fragmented_announce(targets, *nit,
-                                                 dbs, max_frag_size, *it);
+            fragmenter(*it);
 
         // have to send one final message with the remaining data and a valid
         //  fragment count
 	ActiveMessage<NodeAnnounceMessage> amsg(targets, dbs.get_buffer(), dbs.bytes_used());
-        amsg->num_fragments = num_fragments + 1;
+        amsg->num_fragments = fragmenter.num_fragments + 1;
+        amsg->is_template = false;
 	amsg.commit();
       }
 
@@ -1818,6 +2054,10 @@ namespace Realm {
       {
 	NodeAnnounceMessage::await_all_announcements();
 
+	// nodes that were only announced by their rdma info can be filled in
+	//  now that node 0's template has arrived
+	machine->parse_templated_announcements();
+
 #ifdef DEBUG_REALM_STARTUP
 	if(Network::my_node_id == 0) {
 	  TimeStamp ts("received all announcements", false);
@@ -2256,6 +2496,7 @@ namespace Realm {
 
       // threads that cause inter-node communication have to stop first
       PartitioningOpQueue::stop_worker_threads();
+      spawn_batcher.stop_timer_thread();
 
       for(std::vector<Channel *>::iterator it = nodes[Network::my_node_id].dma_channels.begin();
 	  it != nodes[Network::my_node_id].dma_channels.end();
@@ -2752,6 +2993,9 @@ namespace Realm {
 #endif
                 << std::dec << ") - obtaining backtrace\n" << std::flush;
 
+      // get buffered log output out before anything else can go wrong
+      Logger::flush_all_streams_for_signal();
+
       Backtrace bt;
       bt.capture_backtrace(1 /* skip this handler */);
       bt.lookup_symbols();
@@ -179,6 +179,7 @@ namespace Realm {
       int num_cpu_procs, num_util_procs, num_io_procs;
       int concurrent_io_threads;
       size_t sysmem_size, stack_size;
+      int sysmem_numa_node;
       bool pin_util_procs;
       long long cpu_bgwork_timeslice, util_bgwork_timeslice;
     };
@@ -325,6 +326,7 @@ namespace Realm {
       BackgroundWorkManager bgwork;
       IncomingMessageManager *message_manager;
       EventTriggerNotifier event_triggerer;
+      RemoteSpawnBatcher spawn_batcher;
 
       OperationTable optable;
 
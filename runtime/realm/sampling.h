@@ -58,6 +58,11 @@ namespace Realm {
 
       const std::string name;
 
+      // true if a profiler is recording this gauge - this is only known
+      //  once the profiler has been configured, so a gauge created before
+      //  then reports false
+      bool is_sampled(void) const;
+
     private:
       Gauge(const Gauge& copy_from) {}
       Gauge& operator=(const Gauge& copy_from) { return *this; }
@@ -40,6 +40,11 @@ namespace Realm {
 	remove_gauge();
     }
 
+    inline bool Gauge::is_sampled(void) const
+    {
+      return (sampler != 0);
+    }
+
 
     ////////////////////////////////////////////////////////////////////////
     //
@@ -72,6 +72,16 @@ namespace Realm {
     assert(pending_head.load() == 0);
   }
 
+  void Task::join_ready_group(Task *head)
+  {
+    // we hold a reference on the head task until we've been started
+    head->add_reference();
+    pending_head.store(reinterpret_cast<uintptr_t>(head));
+    // make sure to record our ready time if anybody in the chain needs it
+    if(wants_timeline)
+      head->wants_timeline = true;
+  }
+
   void Task::print(std::ostream& os) const
   {
     os << "task(proc=" << proc << ", func=" << func_id << ")";
@@ -411,12 +421,7 @@ namespace Realm {
 	ok = true;
 	pending_list.push_back(to_add);
 	list_length++;
-	// task we added will hold a reference this head task
-	task->add_reference();
-	to_add->pending_head.store(reinterpret_cast<uintptr_t>(task));
-	// make sure to record our ready time if anybody in the chain needs it
-	if(to_add->wants_timeline)
-	  task->wants_timeline = true;
+	to_add->join_ready_group(task);
       }
     }
     return ok;
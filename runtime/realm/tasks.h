@@ -62,6 +62,11 @@ namespace Realm {
       
       void execute_on_processor(Processor p);
 
+      // adds this task to a list headed by 'head' that will be handed to
+      //  TaskQueue::enqueue_tasks as a whole - only the head is marked ready
+      //  there, and this task picks that up lazily
+      void join_ready_group(Task *head);
+
       Processor proc;
       Processor::TaskFuncID func_id;
 
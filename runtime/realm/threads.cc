@@ -148,6 +148,56 @@ namespace Realm {
     /*extern*/ REALM_THREAD_LOCAL Thread *current_thread = 0;
   };
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // thread exit callbacks
+
+#ifdef REALM_USE_PTHREADS
+  namespace {
+    struct ThreadExitCallback {
+      void (*callback)(void *);
+      void *arg;
+      ThreadExitCallback *next;
+    };
+
+    pthread_once_t thread_exit_key_once = PTHREAD_ONCE_INIT;
+    pthread_key_t thread_exit_key;
+
+    void run_thread_exit_callbacks(void *data)
+    {
+      // the key's value is cleared before we're called, so a callback that
+      //  registers a new one gets us called again (up to
+      //  PTHREAD_DESTRUCTOR_ITERATIONS times)
+      ThreadExitCallback *cb = static_cast<ThreadExitCallback *>(data);
+      while(cb) {
+	ThreadExitCallback *next = cb->next;
+	(*cb->callback)(cb->arg);
+	delete cb;
+	cb = next;
+      }
+    }
+
+    void create_thread_exit_key(void)
+    {
+      CHECK_PTHREAD( pthread_key_create(&thread_exit_key,
+					run_thread_exit_callbacks) );
+    }
+  };
+#endif
+
+  void add_thread_exit_callback(void (*callback)(void *), void *arg)
+  {
+#ifdef REALM_USE_PTHREADS
+    CHECK_PTHREAD( pthread_once(&thread_exit_key_once,
+				create_thread_exit_key) );
+    ThreadExitCallback *cb = new ThreadExitCallback;
+    cb->callback = callback;
+    cb->arg = arg;
+    cb->next = static_cast<ThreadExitCallback *>(pthread_getspecific(thread_exit_key));
+    CHECK_PTHREAD( pthread_setspecific(thread_exit_key, cb) );
+#endif
+  }
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class CoreReservation
@@ -441,6 +441,12 @@ namespace Realm {
   };
 #endif
 
+  // registers a function to be called (with 'arg') when the calling kernel
+  //  thread exits, whether or not Realm created it - used to hand per-thread
+  //  caches back to shared pools (callbacks are not run on Windows, or for
+  //  the thread that calls exit())
+  void add_thread_exit_callback(void (*callback)(void *), void *arg);
+
   // move this somewhere else
 
   class DummyLock {
@@ -17,9 +17,16 @@
 
 #include "realm/timers.h"
 #include "realm/activemsg.h"
+#include "realm/logging.h"
 
 #include <string.h>
+#include <math.h>
 #include <list>
+#include <algorithm>
+
+#ifdef REALM_CLOCK_USE_TSC
+#include <cpuid.h>
+#endif
 
 #ifdef DETAILED_TIMING
 pthread_key_t thread_timer_key;
@@ -27,9 +34,251 @@ pthread_key_t thread_timer_key;
 
 namespace Realm {
 
+  Logger log_clock("clock");
+
   // if set_zero_time() is not called, relative time will equal absolute time
   /*static*/ long long Clock::zero_time = 0;
 
+#ifdef REALM_CLOCK_USE_TSC
+  /*static*/ atomic<unsigned> Clock::tsc_seq(0);
+  /*static*/ atomic<unsigned long long> Clock::tsc_base(0);
+  /*static*/ atomic<unsigned long long> Clock::tsc_limit(0);
+  /*static*/ atomic<unsigned long long> Clock::tsc_mult(0);
+  /*static*/ atomic<long long> Clock::tsc_base_nsec(0);
+
+  namespace {
+    // the initial calibration point and rate - every resync measures the
+    //  rate over the whole interval since then, which gets more accurate as
+    //  the program runs
+    unsigned long long tsc_calib_ticks = 0;
+    long long tsc_calib_nsec = 0;
+    double tsc_calib_rate = 0; // nanoseconds per tick
+
+    // how long to measure at startup, and how often to resync after that
+    const long long TSC_CALIBRATE_NSEC = 10000000;  // 10 ms
+    const long long TSC_RESYNC_NSEC = 1000000000;   // 1 s
+    // how far the TSC-derived time may wander from the OS clock between
+    //  resyncs, or the TSC's rate from its initial calibration, before the
+    //  TSC is deemed unreliable
+    const long long TSC_MAX_DRIFT_NSEC = 1000000;   // 1 ms
+    const double TSC_MAX_RATE_CHANGE = 0.01;
+    // how far a thread's TSC may lag the most recent resync point (e.g.
+    //  due to cross-socket skew) before the TSC is deemed unreliable
+    const long long TSC_MAX_SKEW_NSEC = 10000;      // 10 us
+
+    // samples the TSC and the OS's monotonic clock as close to simultaneously
+    //  as possible by bracketing the system call with TSC reads and keeping
+    //  the tightest of a few attempts
+    void sample_clocks(unsigned long long& ticks, long long& nsec)
+    {
+      unsigned long long best_window = ~0ULL;
+      for(int i = 0; i < 5; i++) {
+	unsigned long long t0 = __builtin_ia32_rdtsc();
+	long long n = (Clock::native_time_in_nanoseconds(false) +
+		       Clock::get_zero_time());
+	unsigned long long t1 = __builtin_ia32_rdtsc();
+	if((t1 >= t0) && ((t1 - t0) < best_window)) {
+	  best_window = t1 - t0;
+	  ticks = t0 + ((t1 - t0) >> 1);
+	  nsec = n;
+	}
+      }
+    }
+  };
+#endif
+
+  /*static*/ void Clock::calibrate(bool use_tsc)
+  {
+#ifdef REALM_CLOCK_USE_TSC
+    if(!use_tsc) {
+      log_clock.info() << "TSC clock disabled - using OS clock";
+      return;
+    }
+
+    // CPUID.80000007H:EDX[8] indicates the TSC runs at a constant rate
+    //  regardless of P-/C-states
+    unsigned eax, ebx, ecx, edx;
+    if(!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ||
+       ((edx & (1U << 8)) == 0)) {
+      log_clock.info() << "no invariant TSC - using OS clock";
+      return;
+    }
+
+    unsigned long long ticks0 = 0, ticks1 = 0;
+    long long nsec0 = 0, nsec1 = 0;
+    sample_clocks(ticks0, nsec0);
+    do {
+      sample_clocks(ticks1, nsec1);
+    } while((nsec1 - nsec0) < TSC_CALIBRATE_NSEC);
+
+    // sanity-check the measured rate (anything outside 100MHz-10GHz is
+    //  almost certainly a virtualization artifact)
+    double rate = ((ticks1 > ticks0) ?
+		     (double(nsec1 - nsec0) / double(ticks1 - ticks0)) :
+		     0);
+    if((rate < 0.1) || (rate > 10.0)) {
+      log_clock.warning() << "implausible TSC rate measured (" << rate
+			  << " ns/tick) - using OS clock";
+      return;
+    }
+
+    tsc_calib_ticks = ticks1;
+    tsc_calib_nsec = nsec1;
+    tsc_calib_rate = rate;
+
+    unsigned seq = tsc_seq.load();
+    tsc_seq.store_release(seq + 1);
+    tsc_base.store_release(ticks1);
+    tsc_base_nsec.store_release(nsec1);
+    tsc_mult.store_release((unsigned long long)(rate * 4294967296.0));
+    tsc_limit.store_release(ticks1 + (unsigned long long)(TSC_RESYNC_NSEC / rate));
+    tsc_seq.store_release(seq + 2);
+
+    log_clock.info() << "using invariant TSC clock: "
+		     << (1e3 / rate) << " MHz";
+#else
+    (void)use_tsc;
+#endif
+  }
+
+#ifdef REALM_CLOCK_USE_TSC
+  /*static*/ long long Clock::resync_tsc(void)
+  {
+    // the OS clock may be behind times that have already been handed out
+    //  from the TSC (by up to the allowed drift), so no path through here
+    //  may simply return the OS time until it has caught up with the last
+    //  conversion that was published
+    while(true) {
+      unsigned seq = tsc_seq.load_acquire();
+      if((seq & 1) != 0) {
+	// another thread is updating the conversion - wait for it
+	__builtin_ia32_pause();
+	continue;
+      }
+      unsigned long long base = tsc_base.load_acquire();
+      unsigned long long limit = tsc_limit.load_acquire();
+      unsigned long long mult = tsc_mult.load_acquire();
+      long long base_nsec = tsc_base_nsec.load_acquire();
+      if(tsc_seq.load() != seq)
+	continue;
+
+      // TSC clock was never enabled, or has been fully retired
+      if(limit == 0)
+	return native_time_in_nanoseconds(false) + zero_time;
+
+      if(base == TSC_FAILED) {
+	// the TSC has been abandoned, but hold time at the last value it
+	//  could have produced until the OS clock catches up, after which the
+	//  OS clock can be used directly again
+	long long nsec = native_time_in_nanoseconds(false) + zero_time;
+	if(nsec < base_nsec)
+	  return base_nsec;
+	if(tsc_seq.compare_exchange(seq, seq + 1)) {
+	  tsc_limit.store_release(0);
+	  tsc_seq.store_release(seq + 2);
+	}
+	return nsec;
+      }
+
+      // somebody else may have already resynced - if so, use their
+      //  conversion
+      unsigned long long now = read_tsc();
+      if((now >= base) && (now < limit)) {
+	long long nsec = base_nsec + (long long)(((now - base) * mult) >> 32);
+	if(tsc_seq.load() == seq)
+	  return nsec;
+	continue;
+      }
+
+      // only one thread does the resync - anybody else retries against
+      //  the conversion it publishes
+      if(tsc_seq.compare_exchange(seq, seq + 1))
+	return update_tsc_conversion(seq, base, limit, mult, base_nsec);
+    }
+  }
+
+  // called with the sequence lock held (i.e. 'seq + 1' stored) - fits a new
+  //  conversion (or abandons the TSC), releases the lock, and returns the
+  //  current time
+  /*static*/ long long Clock::update_tsc_conversion(unsigned seq,
+						    unsigned long long base,
+						    unsigned long long limit,
+						    unsigned long long mult,
+						    long long base_nsec)
+  {
+    unsigned long long ticks;
+    long long nsec;
+    sample_clocks(ticks, nsec);
+
+    // the latest time any reader could have gotten from the outgoing
+    //  conversion - nothing returned from here on may be earlier
+    unsigned long long last_ticks = std::min(std::max(ticks, base), limit);
+    long long floor_nsec = base_nsec + (long long)(double(last_ticks - base) *
+						   double(mult) / 4294967296.0);
+
+    const char *failure = 0;
+    long long predicted = 0;
+    double rate = 0;
+    if(ticks < base) {
+      // this thread's TSC lags the most recent resync point - small amounts
+      //  of skew between cores are tolerable, but a TSC that goes
+      //  significantly backwards is not
+      if(double(base - ticks) * tsc_calib_rate > TSC_MAX_SKEW_NSEC)
+	failure = "went backwards";
+      else {
+	tsc_seq.store_release(seq + 2);
+	return std::max(nsec, floor_nsec);
+      }
+    } else if(ticks < limit) {
+      // the TSC moved back into the current interval while we were getting
+      //  here - no changes needed
+      tsc_seq.store_release(seq + 2);
+      return floor_nsec;
+    } else {
+      predicted = base_nsec + (long long)(double(ticks - base) *
+					  double(mult) / 4294967296.0);
+      long long drift = predicted - nsec;
+      // if nobody has asked for the time in a while, allow a proportionally
+      //  larger drift
+      long long max_drift = (TSC_MAX_DRIFT_NSEC *
+			     std::max(1LL, (nsec - base_nsec) / TSC_RESYNC_NSEC));
+      rate = double(nsec - tsc_calib_nsec) / double(ticks - tsc_calib_ticks);
+      if((drift > max_drift) || (drift < -max_drift))
+	failure = "drifted from OS clock";
+      else if(fabs(rate - tsc_calib_rate) > (TSC_MAX_RATE_CHANGE * tsc_calib_rate))
+	failure = "changed rate";
+    }
+
+    if(failure) {
+      log_clock.warning() << "TSC " << failure << " - falling back to OS clock";
+      // readers keep coming through resync_tsc (which holds time at
+      //  'floor_nsec') until the OS clock catches up
+      long long hold_nsec = std::max(nsec, floor_nsec);
+      tsc_base.store_release(TSC_FAILED);
+      tsc_base_nsec.store_release(hold_nsec);
+      tsc_limit.store_release(TSC_FAILED);
+      tsc_seq.store_release(seq + 2);
+      return hold_nsec;
+    }
+
+    // never let time go backwards - if the TSC-based time has gotten ahead
+    //  of the OS clock, start from where it is and slew the rate so that
+    //  the two line up again at the end of the next interval
+    long long new_base_nsec = std::max(nsec, predicted);
+    unsigned long long interval = (unsigned long long)(TSC_RESYNC_NSEC / rate);
+    double new_rate = (double(nsec + TSC_RESYNC_NSEC - new_base_nsec) /
+		       double(interval));
+
+    tsc_base.store_release(ticks);
+    tsc_base_nsec.store_release(new_base_nsec);
+    tsc_mult.store_release((unsigned long long)(new_rate * 4294967296.0));
+    tsc_limit.store_release(ticks + interval);
+    tsc_seq.store_release(seq + 2);
+
+    return new_base_nsec;
+  }
+#endif
+
 #ifdef DETAILED_TIMERS
   ////////////////////////////////////////////////////////////////////////
   //
@@ -19,6 +19,7 @@
 #define REALM_TIMERS_H
 
 #include "realm/realm_config.h"
+#include "realm/atomics.h"
 
 #ifdef DETAILED_TIMING
 #include "realm/network.h"
@@ -27,6 +28,13 @@
 #include <stdio.h>
 #include <map>
 
+// on x86 Linux, relative times are normally computed from the timestamp
+//  counter (calibrated against CLOCK_MONOTONIC) rather than with a system
+//  call - define REALM_NO_TSC_CLOCK to compile this out entirely
+#if defined(REALM_ON_LINUX) && (defined(__x86_64__) || defined(__i386__)) && !defined(REALM_NO_TSC_CLOCK)
+#define REALM_CLOCK_USE_TSC
+#endif
+
 // outside of namespace because 50-letter-long enums are annoying
 enum {
   TIME_NONE,
@@ -63,9 +71,51 @@ namespace Realm {
     // set_zero_time() should only be called by the runtime init code
     static void set_zero_time(void);
 
+    // calibrate() should also only be called by the runtime init code (before
+    //  set_zero_time) - if 'use_tsc' is set and the processor advertises an
+    //  invariant timestamp counter, relative times will be computed from the
+    //  TSC from then on, otherwise the OS clock continues to be used
+    static void calibrate(bool use_tsc);
+
+    // returns true if relative times are currently being derived from the TSC
+    static bool using_tsc(void);
+
+    // always asks the OS, bypassing any TSC-based clock
+    static long long native_time_in_nanoseconds(bool absolute = false);
+
   protected:
     REALM_INTERNAL_API_EXTERNAL_LINKAGE
     static long long zero_time;
+
+#ifdef REALM_CLOCK_USE_TSC
+    static unsigned long long read_tsc(void);
+
+    // called when the current TSC calibration interval has expired - refits
+    //  the conversion against the OS clock (or disables the TSC clock if the
+    //  two have diverged) and returns the current (non-zero-adjusted) time,
+    //  which is never earlier than any time already handed out
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static long long resync_tsc(void);
+    static long long update_tsc_conversion(unsigned seq,
+					   unsigned long long base,
+					   unsigned long long limit,
+					   unsigned long long mult,
+					   long long base_nsec);
+
+    // the conversion is protected by a sequence lock (odd == being updated):
+    //   nsec = tsc_base_nsec + (((tsc - tsc_base) * tsc_mult) >> 32)
+    //  and is valid for tsc_base <= tsc < tsc_limit - a tsc_limit of 0
+    //  means the TSC clock is not in use, while a tsc_base of TSC_FAILED
+    //  means it has been abandoned and tsc_base_nsec holds the last time
+    //  it may have produced (which the OS clock has yet to reach)
+    static const unsigned long long TSC_FAILED = ~0ULL;
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static atomic<unsigned> tsc_seq;
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static atomic<unsigned long long> tsc_base, tsc_limit, tsc_mult;
+    REALM_INTERNAL_API_EXTERNAL_LINKAGE
+    static atomic<long long> tsc_base_nsec;
+#endif
   };
 
   class Logger;
@@ -52,6 +52,34 @@ namespace Realm {
   
   inline /*static*/ long long Clock::current_time_in_nanoseconds(bool absolute /*= false*/)
   {
+#ifdef REALM_CLOCK_USE_TSC
+    // absolute times always come from the OS (CLOCK_REALTIME is not
+    //  monotonic, so the TSC can't be used to extrapolate it)
+    if(!absolute) {
+      unsigned long long limit = tsc_limit.load();
+      if(limit != 0) {
+	unsigned seq = tsc_seq.load_acquire();
+	unsigned long long base = tsc_base.load_acquire();
+	unsigned long long mult = tsc_mult.load_acquire();
+	long long base_nsec = tsc_base_nsec.load_acquire();
+	limit = tsc_limit.load_acquire();
+	unsigned long long now = read_tsc();
+	if(((seq & 1) == 0) && (tsc_seq.load() == seq) &&
+	   (now >= base) && (now < limit))
+	  return (base_nsec + (long long)(((now - base) * mult) >> 32) -
+		  zero_time);
+	// either the calibration interval has run out or we raced with an
+	//  update - the slow path sorts out which
+	if(limit != 0)
+	  return resync_tsc() - zero_time;
+      }
+    }
+#endif
+    return native_time_in_nanoseconds(absolute);
+  }
+
+  inline /*static*/ long long Clock::native_time_in_nanoseconds(bool absolute /*= false*/)
+  {
 #if defined(REALM_ON_LINUX) || defined(REALM_ON_FREEBSD)
     struct timespec ts;
     clock_gettime(absolute ? CLOCK_REALTIME : CLOCK_MONOTONIC, &ts);
@@ -80,6 +108,22 @@ namespace Realm {
     return zero_time;
   }
 
+#ifdef REALM_CLOCK_USE_TSC
+  inline /*static*/ unsigned long long Clock::read_tsc(void)
+  {
+    return __builtin_ia32_rdtsc();
+  }
+#endif
+
+  inline /*static*/ bool Clock::using_tsc(void)
+  {
+#ifdef REALM_CLOCK_USE_TSC
+    return ((tsc_limit.load() != 0) && (tsc_base.load() != TSC_FAILED));
+#else
+    return false;
+#endif
+  }
+
   inline /*static*/ void Clock::set_zero_time(void)
   {
     // this looks weird, but we can't use the absolute time because it uses
@@ -92,7 +136,7 @@ namespace Realm {
   
   ////////////////////////////////////////////////////////////////////////
   //
-  // class Clock
+  // class TimeStamp
 
   inline TimeStamp::TimeStamp(const char *_message, bool _difference, Logger *_logger /*= 0*/)
     : message(_message), difference(_difference), logger(_logger)
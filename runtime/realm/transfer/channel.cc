@@ -53,6 +53,17 @@ namespace Realm {
 			      uintptr_t src_base, uintptr_t src_lstride,
 			      size_t bytes, size_t lines)
   {
+    // single-element lines (e.g. one field of an AOS instance) are common
+    //  enough to be worth avoiding the std::copy loop setup for
+    if(bytes == sizeof(T)) {
+      for(size_t i = 0; i < lines; i++) {
+	*reinterpret_cast<T *>(dst_base) = *reinterpret_cast<const T *>(src_base);
+	src_base += src_lstride;
+	dst_base += dst_lstride;
+      }
+      return;
+    }
+
     for(size_t i = 0; i < lines; i++) {
       std::copy(reinterpret_cast<const T *>(src_base),
 		reinterpret_cast<const T *>(src_base + bytes),
@@ -75,6 +86,19 @@ namespace Realm {
     uintptr_t dst_pstride_adj = dst_pstride - (lines * dst_lstride);
     uintptr_t src_pstride_adj = src_pstride - (lines * src_lstride);
 
+    if(bytes == sizeof(T)) {
+      for(size_t j = 0; j < planes; j++) {
+	for(size_t i = 0; i < lines; i++) {
+	  *reinterpret_cast<T *>(dst_base) = *reinterpret_cast<const T *>(src_base);
+	  src_base += src_lstride;
+	  dst_base += dst_lstride;
+	}
+	src_base += src_pstride_adj;
+	dst_base += dst_pstride_adj;
+      }
+      return;
+    }
+
     for(size_t j = 0; j < planes; j++) {
       for(size_t i = 0; i < lines; i++) {
 	std::copy(reinterpret_cast<const T *>(src_base),
@@ -89,6 +113,37 @@ namespace Realm {
     }
   }
 
+  // transposing copies end up as 3D copies of single elements, with one
+  //  side walking lines and the other walking planes - copy these in
+  //  tiles of lines so that each cache line (and page) on the strided side
+  //  gets reused across several planes before it's evicted
+  template <typename T>
+  static void memcpy_3d_elements_typed(uintptr_t dst_base, uintptr_t dst_lstride,
+				       uintptr_t dst_pstride,
+				       uintptr_t src_base, uintptr_t src_lstride,
+				       uintptr_t src_pstride,
+				       size_t lines, size_t planes)
+  {
+    static const size_t TILE_LINES = 16;
+
+    for(size_t l0 = 0; l0 < lines; l0 += TILE_LINES) {
+      size_t tile_lines = std::min(TILE_LINES, lines - l0);
+      uintptr_t src_tile = src_base + (l0 * src_lstride);
+      uintptr_t dst_tile = dst_base + (l0 * dst_lstride);
+      for(size_t j = 0; j < planes; j++) {
+	uintptr_t src = src_tile;
+	uintptr_t dst = dst_tile;
+	for(size_t i = 0; i < tile_lines; i++) {
+	  *reinterpret_cast<T *>(dst) = *reinterpret_cast<const T *>(src);
+	  src += src_lstride;
+	  dst += dst_lstride;
+	}
+	src_tile += src_pstride;
+	dst_tile += dst_pstride;
+      }
+    }
+  }
+
   // need types with various powers-of-2 size/alignment - we have up to
   //  uint64_t as builtins, but we need trivially-copyable 16B and 32B things
   struct dummy_16b_t { uint64_t a, b; };
@@ -199,6 +254,36 @@ namespace Realm {
       std::swap(src_pstride, src_lstride);
       std::swap(planes, lines);
     }
+    // single-element lines with a source that's more linear in planes than
+    //  in lines is a transpose, which gets its own tiled kernel
+    if((src_pstride < src_lstride) && (bytes <= 8) &&
+       ((alignment & (bytes - 1)) == (bytes - 1))) {
+      switch(bytes) {
+      case 8:
+	memcpy_3d_elements_typed<uint64_t>(dst_base, dst_lstride, dst_pstride,
+					   src_base, src_lstride, src_pstride,
+					   lines, planes);
+	return;
+      case 4:
+	memcpy_3d_elements_typed<uint32_t>(dst_base, dst_lstride, dst_pstride,
+					   src_base, src_lstride, src_pstride,
+					   lines, planes);
+	return;
+      case 2:
+	memcpy_3d_elements_typed<uint16_t>(dst_base, dst_lstride, dst_pstride,
+					   src_base, src_lstride, src_pstride,
+					   lines, planes);
+	return;
+      case 1:
+	memcpy_3d_elements_typed<uint8_t>(dst_base, dst_lstride, dst_pstride,
+					  src_base, src_lstride, src_pstride,
+					  lines, planes);
+	return;
+      default:
+	// not a power of 2 - fall through to the general case
+	break;
+      }
+    }
     // TODO: consider jump table approach?
     if((alignment & 31) == 31)
       memcpy_3d_typed<aligned_32b_t>(dst_base, dst_lstride, dst_pstride,
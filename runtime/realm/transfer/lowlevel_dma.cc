@@ -64,11 +64,53 @@ namespace Realm {
 
   PendingIBQueue ib_req_queue;
 
+  /*static*/ bool PendingIBQueue::attempt_allocation(IBMemory *ibmem,
+						     const IBAllocRequest& req,
+						     unsigned waiters)
+  {
+    off_t offset;
+    size_t granted = req.size;
+    if(req.min_size > 0)
+      offset = ibmem->alloc_bytes_elastic(req.size, req.min_size,
+					  waiters, granted);
+    else
+      offset = ibmem->alloc_bytes_local(req.size);
+    if(offset < 0)
+      return false;
+
+    if(req.req_node == Network::my_node_id) {
+      TransferOperation *op = reinterpret_cast<TransferOperation *>(req.req_op);
+      op->notify_ib_allocation(req.ib_index, offset, granted);
+    } else {
+      ActiveMessage<RemoteIBAllocResponse> amsg(req.req_node);
+      amsg->req_op = req.req_op;
+      amsg->ib_index = req.ib_index;
+      amsg->offset = offset;
+      amsg->size = granted;
+      amsg.commit();
+    }
+    return true;
+  }
+
   // enqueues a request (or handles immediately, if possible)
   void PendingIBQueue::enqueue_request(Memory tgt_mem, NodeID req_node,
 				       uintptr_t req_op,
-				       unsigned ib_index, size_t size)
+				       unsigned ib_index, size_t size,
+				       size_t min_size)
   {
+    IBAllocRequest req { req_node, req_op, ib_index, size, min_size };
+
+    // a request that can never be satisfied would just sit at the head of
+    //  the queue and block everybody else forever
+    IBMemory *ibmem = get_runtime()->get_ib_memory_impl(tgt_mem);
+    if(((min_size > 0) ? min_size : size) > ibmem->size) {
+      log_ib_alloc.fatal() << "intermediate buffer request of "
+			   << ((min_size > 0) ? min_size : size)
+			   << " bytes exceeds size of " << tgt_mem
+			   << " (" << ibmem->size << " bytes)";
+      abort();
+    }
+
     // do most of this with mutex held
     AutoLock<> al(queue_mutex);
 
@@ -78,22 +120,9 @@ namespace Realm {
       // drop the lock while we attempt an immediate allocation
       al.release();
 
-      IBMemory *ibmem = get_runtime()->get_ib_memory_impl(tgt_mem);
-      off_t offset = ibmem->alloc_bytes_local(size);
-      if(offset >= 0) {
-	// success - notify op and return (lock is already dropped)
-	if(req_node == Network::my_node_id) {
-	  TransferOperation *op = reinterpret_cast<TransferOperation *>(req_op);
-	  op->notify_ib_allocation(ib_index, offset);
-	} else {
-	  ActiveMessage<RemoteIBAllocResponse> amsg(req_node);
-	  amsg->req_op = req_op;
-	  amsg->ib_index = ib_index;
-	  amsg->offset = offset;
-	  amsg.commit();
-	}
+      // success notifies the op, so we just return (lock is already dropped)
+      if(attempt_allocation(ibmem, req, 0))
 	return;
-      }
 
       // failed - reacquire lock and enqueue
       al.reacquire();
@@ -106,7 +135,11 @@ namespace Realm {
     if(it == queues.end())
       it = queues.insert({ tgt_mem, PerMemory { 0 } }).first;
 
-    it->second.requests.push_back(IBAllocRequest { req_node, req_op, ib_index, size });
+    // the request will be retried as other buffers in this memory are freed
+    log_ib_alloc.info() << "ib request queued: mem=" << tgt_mem
+			<< " size=" << size
+			<< " pending=" << (it->second.requests.size() + 1);
+    it->second.requests.push_back(req);
   }
 
   // attempts to dequeue pending requests for the specified memory
@@ -139,29 +172,19 @@ namespace Realm {
     while(!pm.requests.empty()) {
       // peek at first entry and then drop lock while attempting allocation
       IBAllocRequest req = pm.requests.front();
+      // everybody else in the queue is owed a share of the memory too
+      unsigned waiters = pm.requests.size() - 1;
       al.release();
 
       if(!ibmem)
 	ibmem = get_runtime()->get_ib_memory_impl(tgt_mem);
-      off_t offset = ibmem->alloc_bytes_local(req.size);
-      if(offset >= 0) {
-	// success - notify op
-	if(req.req_node == Network::my_node_id) {
-	  TransferOperation *op = reinterpret_cast<TransferOperation *>(req.req_op);
-	  op->notify_ib_allocation(req.ib_index, offset);
-	} else {
-	  ActiveMessage<RemoteIBAllocResponse> amsg(req.req_node);
-	  amsg->req_op = req.req_op;
-	  amsg->ib_index = req.ib_index;
-	  amsg->offset = offset;
-	  amsg.commit();
-	}
-      }
+      // success notifies op
+      bool ok = attempt_allocation(ibmem, req, waiters);
 
       // have to re-take lock even if we failed because another dequeue request
       //  might have piled up, which means we need to try again
       al.reacquire();
-      if(offset >= 0) {
+      if(ok) {
 #ifdef DEBUG_REALM
 	assert(req.req_node == pm.requests.front().req_node);
 	assert(req.req_op == pm.requests.front().req_op);
@@ -193,7 +216,8 @@ namespace Realm {
 						       const void *data, size_t msglen)
   {
     ib_req_queue.enqueue_request(args.memory, sender,
-				 args.req_op, args.ib_index, args.size);
+				 args.req_op, args.ib_index,
+				 args.size, args.min_size);
   }
 
   ActiveMessageHandlerReg<RemoteIBAllocRequest> remote_ib_alloc_request_handler;
@@ -209,7 +233,7 @@ namespace Realm {
 							const void *data, size_t msglen)
   {
     TransferOperation *op = reinterpret_cast<TransferOperation *>(args.req_op);
-    op->notify_ib_allocation(args.ib_index, args.offset);
+    op->notify_ib_allocation(args.ib_index, args.offset, args.size);
   }
 
   ActiveMessageHandlerReg<RemoteIBAllocResponse> remote_ib_alloc_response_handler;
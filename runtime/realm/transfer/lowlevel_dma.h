@@ -32,9 +32,11 @@ namespace Realm {
   // keeps a per-memory queue of pending IB allocation requests
   class PendingIBQueue {
   public:
-    // enqueues a request (or handles immediately, if possible)
+    // enqueues a request (or handles immediately, if possible) - if
+    //  'min_size' is nonzero, anything from 'min_size' to 'size' bytes
+    //  (see IBMemory::alloc_bytes_elastic) is acceptable
     void enqueue_request(Memory tgt_mem, NodeID req_node, uintptr_t req_op,
-			 unsigned ib_index, size_t size);
+			 unsigned ib_index, size_t size, size_t min_size);
 
     // attempts to dequeue pending requests for the specified memory
     void dequeue_request(Memory tgt_mem);
@@ -45,8 +47,14 @@ namespace Realm {
       NodeID req_node;
       uintptr_t req_op;
       unsigned ib_index;
-      size_t size;
+      size_t size, min_size;
     };
+
+    // attempts the allocation for a request and notifies the requestor on
+    //  success
+    static bool attempt_allocation(IBMemory *ibmem, const IBAllocRequest& req,
+				   unsigned waiters);
+
     struct PerMemory {
       int deq_count;  // count of pending dequeuers
       CircularQueue<IBAllocRequest, 16> requests;
@@ -58,7 +66,7 @@ namespace Realm {
 
   struct RemoteIBAllocRequest {
     Memory memory;
-    size_t size;
+    size_t size, min_size;
     uintptr_t req_op;
     unsigned ib_index;
     
@@ -70,6 +78,7 @@ namespace Realm {
     uintptr_t req_op;
     unsigned ib_index;
     off_t offset;
+    size_t size;
 
     static void handle_message(NodeID sender, const RemoteIBAllocResponse &args,
 			       const void *data, size_t msglen);
@@ -3124,9 +3124,13 @@ namespace Realm {
     perform_analysis();
   }
 
+  // picks the preferred size of an intermediate buffer for a copy, along
+  //  with the smallest size it can be shrunk to (0 if it can't be) when the
+  //  IB memory is shared with other transfers
   static size_t compute_ib_size(size_t combined_field_size,
 				size_t domain_size,
-				CustomSerdezID serdez_id)
+				CustomSerdezID serdez_id,
+				size_t& min_size)
   {
     size_t element_size;
     size_t serdez_pad = 0;
@@ -3142,7 +3146,12 @@ namespace Realm {
     }
 
     size_t ib_size = domain_size * element_size + serdez_pad;
-    const size_t IB_MAX_SIZE = 16 << 20; // 16MB
+    // large copies get deep pipelining if the IB memory is idle when the
+    //  buffer is granted - IBMemory::alloc_bytes_elastic caps this at a
+    //  share of the memory if other copies hold or are waiting for buffers
+    //  then (a granted buffer is not resized afterwards)
+    const size_t IB_MAX_SIZE = 64 << 20; // 64MB
+    const size_t IB_MIN_SIZE = 1 << 20; // 1MB
     if(ib_size > IB_MAX_SIZE) {
       // take up to IB_MAX_SIZE, respecting the min granularity
       if(min_granularity > 1) {
@@ -3158,6 +3167,14 @@ namespace Realm {
 	ib_size = IB_MAX_SIZE;
     }
 
+    // serdez buffers stay fixed, as do ones that are already small - others
+    //  can be shrunk in units of the element size
+    if((serdez_id == 0) && (ib_size > IB_MIN_SIZE) &&
+       (min_granularity <= IB_MIN_SIZE))
+      min_size = IB_MIN_SIZE - (IB_MIN_SIZE % min_granularity);
+    else
+      min_size = 0;
+
     return ib_size;
   }
 
@@ -3259,12 +3276,14 @@ namespace Realm {
         size_t xd_idx = graph.xd_nodes.size();
         size_t ib_idx = graph.ib_edges.size();
         size_t ib_alloc_size = 0;
+        size_t ib_min_size = 0;
         graph.xd_nodes.resize(xd_idx + pathlen);
         if(pathlen > 1) {
           graph.ib_edges.resize(ib_idx + pathlen - 1);
           ib_alloc_size = compute_ib_size(combined_field_size,
                                           domain_size,
-                                          serdez_id);
+                                          serdez_id,
+                                          ib_min_size);
         }
         for(size_t j = 0; j < pathlen; j++) {
           TransferGraph::XDTemplate& xdn = graph.xd_nodes[xd_idx++];
@@ -3294,6 +3313,7 @@ namespace Realm {
             TransferGraph::IBInfo& ibe = graph.ib_edges[ib_idx++];
             ibe.memory = path_info.path[j + 1];
             ibe.size = ib_alloc_size;
+            ibe.min_size = ib_min_size;
           }
         }
 
@@ -3389,12 +3409,14 @@ namespace Realm {
 	    size_t xd_idx = graph.xd_nodes.size();
 	    size_t ib_idx = graph.ib_edges.size();
 	    size_t ib_alloc_size = 0;
+	    size_t ib_min_size = 0;
 	    graph.xd_nodes.resize(xd_idx + pathlen);
 	    if(pathlen > 1) {
 	      graph.ib_edges.resize(ib_idx + pathlen - 1);
 	      ib_alloc_size = compute_ib_size(combined_field_size,
 					      domain_size,
-					      serdez_id);
+					      serdez_id,
+					      ib_min_size);
 	    }
 	    for(size_t j = 0; j < pathlen; j++) {
 	      TransferGraph::XDTemplate& xdn = graph.xd_nodes[xd_idx++];
@@ -3420,6 +3442,7 @@ namespace Realm {
 		TransferGraph::IBInfo& ibe = graph.ib_edges[ib_idx++];
 		ibe.memory = path_info.path[j + 1];
 		ibe.size = ib_alloc_size;
+		ibe.min_size = ib_min_size;
 	      }
 	    }
 
@@ -3702,6 +3725,7 @@ namespace Realm {
 
     if(!tg.ib_edges.empty()) {
       ib_offsets.resize(tg.ib_edges.size(), -1);
+      ib_sizes.resize(tg.ib_edges.size(), 0);
 
       // increase the count by one to prevent a trigger before we finish
       //  this loop
@@ -3726,12 +3750,14 @@ namespace Realm {
 	    // local request
 	    ib_req_queue.enqueue_request(tgt_mem, Network::my_node_id,
 					 reinterpret_cast<uintptr_t>(this),
-					 *it2, tg.ib_edges[*it2].size);
+					 *it2, tg.ib_edges[*it2].size,
+					 tg.ib_edges[*it2].min_size);
 	  } else {
 	    // send message to remote owner
 	    ActiveMessage<RemoteIBAllocRequest> amsg(owner);
 	    amsg->memory = tgt_mem;
 	    amsg->size = tg.ib_edges[*it2].size;
+	    amsg->min_size = tg.ib_edges[*it2].min_size;
 	    amsg->req_op = reinterpret_cast<uintptr_t>(this);
 	    amsg->ib_index = *it2;
 	    amsg.commit();
@@ -3767,13 +3793,16 @@ namespace Realm {
   }
 
   void TransferOperation::notify_ib_allocation(unsigned ib_index,
-					       off_t ib_offset)
+					       off_t ib_offset,
+					       size_t ib_size)
   {
     assert(ib_index < ib_offsets.size());
 #ifdef DEBUG_REALM
     assert(ib_offsets[ib_index] == -1);
 #endif
     ib_offsets[ib_index] = ib_offset;
+    // may be smaller than requested if the IB memory is busy
+    ib_sizes[ib_index] = ib_size;
 
     // if this was the last response needed, we can continue on to creating xds
     if(ib_responses_needed.fetch_sub_acqrel(1) == 1)
@@ -3901,7 +3930,7 @@ namespace Realm {
 	    ii.mem = tg.ib_edges[xdn.inputs[j].edge].memory;
 	    ii.inst = RegionInstance::NO_INST;
 	    ii.ib_offset = ib_offsets[xdn.inputs[j].edge];
-	    ii.ib_size = tg.ib_edges[xdn.inputs[j].edge].size;
+	    ii.ib_size = ib_sizes[xdn.inputs[j].edge];
 	    ii.iter = new WrappingFIFOIterator(ii.ib_offset, ii.ib_size);
 	    ii.serdez_id = 0;
 	    break;
@@ -4032,7 +4061,7 @@ namespace Realm {
 	    oi.mem = tg.ib_edges[xdn.outputs[j].edge].memory;
 	    oi.inst = RegionInstance::NO_INST;
 	    oi.ib_offset = ib_offsets[xdn.outputs[j].edge];
-	    oi.ib_size = tg.ib_edges[xdn.outputs[j].edge].size;
+	    oi.ib_size = ib_sizes[xdn.outputs[j].edge];
 	    oi.iter = new WrappingFIFOIterator(oi.ib_offset, oi.ib_size);
 	    oi.serdez_id = 0;
 	    break;
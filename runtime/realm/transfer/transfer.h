@@ -214,6 +214,9 @@ namespace Realm {
     struct IBInfo {
       Memory memory;
       size_t size;
+      // if nonzero, the IB may be shrunk to a multiple of this when the
+      //  memory is contended
+      size_t min_size;
     };
     std::vector<XDTemplate> xd_nodes;
     std::vector<IBInfo> ib_edges;
@@ -347,7 +350,8 @@ namespace Realm {
     void allocate_ibs();
     void create_xds();
 
-    void notify_ib_allocation(unsigned ib_index, off_t ib_offset);
+    void notify_ib_allocation(unsigned ib_index, off_t ib_offset,
+			      size_t ib_size);
     void notify_xd_completion(XferDesID xd_id);
 
     class XDLifetimeTracker : public Operation::AsyncWorkItem {
@@ -381,6 +385,7 @@ namespace Realm {
     std::vector<XferDesID> xd_ids;
     std::vector<XDLifetimeTracker *> xd_trackers;
     std::vector<off_t> ib_offsets;
+    std::vector<size_t> ib_sizes;
     atomic<int> ib_responses_needed;
     int priority;
   };
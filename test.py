@@ -75,6 +75,9 @@ legion_cxx_tests = [
     # Tests
     ['test/rendering/rendering', ['-i', '2', '-n', '64', '-ll:cpu', '4']],
     ['test/legion_stl/test_stl', []],
+    ['test/accessor_cache/accessor_cache', []],
+    ['test/c_accessors/c_accessors', []],
+    ['test/lazy_partition/lazy_partition', []],
 ]
 
 legion_fortran_tests = [
@@ -95,6 +98,7 @@ if platform.system() != 'Darwin':
     legion_cxx_tests += [
         # FIXME: Fails non-deterministically on Mac OS: https://github.com/StanfordLegion/legion/issues/213
         ['test/attach_file_mini/attach_file_mini', []],
+        ['test/attach_prefetch/attach_prefetch', []],
     ]
 
 legion_network_cxx_tests = [
@@ -103,6 +107,7 @@ legion_network_cxx_tests = [
 
     # Tests
     ['test/bug954/bug954', ['-ll:rsize', '1024']],
+    ['test/deterministic_reduction/deterministic_reduction', []],
 ]
 
 legion_openmp_cxx_tests = [
@@ -0,0 +1,218 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests the cache of affine field layouts kept by physical regions:
+//  repeated accessor constructions (including from several threads at
+//  once) must hit the cache and see the same layout, and an unmap/remap
+//  must not hand out stale layouts
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  LEAF_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_A = 1,
+  FID_B = 2,
+};
+
+typedef FieldAccessor<LEGION_READ_ONLY,double,2,coord_t,
+          Realm::AffineAccessor<double,2,coord_t> > ReadAccessorA;
+typedef FieldAccessor<LEGION_READ_WRITE,double,2,coord_t,
+          Realm::AffineAccessor<double,2,coord_t> > WriteAccessorA;
+typedef FieldAccessor<LEGION_READ_WRITE,long long,2,coord_t,
+          Realm::AffineAccessor<long long,2,coord_t> > WriteAccessorB;
+
+static const int NUM_THREADS = 4;
+static const int NUM_REPEATS = 100;
+
+struct CheckArgs {
+  const PhysicalRegion *region;
+  Rect<2> bounds;
+  const void *expected_a;
+  const void *expected_b;
+  bool ok;
+};
+
+static bool check_values(const PhysicalRegion &region, const Rect<2> &bounds,
+                         const void *expected_a, const void *expected_b)
+{
+  bool ok = true;
+  for (int rep = 0; rep < NUM_REPEATS; rep++)
+  {
+    // Every construction after the first comes from the layout cache
+    const ReadAccessorA acc_a(region, FID_A);
+    const WriteAccessorB acc_b(region, FID_B);
+    if ((acc_a.ptr(bounds.lo) != expected_a) ||
+        (acc_b.ptr(bounds.lo) != expected_b))
+      ok = false;
+    for (PointInRectIterator<2> pir(bounds); pir(); pir++)
+    {
+      if (acc_a[*pir] != (pir[0] * 1000 + pir[1]))
+        ok = false;
+      if (acc_b[*pir] != (pir[0] - pir[1]))
+        ok = false;
+    }
+  }
+  return ok;
+}
+
+static void *check_thread(void *arg)
+{
+  CheckArgs *args = static_cast<CheckArgs*>(arg);
+  args->ok = check_values(*(args->region), args->bounds,
+                          args->expected_a, args->expected_b);
+  return NULL;
+}
+
+void leaf_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, Runtime *runtime)
+{
+  const Rect<2> bounds = regions[0];
+  const void *expected_a = NULL;
+  const void *expected_b = NULL;
+  {
+    const WriteAccessorA acc_a(regions[0], FID_A);
+    const WriteAccessorB acc_b(regions[0], FID_B);
+    for (PointInRectIterator<2> pir(bounds); pir(); pir++)
+    {
+      acc_a[*pir] = pir[0] * 1000 + pir[1];
+      acc_b[*pir] = pir[0] - pir[1];
+    }
+    expected_a = acc_a.ptr(bounds.lo);
+    expected_b = acc_b.ptr(bounds.lo);
+  }
+  // Build accessors from several threads at once so they race on the cache
+  CheckArgs args[NUM_THREADS];
+  pthread_t threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; i++)
+  {
+    args[i].region = &regions[0];
+    args[i].bounds = bounds;
+    args[i].expected_a = expected_a;
+    args[i].expected_b = expected_b;
+    args[i].ok = false;
+    int ret = pthread_create(&threads[i], NULL, check_thread, &args[i]);
+    assert(ret == 0);
+  }
+  bool ok = check_values(regions[0], bounds, expected_a, expected_b);
+  for (int i = 0; i < NUM_THREADS; i++)
+  {
+    pthread_join(threads[i], NULL);
+    if (!args[i].ok)
+      ok = false;
+  }
+  if (!ok)
+  {
+    printf("Accessor cache check failed for point %lld\n",
+           task->index_point[0]);
+    abort();
+  }
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  const Rect<2> bounds(Point<2>(0,0), Point<2>(63,31));
+  IndexSpace is = runtime->create_index_space(ctx, bounds);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(double), FID_A);
+    allocator.allocate_field(sizeof(long long), FID_B);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  const Rect<1> colors(0, 3);
+  IndexSpace color_space = runtime->create_index_space(ctx, colors);
+  IndexPartition ip = runtime->create_equal_partition(ctx, is, color_space);
+  LogicalPartition lp = runtime->get_logical_partition(lr, ip);
+
+  IndexTaskLauncher launcher(LEAF_TASK_ID, color_space,
+                             TaskArgument(), ArgumentMap());
+  launcher.add_region_requirement(
+      RegionRequirement(lp, 0/*projection*/, LEGION_READ_WRITE,
+                        LEGION_EXCLUSIVE, lr));
+  launcher.add_field(0, FID_A);
+  launcher.add_field(0, FID_B);
+  runtime->execute_index_space(ctx, launcher).wait_all_results();
+
+  // Unmapping must clear the cache so a remap never sees a stale layout
+  InlineLauncher inline_launcher(
+      RegionRequirement(lr, LEGION_READ_WRITE, LEGION_EXCLUSIVE, lr));
+  inline_launcher.add_field(FID_A);
+  PhysicalRegion region = runtime->map_region(ctx, inline_launcher);
+  bool ok = true;
+  for (int rep = 0; rep < 2; rep++)
+  {
+    region.wait_until_valid();
+    const WriteAccessorA acc_a(region, FID_A);
+    const WriteAccessorA cached_a(region, FID_A);
+    if (acc_a.ptr(bounds.lo) != cached_a.ptr(bounds.lo))
+      ok = false;
+    for (PointInRectIterator<2> pir(bounds); pir(); pir++)
+    {
+      if (acc_a[*pir] != (pir[0] * 1000 + pir[1] + rep))
+        ok = false;
+      cached_a[*pir] = cached_a[*pir] + 1;
+    }
+    runtime->unmap_region(ctx, region);
+    if (rep == 0)
+      runtime->remap_region(ctx, region);
+  }
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_space);
+  runtime->destroy_index_space(ctx, is);
+
+  if (ok)
+    printf("SUCCESS!\n");
+  else
+  {
+    printf("FAILURE!\n");
+    abort();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  {
+    TaskVariantRegistrar registrar(LEAF_TASK_ID, "leaf");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<leaf_task>(registrar, "leaf");
+  }
+
+  return Runtime::start(argc, argv);
+}
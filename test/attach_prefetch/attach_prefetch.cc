@@ -0,0 +1,320 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests index attaches with prefetching turned on: every piece of a
+//  region is attached to its own file after the files have been pushed
+//  out of the page cache, and the files have to come back into the page
+//  cache before anything reads from the attached instances. With HDF5
+//  the files are named with 'rank=N:' prefixes, which the prefetch has
+//  to strip (and use to pick the node that reads the file).
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "legion.h"
+#ifdef LEGION_USE_HDF5
+#include <hdf5.h>
+#endif
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_FILE = 1,
+  FID_COPY = 2,
+};
+
+static const coord_t NUM_PIECES = 4;
+// 2MB of doubles in every piece
+static const coord_t PIECE_SIZE = 1 << 18;
+static const coord_t NUM_POINTS = NUM_PIECES * PIECE_SIZE;
+
+typedef FieldAccessor<LEGION_READ_ONLY,double,1,coord_t,
+          Realm::AffineAccessor<double,1,coord_t> > ValueAccessor;
+
+static double expected_value(coord_t point)
+{
+  return 0.5 * point + 1.0;
+}
+
+// Returns the fraction of the file's pages that are in the page cache
+static double resident_fraction(const char *file_name)
+{
+  const int fd = open(file_name, O_RDONLY);
+  assert(fd >= 0);
+  struct stat st;
+  fstat(fd, &st);
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  assert(base != MAP_FAILED);
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t pages = (st.st_size + page_size - 1) / page_size;
+  std::vector<unsigned char> residency(pages);
+  int ret = mincore(base, st.st_size, &residency[0]);
+  assert(ret == 0);
+  size_t resident = 0;
+  for (size_t idx = 0; idx < pages; idx++)
+    if (residency[idx] & 1)
+      resident++;
+  munmap(base, st.st_size);
+  close(fd);
+  return double(resident) / pages;
+}
+
+// Writes the file out to the disk and drops it from the page cache
+static void evict_file(const char *file_name)
+{
+  const int fd = open(file_name, O_RDONLY);
+  assert(fd >= 0);
+  fsync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+static void write_posix_file(const char *file_name, coord_t lo)
+{
+  std::vector<double> values(PIECE_SIZE);
+  for (coord_t idx = 0; idx < PIECE_SIZE; idx++)
+    values[idx] = expected_value(lo + idx);
+  FILE *f = fopen(file_name, "wb");
+  assert(f != NULL);
+  size_t amt = fwrite(&values[0], sizeof(double), PIECE_SIZE, f);
+  assert(amt == size_t(PIECE_SIZE));
+  fclose(f);
+}
+
+#ifdef LEGION_USE_HDF5
+static void write_hdf5_file(const char *file_name, coord_t lo)
+{
+  // HDF5 instances use the points' coordinates in the dataset, so the
+  // dataset has to cover the whole region even though only this piece's
+  // part of it is ever read
+  std::vector<double> values(NUM_POINTS, 0.0);
+  for (coord_t idx = 0; idx < PIECE_SIZE; idx++)
+    values[lo + idx] = expected_value(lo + idx);
+  hid_t file_id = H5Fcreate(file_name, H5F_ACC_TRUNC,
+                            H5P_DEFAULT, H5P_DEFAULT);
+  assert(file_id >= 0);
+  hsize_t dims[1] = { hsize_t(NUM_POINTS) };
+  hid_t space_id = H5Screate_simple(1, dims, NULL);
+  hid_t dset_id = H5Dcreate2(file_id, "value", H5T_IEEE_F64LE, space_id,
+                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  assert(dset_id >= 0);
+  herr_t status = H5Dwrite(dset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL,
+                           H5P_DEFAULT, &values[0]);
+  assert(status >= 0);
+  H5Dclose(dset_id);
+  H5Sclose(space_id);
+  H5Fclose(file_id);
+}
+#endif
+
+// Attaches every piece of the region to its own file with prefetching
+//  and checks that the files are read in before any copies out of them
+static bool test_attach(Context ctx, Runtime *runtime,
+                        LogicalRegion lr, LogicalPartition lp,
+                        bool hdf5)
+{
+  const AddressSpace num_nodes =
+    Machine::get_machine().get_address_space_count();
+  // The names of the files in the file system, and the names that they
+  // are attached with (with the 'rank=N:' prefixes for HDF5)
+  std::vector<std::string> file_names(NUM_PIECES);
+  std::vector<std::string> attach_names(NUM_PIECES);
+  // Only the page cache of this node can be inspected
+  std::vector<bool> check_residency(NUM_PIECES, true);
+  for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+  {
+    char name[64];
+    snprintf(name, sizeof(name), "attach_prefetch_%d_%lld.%s",
+             int(getpid()), idx, hdf5 ? "h5" : "dat");
+    file_names[idx] = name;
+    attach_names[idx] = name;
+#ifdef LEGION_USE_HDF5
+    if (hdf5)
+    {
+      const AddressSpace rank = idx % num_nodes;
+      char prefix[32];
+      snprintf(prefix, sizeof(prefix), "rank=%d:", rank);
+      attach_names[idx] = prefix + file_names[idx];
+      check_residency[idx] = (rank == 0);
+      write_hdf5_file(name, idx * PIECE_SIZE);
+    }
+    else
+#endif
+      write_posix_file(name, idx * PIECE_SIZE);
+    evict_file(name);
+  }
+  (void)num_nodes;
+
+  // Not all file systems let files be dropped from the page cache
+  bool evicted = true;
+  for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+    if (resident_fraction(file_names[idx].c_str()) > 0.5)
+      evicted = false;
+  if (!evicted)
+    printf("Files could not be evicted from the page cache, "
+           "skipping the prefetch checks\n");
+
+  IndexAttachLauncher launcher(hdf5 ? LEGION_EXTERNAL_HDF5_FILE :
+                                 LEGION_EXTERNAL_POSIX_FILE, lr);
+  launcher.prefetch = true;
+  launcher.privilege_fields.insert(FID_FILE);
+  std::vector<FieldID> fields(1, FID_FILE);
+  std::map<FieldID,const char*> field_map;
+  field_map[FID_FILE] = "value";
+  for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+  {
+    LogicalRegion piece =
+      runtime->get_logical_subregion_by_color(ctx, lp, DomainPoint(idx));
+    if (hdf5)
+      launcher.attach_hdf5(piece, attach_names[idx].c_str(), field_map,
+                           LEGION_FILE_READ_ONLY);
+    else
+      launcher.attach_file(piece, attach_names[idx].c_str(), fields,
+                           LEGION_FILE_READ_ONLY);
+  }
+  ExternalResources resources =
+    runtime->attach_external_resources(ctx, launcher);
+
+  bool ok = true;
+  if (evicted)
+  {
+    // Nothing has read from the files yet, so only the prefetch can be
+    // bringing them back into the page cache
+    bool all_resident = false;
+    for (int tries = 0; !all_resident && (tries < 1000); tries++)
+    {
+      all_resident = true;
+      for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+        if (check_residency[idx] &&
+            (resident_fraction(file_names[idx].c_str()) < 0.99))
+          all_resident = false;
+      if (!all_resident)
+        usleep(10000);
+    }
+    if (!all_resident)
+    {
+      printf("Attached %s files were not prefetched\n",
+             hdf5 ? "HDF5" : "POSIX");
+      ok = false;
+    }
+  }
+
+  for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+  {
+    LogicalRegion piece =
+      runtime->get_logical_subregion_by_color(ctx, lp, DomainPoint(idx));
+    CopyLauncher copy;
+    copy.add_copy_requirements(
+        RegionRequirement(piece, LEGION_READ_ONLY, LEGION_EXCLUSIVE, lr)
+          .add_field(FID_FILE),
+        RegionRequirement(piece, LEGION_WRITE_DISCARD, LEGION_EXCLUSIVE, lr)
+          .add_field(FID_COPY));
+    runtime->issue_copy_operation(ctx, copy);
+  }
+  runtime->detach_external_resources(ctx, resources);
+
+  {
+    InlineLauncher inline_launcher(RegionRequirement(lr, LEGION_READ_ONLY,
+                                                     LEGION_EXCLUSIVE, lr));
+    inline_launcher.add_field(FID_COPY);
+    PhysicalRegion region = runtime->map_region(ctx, inline_launcher);
+    region.wait_until_valid();
+    const ValueAccessor values(region, FID_COPY);
+    size_t errors = 0;
+    for (coord_t point = 0; point < NUM_POINTS; point++)
+      if (values[point] != expected_value(point))
+      {
+        if (errors < 10)
+          printf("Point %lld has value %g instead of %g\n",
+                 point, values[point], expected_value(point));
+        errors++;
+      }
+    if (errors > 0)
+    {
+      printf("%zd values were not read correctly from the %s files\n",
+             errors, hdf5 ? "HDF5" : "POSIX");
+      ok = false;
+    }
+    runtime->unmap_region(ctx, region);
+  }
+
+  // Make sure the instances are gone before the files
+  runtime->issue_execution_fence(ctx).wait();
+  for (coord_t idx = 0; idx < NUM_PIECES; idx++)
+    remove(file_names[idx].c_str());
+  return ok;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  IndexSpace is =
+    runtime->create_index_space(ctx, Rect<1>(0, NUM_POINTS-1));
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(double), FID_FILE);
+    allocator.allocate_field(sizeof(double), FID_COPY);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  IndexSpace color_space =
+    runtime->create_index_space(ctx, Rect<1>(0, NUM_PIECES-1));
+  IndexPartition ip = runtime->create_equal_partition(ctx, is, color_space);
+  LogicalPartition lp = runtime->get_logical_partition(lr, ip);
+
+  bool ok = test_attach(ctx, runtime, lr, lp, false/*hdf5*/);
+#ifdef LEGION_USE_HDF5
+  if (!test_attach(ctx, runtime, lr, lp, true/*hdf5*/))
+    ok = false;
+#endif
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_space);
+  runtime->destroy_index_space(ctx, is);
+
+  if (ok)
+    printf("SUCCESS!\n");
+  else
+  {
+    printf("FAILURE!\n");
+    abort();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  return Runtime::start(argc, argv);
+}
@@ -0,0 +1,246 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Tests the bulk rectangle and point-list accessors of the C API against
+ * the element-at-a-time ones, for both dense and strided copies */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "legion/legion_c.h"
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VALUE = 1,
+};
+
+#define NX 16
+#define NY 8
+
+static int errors = 0;
+
+static double value_at(coord_t x, coord_t y)
+{
+  return x * 100.0 + y;
+}
+
+static legion_point_2d_t make_point(coord_t x, coord_t y)
+{
+  legion_point_2d_t p;
+  p.x[0] = x;
+  p.x[1] = y;
+  return p;
+}
+
+static legion_rect_2d_t make_rect(coord_t lx, coord_t ly,
+                                  coord_t hx, coord_t hy)
+{
+  legion_rect_2d_t r;
+  r.lo = make_point(lx, ly);
+  r.hi = make_point(hx, hy);
+  return r;
+}
+
+static void check_value(const char *what, coord_t x, coord_t y,
+                        double actual, double expected)
+{
+  if (actual != expected)
+  {
+    if (errors < 10)
+      printf("%s: value at (%lld,%lld) is %g, expected %g\n", what,
+             (long long)x, (long long)y, actual, expected);
+    errors++;
+  }
+}
+
+static void test_accessors(legion_accessor_array_2d_t acc)
+{
+  /* dense write of the whole region, first dimension fastest */
+  {
+    double *buffer = (double*)malloc(NX * NY * sizeof(double));
+    coord_t x, y;
+    for (y = 0; y < NY; y++)
+      for (x = 0; x < NX; x++)
+        buffer[y * NX + x] = value_at(x, y);
+    legion_accessor_array_2d_write_rect(acc, make_rect(0, 0, NX-1, NY-1),
+                                        buffer, sizeof(double));
+    free(buffer);
+    for (y = 0; y < NY; y++)
+      for (x = 0; x < NX; x++)
+      {
+        double v;
+        legion_accessor_array_2d_read_point(acc, make_point(x, y),
+                                            &v, sizeof(v));
+        check_value("write_rect (dense)", x, y, v, value_at(x, y));
+      }
+  }
+
+  /* a sub-rectangle is not dense in the instance so goes row by row */
+  {
+    const coord_t lx = 3, ly = 2, hx = 10, hy = 6;
+    const size_t w = hx - lx + 1, h = hy - ly + 1;
+    double *buffer = (double*)malloc(w * h * sizeof(double));
+    size_t i, j;
+    legion_accessor_array_2d_read_rect(acc, make_rect(lx, ly, hx, hy),
+                                       buffer, sizeof(double));
+    for (j = 0; j < h; j++)
+      for (i = 0; i < w; i++)
+        check_value("read_rect (rows)", lx + i, ly + j, buffer[j * w + i],
+                    value_at(lx + i, ly + j));
+    /* negate it and write it back */
+    for (i = 0; i < w * h; i++)
+      buffer[i] = -buffer[i];
+    legion_accessor_array_2d_write_rect(acc, make_rect(lx, ly, hx, hy),
+                                        buffer, sizeof(double));
+    free(buffer);
+    {
+      coord_t x, y;
+      for (y = 0; y < NY; y++)
+        for (x = 0; x < NX; x++)
+        {
+          const int inside = ((x >= lx) && (x <= hx) &&
+                              (y >= ly) && (y <= hy));
+          double v;
+          legion_accessor_array_2d_read_point(acc, make_point(x, y),
+                                              &v, sizeof(v));
+          check_value("write_rect (rows)", x, y, v,
+                      inside ? -value_at(x, y) : value_at(x, y));
+        }
+    }
+  }
+
+  /* empty rectangles copy nothing */
+  {
+    double sentinel = 42.0;
+    legion_accessor_array_2d_read_rect(acc, make_rect(5, 5, 4, 5),
+                                       &sentinel, sizeof(double));
+    check_value("read_rect (empty)", 5, 5, sentinel, 42.0);
+  }
+
+  /* scattered points in an arbitrary order */
+  {
+    legion_point_2d_t points[5];
+    double values[5], readback[5];
+    int i;
+    points[0] = make_point(NX-1, NY-1);
+    points[1] = make_point(0, 0);
+    points[2] = make_point(7, 3);
+    points[3] = make_point(1, NY-1);
+    points[4] = make_point(NX-1, 0);
+    for (i = 0; i < 5; i++)
+      values[i] = 1000.0 + i;
+    legion_accessor_array_2d_write_points(acc, points, 5,
+                                          values, sizeof(double));
+    for (i = 0; i < 5; i++)
+    {
+      double v;
+      legion_accessor_array_2d_read_point(acc, points[i], &v, sizeof(v));
+      check_value("write_points", points[i].x[0], points[i].x[1],
+                  v, values[i]);
+    }
+    memset(readback, 0, sizeof(readback));
+    legion_accessor_array_2d_read_points(acc, points, 5,
+                                         readback, sizeof(double));
+    for (i = 0; i < 5; i++)
+      check_value("read_points", points[i].x[0], points[i].x[1],
+                  readback[i], values[i]);
+  }
+}
+
+static void top_level_task(const void *data, size_t datalen,
+                           const void *userdata, size_t userlen,
+                           realm_id_t proc_id)
+{
+  legion_task_t task;
+  const legion_physical_region_t *regions;
+  unsigned num_regions;
+  legion_context_t ctx;
+  legion_runtime_t runtime;
+  legion_task_preamble(data, datalen, proc_id, &task, &regions,
+                       &num_regions, &ctx, &runtime);
+
+  legion_index_space_t is = legion_index_space_create_domain(runtime, ctx,
+      legion_domain_from_rect_2d(make_rect(0, 0, NX-1, NY-1)));
+  legion_field_space_t fs = legion_field_space_create(runtime, ctx);
+  {
+    legion_field_allocator_t allocator =
+      legion_field_allocator_create(runtime, ctx, fs);
+    legion_field_allocator_allocate_field(allocator, sizeof(double),
+                                          FID_VALUE);
+    legion_field_allocator_destroy(allocator);
+  }
+  legion_logical_region_t lr =
+    legion_logical_region_create(runtime, ctx, is, fs, false/*task local*/);
+
+  legion_inline_launcher_t launcher =
+    legion_inline_launcher_create_logical_region(lr, LEGION_READ_WRITE,
+        LEGION_EXCLUSIVE, lr, 0/*region tag*/, false/*verified*/,
+        0/*mapper*/, 0/*launcher tag*/);
+  legion_inline_launcher_add_field(launcher, FID_VALUE, true/*inst*/);
+  legion_physical_region_t pr =
+    legion_inline_launcher_execute(runtime, ctx, launcher);
+  legion_inline_launcher_destroy(launcher);
+  legion_physical_region_wait_until_valid(pr);
+
+  legion_accessor_array_2d_t acc =
+    legion_physical_region_get_field_accessor_array_2d(pr, FID_VALUE);
+  test_accessors(acc);
+  legion_accessor_array_2d_destroy(acc);
+
+  legion_runtime_unmap_region(runtime, ctx, pr);
+  legion_physical_region_destroy(pr);
+  legion_logical_region_destroy(runtime, ctx, lr);
+  legion_field_space_destroy(runtime, ctx, fs);
+  legion_index_space_destroy(runtime, ctx, is);
+
+  if (errors == 0)
+    printf("SUCCESS!\n");
+  else
+  {
+    printf("FAILURE! %d errors\n", errors);
+    fflush(stdout);
+    abort();
+  }
+
+  legion_task_postamble(runtime, ctx, NULL, 0);
+}
+
+int main(int argc, char **argv)
+{
+  legion_runtime_set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    legion_execution_constraint_set_t execution_constraints =
+      legion_execution_constraint_set_create();
+    legion_execution_constraint_set_add_processor_constraint(
+        execution_constraints, LOC_PROC);
+    legion_task_layout_constraint_set_t layout_constraints =
+      legion_task_layout_constraint_set_create();
+    legion_task_config_options_t config_options;
+    memset(&config_options, 0, sizeof(config_options));
+    legion_runtime_preregister_task_variant_fnptr(
+        TOP_LEVEL_TASK_ID, LEGION_AUTO_GENERATE_ID, "top_level_task",
+        "top_level_task", execution_constraints, layout_constraints,
+        config_options, top_level_task, NULL, 0);
+    legion_execution_constraint_set_destroy(execution_constraints);
+    legion_task_layout_constraint_set_destroy(layout_constraints);
+  }
+
+  return legion_runtime_start(argc, argv, false/*background*/);
+}
@@ -0,0 +1,174 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests that deterministic float reductions of index launches and future
+//  maps give bit-identical results no matter what order the point tasks
+//  (and therefore the slices and the nodes holding their values) finish
+//  in, and that a future map reduction is exactly the point-order fold.
+//  Non-deterministic future map reductions are checked against that fold
+//  with a tolerance. Run it on several nodes to exercise remote slices and
+//  the future reduction tree.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  POINT_TASK_ID,
+};
+
+struct PointArgs {
+  int iteration;
+  int max_delay;  // usec
+};
+
+// Values of very different magnitudes and signs so that any change in
+// the order they are summed changes the bits of the result
+static float point_value(long long point)
+{
+  const float scale = ((point % 3) == 0) ? 1e7f : 1.f;
+  const float sign = ((point % 2) == 0) ? 1.f : -1.f;
+  return sign * scale * (1.f + 0.37f * point);
+}
+
+float point_task(const Task *task,
+                 const std::vector<PhysicalRegion> &regions,
+                 Context ctx, Runtime *runtime)
+{
+  const PointArgs *args = (const PointArgs*)task->args;
+  const long long point = task->index_point[0];
+  // Shuffle the order the points finish in differently on every iteration
+  if (args->max_delay > 0)
+  {
+    const unsigned long long hash =
+      (point + 1) * 7919ULL + (args->iteration + 1) * 104729ULL;
+    usleep((hash * 2654435761ULL >> 7) % args->max_delay);
+  }
+  return point_value(point);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  int num_points = 64;
+  int num_iterations = 8;
+  int max_delay = 2000;
+  {
+    const InputArgs &command_args = Runtime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i], "-p"))
+        num_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-i"))
+        num_iterations = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-d"))
+        max_delay = atoi(command_args.argv[++i]);
+    }
+  }
+  printf("Running deterministic reductions of %d points for %d iterations\n",
+         num_points, num_iterations);
+
+  const Rect<1> launch_bounds(0, num_points - 1);
+  float point_order = 0.f, magnitude = 0.f;
+  for (int point = 0; point < num_points; point++)
+  {
+    point_order += point_value(point);
+    magnitude += fabsf(point_value(point));
+  }
+  float first_index = 0.f;
+  bool ok = true;
+  for (int iter = 0; iter < num_iterations; iter++)
+  {
+    PointArgs args;
+    args.iteration = iter;
+    args.max_delay = max_delay;
+    IndexTaskLauncher launcher(POINT_TASK_ID, launch_bounds,
+                               TaskArgument(&args, sizeof(args)),
+                               ArgumentMap());
+    // Deterministic is the default, which folds remote slices locally
+    Future index_result = runtime->execute_index_space(ctx, launcher,
+                          LEGION_REDOP_SUM_FLOAT32);
+    // Deterministic future map reductions fold every point in order,
+    // non-deterministic ones use the future reduction tree
+    args.iteration = iter + num_iterations;
+    FutureMap map = runtime->execute_index_space(ctx, launcher);
+    Future map_result = runtime->reduce_future_map(ctx, map,
+                          LEGION_REDOP_SUM_FLOAT32);
+    Future tree_result = runtime->reduce_future_map(ctx, map,
+                          LEGION_REDOP_SUM_FLOAT32, false/*deterministic*/);
+    const float index_value = index_result.get_result<float>();
+    const float map_value = map_result.get_result<float>();
+    const float tree_value = tree_result.get_result<float>();
+    if (memcmp(&map_value, &point_order, sizeof(float)) != 0)
+    {
+      printf("Iteration %d: future map reduction %.9g is not the "
+             "point-order fold %.9g\n", iter, map_value, point_order);
+      ok = false;
+    }
+    if (fabsf(tree_value - point_order) > (1e-5f * magnitude))
+    {
+      printf("Iteration %d: non-deterministic future map reduction %.9g "
+             "is too far from %.9g\n", iter, tree_value, point_order);
+      ok = false;
+    }
+    if (iter == 0)
+    {
+      first_index = index_value;
+      continue;
+    }
+    // Compare the bits, not the values
+    if (memcmp(&index_value, &first_index, sizeof(float)) != 0)
+    {
+      printf("Iteration %d: index launch reduction %.9g differs from %.9g\n",
+             iter, index_value, first_index);
+      ok = false;
+    }
+  }
+
+  if (ok)
+    printf("SUCCESS!\n");
+  else
+  {
+    printf("FAILURE!\n");
+    abort();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  {
+    TaskVariantRegistrar registrar(POINT_TASK_ID, "point");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<float, point_task>(registrar, "point");
+  }
+
+  return Runtime::start(argc, argv);
+}
@@ -0,0 +1,168 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests disjointness and completeness queries on partitions whose child
+//  index spaces have not been made yet: images through a pointer field
+//  give every child a sparse subspace, and the queries have to work
+//  directly on those subspaces before anybody asks for a child
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_DISJOINT = 1,
+  FID_ALIASED = 2,
+};
+
+static const coord_t NUM_POINTS = 1024;
+static const coord_t NUM_PIECES = 8;
+static const coord_t PIECE_SIZE = NUM_POINTS / NUM_PIECES;
+
+typedef FieldAccessor<LEGION_WRITE_DISCARD,Point<1>,1,coord_t,
+          Realm::AffineAccessor<Point<1>,1,coord_t> > PointerAccessor;
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  const Rect<1> src_bounds(0, NUM_POINTS-1);
+  // Every pointer lands on an even point so all the images are sparse
+  const Rect<1> dst_bounds(0, 2*NUM_POINTS-1);
+  IndexSpace src_is = runtime->create_index_space(ctx, src_bounds);
+  IndexSpace dst_is = runtime->create_index_space(ctx, dst_bounds);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(Point<1>), FID_DISJOINT);
+    allocator.allocate_field(sizeof(Point<1>), FID_ALIASED);
+  }
+  LogicalRegion src_lr = runtime->create_logical_region(ctx, src_is, fs);
+
+  {
+    InlineLauncher launcher(RegionRequirement(src_lr, LEGION_WRITE_DISCARD,
+                                              LEGION_EXCLUSIVE, src_lr));
+    launcher.add_field(FID_DISJOINT);
+    launcher.add_field(FID_ALIASED);
+    PhysicalRegion region = runtime->map_region(ctx, launcher);
+    region.wait_until_valid();
+    const PointerAccessor disjoint(region, FID_DISJOINT);
+    const PointerAccessor aliased(region, FID_ALIASED);
+    for (PointInRectIterator<1> pir(src_bounds); pir(); pir++)
+    {
+      disjoint[*pir] = Point<1>(2 * pir[0]);
+      // The last point of each piece also points at the first point
+      // of the next piece's image, so neighboring images overlap
+      if ((pir[0] % PIECE_SIZE) == (PIECE_SIZE - 1))
+        aliased[*pir] = Point<1>(2 * ((pir[0] + 1) % NUM_POINTS));
+      else
+        aliased[*pir] = Point<1>(2 * pir[0]);
+    }
+    runtime->unmap_region(ctx, region);
+  }
+
+  const Rect<1> colors(0, NUM_PIECES-1);
+  IndexSpace color_space = runtime->create_index_space(ctx, colors);
+  IndexPartition src_ip =
+    runtime->create_equal_partition(ctx, src_is, color_space);
+  LogicalPartition src_lp = runtime->get_logical_partition(src_lr, src_ip);
+
+  IndexPartition disjoint_ip = runtime->create_partition_by_image(ctx,
+      dst_is, src_lp, src_lr, FID_DISJOINT, color_space);
+  IndexPartition aliased_ip = runtime->create_partition_by_image(ctx,
+      dst_is, src_lp, src_lr, FID_ALIASED, color_space);
+
+  bool ok = true;
+  // Ask before touching any of the children so they all stay lazy
+  if (!runtime->is_index_partition_disjoint(ctx, disjoint_ip))
+  {
+    printf("Disjoint image was reported as aliased\n");
+    ok = false;
+  }
+  if (runtime->is_index_partition_complete(ctx, disjoint_ip))
+  {
+    printf("Image of only the even points was reported as complete\n");
+    ok = false;
+  }
+  if (runtime->is_index_partition_disjoint(ctx, aliased_ip))
+  {
+    printf("Aliased image was reported as disjoint\n");
+    ok = false;
+  }
+
+  // Now make the children and check the subspaces they were given
+  size_t total_volume = 0;
+  for (coord_t c = 0; c < NUM_PIECES; c++)
+  {
+    IndexSpace child =
+      runtime->get_index_subspace(ctx, disjoint_ip, DomainPoint(Point<1>(c)));
+    const Domain dom = runtime->get_index_space_domain(ctx, child);
+    if (dom.dense())
+    {
+      printf("Image piece %lld is dense\n", c);
+      ok = false;
+    }
+    size_t volume = 0;
+    for (Domain::DomainPointIterator itr(dom); itr; itr++)
+    {
+      if ((itr.p[0] % 2) != 0)
+        ok = false;
+      volume++;
+    }
+    if (volume != size_t(PIECE_SIZE))
+    {
+      printf("Image piece %lld has %zd points instead of %lld\n",
+             c, volume, PIECE_SIZE);
+      ok = false;
+    }
+    total_volume += volume;
+  }
+  if (total_volume != size_t(NUM_POINTS))
+    ok = false;
+
+  runtime->destroy_logical_region(ctx, src_lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_space);
+  runtime->destroy_index_space(ctx, dst_is);
+  runtime->destroy_index_space(ctx, src_is);
+
+  if (ok)
+    printf("SUCCESS!\n");
+  else
+  {
+    printf("FAILURE!\n");
+    abort();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  return Runtime::start(argc, argv);
+}
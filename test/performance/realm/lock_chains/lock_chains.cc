@@ -104,6 +104,7 @@ void top_level_task(const void *args, size_t arglen,
   int locks_per_processor = 16;
   int chains_per_processor = 32;
   int chain_depth = 16;
+  int read_percent = 0;
   // Parse the input arguments
 #define INT_ARG(argname, varname) do { \
         if(!strcmp((argv)[i], argname)) {		\
@@ -124,10 +125,12 @@ void top_level_task(const void *args, size_t arglen,
       INT_ARG("-lpp", locks_per_processor);
       INT_ARG("-cpp", chains_per_processor);
       INT_ARG("-d",chain_depth);
+      INT_ARG("-rdpct",read_percent);
     }
     assert(locks_per_processor > 0);
     assert(chains_per_processor > 0);
     assert(chain_depth > 0);
+    assert((read_percent >= 0) && (read_percent <= 100));
   }
 #undef INT_ARG
 #undef BOOL_ARG
@@ -155,11 +158,11 @@ void top_level_task(const void *args, size_t arglen,
   }
   // Send all the locks to each processor and tell them how many chains and what depth to make the chains
   {
-    fprintf(stdout,"Initializing lock chain experiment with %d locks per processor, %d chains per processor, and %d chain depth\n",
-            locks_per_processor,chains_per_processor,chain_depth);
+    fprintf(stdout,"Initializing lock chain experiment with %d locks per processor, %d chains per processor, %d chain depth, and %d%% shared acquires\n",
+            locks_per_processor,chains_per_processor,chain_depth,read_percent);
     std::set<Reservation> &lock_set = get_lock_set();
     // Package up all the locks and tell the processor how many tasks to register for each
-    size_t buffer_size = sizeof(Processor) + sizeof(Event) + 2*sizeof(int) + sizeof(size_t) + (lock_set.size() * sizeof(Reservation));
+    size_t buffer_size = sizeof(Processor) + sizeof(Event) + 3*sizeof(int) + sizeof(size_t) + (lock_set.size() * sizeof(Reservation));
     void *buffer = malloc(buffer_size);
     char *ptr = (char*)buffer;
     *((Processor*)ptr) = p;
@@ -170,6 +173,8 @@ void top_level_task(const void *args, size_t arglen,
     ptr += sizeof(int);
     *((int*)ptr) = chain_depth;
     ptr += sizeof(int);
+    *((int*)ptr) = read_percent;
+    ptr += sizeof(int);
     *((size_t*)ptr) = lock_set.size();
     ptr += sizeof(size_t);
     for (std::set<Reservation>::const_iterator it = lock_set.begin();
@@ -264,6 +269,8 @@ void chain_creation_task(const void *args, size_t arglen,
   ptr += sizeof(int);
   int chain_depth = *((int*)ptr);
   ptr += sizeof(int);
+  int read_percent = *((int*)ptr);
+  ptr += sizeof(int);
   size_t num_locks = *((size_t*)ptr);
   ptr += sizeof(size_t);
   std::vector<Reservation> lock_vector;
@@ -283,7 +290,9 @@ void chain_creation_task(const void *args, size_t arglen,
     for (int idx = 0; idx < chain_depth; idx++)
     {
       Reservation next_lock = lock_vector[(lrand48() % lock_vector.size())];
-      next_wait = next_lock.acquire(0,true,next_wait);
+      // shared acquires all use mode 0 so they can be granted together
+      bool exclusive = ((lrand48() % 100) >= read_percent);
+      next_wait = next_lock.acquire(0,exclusive,next_wait);
       next_lock.release(next_wait);
     }
     wait_for_events.insert(next_wait);
@@ -19,6 +19,7 @@
 #include <cassert>
 #include <cstring>
 #include <set>
+#include <vector>
 #include <time.h>
 
 #include <realm.h>
@@ -34,6 +35,9 @@ enum {
   LAUNCH_UNFAIR_LOCK_TASK = Processor::TASK_ID_FIRST_AVAILABLE+4,
   ADD_FINAL_EVENT_TASK = Processor::TASK_ID_FIRST_AVAILABLE+5,
   DUMMY_TASK = Processor::TASK_ID_FIRST_AVAILABLE+6,
+  FAST_LOCK_TASK = Processor::TASK_ID_FIRST_AVAILABLE+7,
+  LAUNCH_CHAIN_LOCK_TASK = Processor::TASK_ID_FIRST_AVAILABLE+8,
+  CHAIN_LINK_TASK = Processor::TASK_ID_FIRST_AVAILABLE+9,
 };
 
 struct InputArgs {
@@ -48,10 +52,35 @@ struct FairStruct {
   int depth;
 };
 
+struct FastStruct {
+  FastReservation *lock;
+  int iterations;
+  int read_percent;
+};
+
 // forward declaration
 void fair_locks_task(const void *args, size_t arglen, 
                      const void *userdata, size_t userlen, Processor p);
 
+struct ChainStruct {
+  Processor orig;
+  Event precondition;
+  int chains_per_processor;
+  int chain_depth;
+  int read_percent;
+};
+
+// one link of a chain of FastReservation acquires - each link runs as its
+//  own task on the processor that owns the chain
+struct ChainLink {
+  UserEvent done;
+  int remaining;
+  int read_percent;
+  unsigned lock_index;
+  bool exclusive;
+  unsigned seed;
+};
+
 InputArgs& get_input_args(void)
 {
   static InputArgs args;
@@ -70,6 +99,14 @@ std::set<Reservation>& get_lock_set(void)
   return lock_set;
 }
 
+// this node's FastReservations for the chain experiment, each backed by
+//  one of the reservations in the lock set
+std::vector<FastReservation*>& get_fast_locks(void)
+{
+  static std::vector<FastReservation*> fast_locks;
+  return fast_locks;
+}
+
 Processor get_next_processor(Processor cur)
 {
   Machine machine = Machine::get_machine();
@@ -102,8 +139,14 @@ void top_level_task(const void *args, size_t arglen,
                     const void *userdata, size_t userlen, Processor p)
 {
   bool fair = false;
+  bool fast = false;
+  bool chains = false;
   int locks_per_processor = 16;
   int tasks_per_processor_per_lock = 8;
+  int fast_iterations = 100000;
+  int read_percent = 90;
+  int chains_per_processor = 32;
+  int chain_depth = 16;
   // Parse the input arguments
 #define INT_ARG(argname, varname) do { \
         if(!strcmp((argv)[i], argname)) {		\
@@ -124,13 +167,51 @@ void top_level_task(const void *args, size_t arglen,
       INT_ARG("-lpp", locks_per_processor);
       INT_ARG("-tpppl",tasks_per_processor_per_lock);
       BOOL_ARG("-fair",fair);
+      BOOL_ARG("-fast",fast);
+      INT_ARG("-iters",fast_iterations);
+      INT_ARG("-rdpct",read_percent);
+      BOOL_ARG("-chains",chains);
+      INT_ARG("-cpp",chains_per_processor);
+      INT_ARG("-d",chain_depth);
     }
     assert(locks_per_processor > 0);
     assert(tasks_per_processor_per_lock > 0);
+    assert((read_percent >= 0) && (read_percent <= 100));
+    assert(chains_per_processor > 0);
+    assert(chain_depth > 0);
   }
 #undef INT_ARG
 #undef BOOL_ARG
 
+  if (fast)
+  {
+    // a FastReservation only works within an address space, so hammer a
+    //  single one from every CPU processor on this node
+    std::vector<Processor> local_procs;
+    Machine::ProcessorQuery pq(Machine::get_machine());
+    pq.local_address_space().only_kind(Processor::LOC_PROC);
+    for (Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+      local_procs.push_back(*it);
+    fprintf(stdout,"Running FAST reservation contention experiment with %zd processors, %d iterations per processor, %d%% reads\n",
+            local_procs.size(), fast_iterations, read_percent);
+    FastReservation lock;
+    FastStruct fast_args = { &lock, fast_iterations, read_percent };
+    std::vector<Event> events;
+    double start = Realm::Clock::current_time_in_microseconds();
+    for (std::vector<Processor>::const_iterator it = local_procs.begin();
+          it != local_procs.end(); it++)
+      events.push_back(it->spawn(FAST_LOCK_TASK,&fast_args,sizeof(FastStruct)));
+    Event::merge_events(events).wait();
+    double stop = Realm::Clock::current_time_in_microseconds();
+
+    double latency = stop - start;
+    fprintf(stdout,"Total time: %7.3f us\n", latency);
+    double grants_per_sec = double(fast_iterations) * local_procs.size() / latency;
+    fprintf(stdout,"Reservation Grants/s (in Millions): %7.3f\n", grants_per_sec);
+    fprintf(stdout,"Cleaning up...\n");
+    return;
+  }
+
   UserEvent start_event = UserEvent::create_user_event();
 
   std::set<Processor> all_procs;
@@ -152,7 +233,40 @@ void top_level_task(const void *args, size_t arglen,
     }
     free(buffer);
   }
-  if (fair)
+  if (chains)
+  {
+    fprintf(stdout,"Running CHAINS lock contention experiment with %d locks per processor, %d chains per processor of depth %d, %d%% shared acquires\n",
+            locks_per_processor, chains_per_processor, chain_depth, read_percent);
+    // every link of a chain is a task that takes one of its node's
+    //  FastReservations, releases it, and launches the next link - a link
+    //  that is handed an event instead of the lock is relaunched once the
+    //  event triggers
+    std::set<Reservation> &lock_set = get_lock_set();
+    size_t buffer_size = sizeof(ChainStruct) + sizeof(size_t) + (lock_set.size() * sizeof(Reservation));
+    void *buffer = malloc(buffer_size);
+    char *ptr = (char*)buffer;
+    ChainStruct chain = { p, start_event, chains_per_processor, chain_depth, read_percent };
+    *((ChainStruct*)ptr) = chain;
+    ptr += sizeof(ChainStruct);
+    *((size_t*)ptr) = lock_set.size();
+    ptr += sizeof(size_t);
+    for (std::set<Reservation>::const_iterator it = lock_set.begin();
+          it != lock_set.end(); it++)
+    {
+      Reservation lock = *it;
+      memcpy(ptr, &lock, sizeof(Reservation));
+      ptr += sizeof(Reservation);
+    }
+    for (std::set<Processor>::const_iterator it = all_procs.begin();
+          it != all_procs.end(); it++)
+    {
+      Processor target = *it;
+      Event wait_event = target.spawn(LAUNCH_CHAIN_LOCK_TASK,buffer,buffer_size);
+      wait_event.wait();
+    }
+    free(buffer);
+  }
+  else if (fair)
   {
     fprintf(stdout,"Running FAIR lock contention experiment with %d locks per processor and %d tasks per lock per processor\n",
             locks_per_processor, tasks_per_processor_per_lock);
@@ -218,7 +332,9 @@ void top_level_task(const void *args, size_t arglen,
 
     double latency = stop - start;
     fprintf(stdout,"Total time: %7.3f us\n", latency);
-    double grants_per_sec = locks_per_processor * tasks_per_processor_per_lock * all_procs.size() / latency;
+    double grants_per_sec = (chains ?
+                               (chains_per_processor * chain_depth) :
+                               (locks_per_processor * tasks_per_processor_per_lock)) * all_procs.size() / latency;
     fprintf(stdout,"Reservation Grants/s (in Thousands): %7.3f\n", grants_per_sec);
   }
   
@@ -328,6 +444,83 @@ void unfair_locks_task(const void *args, size_t arglen,
   wait_event.wait();
 }
 
+static void next_chain_link(ChainLink &link, size_t num_locks)
+{
+  // a little LCG per chain keeps the chains independent of each other
+  link.seed = link.seed * 1103515245 + 12345;
+  link.lock_index = (link.seed >> 8) % num_locks;
+  link.seed = link.seed * 1103515245 + 12345;
+  link.exclusive = (int((link.seed >> 8) % 100) >= link.read_percent);
+}
+
+void chain_locks_task(const void *args, size_t arglen, 
+                      const void *userdata, size_t userlen, Processor p)
+{
+  char *ptr = (char*)args;
+  ChainStruct chain = *((ChainStruct*)ptr);
+  ptr += sizeof(ChainStruct);
+  size_t num_locks = *((size_t*)ptr);
+  ptr += sizeof(size_t);
+
+  // FastReservations only work within an address space, so the first
+  //  processor on each node makes that node's set (the launches are done
+  //  one at a time, so there's no race here)
+  std::vector<FastReservation*> &fast_locks = get_fast_locks();
+  if (fast_locks.empty())
+  {
+    for (unsigned idx = 0; idx < num_locks; idx++)
+    {
+      Reservation lock;
+      memcpy(&lock, ptr, sizeof(Reservation));
+      ptr += sizeof(Reservation);
+      fast_locks.push_back(new FastReservation(lock));
+    }
+  }
+  assert(fast_locks.size() == num_locks);
+
+  std::set<Event> wait_for_events;
+  for (int idx = 0; idx < chain.chains_per_processor; idx++)
+  {
+    ChainLink link;
+    link.done = UserEvent::create_user_event();
+    link.remaining = chain.chain_depth;
+    link.read_percent = chain.read_percent;
+    link.seed = (unsigned)(p.id * 7919 + idx);
+    next_chain_link(link, num_locks);
+    p.spawn(CHAIN_LINK_TASK, &link, sizeof(ChainLink), chain.precondition);
+    wait_for_events.insert(link.done);
+  }
+  // Merge all the wait for events together and send back the result
+  Event final_event = Event::merge_events(wait_for_events);
+  Event wait_event = chain.orig.spawn(ADD_FINAL_EVENT_TASK,&final_event,sizeof(Event));
+  wait_event.wait();
+}
+
+void chain_link_task(const void *args, size_t arglen, 
+                     const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(ChainLink));
+  ChainLink link = *((const ChainLink*)args);
+  std::vector<FastReservation*> &fast_locks = get_fast_locks();
+  FastReservation *lock = fast_locks[link.lock_index];
+  Event wait_on = (link.exclusive ? lock->wrlock() : lock->rdlock());
+  if (wait_on.exists())
+  {
+    // the deferred case (e.g. the backing reservation is held elsewhere),
+    //  so try this link again once the lock might be available
+    p.spawn(CHAIN_LINK_TASK, &link, sizeof(ChainLink), wait_on);
+    return;
+  }
+  lock->unlock();
+  if (--link.remaining == 0)
+  {
+    link.done.trigger();
+    return;
+  }
+  next_chain_link(link, fast_locks.size());
+  p.spawn(CHAIN_LINK_TASK, &link, sizeof(ChainLink));
+}
+
 void add_final_event(const void *args, size_t arglen, 
                      const void *userdata, size_t userlen, Processor p)
 {
@@ -336,6 +529,25 @@ void add_final_event(const void *args, size_t arglen,
   get_final_events().insert(result);
 }
 
+void fast_locks_task(const void *args, size_t arglen, 
+                     const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(FastStruct));
+  const FastStruct *fast = (const FastStruct *)args;
+  for (int idx = 0; idx < fast->iterations; idx++)
+  {
+    bool reader = ((idx % 100) < fast->read_percent);
+    while (true)
+    {
+      Event e = (reader ? fast->lock->rdlock() : fast->lock->wrlock());
+      if (!e.exists())
+        break;
+      e.wait();
+    }
+    fast->lock->unlock();
+  }
+}
+
 void dummy_task(const void *args, size_t arglen, 
                 const void *userdata, size_t userlen, Processor p)
 {
@@ -356,6 +568,9 @@ int main(int argc, char **argv)
   r.register_task(LAUNCH_UNFAIR_LOCK_TASK, unfair_locks_task);
   r.register_task(ADD_FINAL_EVENT_TASK, add_final_event);
   r.register_task(DUMMY_TASK, dummy_task);
+  r.register_task(FAST_LOCK_TASK, fast_locks_task);
+  r.register_task(LAUNCH_CHAIN_LOCK_TASK, chain_locks_task);
+  r.register_task(CHAIN_LINK_TASK, chain_link_task);
 
   // Set the input args
   get_input_args().argv = argv;
@@ -0,0 +1,219 @@
+/* Copyright 2021 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how the allocation of Realm objects from the runtime's tables
+//  (reservations, user events, completion queues, processor groups and
+//  subgraphs) scales with the number of processors doing it at once. With
+//  -mixed every task cycles through more tables than a thread has cached
+//  free entries for, so the least recently used cache keeps getting
+//  handed back to its table.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include <realm.h>
+
+using namespace Realm;
+
+// TASK IDs
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  ALLOC_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+1,
+  NOOP_TASK      = Processor::TASK_ID_FIRST_AVAILABLE+2,
+};
+
+struct InputArgs {
+  int argc;
+  char **argv;
+};
+
+InputArgs& get_input_args(void)
+{
+  static InputArgs args;
+  return args;
+}
+
+struct AllocArgs {
+  int iterations;
+  int batch;
+  bool mixed;
+};
+
+// returns the number of objects created (and destroyed)
+static size_t objects_per_task(const AllocArgs& args)
+{
+  return size_t(args.iterations) * args.batch * (args.mixed ? 5 : 1);
+}
+
+void alloc_task(const void *args, size_t arglen,
+                const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(AllocArgs));
+  const AllocArgs& alloc_args = *(const AllocArgs*)args;
+  const int batch = alloc_args.batch;
+
+  std::vector<Reservation> rsrvs(batch);
+  std::vector<UserEvent> events(batch);
+  std::vector<CompletionQueue> cqs(batch);
+  std::vector<ProcessorGroup> groups(batch);
+  std::vector<Subgraph> subgraphs(batch);
+  std::vector<Processor> members(1, p);
+  // subgraphs are only created and destroyed, never instantiated, but
+  //  they have to contain something to compile
+  SubgraphDefinition subgraph_defn;
+  subgraph_defn.tasks.resize(1);
+  subgraph_defn.tasks[0].proc = p;
+  subgraph_defn.tasks[0].task_id = NOOP_TASK;
+
+  for (int i = 0; i < alloc_args.iterations; i++)
+  {
+    // everything is created before anything is destroyed so that each
+    //  table sees a burst of allocations followed by a burst of frees
+    for (int j = 0; j < batch; j++)
+    {
+      rsrvs[j] = Reservation::create_reservation();
+      if (alloc_args.mixed)
+      {
+        events[j] = UserEvent::create_user_event();
+        cqs[j] = CompletionQueue::create_completion_queue(1);
+        groups[j] = ProcessorGroup::create_group(members);
+        Subgraph::create_subgraph(subgraphs[j], subgraph_defn,
+                                  ProfilingRequestSet()).wait();
+      }
+    }
+    for (int j = 0; j < batch; j++)
+    {
+      rsrvs[j].destroy_reservation();
+      if (alloc_args.mixed)
+      {
+        events[j].trigger();
+        cqs[j].destroy();
+        groups[j].destroy();
+        subgraphs[j].destroy();
+      }
+    }
+  }
+}
+
+void noop_task(const void *args, size_t arglen,
+               const void *userdata, size_t userlen, Processor p)
+{
+}
+
+void top_level_task(const void *args, size_t arglen,
+                    const void *userdata, size_t userlen, Processor p)
+{
+  AllocArgs alloc_args;
+  alloc_args.iterations = 1000;
+  alloc_args.batch = 64;
+  alloc_args.mixed = false;
+  int min_procs = 1;
+
+#define INT_ARG(argname, varname) do { \
+        if(!strcmp((argv)[i], argname)) {		\
+          varname = atoi((argv)[++i]);		\
+          continue;					\
+        } } while(0)
+
+#define BOOL_ARG(argname, varname) do { \
+        if(!strcmp((argv)[i], argname)) {		\
+          varname = true;				\
+          continue;					\
+        } } while(0)
+  {
+    InputArgs &inputs = get_input_args();
+    char **argv = inputs.argv;
+    for (int i = 1; i < inputs.argc; i++)
+    {
+      INT_ARG("-iters", alloc_args.iterations);
+      INT_ARG("-batch", alloc_args.batch);
+      INT_ARG("-minprocs", min_procs);
+      BOOL_ARG("-mixed", alloc_args.mixed);
+    }
+    assert(alloc_args.iterations > 0);
+    assert(alloc_args.batch > 0);
+    assert(min_procs > 0);
+  }
+#undef INT_ARG
+#undef BOOL_ARG
+
+  // the tables are per node, so only local processors take part
+  std::vector<Processor> local_procs;
+  Machine::ProcessorQuery pq(Machine::get_machine());
+  pq.local_address_space().only_kind(Processor::LOC_PROC);
+  for (Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+    local_procs.push_back(*it);
+
+  fprintf(stdout,"Running %s table allocation experiment with %d iterations of %d objects per processor\n",
+          (alloc_args.mixed ? "MIXED" : "RESERVATION"),
+          alloc_args.iterations, alloc_args.batch);
+
+  // double the number of processors each time, finishing with all of them
+  for (size_t num_procs = min_procs; ; num_procs *= 2)
+  {
+    if (num_procs > local_procs.size())
+      num_procs = local_procs.size();
+    std::vector<Event> events;
+    double start = Realm::Clock::current_time_in_microseconds();
+    for (size_t i = 0; i < num_procs; i++)
+      events.push_back(local_procs[i].spawn(ALLOC_TASK, &alloc_args,
+                                            sizeof(alloc_args)));
+    Event::merge_events(events).wait();
+    double stop = Realm::Clock::current_time_in_microseconds();
+
+    double latency = stop - start;
+    double total = double(objects_per_task(alloc_args)) * num_procs;
+    fprintf(stdout,"Processors: %3zd  Total time: %10.3f us  Objects/s (in Millions): %7.3f  Per processor: %7.3f\n",
+            num_procs, latency, total / latency, total / latency / num_procs);
+    if (num_procs == local_procs.size())
+      break;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime r;
+
+  bool ok = r.init(&argc, &argv);
+  assert(ok);
+
+  r.register_task(TOP_LEVEL_TASK, top_level_task);
+  r.register_task(ALLOC_TASK, alloc_task);
+  r.register_task(NOOP_TASK, noop_task);
+
+  // Set the input args
+  get_input_args().argv = argv;
+  get_input_args().argc = argc;
+
+  // select a processor to run the top level task on
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single task - everybody gets the same finish event
+  Event e = r.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // request shutdown once that task is complete
+  r.shutdown(e);
+
+  // now sleep this thread until that shutdown actually happens
+  r.wait_for_shutdown();
+
+  return 0;
+}
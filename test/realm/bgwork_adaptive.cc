@@ -0,0 +1,267 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for the adaptive background worker pool - bursts of copies
+//  and fills are issued with idle gaps between them, using a pool that
+//  may grow past -ll:bgwork and adaptive spinning (-ll:bgspin -1), and the
+//  bgwork log is checked afterwards to see that:
+//  1) the pool grew during a burst
+//  2) the extra workers parked again during an idle gap
+//  3) every dedicated worker (parked or not) terminated at shutdown
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <fstream>
+
+#include <unistd.h>
+
+#include "realm.h"
+#include "realm/cmdline.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+enum {
+  FID_DATA = 100,
+};
+
+namespace TestConfig {
+  int num_bursts = 4;
+  int copies_per_burst = 8;
+  int num_elements = 1 << 20;
+  int idle_ms = 200;
+  int bgwork = 1;
+  int bgwork_max = 4;
+};
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Memory m = Machine::MemoryQuery(Machine::get_machine())
+    .has_affinity_to(p)
+    .only_kind(Memory::SYSTEM_MEM)
+    .first();
+  assert(m.exists());
+
+  IndexSpace<1> is(Rect<1>(0, TestConfig::num_elements - 1));
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[FID_DATA] = sizeof(int);
+
+  // a source and destination per copy, so every copy in a burst can be
+  //  in flight at once
+  std::vector<RegionInstance> srcs(TestConfig::copies_per_burst);
+  std::vector<RegionInstance> dsts(TestConfig::copies_per_burst);
+  for(int i = 0; i < TestConfig::copies_per_burst; i++) {
+    RegionInstance::create_instance(srcs[i], m, is, field_sizes,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+    RegionInstance::create_instance(dsts[i], m, is, field_sizes,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+  }
+
+  std::vector<CopySrcDstField> src_fields(1), dst_fields(1);
+  src_fields[0].set_field(RegionInstance::NO_INST, FID_DATA, sizeof(int));
+  dst_fields[0].set_field(RegionInstance::NO_INST, FID_DATA, sizeof(int));
+
+  for(int b = 0; b < TestConfig::num_bursts; b++) {
+    log_app.info() << "burst " << b;
+
+    // fill every source and copy it to its destination, with all the
+    //  fill->copy chains launched together
+    std::set<Event> done;
+    for(int i = 0; i < TestConfig::copies_per_burst; i++) {
+      int fill_value = b * TestConfig::copies_per_burst + i;
+      dst_fields[0].inst = srcs[i];
+      Event filled = is.fill(dst_fields, ProfilingRequestSet(),
+			     &fill_value, sizeof(fill_value));
+      src_fields[0].inst = srcs[i];
+      dst_fields[0].inst = dsts[i];
+      done.insert(is.copy(src_fields, dst_fields, ProfilingRequestSet(),
+			  filled));
+    }
+    Event::merge_events(done).wait();
+
+    // spot-check the results
+    for(int i = 0; i < TestConfig::copies_per_burst; i++) {
+      AffineAccessor<int, 1> acc(dsts[i], FID_DATA);
+      int expected = b * TestConfig::copies_per_burst + i;
+      if((acc[0] != expected) ||
+	 (acc[TestConfig::num_elements - 1] != expected)) {
+	log_app.fatal() << "copy mismatch: burst=" << b << " copy=" << i
+			<< " expected=" << expected << " actual=" << acc[0];
+	abort();
+      }
+    }
+
+    // go quiet long enough for the extra workers to give up spinning
+    usleep(TestConfig::idle_ms * 1000);
+  }
+
+  for(int i = 0; i < TestConfig::copies_per_burst; i++) {
+    srcs[i].destroy();
+    dsts[i].destroy();
+  }
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, 0 /*success*/);
+}
+
+static int count_lines(const std::vector<std::string>& lines,
+		       const char *pattern)
+{
+  int count = 0;
+  for(size_t i = 0; i < lines.size(); i++)
+    if(lines[i].find(pattern) != std::string::npos)
+      count++;
+  return count;
+}
+
+static int check_log(const char *logname)
+{
+  std::vector<std::string> lines;
+  {
+    std::ifstream ifs(logname);
+    std::string line;
+    while(std::getline(ifs, line))
+      lines.push_back(line);
+  }
+
+  int errors = 0;
+
+  int grown = count_lines(lines, "growing worker pool");
+  int shrunk = count_lines(lines, "shrinking worker pool");
+  int started = count_lines(lines, "dedicated worker starting");
+  int terminated = count_lines(lines, "dedicated worker terminating");
+  printf("workers: started=%d grew=%d shrank=%d terminated=%d\n",
+	 started, grown, shrunk, terminated);
+
+  if(grown == 0) {
+    printf("worker pool never grew past %d\n", TestConfig::bgwork);
+    errors++;
+  }
+
+  // every growth after the first burst needs the pool to have shrunk back
+  //  in between, so a pool that grew more than it has room for must have
+  //  parked workers again
+  if((shrunk == 0) ||
+     (grown > (TestConfig::bgwork_max - TestConfig::bgwork + shrunk))) {
+    printf("worker pool did not shrink after growing\n");
+    errors++;
+  }
+
+  if(started != TestConfig::bgwork_max) {
+    printf("expected %d dedicated workers, %d started\n",
+	   TestConfig::bgwork_max, started);
+    errors++;
+  }
+
+  if(terminated != started) {
+    printf("%d dedicated workers started, but %d terminated\n",
+	   started, terminated);
+    errors++;
+  }
+
+  return errors;
+}
+
+int main(int argc, const char **argv)
+{
+  bool keep_log = false;
+  {
+    CommandLineParser clp;
+    clp.add_option_int("-bursts", TestConfig::num_bursts);
+    clp.add_option_int("-copies", TestConfig::copies_per_burst);
+    clp.add_option_int("-elements", TestConfig::num_elements);
+    clp.add_option_int("-idle", TestConfig::idle_ms);
+    clp.add_option_int("-ll:bgwork", TestConfig::bgwork);
+    clp.add_option_int("-ll:bgworkmax", TestConfig::bgwork_max);
+    clp.add_option_bool("-keep", keep_log);
+    bool ok = clp.parse_command_line(argc, argv);
+    assert(ok);
+  }
+  assert(TestConfig::bgwork_max > TestConfig::bgwork);
+
+  // the adaptive pool settings (as parsed above, so the checks agree) and
+  //  a bgwork log of our own are added to whatever else was asked for
+  char logname[64];
+  snprintf(logname, sizeof(logname), "bgwork_adaptive_%d.log", int(getpid()));
+  char bgwork[16], bgwork_max[16];
+  snprintf(bgwork, sizeof(bgwork), "%d", TestConfig::bgwork);
+  snprintf(bgwork_max, sizeof(bgwork_max), "%d", TestConfig::bgwork_max);
+  std::vector<const char *> args(argv, argv + argc);
+  args.push_back("-ll:bgwork");
+  args.push_back(bgwork);
+  args.push_back("-ll:bgworkmax");
+  args.push_back(bgwork_max);
+  args.push_back("-ll:bgspin");
+  args.push_back("-1");
+  // grow as soon as any work would have to wait
+  args.push_back("-ll:bgworklat");
+  args.push_back("1");
+  args.push_back("-level");
+  args.push_back("bgwork=2");
+  args.push_back("-logfile");
+  args.push_back(logname);
+  int my_argc = args.size();
+  args.push_back(0);
+  const char **my_argv = &args[0];
+
+  Runtime rt;
+
+  rt.init(&my_argc, (char ***)&my_argv);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   TOP_LEVEL_TASK,
+                                   CodeDescriptor(top_level_task),
+                                   ProfilingRequestSet()).external_wait();
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  Logger::flush_all_streams();
+
+  if(ret == 0) {
+    int errors = check_log(logname);
+    if(errors == 0)
+      printf("adaptive worker pool behaved as expected\n");
+    else {
+      printf("%d errors in adaptive worker pool behavior\n", errors);
+      ret = 1;
+    }
+  }
+
+  if(!keep_log)
+    remove(logname);
+
+  return ret;
+}
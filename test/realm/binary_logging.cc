@@ -0,0 +1,376 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for binary logging (-logbinary 1) - messages are written
+//  through both the LoggerMessage stream and the printf-style interfaces,
+//  from one task and then from many tasks at once (enough to wrap every
+//  thread's buffer several times), and the log is then decoded with
+//  tools/realm_log_decode.py and compared to the text the default logger
+//  would have produced
+
+#include <realm.h>
+#include <realm/cmdline.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+Logger log_bin("binlog");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  WRITER_TASK,
+};
+
+struct WriterArgs {
+  int task_idx;
+  int num_messages;
+};
+
+// which records the log should contain - from the single task's messages
+static std::vector<std::string> expected_messages;
+static int num_stream_messages = 0;
+static int num_printf_messages = 0;
+static const int num_buffer_messages = 50;
+static int num_writers = 4;
+static int writer_messages = 10000;
+
+// logs a stream message and remembers the text an ostream makes of it
+#define LOG_STREAM(insertions) \
+  do { \
+    log_bin.print() insertions; \
+    std::ostringstream ss; \
+    ss insertions; \
+    expected_messages.push_back(ss.str()); \
+    num_stream_messages++; \
+  } while(0)
+
+#define LOG_PRINTF(...) \
+  do { \
+    log_bin.print(__VA_ARGS__); \
+    char buffer[256]; \
+    snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
+    expected_messages.push_back(buffer); \
+    num_printf_messages++; \
+  } while(0)
+
+static std::string writer_message(int task_idx, int msg_idx)
+{
+  std::ostringstream ss;
+  ss << "writer " << task_idx << " message " << msg_idx
+     << " value " << (msg_idx * 0.25);
+  return ss.str();
+}
+
+void writer_task(const void *args, size_t arglen,
+                 const void *userdata, size_t userlen, Processor p)
+{
+  const WriterArgs& wargs = *reinterpret_cast<const WriterArgs *>(args);
+  for(int i = 0; i < wargs.num_messages; i++)
+    log_bin.print() << "writer " << wargs.task_idx << " message " << i
+                    << " value " << (i * 0.25);
+}
+
+void top_level_task(const void *args, size_t arglen,
+                    const void *userdata, size_t userlen, Processor p)
+{
+  // stream messages - string literals (marked or not) and plain numbers
+  //  are recorded as values, everything else as text
+  LOG_STREAM(<< REALM_LOGGER_LITERAL("literal only"));
+  LOG_STREAM(<< REALM_LOGGER_LITERAL("int ") << -42
+             << REALM_LOGGER_LITERAL(" long ") << 1234567890123LL
+             << " unsigned " << 42U << " size " << size_t(-1));
+  LOG_STREAM(<< "short " << short(-7) << " ushort " << (unsigned short)(7));
+  LOG_STREAM(<< "double " << 3.14159265358979 << " float " << 0.5f
+             << " big " << 1.5e300 << " small " << -2.5e-10);
+  LOG_STREAM(<< "char " << 'x' << " bool " << true);
+  {
+    const char *dynamic = "c string";
+    std::string str("std::string");
+    LOG_STREAM(<< dynamic << " and " << str);
+  }
+  LOG_STREAM(<< "hex " << std::hex << 255 << " dec " << std::dec << 255);
+  LOG_STREAM(<< "width [" << std::setw(8) << 17 << "] ["
+             << std::setw(6) << "ab" << "]");
+  LOG_STREAM(<< "precision " << std::setprecision(3) << 3.14159265358979);
+  LOG_STREAM(<< "fixed " << std::fixed << 2.5);
+  LOG_STREAM(<< "percent % signs %d stay as they are");
+  {
+    // a message too big for a stream record is kept as text
+    std::string big(2000, 'z');
+    LOG_STREAM(<< "big " << big.c_str() << " end");
+  }
+  {
+    // a char array is text even when its contents change under the same
+    //  address, and must not turn into a format string per message
+    char buffer[32];
+    for(int i = 0; i < num_buffer_messages; i++) {
+      snprintf(buffer, sizeof(buffer), "buffer %d", i);
+      LOG_STREAM(<< buffer);
+    }
+  }
+  {
+    // writes that don't go through operator<< are kept as text too
+    log_bin.print().get_stream() << "direct " << 5;
+    expected_messages.push_back("direct 5");
+  }
+
+  // printf-style messages
+  LOG_PRINTF("printf %d %u %s", -5, 5U, "str");
+  LOG_PRINTF("printf %5.2f|%-4d|%x|%c", 2.71828, 9, 0xbeefU, 'q');
+  LOG_PRINTF("printf %lld %zu %%", -1234567890123LL, size_t(99));
+
+  // lots of messages from several threads at once
+  std::vector<Processor> procs;
+  Machine::ProcessorQuery pq(Machine::get_machine());
+  pq.only_kind(Processor::LOC_PROC);
+  procs.assign(pq.begin(), pq.end());
+  std::vector<Event> events;
+  for(int i = 0; i < num_writers; i++) {
+    WriterArgs wargs;
+    wargs.task_idx = i;
+    wargs.num_messages = writer_messages;
+    events.push_back(procs[i % procs.size()].spawn(WRITER_TASK,
+                                                   &wargs, sizeof(wargs)));
+  }
+  Event::merge_events(events).wait();
+
+  log_app.info() << "logging done";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, 0);
+}
+
+// walks the records in the file, checking that the stream and printf
+//  messages were recorded as such
+static bool count_records(const std::string& filename,
+                          int& num_stream, int& num_printf,
+                          std::set<std::string>& formats)
+{
+  FILE *f = fopen(filename.c_str(), "rb");
+  if(!f) return false;
+  std::vector<char> data;
+  char chunk[65536];
+  size_t amt;
+  while((amt = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    data.insert(data.end(), chunk, chunk + amt);
+  fclose(f);
+
+  num_stream = num_printf = 0;
+  if((data.size() < 16) || (memcmp(&data[0], "REALMLOG", 8) != 0))
+    return false;
+  size_t pos = 16;
+  while(pos < data.size()) {
+    uint8_t rectype = data[pos++];
+    uint32_t len32;
+    uint16_t len16;
+    switch(rectype) {
+    case 1:  // category: u16:cat_id u16:name_len name
+      memcpy(&len16, &data[pos + 2], sizeof(len16));
+      pos += 4 + len16;
+      break;
+    case 2:  // message: u8 u16 u64 s64 u32:len msg
+    case 5:  // stream: u8 u16 u64 s64 u32:len items
+      memcpy(&len32, &data[pos + 19], sizeof(len32));
+      pos += 23 + len32;
+      if(rectype == 5) num_stream++;
+      break;
+    case 3:  // format: u32:fmt_id u32:len fmt
+      memcpy(&len32, &data[pos + 4], sizeof(len32));
+      formats.insert(std::string(&data[pos + 8], len32));
+      pos += 8 + len32;
+      break;
+    case 4:  // printf: u8 u16 u64 s64 u32:fmt_id u32:len args
+      memcpy(&len32, &data[pos + 23], sizeof(len32));
+      pos += 27 + len32;
+      num_printf++;
+      break;
+    default:
+      printf("unknown record type %d at offset %zu\n", rectype, pos - 1);
+      return false;
+    }
+  }
+  return (pos == data.size());
+}
+
+static int check_log(const std::string& logname, const std::string& decoder)
+{
+  int errors = 0;
+
+  int num_stream, num_printf;
+  std::set<std::string> formats;
+  if(!count_records(logname, num_stream, num_printf, formats)) {
+    printf("could not parse binary log '%s'\n", logname.c_str());
+    return 1;
+  }
+  // all but the big message are stream records, as are the writers' messages
+  int min_stream = (num_stream_messages - 1 + (num_writers * writer_messages));
+  if((num_stream < min_stream) || (num_printf < num_printf_messages)) {
+    printf("expected at least %d stream and %d printf records, got %d and %d\n",
+           min_stream, num_printf_messages, num_stream, num_printf);
+    errors++;
+  }
+  // the formats are the printf formats and the string literals - but not
+  //  the contents of a char array on the stack
+  if(formats.size() >= size_t(num_buffer_messages)) {
+    printf("%zu format records - char arrays were recorded as literals?\n",
+           formats.size());
+    errors++;
+  }
+  if((formats.count("writer ") == 0) || (formats.count("c string") == 0)) {
+    printf("unmarked string literals were not recorded as literals\n");
+    errors++;
+  }
+
+  std::string cmd = "python3 " + decoder + " -t -u " + logname;
+  FILE *p = popen(cmd.c_str(), "r");
+  if(!p) {
+    printf("could not run '%s'\n", cmd.c_str());
+    return 1;
+  }
+
+  // decoded lines look like "[node - thread] {level}{category}: message"
+  std::vector<std::string> single_msgs;
+  std::set<std::string> writer_msgs;
+  size_t writer_lines = 0;
+  std::string line;
+  char buffer[4096];
+  while(fgets(buffer, sizeof(buffer), p)) {
+    line += buffer;
+    if(line.empty() || (line[line.size() - 1] != '\n'))
+      continue;  // a long line - keep reading
+    line.erase(line.size() - 1);
+    size_t ofs = line.find("{binlog}: ");
+    if(ofs != std::string::npos) {
+      std::string msg = line.substr(ofs + 10);
+      if(msg.compare(0, 7, "writer ") == 0) {
+        writer_msgs.insert(msg);
+        writer_lines++;
+      } else
+        single_msgs.push_back(msg);
+    }
+    line.clear();
+  }
+  int ret = pclose(p);
+  if(ret != 0) {
+    printf("'%s' failed: status=%d\n", cmd.c_str(), ret);
+    return 1;
+  }
+
+  if(single_msgs.size() != expected_messages.size()) {
+    printf("expected %zu messages, decoded %zu\n",
+           expected_messages.size(), single_msgs.size());
+    errors++;
+  }
+  for(size_t i = 0; (i < single_msgs.size()) && (i < expected_messages.size()); i++)
+    if(single_msgs[i] != expected_messages[i]) {
+      printf("mismatch: expected '%s'\n          decoded  '%s'\n",
+             expected_messages[i].c_str(), single_msgs[i].c_str());
+      errors++;
+    }
+
+  size_t total = size_t(num_writers) * writer_messages;
+  if(writer_lines != total) {
+    printf("expected %zu writer messages, decoded %zu\n", total, writer_lines);
+    errors++;
+  }
+  for(int i = 0; i < num_writers; i++)
+    for(int j = 0; j < writer_messages; j++)
+      if(writer_msgs.count(writer_message(i, j)) == 0) {
+        if(errors < 10)
+          printf("missing: '%s'\n", writer_message(i, j).c_str());
+        errors++;
+      }
+
+  return errors;
+}
+
+int main(int argc, const char **argv)
+{
+  std::string decoder = "realm_log_decode.py";
+  bool keep_log = false;
+  {
+    CommandLineParser clp;
+    clp.add_option_string("-decoder", decoder);
+    clp.add_option_int("-writers", num_writers);
+    clp.add_option_int("-messages", writer_messages);
+    clp.add_option_bool("-keep", keep_log);
+    bool ok = clp.parse_command_line(argc, argv);
+    assert(ok);
+  }
+
+  // binary logging to a file of our own is added to whatever else was
+  //  asked for
+  char logname[64];
+  snprintf(logname, sizeof(logname), "binary_logging_%d.log", int(getpid()));
+  std::vector<const char *> args(argv, argv + argc);
+  args.push_back("-logfile");
+  args.push_back(logname);
+  args.push_back("-logbinary");
+  args.push_back("1");
+  int my_argc = args.size();
+  args.push_back(0);
+  const char **my_argv = &args[0];
+
+  Runtime rt;
+
+  rt.init(&my_argc, (char ***)&my_argv);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   TOP_LEVEL_TASK,
+                                   CodeDescriptor(top_level_task),
+                                   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   WRITER_TASK,
+                                   CodeDescriptor(writer_task),
+                                   ProfilingRequestSet()).external_wait();
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  Logger::flush_all_streams();
+
+  if(ret == 0) {
+    int errors = check_log(logname, decoder);
+    if(errors == 0)
+      printf("binary log decoded successfully\n");
+    else {
+      printf("%d errors in decoded binary log\n", errors);
+      ret = 1;
+    }
+  }
+
+  if(!keep_log)
+    remove(logname);
+
+  return ret;
+}
@@ -0,0 +1,161 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for monotonicity of relative time (including across the
+//  periodic resyncs of a TSC-based clock) as seen by several threads
+
+#include <realm.h>
+#include <realm/cmdline.h>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  CHECKER_TASK,
+};
+
+namespace TestConfig {
+  long long duration = 2500;  // msec - long enough to span two TSC resyncs
+  int max_procs = 4;
+};
+
+struct CheckerArgs {
+  long long duration;  // nsec
+};
+
+// the latest time observed by any checker - a time read after this value
+//  was published must not be earlier than it
+static atomic<long long> latest_time(0);
+static atomic<size_t> total_errors(0);
+
+void checker_task(const void *args, size_t arglen,
+		  const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(CheckerArgs));
+  const CheckerArgs& cargs = *static_cast<const CheckerArgs *>(args);
+
+  long long start = Clock::current_time_in_nanoseconds();
+  long long last = start;
+  size_t samples = 0;
+  size_t errors = 0;
+  while(true) {
+    long long prev_global = latest_time.load_acquire();
+    long long now = Clock::current_time_in_nanoseconds();
+    samples++;
+
+    if(now < last) {
+      if(errors < 10)
+	log_app.error() << "time went backwards on " << p << ": "
+			<< last << " -> " << now;
+      errors++;
+    }
+    if(now < prev_global) {
+      if(errors < 10)
+	log_app.error() << "time on " << p << " earlier than published: "
+			<< prev_global << " > " << now;
+      errors++;
+    }
+    last = now;
+
+    // publish our time if it's the latest
+    while(now > prev_global) {
+      if(latest_time.compare_exchange(prev_global, now))
+	break;
+    }
+
+    if((now - start) >= cargs.duration)
+      break;
+  }
+
+  log_app.info() << "checker on " << p << ": " << samples << " samples, "
+		 << errors << " errors";
+  total_errors.fetch_add(errors);
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "clock monotonicity test: tsc=" << Clock::using_tsc();
+
+  std::vector<Processor> procs;
+  {
+    Machine::ProcessorQuery pq = Machine::ProcessorQuery(Machine::get_machine())
+      .only_kind(p.kind()).local_address_space();
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it) {
+      procs.push_back(*it);
+      if(int(procs.size()) >= TestConfig::max_procs)
+	break;
+    }
+  }
+
+  CheckerArgs cargs;
+  cargs.duration = TestConfig::duration * 1000000;
+
+  std::vector<Event> events;
+  for(size_t i = 0; i < procs.size(); i++)
+    events.push_back(procs[i].spawn(CHECKER_TASK, &cargs, sizeof(cargs)));
+  Event::merge_events(events).wait();
+
+  size_t errors = total_errors.load();
+  if(errors == 0)
+    log_app.info() << "completed successfully";
+  else
+    log_app.error() << errors << " errors detected";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+int main(int argc, const char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, (char ***)&argv);
+
+  CommandLineParser clp;
+  clp.add_option_int("-d", TestConfig::duration);
+  clp.add_option_int("-p", TestConfig::max_procs);
+
+  bool ok = clp.parse_command_line(argc, argv);
+  assert(ok);
+
+  // try to use a cpu proc, but if that doesn't exist, take whatever we can get
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  if(!p.exists())
+    p = Machine::ProcessorQuery(Machine::get_machine()).first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   TOP_LEVEL_TASK,
+				   CodeDescriptor(top_level_task),
+				   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   CHECKER_TASK,
+				   CodeDescriptor(checker_task),
+				   ProfilingRequestSet()).external_wait();
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
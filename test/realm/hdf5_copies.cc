@@ -0,0 +1,272 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for many concurrent copies to and from HDF5 datasets - every
+//  slab of every file is written and then read back by copies that are all
+//  in flight at once, so the datasets (and the files they live in) are
+//  opened and closed by several background workers and I/O threads at the
+//  same time (run with -hdf5:openfiles 0 to close files as soon as they
+//  are unused, and -hdf5:iothreads N to use the dedicated I/O threads)
+
+#include <realm.h>
+#include <realm/cmdline.h>
+#include <realm/hdf5/hdf5_access.h>
+
+#include <hdf5.h>
+
+#include <stdio.h>
+#include <vector>
+#include <string>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+enum {
+  FID_VALUE = 100,
+};
+
+struct TestConfig {
+  int num_files;
+  int slabs_per_file;
+  int slab_size;
+  int watchdog_timeout;
+};
+
+static const char *DSET_NAME = "data/values";
+
+static std::string file_name(int f)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "hdf5_copies_%d_%d.h5", int(getpid()), f);
+  return buffer;
+}
+
+static long long expected_value(int f, long long i)
+{
+  return (f * 1000000LL) + i;
+}
+
+static void create_file(const std::string& name, hsize_t size)
+{
+  hid_t file_id = H5Fcreate(name.c_str(), H5F_ACC_TRUNC,
+			    H5P_DEFAULT, H5P_DEFAULT);
+  assert(file_id >= 0);
+  hid_t grp_id = H5Gcreate2(file_id, "data",
+			    H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  assert(grp_id >= 0);
+  hid_t space_id = H5Screate_simple(1, &size, 0);
+  assert(space_id >= 0);
+  hid_t dset_id = H5Dcreate2(grp_id, "values", H5T_NATIVE_LLONG, space_id,
+			     H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  assert(dset_id >= 0);
+  H5Dclose(dset_id);
+  H5Sclose(space_id);
+  H5Gclose(grp_id);
+  H5Fclose(file_id);
+}
+
+static RegionInstance create_hdf5_instance(const std::string& name,
+					   IndexSpace<1> space)
+{
+  InstanceLayout<1,int> *layout = new InstanceLayout<1,int>;
+  layout->bytes_used = 0;
+  layout->alignment_reqd = 0;
+  layout->space = space;
+  layout->piece_lists.resize(1);
+  InstanceLayoutGeneric::FieldLayout& fl = layout->fields[FID_VALUE];
+  fl.list_idx = 0;
+  fl.rel_offset = 0;
+  fl.size_in_bytes = sizeof(long long);
+  HDF5LayoutPiece<1,int> *hlp = new HDF5LayoutPiece<1,int>;
+  hlp->bounds = space.bounds;
+  hlp->dsetname = DSET_NAME;
+  hlp->offset[0] = 0;
+  hlp->dim_order[0] = 0;
+  layout->piece_lists[0].pieces.push_back(hlp);
+
+  ExternalHDF5Resource res(name, false /*!read_only*/);
+  RegionInstance inst;
+  RegionInstance::create_external_instance(inst, res.suggested_memory(),
+					   layout, res,
+					   ProfilingRequestSet()).wait();
+  return inst;
+}
+
+static Event copy_slab(IndexSpace<1> slab,
+		       RegionInstance src, RegionInstance dst)
+{
+  std::vector<CopySrcDstField> srcs(1), dsts(1);
+  srcs[0].set_field(src, FID_VALUE, sizeof(long long));
+  dsts[0].set_field(dst, FID_VALUE, sizeof(long long));
+  return slab.copy(srcs, dsts, ProfilingRequestSet());
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  const TestConfig& config = *reinterpret_cast<const TestConfig *>(args);
+  const int num_slabs = config.num_files * config.slabs_per_file;
+  const int file_size = int(config.slabs_per_file) * config.slab_size;
+
+  log_app.print() << "hdf5 copy test: " << config.num_files << " files, "
+		  << config.slabs_per_file << " slabs/file, "
+		  << config.slab_size << " elements/slab";
+
+  Memory sysmem = Machine::MemoryQuery(Machine::get_machine())
+    .only_kind(Memory::SYSTEM_MEM)
+    .has_affinity_to(p)
+    .first();
+  assert(sysmem.exists());
+
+  // one sysmem instance per slab holds the values written, another gets
+  //  what is read back
+  std::vector<IndexSpace<1> > slabs(num_slabs);
+  std::vector<RegionInstance> src_insts(num_slabs), dst_insts(num_slabs);
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[FID_VALUE] = sizeof(long long);
+  for(int f = 0; f < config.num_files; f++)
+    for(int s = 0; s < config.slabs_per_file; s++) {
+      int idx = (f * config.slabs_per_file) + s;
+      int lo = int(s) * config.slab_size;
+      slabs[idx] = Rect<1>(lo, lo + config.slab_size - 1);
+      RegionInstance::create_instance(src_insts[idx], sysmem, slabs[idx],
+				      field_sizes, 0 /*SOA*/,
+				      ProfilingRequestSet()).wait();
+      RegionInstance::create_instance(dst_insts[idx], sysmem, slabs[idx],
+				      field_sizes, 0 /*SOA*/,
+				      ProfilingRequestSet()).wait();
+      AffineAccessor<long long,1> acc(src_insts[idx], FID_VALUE);
+      for(int i = lo; i < lo + config.slab_size; i++)
+	acc[i] = expected_value(f, i);
+    }
+
+  // create the files and an instance covering each whole dataset
+  std::vector<RegionInstance> file_insts(config.num_files);
+  for(int f = 0; f < config.num_files; f++) {
+    create_file(file_name(f), file_size);
+    file_insts[f] = create_hdf5_instance(file_name(f),
+					 Rect<1>(0, file_size - 1));
+  }
+
+  // set a timeout to catch hangs
+  if(config.watchdog_timeout > 0)
+    alarm(config.watchdog_timeout);
+
+  // all the writes at once, then all the reads at once
+  std::vector<Event> events;
+  for(int idx = 0; idx < num_slabs; idx++)
+    events.push_back(copy_slab(slabs[idx], src_insts[idx],
+			       file_insts[idx / config.slabs_per_file]));
+  Event::merge_events(events).wait();
+  events.clear();
+  for(int idx = 0; idx < num_slabs; idx++)
+    events.push_back(copy_slab(slabs[idx],
+			       file_insts[idx / config.slabs_per_file],
+			       dst_insts[idx]));
+  Event::merge_events(events).wait();
+
+  if(config.watchdog_timeout > 0)
+    alarm(0);
+
+  size_t errors = 0;
+  for(int idx = 0; idx < num_slabs; idx++) {
+    int f = idx / config.slabs_per_file;
+    AffineAccessor<long long,1> acc(dst_insts[idx], FID_VALUE);
+    for(PointInRectIterator<1> pir(slabs[idx].bounds); pir.valid; pir.step()) {
+      long long actual = acc[pir.p];
+      long long expected = expected_value(f, pir.p[0]);
+      if(actual != expected) {
+	if(errors < 10)
+	  log_app.error() << "mismatch: file=" << f << " index=" << pir.p[0]
+			  << " expected=" << expected << " actual=" << actual;
+	errors++;
+      }
+    }
+  }
+
+  for(int idx = 0; idx < num_slabs; idx++) {
+    src_insts[idx].destroy();
+    dst_insts[idx].destroy();
+  }
+  for(int f = 0; f < config.num_files; f++) {
+    file_insts[f].destroy();
+    remove(file_name(f).c_str());
+  }
+
+  if(errors == 0)
+    log_app.info() << "completed successfully";
+  else
+    log_app.error() << errors << " errors detected";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  log_app.fatal() << "HELP!  Alarm triggered - likely deadlock!";
+  abort();
+}
+
+int main(int argc, const char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, (char ***)&argv);
+
+  TestConfig config;
+  config.num_files = 4;
+  config.slabs_per_file = 16;
+  config.slab_size = 4096;
+  config.watchdog_timeout = 60; // 60 seconds
+
+  CommandLineParser clp;
+  clp.add_option_int("-files", config.num_files);
+  clp.add_option_int("-slabs", config.slabs_per_file);
+  clp.add_option_int("-size", config.slab_size);
+  clp.add_option_int("-timeout", config.watchdog_timeout);
+
+  bool ok = clp.parse_command_line(argc, argv);
+  assert(ok);
+  assert((config.num_files > 0) && (config.slabs_per_file > 0) &&
+	 (config.slab_size > 0));
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   TOP_LEVEL_TASK,
+				   CodeDescriptor(top_level_task),
+				   ProfilingRequestSet()).external_wait();
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, &config, sizeof(config));
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
@@ -0,0 +1,207 @@
+// Copyright 2021 Stanford University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Realm test for elastic intermediate buffer sizing - node 0 copies
+//  instances to the system memory of every other node and back again, all
+//  at once, with a registered IB memory (-ll:ib_rsize) much smaller than
+//  the buffer any one of those copies would like - each copy only fits if
+//  its buffer is shrunk to a share of the memory, and every element is
+//  checked once the copies finish
+//
+// intermediate buffers are only used for copies between nodes - on a
+//  single node the same copies are made within the local system memory
+
+#include "realm.h"
+#include "realm/cmdline.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+#include <map>
+#include <set>
+#include <cassert>
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+enum {
+  FID_DATA = 100,
+};
+
+// an odd-sized element, so shrunk buffers must stay a multiple of it
+struct Element {
+  int x[3];
+};
+
+namespace TestConfig {
+  int num_elements = 1 << 20;  // 12MB per instance
+  int copies_per_target = 4;
+  int ib_size_mb = 4;          // -ll:ib_rsize
+};
+
+static int element_value(int copy, int i, int j)
+{
+  return (copy * 7919 + i) * 3 + j;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Machine machine = Machine::get_machine();
+
+  Memory local_mem = Machine::MemoryQuery(machine)
+    .local_address_space()
+    .only_kind(Memory::SYSTEM_MEM)
+    .first();
+  assert(local_mem.exists());
+
+  // one system memory on every other node
+  std::vector<Memory> targets;
+  {
+    std::set<AddressSpace> seen;
+    seen.insert(p.address_space());
+    Machine::MemoryQuery mq(machine);
+    mq.only_kind(Memory::SYSTEM_MEM);
+    for(Machine::MemoryQuery::iterator it = mq.begin(); it; ++it)
+      if(seen.count(it->address_space()) == 0) {
+	seen.insert(it->address_space());
+	targets.push_back(*it);
+      }
+  }
+  if(targets.empty()) {
+    log_app.print() << "no remote memories - intermediate buffers will not be used";
+    targets.push_back(local_mem);
+  }
+
+  IndexSpace<1> is(Rect<1>(0, TestConfig::num_elements - 1));
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[FID_DATA] = sizeof(Element);
+
+  std::vector<CopySrcDstField> src_fields(1), dst_fields(1);
+  src_fields[0].set_field(RegionInstance::NO_INST, FID_DATA, sizeof(Element));
+  dst_fields[0].set_field(RegionInstance::NO_INST, FID_DATA, sizeof(Element));
+
+  // every copy goes out to its target and back into an instance of its own
+  size_t num_copies = targets.size() * TestConfig::copies_per_target;
+  std::vector<RegionInstance> srcs(num_copies), remotes(num_copies);
+  std::vector<RegionInstance> results(num_copies);
+  std::vector<Event> done(num_copies);
+  for(size_t c = 0; c < num_copies; c++) {
+    RegionInstance::create_instance(srcs[c], local_mem, is, field_sizes,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+    RegionInstance::create_instance(remotes[c],
+				    targets[c % targets.size()],
+				    is, field_sizes,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+    RegionInstance::create_instance(results[c], local_mem, is, field_sizes,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+
+    AffineAccessor<Element, 1> acc(srcs[c], FID_DATA);
+    for(int i = 0; i < TestConfig::num_elements; i++)
+      for(int j = 0; j < 3; j++)
+	acc[i].x[j] = element_value(c, i, j);
+  }
+
+  // launch everything before waiting on anything, so the buffer requests
+  //  compete for the IB memory
+  for(size_t c = 0; c < num_copies; c++) {
+    src_fields[0].inst = srcs[c];
+    dst_fields[0].inst = remotes[c];
+    Event e = is.copy(src_fields, dst_fields, ProfilingRequestSet());
+    src_fields[0].inst = remotes[c];
+    dst_fields[0].inst = results[c];
+    done[c] = is.copy(src_fields, dst_fields, ProfilingRequestSet(), e);
+  }
+  Event::merge_events(done).wait();
+
+  int errors = 0;
+  for(size_t c = 0; c < num_copies; c++) {
+    AffineAccessor<Element, 1> acc(results[c], FID_DATA);
+    for(int i = 0; i < TestConfig::num_elements; i++)
+      for(int j = 0; j < 3; j++)
+	if(acc[i].x[j] != element_value(c, i, j)) {
+	  if(errors < 10)
+	    log_app.error() << "mismatch: copy=" << c << " target="
+			    << targets[c % targets.size()] << " element=" << i
+			    << "." << j << " expected=" << element_value(c, i, j)
+			    << " actual=" << acc[i].x[j];
+	  errors++;
+	}
+  }
+
+  if(errors == 0)
+    log_app.print() << num_copies << " copies through "
+		    << TestConfig::ib_size_mb << "MB of intermediate buffers"
+		    << " matched";
+
+  for(size_t c = 0; c < num_copies; c++) {
+    srcs[c].destroy();
+    remotes[c].destroy();
+    results[c].destroy();
+  }
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+int main(int argc, const char **argv)
+{
+  {
+    CommandLineParser clp;
+    clp.add_option_int("-elements", TestConfig::num_elements);
+    clp.add_option_int("-copies", TestConfig::copies_per_target);
+    clp.add_option_int("-ll:ib_rsize", TestConfig::ib_size_mb);
+    bool ok = clp.parse_command_line(argc, argv);
+    assert(ok);
+  }
+
+  // the small IB memory (as parsed above) and enough system memory for the
+  //  instances are added to whatever else was asked for
+  char ib_size[16];
+  snprintf(ib_size, sizeof(ib_size), "%d", TestConfig::ib_size_mb);
+  std::vector<const char *> args(argv, argv + argc);
+  args.push_back("-ll:ib_rsize");
+  args.push_back(ib_size);
+  args.push_back("-ll:csize");
+  args.push_back("512");
+  int my_argc = args.size();
+  args.push_back(0);
+  const char **my_argv = &args[0];
+
+  Runtime rt;
+
+  rt.init(&my_argc, (char ***)&my_argv);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   TOP_LEVEL_TASK,
+                                   CodeDescriptor(top_level_task),
+                                   ProfilingRequestSet()).external_wait();
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  return rt.wait_for_shutdown();
+}
@@ -0,0 +1,267 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for the machine model built from the startup announcements -
+//  every node describes its own processors, memories and affinities from
+//  its local view of the machine, and node 0 checks that its view of each
+//  node (built from that node's announcement) is the same, including the
+//  order in which the affinities are returned
+//
+// this is only interesting when run on multiple nodes - on a single node
+//  nothing is announced and node 0 just compares its view with itself -
+//  and giving the nodes different processor counts, e.g.:
+//    mpirun -n 1 machine_announce -ll:cpu 4 -ll:util 2 :
+//           -n 1 machine_announce -ll:cpu 2 -ll:io 1
+//  checks that each node's announcement is decoded on its own terms
+
+#include <realm.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  DESCRIBE_TASK,
+  CHECK_TASK,
+};
+
+enum {
+  DESC_PROC = 1,  // id kind num_cores
+  DESC_MEM,       // id kind capacity
+  DESC_PMA,       // proc mem bandwidth latency
+  DESC_MMA,       // mem1 mem2 bandwidth latency
+};
+
+struct DescribeArgs {
+  Processor reply_proc;
+};
+
+struct CheckArgs {
+  AddressSpace node;
+  size_t count;
+  // followed by 'count' uint64_t's of description
+};
+
+static int errors = 0;
+
+// describes everything the machine model knows about the processors and
+//  memories of 'node', in an order that doesn't depend on which node is
+//  asking
+static void describe_node(AddressSpace node, std::vector<uint64_t>& desc)
+{
+  Machine machine = Machine::get_machine();
+
+  std::vector<Processor> procs;
+  {
+    Machine::ProcessorQuery pq(machine);
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it; ++it)
+      if(AddressSpace((*it).address_space()) == node)
+        procs.push_back(*it);
+  }
+  std::sort(procs.begin(), procs.end());
+
+  std::vector<Memory> mems;
+  {
+    Machine::MemoryQuery mq(machine);
+    for(Machine::MemoryQuery::iterator it = mq.begin(); it; ++it)
+      if(AddressSpace((*it).address_space()) == node)
+        mems.push_back(*it);
+  }
+  std::sort(mems.begin(), mems.end());
+
+  for(std::vector<Processor>::const_iterator it = procs.begin();
+      it != procs.end();
+      ++it) {
+    desc.push_back(DESC_PROC);
+    desc.push_back(it->id);
+    desc.push_back(it->kind());
+    desc.push_back(it->get_num_cores());
+  }
+
+  for(std::vector<Memory>::const_iterator it = mems.begin();
+      it != mems.end();
+      ++it) {
+    desc.push_back(DESC_MEM);
+    desc.push_back(it->id);
+    desc.push_back(it->kind());
+    desc.push_back(it->capacity());
+  }
+
+  // affinities are kept in the order the machine returns them
+  for(std::vector<Processor>::const_iterator it = procs.begin();
+      it != procs.end();
+      ++it) {
+    std::vector<Machine::ProcessorMemoryAffinity> pmas;
+    machine.get_proc_mem_affinity(pmas, *it);
+    for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = pmas.begin();
+        it2 != pmas.end();
+        ++it2) {
+      desc.push_back(DESC_PMA);
+      desc.push_back(it2->p.id);
+      desc.push_back(it2->m.id);
+      desc.push_back(it2->bandwidth);
+      desc.push_back(it2->latency);
+    }
+  }
+
+  // only affinities between two memories of the node are announced
+  for(std::vector<Memory>::const_iterator it = mems.begin();
+      it != mems.end();
+      ++it) {
+    std::vector<Machine::MemoryMemoryAffinity> mmas;
+    machine.get_mem_mem_affinity(mmas, *it);
+    for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = mmas.begin();
+        it2 != mmas.end();
+        ++it2) {
+      if((it2->m1 != *it) || (AddressSpace(it2->m2.address_space()) != node))
+        continue;
+      desc.push_back(DESC_MMA);
+      desc.push_back(it2->m1.id);
+      desc.push_back(it2->m2.id);
+      desc.push_back(it2->bandwidth);
+      desc.push_back(it2->latency);
+    }
+  }
+}
+
+void check_task(const void *args, size_t arglen,
+                const void *userdata, size_t userlen, Processor p)
+{
+  const CheckArgs& cargs = *reinterpret_cast<const CheckArgs *>(args);
+  assert(arglen == (sizeof(CheckArgs) + cargs.count * sizeof(uint64_t)));
+  std::vector<uint64_t> remote(cargs.count);
+  if(cargs.count > 0)
+    memcpy(&remote[0], reinterpret_cast<const char *>(args) + sizeof(CheckArgs),
+           cargs.count * sizeof(uint64_t));
+
+  std::vector<uint64_t> local;
+  describe_node(cargs.node, local);
+
+  if(local == remote) {
+    log_app.info() << "node " << cargs.node << ": " << local.size()
+                   << " description entries match";
+    return;
+  }
+
+  // find the first difference to report
+  size_t i = 0;
+  while((i < local.size()) && (i < remote.size()) && (local[i] == remote[i]))
+    i++;
+  log_app.error() << "node " << cargs.node << ": description differs at entry "
+                  << i << " (node's own view has " << remote.size()
+                  << " entries, node " << p.address_space() << " has "
+                  << local.size() << ")";
+  __sync_fetch_and_add(&errors, 1);
+}
+
+void describe_task(const void *args, size_t arglen,
+                   const void *userdata, size_t userlen, Processor p)
+{
+  const DescribeArgs& dargs = *reinterpret_cast<const DescribeArgs *>(args);
+
+  std::vector<uint64_t> desc;
+  describe_node(p.address_space(), desc);
+
+  std::vector<char> buffer(sizeof(CheckArgs) + desc.size() * sizeof(uint64_t));
+  CheckArgs& cargs = *reinterpret_cast<CheckArgs *>(&buffer[0]);
+  cargs.node = p.address_space();
+  cargs.count = desc.size();
+  if(!desc.empty())
+    memcpy(&buffer[sizeof(CheckArgs)], &desc[0],
+           desc.size() * sizeof(uint64_t));
+
+  // the check has to finish before we do so the top level task can wait
+  //  on just us
+  dargs.reply_proc.spawn(CHECK_TASK, &buffer[0], buffer.size()).wait();
+}
+
+void top_level_task(const void *args, size_t arglen,
+                    const void *userdata, size_t userlen, Processor p)
+{
+  Machine machine = Machine::get_machine();
+
+  // one describing processor on every node
+  std::vector<Processor> targets(machine.get_address_space_count());
+  {
+    Machine::ProcessorQuery pq(machine);
+    pq.only_kind(Processor::LOC_PROC);
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it; ++it) {
+      AddressSpace node = (*it).address_space();
+      if(!targets[node].exists())
+        targets[node] = *it;
+    }
+  }
+
+  std::vector<Event> events;
+  for(size_t i = 0; i < targets.size(); i++) {
+    if(!targets[i].exists()) {
+      log_app.error() << "no CPU processor found on node " << i;
+      errors++;
+      continue;
+    }
+    DescribeArgs dargs;
+    dargs.reply_proc = p;
+    events.push_back(targets[i].spawn(DESCRIBE_TASK, &dargs, sizeof(dargs)));
+  }
+  Event::merge_events(events).wait();
+
+  if(errors == 0)
+    log_app.print() << "machine model of " << targets.size()
+                    << " node(s) matches";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+int main(int argc, const char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, (char ***)&argv);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   TOP_LEVEL_TASK,
+                                   CodeDescriptor(top_level_task),
+                                   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   DESCRIBE_TASK,
+                                   CodeDescriptor(describe_task),
+                                   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+                                   CHECK_TASK,
+                                   CodeDescriptor(check_task),
+                                   ProfilingRequestSet()).external_wait();
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
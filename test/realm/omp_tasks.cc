@@ -0,0 +1,413 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for OpenMP explicit tasks (task, taskwait, taskgroup and
+//  taskloop) running on Realm's OpenMP runtime - the pragmas exercise
+//  whichever entry points the compiler emits (GOMP for gcc, KMP for clang)
+//  and the KMP entry points are also called directly
+
+#include <realm.h>
+#include <realm/cmdline.h>
+
+#include <omp.h>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  OMP_TASK,
+};
+
+namespace TestConfig {
+  int num_tasks = 1000;
+  int fib_n = 20;
+};
+
+static size_t errors = 0;
+
+static void check(const char *what, long long actual, long long expected)
+{
+  if(actual == expected)
+    log_app.info() << what << ": " << actual;
+  else {
+    log_app.error() << what << ": got " << actual
+		    << ", expected " << expected;
+    errors++;
+  }
+}
+
+static long long fib(int n)
+{
+  if(n < 2) return n;
+  long long a, b;
+#pragma omp task shared(a)
+  a = fib(n - 1);
+#pragma omp task shared(b)
+  b = fib(n - 2);
+#pragma omp taskwait
+  return a + b;
+}
+
+// spins until 'flag' is set, giving up (and counting an error) if that
+//  takes far longer than it ever should
+static void spin_until(const atomic<int>& flag, const char *what)
+{
+  long long start = Clock::current_time_in_microseconds();
+  while(!flag.load_acquire()) {
+    if((Clock::current_time_in_microseconds() - start) > 10000000) {
+      log_app.error() << "timed out waiting for " << what;
+      errors++;
+      return;
+    }
+    usleep(10);
+  }
+}
+
+// a thread waiting in a taskwait may only run descendants of the task that
+//  is waiting - thread 0's task P waits for a child C that thread 1 has
+//  stolen, while thread 2 queues an unrelated task U that must not be
+//  picked up by thread 0 until P is done waiting
+static void test_tied_waits(void)
+{
+  atomic<int> p_started(0), c_started(0), u_queued(0), p_done(0);
+  atomic<int> waiter(-1);
+  atomic<int> violations(0);
+#pragma omp parallel num_threads(3)
+  {
+    if(omp_get_num_threads() == 3) {
+      switch(omp_get_thread_num()) {
+      case 0:
+	{
+#pragma omp task shared(p_started, c_started, u_queued, p_done, waiter)
+	  {
+	    p_started.store_release(1);
+#pragma omp task shared(c_started, u_queued)
+	    {
+	      c_started.store_release(1);
+	      spin_until(u_queued, "unrelated task");
+	      // give the waiting thread plenty of chances to steal
+	      usleep(50000);
+	    }
+	    spin_until(c_started, "child to be stolen");
+	    spin_until(u_queued, "unrelated task");
+	    waiter.store_release(omp_get_thread_num());
+#pragma omp taskwait
+	    waiter.store_release(-1);
+	    p_done.store_release(1);
+	  }
+#pragma omp taskyield
+	  break;
+	}
+
+      case 1:
+	// the barrier at the end of the region will steal the child
+	spin_until(p_started, "waiting task");
+	break;
+
+      case 2:
+	{
+	  spin_until(c_started, "child to be stolen");
+#pragma omp task shared(waiter, violations)
+	  if(omp_get_thread_num() == waiter.load_acquire())
+	    violations.fetch_add(1);
+	  u_queued.store_release(1);
+	  spin_until(p_done, "taskwait");
+	  break;
+	}
+      }
+    }
+  }
+  check("unrelated tasks run in taskwait", violations.load(), 0);
+}
+
+#ifdef REALM_OPENMP_KMP_SUPPORT
+// the KMP entry points, laid out the way clang calls them
+struct ident_t;
+struct kmp_task_t;
+typedef int (*kmp_routine_entry_t)(int, kmp_task_t *);
+struct kmp_task_t {
+  void *shareds;
+  kmp_routine_entry_t routine;
+  int part_id;
+  void *data1, *data2;
+};
+
+extern "C" {
+  kmp_task_t *__kmpc_omp_task_alloc(ident_t *loc, int gtid, int flags,
+				    size_t sizeof_kmp_task_t,
+				    size_t sizeof_shareds,
+				    kmp_routine_entry_t task_entry);
+  int __kmpc_omp_task(ident_t *loc, int gtid, kmp_task_t *new_task);
+  int __kmpc_omp_taskwait(ident_t *loc, int gtid);
+  void __kmpc_omp_task_begin_if0(ident_t *loc, int gtid, kmp_task_t *task);
+  void __kmpc_omp_task_complete_if0(ident_t *loc, int gtid,
+				    kmp_task_t *task);
+  void __kmpc_taskgroup(ident_t *loc, int gtid);
+  void __kmpc_end_taskgroup(ident_t *loc, int gtid);
+  void __kmpc_taskloop(ident_t *loc, int gtid, kmp_task_t *task, int if_val,
+		       unsigned long long *lb, unsigned long long *ub,
+		       long long st, int nogroup, int sched,
+		       unsigned long long grainsize, void *task_dup);
+};
+
+struct KmpShareds {
+  atomic<long long> *sum;
+};
+
+struct KmpValueTask {
+  kmp_task_t task;
+  long long value;
+};
+
+struct KmpLoopTask {
+  kmp_task_t task;
+  unsigned long long lb, ub;
+  long long st;
+};
+
+static int kmp_value_body(int gtid, kmp_task_t *task)
+{
+  KmpValueTask *t = reinterpret_cast<KmpValueTask *>(task);
+  static_cast<KmpShareds *>(task->shareds)->sum->fetch_add(t->value);
+  return 0;
+}
+
+static int kmp_loop_body(int gtid, kmp_task_t *task)
+{
+  KmpLoopTask *t = reinterpret_cast<KmpLoopTask *>(task);
+  for(unsigned long long i = t->lb; i <= t->ub; i += t->st)
+    static_cast<KmpShareds *>(task->shareds)->sum->fetch_add(i);
+  return 0;
+}
+
+static kmp_task_t *kmp_alloc(size_t size, kmp_routine_entry_t entry,
+			     atomic<long long> *sum)
+{
+  kmp_task_t *task = __kmpc_omp_task_alloc(0, 0, 1 /*tied*/, size,
+					   sizeof(KmpShareds), entry);
+  static_cast<KmpShareds *>(task->shareds)->sum = sum;
+  return task;
+}
+
+static void test_kmp_entry_points(void)
+{
+  atomic<long long> sum(0);
+#pragma omp parallel
+#pragma omp single
+  {
+    // deferred tasks and an undeferred one, waited on by a taskgroup
+    __kmpc_taskgroup(0, 0);
+    for(int i = 1; i <= 100; i++) {
+      kmp_task_t *task = kmp_alloc(sizeof(KmpValueTask), kmp_value_body, &sum);
+      reinterpret_cast<KmpValueTask *>(task)->value = i;
+      __kmpc_omp_task(0, 0, task);
+    }
+    kmp_task_t *task = kmp_alloc(sizeof(KmpValueTask), kmp_value_body, &sum);
+    reinterpret_cast<KmpValueTask *>(task)->value = 1000;
+    __kmpc_omp_task_begin_if0(0, 0, task);
+    kmp_value_body(0, task);
+    __kmpc_omp_task_complete_if0(0, 0, task);
+    __kmpc_end_taskgroup(0, 0);
+    check("kmp taskgroup", sum.load(), 6050);
+
+    // taskwait
+    sum.store(0);
+    for(int i = 1; i <= 10; i++) {
+      kmp_task_t *task = kmp_alloc(sizeof(KmpValueTask), kmp_value_body, &sum);
+      reinterpret_cast<KmpValueTask *>(task)->value = i;
+      __kmpc_omp_task(0, 0, task);
+    }
+    __kmpc_omp_taskwait(0, 0);
+    check("kmp taskwait", sum.load(), 55);
+
+    // taskloop with a grainsize (sched=1)
+    sum.store(0);
+    task = kmp_alloc(sizeof(KmpLoopTask), kmp_loop_body, &sum);
+    KmpLoopTask *loop = reinterpret_cast<KmpLoopTask *>(task);
+    loop->lb = 0;
+    loop->ub = 999;
+    loop->st = 1;
+    __kmpc_taskloop(0, 0, task, 1, &loop->lb, &loop->ub, loop->st,
+		    0 /*!nogroup*/, 1 /*grainsize*/, 10, 0);
+    check("kmp taskloop grainsize", sum.load(), 499500);
+
+    // taskloop with a non-unit stride and the default schedule
+    sum.store(0);
+    task = kmp_alloc(sizeof(KmpLoopTask), kmp_loop_body, &sum);
+    loop = reinterpret_cast<KmpLoopTask *>(task);
+    loop->lb = 5;
+    loop->ub = 100;
+    loop->st = 3;
+    __kmpc_taskloop(0, 0, task, 1, &loop->lb, &loop->ub, loop->st,
+		    0 /*!nogroup*/, 0 /*default*/, 0, 0);
+    long long expected = 0;
+    for(long long i = 5; i <= 100; i += 3)
+      expected += i;
+    check("kmp taskloop stride", sum.load(), expected);
+  }
+}
+#endif
+
+void omp_task(const void *args, size_t arglen,
+	      const void *userdata, size_t userlen, Processor p)
+{
+  const int num_tasks = TestConfig::num_tasks;
+
+  // tasks created by one thread and run by the whole team
+  {
+    atomic<long long> sum(0);
+#pragma omp parallel
+#pragma omp single
+    for(int i = 1; i <= num_tasks; i++) {
+#pragma omp task firstprivate(i) shared(sum)
+      sum.fetch_add(i);
+    }
+    check("tasks", sum.load(), (long long)num_tasks * (num_tasks + 1) / 2);
+  }
+
+  // recursive tasks with taskwait
+  {
+    long long result = 0;
+#pragma omp parallel
+#pragma omp single
+    result = fib(TestConfig::fib_n);
+    long long expected = 0, next = 1;
+    for(int i = 0; i < TestConfig::fib_n; i++) {
+      long long t = expected + next;
+      expected = next;
+      next = t;
+    }
+    check("fib", result, expected);
+  }
+
+  // taskloop with a grainsize and with a number of tasks
+  {
+    atomic<long long> sum(0);
+#pragma omp parallel
+#pragma omp single
+    {
+#pragma omp taskloop grainsize(7) shared(sum)
+      for(long long i = 0; i < 10000; i++)
+	sum.fetch_add(i);
+    }
+    check("taskloop grainsize", sum.load(), 49995000);
+
+    sum.store(0);
+#pragma omp parallel
+#pragma omp single
+    {
+#pragma omp taskloop num_tasks(13) shared(sum)
+      for(unsigned long long i = 10; i > 3; i--)
+	sum.fetch_add(i);
+    }
+    check("taskloop num_tasks", sum.load(), 49);
+  }
+
+  // a taskgroup waits for nested tasks too
+  {
+    atomic<long long> sum(0);
+#pragma omp parallel
+#pragma omp single
+    {
+#pragma omp taskgroup
+      {
+	for(int i = 0; i < 100; i++) {
+#pragma omp task shared(sum)
+	  {
+#pragma omp task shared(sum)
+	    sum.fetch_add(1);
+	  }
+	}
+      }
+      check("taskgroup", sum.load(), 100);
+    }
+  }
+
+  // taskwait only runs descendants of the waiting task
+  test_tied_waits();
+
+  // tasks outside of any parallel region run right away
+  {
+    atomic<long long> sum(0);
+#pragma omp task shared(sum)
+    sum.fetch_add(5);
+#pragma omp taskwait
+    check("task outside parallel", sum.load(), 5);
+  }
+
+#ifdef REALM_OPENMP_KMP_SUPPORT
+  test_kmp_entry_points();
+#endif
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Processor omp_proc = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::OMP_PROC)
+    .first();
+  if(!omp_proc.exists()) {
+    log_app.error() << "no OpenMP processors - run with -ll:ocpu 1";
+    errors++;
+  } else
+    omp_proc.spawn(OMP_TASK, 0, 0).wait();
+
+  if(errors == 0)
+    log_app.info() << "completed successfully";
+  else
+    log_app.error() << errors << " errors detected";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+int main(int argc, const char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, (char ***)&argv);
+
+  CommandLineParser clp;
+  clp.add_option_int("-n", TestConfig::num_tasks);
+  clp.add_option_int("-fib", TestConfig::fib_n);
+
+  bool ok = clp.parse_command_line(argc, argv);
+  assert(ok);
+
+  Processor::register_task_by_kind(Processor::LOC_PROC, false /*!global*/,
+				   TOP_LEVEL_TASK,
+				   CodeDescriptor(top_level_task),
+				   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(Processor::OMP_PROC, false /*!global*/,
+				   OMP_TASK,
+				   CodeDescriptor(omp_task),
+				   ProfilingRequestSet()).external_wait();
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
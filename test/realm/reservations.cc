@@ -0,0 +1,249 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for reservations contended by every processor in the machine -
+//  each processor builds chains of deferred exclusive and shared acquires
+//  and the tasks run while holding a reservation check that nobody else on
+//  their node holds it in a conflicting mode (run on multiple nodes with
+//  -ll:rsrv_local_limit and -ll:rsrv_migrate to exercise handing ownership
+//  to remote waiters)
+
+#include <realm.h>
+#include <realm/cmdline.h>
+
+#include "philox.h"
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+typedef Philox_2x32<> PRNG;
+
+enum {
+  // PRNG keys
+  PKEY_RSRV,
+  PKEY_MODE,
+};
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  CHAIN_TASK,
+  HOLDER_TASK,
+  REPORT_TASK,
+};
+
+enum {
+  MAX_RESERVATIONS = 64,
+  // holders in exclusive mode add this, shared ones add 1
+  EXCL_HOLDER = 1 << 16,
+};
+
+struct TestConfig {
+  int num_reservations;
+  int chain_length;
+  int shared_percent;
+  int watchdog_timeout;
+};
+
+struct ChainArgs {
+  TestConfig config;
+  Processor report_proc;
+  int index;
+  Reservation rsrvs[MAX_RESERVATIONS];
+};
+
+struct HolderArgs {
+  int rsrv_index;
+  bool exclusive;
+};
+
+// per-node record of who holds each reservation
+static atomic<int> holders[MAX_RESERVATIONS];
+static atomic<size_t> errors(0);
+
+void holder_task(const void *args, size_t arglen,
+		 const void *userdata, size_t userlen, Processor p)
+{
+  const HolderArgs& h_args = *reinterpret_cast<const HolderArgs *>(args);
+
+  atomic<int>& h = holders[h_args.rsrv_index];
+  int prev = h.fetch_add_acqrel(h_args.exclusive ? EXCL_HOLDER : 1);
+  bool ok = (h_args.exclusive ? (prev == 0) : (prev < EXCL_HOLDER));
+  if(!ok) {
+    log_app.error() << "reservation " << h_args.rsrv_index
+		    << " granted in conflicting mode: exclusive="
+		    << h_args.exclusive << " prev_holders=" << prev;
+    errors.fetch_add(1);
+  }
+  // stay in the critical section long enough for others to collide
+  usleep(10);
+  h.fetch_sub_acqrel(h_args.exclusive ? EXCL_HOLDER : 1);
+}
+
+void report_task(const void *args, size_t arglen,
+		 const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(size_t));
+  errors.fetch_add(*reinterpret_cast<const size_t *>(args));
+}
+
+void chain_task(const void *args, size_t arglen,
+		const void *userdata, size_t userlen, Processor p)
+{
+  const ChainArgs& c_args = *reinterpret_cast<const ChainArgs *>(args);
+
+  // each link waits for the previous one, so there's only ever one
+  //  outstanding request per processor, but all the processors are
+  //  fighting over a handful of reservations
+  Event prev = Event::NO_EVENT;
+  for(int i = 0; i < c_args.config.chain_length; i++) {
+    HolderArgs h_args;
+    h_args.rsrv_index = PRNG::rand_int(PKEY_RSRV, c_args.index, i,
+				       c_args.config.num_reservations);
+    h_args.exclusive = (PRNG::rand_int(PKEY_MODE, c_args.index, i, 100) >=
+			unsigned(c_args.config.shared_percent));
+    Reservation r = c_args.rsrvs[h_args.rsrv_index];
+    // shared acquires all use the same mode so they can be granted together
+    Event acquired = r.acquire(1, h_args.exclusive, prev);
+    Event done = p.spawn(HOLDER_TASK, &h_args, sizeof(h_args), acquired);
+    r.release(done);
+    prev = done;
+  }
+  prev.wait();
+
+  // errors are counted on whichever node ran the holder - every holder in
+  //  this chain is done, so anything it found is in our node's count now
+  size_t local_errors = errors.exchange(0);
+  if(local_errors > 0)
+    c_args.report_proc.spawn(REPORT_TASK,
+			     &local_errors, sizeof(local_errors)).wait();
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  const TestConfig& config = *reinterpret_cast<const TestConfig *>(args);
+
+  Machine::ProcessorQuery pq(Machine::get_machine());
+  pq.only_kind(p.kind());
+  std::vector<Processor> procs(pq.begin(), pq.end());
+
+  log_app.print() << "reservation test: " << procs.size() << " procs, "
+		  << config.num_reservations << " reservations, "
+		  << config.chain_length << " acquires/proc, "
+		  << config.shared_percent << "% shared";
+
+  ChainArgs c_args;
+  c_args.config = config;
+  c_args.report_proc = p;
+  for(int i = 0; i < config.num_reservations; i++)
+    c_args.rsrvs[i] = Reservation::create_reservation();
+
+  // set a timeout to catch hangs
+  if(config.watchdog_timeout > 0)
+    alarm(config.watchdog_timeout);
+
+  std::vector<Event> events;
+  for(size_t i = 0; i < procs.size(); i++) {
+    c_args.index = i;
+    events.push_back(procs[i].spawn(CHAIN_TASK, &c_args, sizeof(c_args)));
+  }
+  Event::merge_events(events).wait();
+
+  if(config.watchdog_timeout > 0)
+    alarm(0);
+
+  for(int i = 0; i < config.num_reservations; i++)
+    c_args.rsrvs[i].destroy_reservation();
+
+  // pick up anything left over on this node
+  size_t total_errors = errors.exchange(0);
+  if(total_errors == 0)
+    log_app.info() << "completed successfully";
+  else
+    log_app.error() << total_errors << " conflicting grants detected";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT,
+				  (total_errors == 0) ? 0 : 1);
+}
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  log_app.fatal() << "HELP!  Alarm triggered - likely deadlock!";
+  abort();
+}
+
+int main(int argc, const char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, (char ***)&argv);
+
+  TestConfig config;
+  config.num_reservations = 4;
+  config.chain_length = 200;
+  config.shared_percent = 25;
+  config.watchdog_timeout = 60; // 60 seconds
+
+  CommandLineParser clp;
+  clp.add_option_int("-r", config.num_reservations);
+  clp.add_option_int("-n", config.chain_length);
+  clp.add_option_int("-s", config.shared_percent);
+  clp.add_option_int("-timeout", config.watchdog_timeout);
+
+  bool ok = clp.parse_command_line(argc, argv);
+  assert(ok);
+  assert((config.num_reservations > 0) &&
+	 (config.num_reservations <= MAX_RESERVATIONS));
+  assert((config.shared_percent >= 0) && (config.shared_percent <= 100));
+
+  // try to use a cpu proc, but if that doesn't exist, take whatever we can get
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  if(!p.exists())
+    p = Machine::ProcessorQuery(Machine::get_machine()).first();
+  assert(p.exists());
+
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   TOP_LEVEL_TASK,
+				   CodeDescriptor(top_level_task),
+				   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   CHAIN_TASK,
+				   CodeDescriptor(chain_task),
+				   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   HOLDER_TASK,
+				   CodeDescriptor(holder_task),
+				   ProfilingRequestSet()).external_wait();
+  Processor::register_task_by_kind(p.kind(), false /*!global*/,
+				   REPORT_TASK,
+				   CodeDescriptor(report_task),
+				   ProfilingRequestSet()).external_wait();
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, &config, sizeof(config));
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
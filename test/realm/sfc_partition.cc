@@ -0,0 +1,353 @@
+// tests space-filling-curve partitioning of dense and sparse index spaces,
+//  with and without per-point weights - every point of the parent must end
+//  up in exactly one subspace and the subspaces should be balanced to within
+//  the weight of a single point
+
+#include "realm.h"
+#include "realm/cmdline.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include "osdep.h"
+#include "philox.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+namespace TestConfig {
+  int random_tests = 20;
+  int random_seed = 12345;
+  int max_pieces = 16;
+  bool verbose = false;
+};
+
+class PRNG {
+public:
+  typedef Philox_2x32<> PRNGBase;
+
+  PRNG(uint32_t _seed, uint32_t _stream)
+    : seed(_seed), stream(_stream), counter(0)
+  {}
+
+  uint32_t rand_int(uint32_t n)
+  {
+    return PRNGBase::rand_int(seed, stream, counter++, n);
+  }
+
+protected:
+  uint32_t seed, stream, counter;
+};
+
+static const char *curve_name(SpaceFillingCurve curve)
+{
+  return (curve == SFC_HILBERT) ? "hilbert" : "morton";
+}
+
+// checks that 'subspaces' exactly cover 'parent' and returns the weight of
+//  each subspace (unit weights if 'weight' is null)
+template <int N, typename T>
+bool check_cover(const IndexSpace<N,T>& parent,
+		 const std::vector<IndexSpace<N,T> >& subspaces,
+		 const AffineAccessor<int,N,T> *weight,
+		 std::vector<size_t>& piece_weights)
+{
+  piece_weights.assign(subspaces.size(), 0);
+  for(IndexSpaceIterator<N,T> it(parent); it.valid; it.step())
+    for(PointInRectIterator<N,T> pir(it.rect); pir.valid; pir.step()) {
+      int found = -1;
+      for(size_t i = 0; i < subspaces.size(); i++)
+	if(subspaces[i].contains(pir.p)) {
+	  if(found != -1) {
+	    log_app.error() << "point " << pir.p << " in subspaces "
+			    << found << " and " << i;
+	    return false;
+	  }
+	  found = i;
+	}
+      if(found == -1) {
+	log_app.error() << "point " << pir.p << " not in any subspace";
+	return false;
+      }
+      piece_weights[found] += (weight ? weight->read(pir.p) : 1);
+    }
+
+  size_t total_volume = 0;
+  for(size_t i = 0; i < subspaces.size(); i++)
+    total_volume += subspaces[i].volume();
+  if(total_volume != parent.volume()) {
+    log_app.error() << "subspaces have " << total_volume
+		    << " points, parent has " << parent.volume();
+    return false;
+  }
+  return true;
+}
+
+// every piece should be within one point's weight of the ideal share
+static bool check_balance(const std::vector<size_t>& piece_weights,
+			  size_t max_point_weight)
+{
+  size_t total = 0;
+  for(size_t i = 0; i < piece_weights.size(); i++)
+    total += piece_weights[i];
+  double ideal = double(total) / piece_weights.size();
+  for(size_t i = 0; i < piece_weights.size(); i++) {
+    double error = double(piece_weights[i]) - ideal;
+    if((error > max_point_weight) || (-error > max_point_weight)) {
+      log_app.error() << "piece " << i << " has weight " << piece_weights[i]
+		      << ", ideal is " << ideal;
+      return false;
+    }
+  }
+  return true;
+}
+
+// a dense 2-D space small enough that every curve cell is a single point
+template <typename T>
+bool test_dense(SpaceFillingCurve curve, size_t count)
+{
+  IndexSpace<2,T> parent(Rect<2,T>(Point<2,T>(0, 0), Point<2,T>(99, 149)));
+  std::vector<IndexSpace<2,T> > subspaces;
+  parent.create_subspaces_by_sfc(curve, count, subspaces,
+				 ProfilingRequestSet()).wait();
+
+  std::vector<size_t> piece_weights;
+  if(!check_cover(parent, subspaces, (AffineAccessor<int,2,T> *)0,
+		  piece_weights))
+    return false;
+  if(!check_balance(piece_weights, 1))
+    return false;
+
+  log_app.info() << "dense " << curve_name(curve) << " count=" << count << " ok";
+  return true;
+}
+
+// a random sparse N-D space, balanced by point count
+template <int N, typename T>
+bool test_sparse(int seed, SpaceFillingCurve curve)
+{
+  PRNG prng(seed, 0);
+  std::vector<Point<N,T> > points;
+  size_t num_points = 100 + prng.rand_int(2000);
+  for(size_t i = 0; i < num_points; i++) {
+    Point<N,T> p;
+    for(int j = 0; j < N; j++)
+      p[j] = T(prng.rand_int(1000)) - 300;
+    points.push_back(p);
+  }
+  IndexSpace<N,T> parent(points);
+  size_t count = 2 + prng.rand_int(TestConfig::max_pieces - 1);
+
+  std::vector<IndexSpace<N,T> > subspaces;
+  parent.create_subspaces_by_sfc(curve, count, subspaces,
+				 ProfilingRequestSet()).wait();
+  for(size_t i = 0; i < subspaces.size(); i++)
+    subspaces[i].make_valid().wait();
+
+  std::vector<size_t> piece_weights;
+  if(!check_cover(parent, subspaces, (AffineAccessor<int,N,T> *)0,
+		  piece_weights))
+    return false;
+  // in 2-D and 3-D the curve's cells hold several points, so this needs the
+  //  cells that cuts fall in to be split
+  if(!check_balance(piece_weights, 1))
+    return false;
+
+  if(TestConfig::verbose)
+    log_app.print() << "sparse N=" << N << " " << curve_name(curve)
+		    << " seed=" << seed << " count=" << count
+		    << " weights=" << PrettyVector<size_t>(piece_weights);
+
+  parent.destroy();
+  for(size_t i = 0; i < subspaces.size(); i++)
+    subspaces[i].destroy();
+  return true;
+}
+
+// a dense 2-D space whose weights live in two instances, one of them
+//  (when possible) on another node
+bool test_weighted(SpaceFillingCurve curve, size_t count)
+{
+  Rect<2> bounds(Point<2>(0, 0), Point<2>(63, 63));
+  IndexSpace<2> parent(bounds);
+
+  std::vector<Memory> memories;
+  Machine::MemoryQuery mq(Machine::get_machine());
+  mq.only_kind(Memory::SYSTEM_MEM);
+  for(Machine::MemoryQuery::iterator it = mq.begin(); it != mq.end(); ++it)
+    if((*it).capacity() > 0)
+      memories.push_back(*it);
+  assert(!memories.empty());
+
+  std::vector<size_t> field_sizes(1, sizeof(int));
+  std::vector<FieldDataDescriptor<IndexSpace<2>,int> > weights(2);
+  std::vector<RegionInstance> insts(2);
+  for(int i = 0; i < 2; i++) {
+    Rect<2> half = bounds;
+    if(i == 0) half.hi[0] = 31; else half.lo[0] = 32;
+    RegionInstance::create_instance(insts[i], memories[i % memories.size()],
+				    half, field_sizes, 0 /*SOA*/,
+				    ProfilingRequestSet()).wait();
+    weights[i].index_space = IndexSpace<2>(half);
+    weights[i].inst = insts[i];
+    weights[i].field_offset = 0;
+  }
+
+  // the right half of the space is three times as heavy as the left, and
+  //  a copy of all the weights is kept in a local instance for checking
+  Memory local_mem = Machine::MemoryQuery(Machine::get_machine())
+    .local_address_space().only_kind(Memory::SYSTEM_MEM).first();
+  RegionInstance check_inst;
+  RegionInstance::create_instance(check_inst, local_mem, bounds, field_sizes,
+				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  AffineAccessor<int,2> check_acc(check_inst, 0);
+  for(int i = 0; i < 2; i++) {
+    // instances may be remote, so fill them with copies
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    int value = (i == 0) ? 1 : 3;
+    srcs[0].set_fill(value);
+    dsts[0].set_field(insts[i], 0, sizeof(int));
+    weights[i].index_space.copy(srcs, dsts, ProfilingRequestSet()).wait();
+    for(PointInRectIterator<2> pir(weights[i].index_space.bounds); pir.valid; pir.step())
+      check_acc.write(pir.p, value);
+  }
+
+  std::vector<IndexSpace<2> > subspaces;
+  parent.create_subspaces_by_sfc(curve, count, weights, subspaces,
+				 ProfilingRequestSet()).wait();
+
+  bool ok = true;
+  std::vector<size_t> piece_weights;
+  if(!check_cover(parent, subspaces, &check_acc, piece_weights) ||
+     !check_balance(piece_weights, 3))
+    ok = false;
+
+  if(ok)
+    log_app.info() << "weighted " << curve_name(curve) << " count=" << count << " ok";
+
+  for(int i = 0; i < 2; i++)
+    insts[i].destroy();
+  check_inst.destroy();
+  for(size_t i = 0; i < subspaces.size(); i++)
+    subspaces[i].destroy();
+  return ok;
+}
+
+// a dense 2-D space whose curve cells hold 8 points each, with a heavy band
+//  across the middle that the cuts between pieces mostly fall in - pieces
+//  made of whole cells would be off by up to a cell's weight
+bool test_unbalanced(SpaceFillingCurve curve, size_t count)
+{
+  Rect<2> bounds(Point<2>(0, 0), Point<2>(2047, 63));
+  IndexSpace<2> parent(bounds);
+  const int heavy_weight = 100;
+
+  Memory local_mem = Machine::MemoryQuery(Machine::get_machine())
+    .local_address_space().only_kind(Memory::SYSTEM_MEM).first();
+  std::vector<size_t> field_sizes(1, sizeof(int));
+  RegionInstance inst;
+  RegionInstance::create_instance(inst, local_mem, bounds, field_sizes,
+				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  AffineAccessor<int,2> acc(inst, 0);
+  for(PointInRectIterator<2> pir(bounds); pir.valid; pir.step())
+    acc.write(pir.p, ((pir.p[0] >= 512) && (pir.p[0] < 1536)) ? heavy_weight : 1);
+
+  std::vector<FieldDataDescriptor<IndexSpace<2>,int> > weights(1);
+  weights[0].index_space = parent;
+  weights[0].inst = inst;
+  weights[0].field_offset = 0;
+
+  std::vector<IndexSpace<2> > subspaces;
+  parent.create_subspaces_by_sfc(curve, count, weights, subspaces,
+				 ProfilingRequestSet()).wait();
+
+  bool ok = true;
+  std::vector<size_t> piece_weights;
+  if(!check_cover(parent, subspaces, &acc, piece_weights) ||
+     !check_balance(piece_weights, heavy_weight))
+    ok = false;
+
+  if(TestConfig::verbose || !ok)
+    log_app.print() << "unbalanced " << curve_name(curve) << " count=" << count
+		    << " weights=" << PrettyVector<size_t>(piece_weights);
+  if(ok)
+    log_app.info() << "unbalanced " << curve_name(curve) << " count=" << count << " ok";
+
+  inst.destroy();
+  for(size_t i = 0; i < subspaces.size(); i++)
+    subspaces[i].destroy();
+  return ok;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "Realm space-filling curve partitioning test";
+
+  bool ok = true;
+
+  SpaceFillingCurve curves[2] = { SFC_MORTON, SFC_HILBERT };
+  for(int c = 0; ok && (c < 2); c++) {
+    if(!test_dense<int>(curves[c], 7) ||
+       !test_dense<long long>(curves[c], 13) ||
+       !test_weighted(curves[c], 5) ||
+       !test_unbalanced(curves[c], 7))
+      ok = false;
+
+    int seed = TestConfig::random_seed;
+    for(int i = 0; ok && (i < TestConfig::random_tests); i++, seed++)
+      if(!test_sparse<1,int>(seed, curves[c]) ||
+	 !test_sparse<2,int>(seed, curves[c]) ||
+	 !test_sparse<3,long long>(seed, curves[c]))
+	ok = false;
+  }
+
+  if(ok)
+    log_app.info() << "sfc_partition test finished successfully";
+  else
+    log_app.error() << "sfc_partition test finished with errors!";
+
+  Runtime::get_runtime().shutdown(Processor::get_current_finish_event(),
+				  ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  CommandLineParser cp;
+  cp.add_option_int("-rand", TestConfig::random_tests);
+  cp.add_option_int("-seed", TestConfig::random_seed);
+  cp.add_option_int("-pieces", TestConfig::max_pieces);
+  cp.add_option_bool("-verbose", TestConfig::verbose);
+  bool ok = cp.parse_command_line(argc, const_cast<const char **>(argv));
+  assert(ok);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  // select a processor to run the top level task on
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single task - everybody gets the same finish event
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // shutdown will be requested by main task
+
+  // now sleep this thread until that shutdown actually happens
+  int result = rt.wait_for_shutdown();
+
+  return result;
+}
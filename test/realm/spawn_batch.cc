@@ -0,0 +1,362 @@
+/* Copyright 2021 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Realm test for batching of remote task spawns - tasks are spawned to a
+//  processor on every other node:
+//  1) inside begin/end_spawn_batch, mixed with spawns too big to batch
+//  2) faster than the coalescing window, so batches are sent when they
+//       reach the size limit
+//  3) one at a time, so each is only sent when the window expires
+//  4) inside begin/end_spawn_batch, waiting on each spawn before the next,
+//       which needs the open batch to be sent when the wait starts
+//  and every processor must run its tasks in the order they were spawned
+//
+// batching only applies to remote spawns - on a single node the same
+//  spawns are made to local processors, but the timing checks are skipped
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <vector>
+#include <set>
+#include <map>
+
+#include "osdep.h"
+
+#include "realm.h"
+#include "realm/cmdline.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  ORDER_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+1,
+};
+
+enum {
+  FID_ORDER = 100,  // int: [0] = count, [1..] = sequence numbers
+};
+
+struct OrderTaskArgs {
+  RegionInstance inst;
+  int seq;
+  // spawns may carry extra (ignored) bytes to make them too big to batch
+};
+
+namespace TestConfig {
+  int num_tasks = 200;
+  int window_us = 200000;  // -ll:spawn_batch
+  int batch_kb = 1;        // -ll:spawn_batch_size
+  int large_every = 7;
+  int watchdog_timeout = 60;
+};
+
+void order_task(const void *args, size_t arglen,
+		const void *userdata, size_t userlen, Processor p)
+{
+  const OrderTaskArgs& o_args = *(const OrderTaskArgs *)args;
+
+  // tasks on a processor run one at a time, so no atomics are needed
+  AffineAccessor<int, 1> order(o_args.inst, FID_ORDER);
+  int count = order[0];
+  order[count + 1] = o_args.seq;
+  order[0] = count + 1;
+}
+
+static Event spawn_ordered(Processor target, RegionInstance inst, int seq,
+			   bool large)
+{
+  size_t arglen = (large ?
+		     (sizeof(OrderTaskArgs) + (TestConfig::batch_kb << 10)) :
+		     sizeof(OrderTaskArgs));
+  std::vector<char> argbuf(arglen, 0);
+  OrderTaskArgs *o_args = reinterpret_cast<OrderTaskArgs *>(&argbuf[0]);
+  o_args->inst = inst;
+  o_args->seq = seq;
+  return target.spawn(ORDER_TASK, &argbuf[0], arglen);
+}
+
+// one instance per target, near that target, for the task order
+static RegionInstance create_order_instance(Processor target, int num_tasks)
+{
+  Memory m = Machine::MemoryQuery(Machine::get_machine())
+    .has_affinity_to(target)
+    .only_kind(Memory::SYSTEM_MEM)
+    .first();
+  assert(m.exists());
+
+  Rect<1> bounds(0, num_tasks);
+  std::map<FieldID, size_t> fields;
+  fields[FID_ORDER] = sizeof(int);
+  RegionInstance inst;
+  RegionInstance::create_instance(inst, m, bounds, fields, 0 /*SOA*/,
+				  ProfilingRequestSet()).wait();
+
+  std::vector<CopySrcDstField> srcs(1), dsts(1);
+  srcs[0].set_fill(int(0));
+  dsts[0].set_field(inst, FID_ORDER, sizeof(int));
+  IndexSpace<1>(bounds).copy(srcs, dsts, ProfilingRequestSet()).wait();
+  return inst;
+}
+
+// copies a target's order back and checks that its tasks ran in spawn order
+static int check_order(const char *phase, Processor target,
+		       RegionInstance inst, int num_tasks, Memory local_mem)
+{
+  Rect<1> bounds(0, num_tasks);
+  std::map<FieldID, size_t> fields;
+  fields[FID_ORDER] = sizeof(int);
+  RegionInstance local_inst;
+  RegionInstance::create_instance(local_inst, local_mem, bounds, fields,
+				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  {
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_field(inst, FID_ORDER, sizeof(int));
+    dsts[0].set_field(local_inst, FID_ORDER, sizeof(int));
+    IndexSpace<1>(bounds).copy(srcs, dsts, ProfilingRequestSet()).wait();
+  }
+
+  int errors = 0;
+  AffineAccessor<int, 1> order(local_inst, FID_ORDER);
+  if(order[0] != num_tasks) {
+    log_app.error() << phase << ": " << target << " ran " << order[0]
+		    << " tasks, not " << num_tasks;
+    errors++;
+  }
+  for(int i = 0; (i < order[0]) && (i < num_tasks); i++)
+    if(order[i + 1] != i) {
+      log_app.error() << phase << ": " << target << " ran task " << order[i + 1]
+		      << " at position " << i;
+      errors++;
+      break;
+    }
+
+  local_inst.destroy();
+  inst.destroy();
+  return errors;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  int errors = 0;
+  const int num_tasks = TestConfig::num_tasks;
+
+  // a processor on each other node, or the local ones if there are none
+  std::vector<Processor> targets;
+  std::set<AddressSpace> seen;
+  seen.insert(p.address_space());
+  Machine::ProcessorQuery pq(Machine::get_machine());
+  pq.only_kind(Processor::LOC_PROC);
+  for(Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+    if(seen.count(it->address_space()) == 0) {
+      seen.insert(it->address_space());
+      targets.push_back(*it);
+    }
+  bool remote = !targets.empty();
+  if(!remote) {
+    log_app.print() << "no remote processors - spawns will not be batched";
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+      targets.push_back(*it);
+  }
+
+  Memory local_mem = Machine::MemoryQuery(Machine::get_machine())
+    .has_affinity_to(p)
+    .only_kind(Memory::SYSTEM_MEM)
+    .first();
+  assert(local_mem.exists());
+
+  if(TestConfig::watchdog_timeout > 0)
+    alarm(TestConfig::watchdog_timeout);
+
+  // 1) explicit batches - every few spawns is too big to batch and has to
+  //  go on its own, after everything batched ahead of it
+  {
+    std::vector<RegionInstance> insts;
+    for(size_t t = 0; t < targets.size(); t++)
+      insts.push_back(create_order_instance(targets[t], num_tasks));
+
+    std::vector<Event> events;
+    Processor::begin_spawn_batch();
+    for(int i = 0; i < num_tasks; i++)
+      for(size_t t = 0; t < targets.size(); t++) {
+	bool large = ((i % TestConfig::large_every) ==
+		      (TestConfig::large_every - 1));
+	events.push_back(spawn_ordered(targets[t], insts[t], i, large));
+      }
+    Processor::end_spawn_batch();
+    Event::merge_events(events).wait();
+
+    for(size_t t = 0; t < targets.size(); t++)
+      errors += check_order("explicit", targets[t], insts[t], num_tasks,
+			    local_mem);
+  }
+
+  // 2) spawns made faster than the window - batches fill up and are sent
+  //  right away, so the first task must not have waited for the window
+  {
+    std::vector<RegionInstance> insts;
+    for(size_t t = 0; t < targets.size(); t++)
+      insts.push_back(create_order_instance(targets[t], num_tasks));
+
+    long long t_start = Clock::current_time_in_nanoseconds();
+    std::vector<Event> events, first_events;
+    for(int i = 0; i < num_tasks; i++)
+      for(size_t t = 0; t < targets.size(); t++) {
+	Event e = spawn_ordered(targets[t], insts[t], i, false /*!large*/);
+	events.push_back(e);
+	if(i == 0)
+	  first_events.push_back(e);
+      }
+    Event::merge_events(first_events).wait();
+    long long t_first = Clock::current_time_in_nanoseconds() - t_start;
+    Event::merge_events(events).wait();
+
+    // make sure the spawns actually filled a batch
+    size_t bytes = size_t(num_tasks) * sizeof(OrderTaskArgs);
+    if(remote && (bytes > size_t(TestConfig::batch_kb << 10)) &&
+       (t_first >= (500LL * TestConfig::window_us))) {
+      log_app.error() << "window: first task took " << (t_first / 1000)
+		      << " us - full batch was not sent early";
+      errors++;
+    } else
+      log_app.info() << "window: first task took " << (t_first / 1000) << " us";
+
+    for(size_t t = 0; t < targets.size(); t++)
+      errors += check_order("window", targets[t], insts[t], num_tasks,
+			    local_mem);
+  }
+
+  // 3) single spawns - nothing else fills the batch, so it's the timer
+  //  that has to send each one
+  {
+    const int num_single = 3;
+    std::vector<RegionInstance> insts;
+    for(size_t t = 0; t < targets.size(); t++)
+      insts.push_back(create_order_instance(targets[t], num_single));
+
+    for(int i = 0; i < num_single; i++) {
+      long long t_start = Clock::current_time_in_nanoseconds();
+      std::vector<Event> events;
+      for(size_t t = 0; t < targets.size(); t++)
+	events.push_back(spawn_ordered(targets[t], insts[t], i,
+				       false /*!large*/));
+      Event::merge_events(events).wait();
+      long long elapsed = Clock::current_time_in_nanoseconds() - t_start;
+
+      // the task should have been held for about the window - allow plenty
+      //  of slack above that for a busy machine
+      if(remote && ((elapsed < (500LL * TestConfig::window_us)) ||
+		    (elapsed > (1000LL * TestConfig::window_us) + 5000000000LL))) {
+	log_app.error() << "timer: single spawn took " << (elapsed / 1000)
+			<< " us with a window of " << TestConfig::window_us << " us";
+	errors++;
+      } else
+	log_app.info() << "timer: single spawn took " << (elapsed / 1000) << " us";
+    }
+
+    for(size_t t = 0; t < targets.size(); t++)
+      errors += check_order("timer", targets[t], insts[t], num_single,
+			    local_mem);
+  }
+
+  // 4) waits inside an explicit batch - the spawn being waited on is still
+  //  in the batch, so it has to be sent before this task blocks
+  {
+    const int num_waited = 3;
+    std::vector<RegionInstance> insts;
+    for(size_t t = 0; t < targets.size(); t++)
+      insts.push_back(create_order_instance(targets[t], num_waited));
+
+    Processor::begin_spawn_batch();
+    for(int i = 0; i < num_waited; i++)
+      for(size_t t = 0; t < targets.size(); t++)
+	spawn_ordered(targets[t], insts[t], i, false /*!large*/).wait();
+    Processor::end_spawn_batch();
+
+    for(size_t t = 0; t < targets.size(); t++)
+      errors += check_order("wait", targets[t], insts[t], num_waited,
+			    local_mem);
+  }
+
+  if(TestConfig::watchdog_timeout > 0)
+    alarm(0);
+
+  if(errors == 0)
+    log_app.info() << "all spawns ran in order";
+  else
+    log_app.error() << errors << " errors detected";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
+}
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  log_app.fatal() << "HELP!  Alarm triggered - likely deadlock!";
+  abort();
+}
+
+int main(int argc, const char **argv)
+{
+  {
+    CommandLineParser clp;
+    clp.add_option_int("-tasks", TestConfig::num_tasks);
+    clp.add_option_int("-window", TestConfig::window_us);
+    clp.add_option_int("-batchkb", TestConfig::batch_kb);
+    clp.add_option_int("-timeout", TestConfig::watchdog_timeout);
+    bool ok = clp.parse_command_line(argc, argv);
+    assert(ok);
+  }
+
+  // the runtime is configured to match the test's window and batch size
+  char window_arg[32], batch_arg[32];
+  snprintf(window_arg, sizeof(window_arg), "%d", TestConfig::window_us);
+  snprintf(batch_arg, sizeof(batch_arg), "%d", TestConfig::batch_kb);
+  std::vector<const char *> args(argv, argv + argc);
+  args.push_back("-ll:spawn_batch");
+  args.push_back(window_arg);
+  args.push_back("-ll:spawn_batch_size");
+  args.push_back(batch_arg);
+  int my_argc = args.size();
+  args.push_back(0);
+  const char **my_argv = &args[0];
+
+  Runtime rt;
+
+  rt.init(&my_argc, (char ***)&my_argv);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(ORDER_TASK, order_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single top level task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // now sleep this thread until that shutdown actually happens
+  int ret = rt.wait_for_shutdown();
+
+  return ret;
+}
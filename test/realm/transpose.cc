@@ -206,6 +206,105 @@ void do_single_dim(Memory src_mem, Memory dst_mem, int log2_size,
     it->destroy();
 }
 
+// a value that differs between neighboring points in every dimension, even
+//  once truncated to a single byte
+template <int N, typename FT>
+static FT check_value(const Point<N>& pt)
+{
+  unsigned long long v = 0x9e3779b97f4a7c15ULL;
+  for(int i = 0; i < N; i++)
+    v = (v ^ (pt[i] + 1)) * 0xff51afd7ed558ccdULL;
+  return FT(v ^ (v >> 29));
+}
+
+// copies between every pair of dimension orders, with extents that are not
+//  multiples of the tiles used by the transposing kernels and a padded
+//  source, and checks every element of every copy
+template <int N, typename FT>
+int check_single_dim(Memory src_mem, Memory dst_mem, const int *extents)
+{
+  std::vector<LayoutPermutation<N> > perms;
+  LayoutPermutation<N> scratch;
+  memset(&scratch, 0, sizeof(scratch));
+  create_permutations<N>(perms, scratch, 0);
+
+  Rect<N> bounds, bounds_pad;
+  for(int i = 0; i < N; i++) {
+    bounds.lo[i] = bounds_pad.lo[i] = 0;
+    bounds.hi[i] = extents[i] - 1;
+    bounds_pad.hi[i] = extents[i] - 1 + 3;
+  }
+  IndexSpace<N> is(bounds), is_pad(bounds_pad);
+
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[0] = sizeof(FT);
+  InstanceLayoutConstraints ilc(field_sizes, 1);
+
+  std::vector<RegionInstance> src_insts, dst_insts;
+  for(size_t p = 0; p < perms.size(); p++) {
+    InstanceLayoutGeneric *ilg = InstanceLayoutGeneric::choose_instance_layout<N,int>(is_pad, ilc, perms[p].dim_order);
+    RegionInstance s_inst;
+    RegionInstance::create_instance(s_inst, src_mem, ilg,
+				    ProfilingRequestSet()).wait();
+    AffineAccessor<FT, N> acc(s_inst, 0);
+    for(PointInRectIterator<N> pir(bounds_pad); pir.valid; pir.step())
+      acc[pir.p] = check_value<N,FT>(pir.p);
+    src_insts.push_back(s_inst);
+
+    ilg = InstanceLayoutGeneric::choose_instance_layout<N,int>(is, ilc, perms[p].dim_order);
+    RegionInstance d_inst;
+    RegionInstance::create_instance(d_inst, dst_mem, ilg,
+				    ProfilingRequestSet()).wait();
+    dst_insts.push_back(d_inst);
+  }
+
+  int errors = 0;
+  for(size_t i = 0; i < perms.size(); i++)
+    for(size_t j = 0; j < perms.size(); j++) {
+      std::vector<CopySrcDstField> srcs(1), dsts(1);
+      FT fill_value = 0;
+      dsts[0].set_field(dst_insts[j], 0, sizeof(FT));
+      Event e = is.fill(dsts, ProfilingRequestSet(),
+			&fill_value, sizeof(fill_value));
+      srcs[0].set_field(src_insts[i], 0, sizeof(FT));
+      is.copy(srcs, dsts, ProfilingRequestSet(), e).wait();
+
+      AffineAccessor<FT, N> acc(dst_insts[j], 0);
+      int mismatches = 0;
+      for(PointInRectIterator<N> pir(bounds); pir.valid; pir.step())
+	if(acc[pir.p] != check_value<N,FT>(pir.p)) {
+	  if(mismatches == 0)
+	    log_app.error() << "mismatch: size=" << sizeof(FT)
+			    << " src=" << perms[i].name
+			    << " dst=" << perms[j].name
+			    << " point=" << pir.p;
+	  mismatches++;
+	}
+      if(mismatches > 0) {
+	log_app.error() << mismatches << " of " << is.volume()
+			<< " elements wrong: size=" << sizeof(FT)
+			<< " src=" << perms[i].name
+			<< " dst=" << perms[j].name;
+	errors++;
+      }
+    }
+
+  for(size_t p = 0; p < perms.size(); p++) {
+    src_insts[p].destroy();
+    dst_insts[p].destroy();
+  }
+  return errors;
+}
+
+template <int N>
+int check_all_sizes(Memory m, const int *extents)
+{
+  return (check_single_dim<N, unsigned char>(m, m, extents) +
+	  check_single_dim<N, unsigned short>(m, m, extents) +
+	  check_single_dim<N, unsigned int>(m, m, extents) +
+	  check_single_dim<N, unsigned long long>(m, m, extents));
+}
+
 std::set<Processor::Kind> supported_proc_kinds;
 
 void top_level_task(const void *args, size_t arglen, 
@@ -222,6 +321,20 @@ void top_level_task(const void *args, size_t arglen,
   do_single_dim<1, FT>(m, m, log2_buffer_size, p);
   do_single_dim<2, FT>(m, m, log2_buffer_size, p);
   do_single_dim<3, FT>(m, m, log2_buffer_size, p);
+
+  // the timed copies above only move constants around - check the
+  //  contents of a smaller set of copies for each element size
+  int errors = 0;
+  static const int extents_2d[2] = { 67, 45 };
+  static const int extents_3d[3] = { 19, 23, 37 };
+  errors += check_all_sizes<2>(m, extents_2d);
+  errors += check_all_sizes<3>(m, extents_3d);
+  if(errors == 0)
+    log_app.print() << "transposed contents checked";
+  else
+    log_app.error() << errors << " copies had wrong contents";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, (errors == 0) ? 0 : 1);
 }
 
 int main(int argc, char **argv)
@@ -253,13 +366,8 @@ int main(int argc, char **argv)
   assert(p.exists());
 
   // collective launch of a single task - everybody gets the same finish event
-  Event e = rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
-
-  // request shutdown once that task is complete
-  rt.shutdown(e);
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
 
   // now sleep this thread until that shutdown actually happens
-  rt.wait_for_shutdown();
-  
-  return 0;
+  return rt.wait_for_shutdown();
 }
@@ -116,6 +116,7 @@ dep_part_kinds = {
     13 : 'Partition by Preimage Range',
     14 : 'Create Association',
     15 : 'Partition by Weights',
+    16 : 'Partition by Space-Filling Curve',
 }
 # Make sure this is up to date with legion_config.h
 legion_equality_kind_t = {
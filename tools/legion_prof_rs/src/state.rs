@@ -73,6 +73,7 @@ pub enum DepPartKind {
     PartitionByPreimageRange = 13,
     CreateAssociation = 14,
     PartitionByWeights = 15,
+    PartitionBySpaceFillingCurve = 16,
 }
 
 impl fmt::Display for DepPartKind {
@@ -88,6 +89,9 @@ impl fmt::Display for DepPartKind {
             DepPartKind::PartitionByPreimageRange => write!(f, "Partition by Preimage Range"),
             DepPartKind::CreateAssociation => write!(f, "Create Association"),
             DepPartKind::PartitionByWeights => write!(f, "Partition by Weights"),
+            DepPartKind::PartitionBySpaceFillingCurve => {
+                write!(f, "Partition by Space-Filling Curve")
+            }
             _ => write!(f, "{:?}", self),
         }
     }
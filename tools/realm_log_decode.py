@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+
+# Copyright 2021 Stanford University, NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# renders log files written by Realm with -logbinary 1 as the same text
+#  that the default text logger would have produced
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b'REALMLOG'
+VERSIONS = (1, 2, 3)
+
+RECORD_CATEGORY = 1
+RECORD_MESSAGE = 2
+RECORD_FORMAT = 3
+RECORD_PRINTF = 4
+RECORD_STREAM = 5
+
+# items of a stream record
+ITEM_LITERAL = 1
+ITEM_SIGNED = 2
+ITEM_UNSIGNED = 3
+ITEM_DOUBLE = 4
+ITEM_TEXT = 5
+
+HEADER = struct.Struct('=8sIi')
+CATEGORY = struct.Struct('=HH')
+MESSAGE = struct.Struct('=BHQqI')
+FORMAT = struct.Struct('=II')
+PRINTF = struct.Struct('=BHQqII')
+STREAM = struct.Struct('=BHQqI')
+FMTID = struct.Struct('=I')
+INT = struct.Struct('=q')
+UINT = struct.Struct('=Q')
+DOUBLE = struct.Struct('=d')
+STRLEN = struct.Struct('=I')
+
+# a C printf conversion, as walked by the writer
+CONVERSION = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?"
+                        r"(?:\.(?P<prec>\*|\d*))?"
+                        r"(?P<len>hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXcpfFeEgGaAs%])")
+
+def format_printf(fmt, args):
+    # applies the arguments of a printf record to its format string the way
+    #  C's printf would
+    pos = [0]
+
+    def take(s):
+        v = s.unpack_from(args, pos[0])[0]
+        pos[0] += s.size
+        return v
+
+    def convert(m):
+        conv = m.group('conv')
+        if m.group(0) == '%%':
+            return '%'
+        flags = m.group('flags')
+        width = m.group('width')
+        prec = m.group('prec')
+        if width == '*':
+            w = take(INT)
+            if w < 0:
+                flags += '-'
+                w = -w
+            width = str(w)
+        if prec == '*':
+            p = take(INT)
+            prec = str(p) if p >= 0 else None
+        spec = '%' + flags + (width or '') + ('.' + prec if prec is not None else '')
+        if conv in 'di':
+            return (spec + 'd') % take(INT)
+        if conv in 'uxX':
+            return (spec + ('d' if conv == 'u' else conv)) % take(UINT)
+        if conv == 'o':
+            v = take(UINT)
+            if '#' in flags:
+                # C's alternate form is a leading 0, not Python's 0o
+                digits = '%o' % v
+                if not digits.startswith('0'):
+                    digits = '0' + digits
+                return (spec.replace('#', '') + 's') % digits
+            return (spec + 'o') % v
+        if conv == 'c':
+            return (spec + 'c') % chr(take(INT) & 0xff)
+        if conv == 'p':
+            return ('%' + flags.replace('#', '') + (width or '') + 's') % hex(take(UINT))
+        if conv in 'aA':
+            v = float.hex(take(DOUBLE))
+            return ('%' + flags.replace('#', '') + (width or '') + 's') % (v.upper() if conv == 'A' else v)
+        if conv in 'fFeEgG':
+            return (spec + conv) % take(DOUBLE)
+        # 's'
+        n = take(STRLEN)
+        v = args[pos[0]:pos[0] + n].decode('utf-8', 'replace')
+        pos[0] += n
+        return (spec + 's') % v
+
+    return CONVERSION.sub(convert, fmt)
+
+def format_stream(formats, items):
+    # concatenates the items of a stream record the way the LoggerMessage's
+    #  ostream printed them
+    pieces = []
+    pos = 0
+    while pos < len(items):
+        item = items[pos]
+        pos += 1
+        if item == ITEM_LITERAL:
+            pieces.append(formats[FMTID.unpack_from(items, pos)[0]])
+            pos += FMTID.size
+        elif item == ITEM_SIGNED:
+            pieces.append(str(INT.unpack_from(items, pos)[0]))
+            pos += INT.size
+        elif item == ITEM_UNSIGNED:
+            pieces.append(str(UINT.unpack_from(items, pos)[0]))
+            pos += UINT.size
+        elif item == ITEM_DOUBLE:
+            pieces.append('%g' % DOUBLE.unpack_from(items, pos)[0])
+            pos += DOUBLE.size
+        elif item == ITEM_TEXT:
+            n = STRLEN.unpack_from(items, pos)[0]
+            pos += STRLEN.size
+            pieces.append(items[pos:pos + n].decode('utf-8', 'replace'))
+            pos += n
+        else:
+            raise ValueError('unknown stream item type {}'.format(item))
+    return ''.join(pieces)
+
+def read_records(f):
+    data = f.read()
+    magic, version, node_id = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError('not a Realm binary log')
+    if version not in VERSIONS:
+        raise ValueError('unsupported binary log version {}'.format(version))
+    pos = HEADER.size
+
+    categories = {}
+    formats = {}
+    messages = []
+    while pos < len(data):
+        rectype = data[pos]
+        pos += 1
+        if rectype == RECORD_CATEGORY:
+            cat_id, name_len = CATEGORY.unpack_from(data, pos)
+            pos += CATEGORY.size
+            categories[cat_id] = data[pos:pos + name_len].decode('utf-8', 'replace')
+            pos += name_len
+        elif rectype == RECORD_MESSAGE:
+            level, cat_id, thread, time_ns, msg_len = MESSAGE.unpack_from(data, pos)
+            pos += MESSAGE.size
+            msg = data[pos:pos + msg_len].decode('utf-8', 'replace')
+            pos += msg_len
+            messages.append((time_ns, len(messages), level, cat_id, thread, msg))
+        elif rectype == RECORD_FORMAT:
+            fmt_id, fmt_len = FORMAT.unpack_from(data, pos)
+            pos += FORMAT.size
+            formats[fmt_id] = data[pos:pos + fmt_len].decode('utf-8', 'replace')
+            pos += fmt_len
+        elif rectype == RECORD_PRINTF:
+            level, cat_id, thread, time_ns, fmt_id, args_len = PRINTF.unpack_from(data, pos)
+            pos += PRINTF.size
+            msg = format_printf(formats[fmt_id], data[pos:pos + args_len])
+            pos += args_len
+            messages.append((time_ns, len(messages), level, cat_id, thread, msg))
+        elif rectype == RECORD_STREAM:
+            level, cat_id, thread, time_ns, items_len = STREAM.unpack_from(data, pos)
+            pos += STREAM.size
+            msg = format_stream(formats, data[pos:pos + items_len])
+            pos += items_len
+            messages.append((time_ns, len(messages), level, cat_id, thread, msg))
+        else:
+            raise ValueError('unknown record type {} at offset {}'.format(rectype, pos - 1))
+    return node_id, categories, messages
+
+def main():
+    parser = argparse.ArgumentParser(description='decode a Realm binary log')
+    parser.add_argument('-t', '--no-timestamp', action='store_true',
+                        help='omit timestamps (like -logtime 0)')
+    parser.add_argument('-u', '--unsorted', action='store_true',
+                        help='keep file order instead of sorting by time')
+    parser.add_argument('files', nargs='+', help='binary log file(s)')
+    args = parser.parse_args()
+
+    for filename in args.files:
+        with open(filename, 'rb') as f:
+            node_id, categories, messages = read_records(f)
+        # each thread buffers its own records, so file order is only
+        #  per-thread order - sort on (time, file position) to interleave
+        if not args.unsorted:
+            messages.sort()
+        for time_ns, _, level, cat_id, thread, msg in messages:
+            name = categories.get(cat_id, '?{}'.format(cat_id))
+            if args.no_timestamp:
+                sys.stdout.write('[{} - {:x}] {{{}}}{{{}}}: {}\n'.format(
+                    node_id, thread, level, name, msg))
+            else:
+                sys.stdout.write('[{} - {:x}] {:11.6f} {{{}}}{{{}}}: {}\n'.format(
+                    node_id, thread, time_ns * 1e-9, level, name, msg))
+
+if __name__ == '__main__':
+    main()